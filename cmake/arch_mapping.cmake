@@ -36,8 +36,13 @@ string(TOLOWER "${DMOSI_COMPILER}"    _compiler)
 # -----------------------------------------------------------------------
 if(_compiler STREQUAL "gcc")
 
+    # --- Raspberry Pi RP2040 (dual Cortex-M0+, SMP) -----------------------
+    if(_family STREQUAL "rp2040")
+        set(FREERTOS_PORT "GCC_RP2040")
+        set(FREERTOS_ARCH_CONFIG_SUBDIR "rp2040")
+
     # --- ARM Cortex-M ---------------------------------------------------
-    if(_family STREQUAL "cortex-m0" OR _family STREQUAL "cortex-m0+")
+    elseif(_family STREQUAL "cortex-m0" OR _family STREQUAL "cortex-m0+")
         set(FREERTOS_PORT "GCC_ARM_CM0")
         set(FREERTOS_ARCH_CONFIG_SUBDIR "arm_cm0")
 
@@ -43,6 +43,26 @@
 #ifndef FREERTOS_CONFIG_H
 #define FREERTOS_CONFIG_H
 
+/* DMOSI_MPU selects the process isolation mode: the MPU is enabled and the
+ * threads of isolated dmosi processes run as restricted tasks. Only
+ * supported by the ARMv8-M mainline ports.
+ * Configurable via CMake parameter DMOSI_MPU. */
+#ifndef DMOSI_MPU
+    #define DMOSI_MPU    0
+#endif
+
+#if DMOSI_MPU
+    #define configENABLE_MPU    1
+#endif
+
+/* DMOSI_STACK_LIMIT_HW detects stack overflows with the hardware stack limit
+ * register (PSPLIM) instead of the pattern check on every context switch.
+ * Only supported by ports that define DMOSI_ARCH_HAS_STACK_LIMIT.
+ * Configurable via CMake parameter DMOSI_STACK_LIMIT_HW. */
+#ifndef DMOSI_STACK_LIMIT_HW
+    #define DMOSI_STACK_LIMIT_HW    0
+#endif
+
 /* Include architecture-specific configuration defaults.
  * The build system adds the appropriate config/arch/<arch>/ directory to the
  * include path when DMOSI_ARCH and DMOSI_ARCH_FAMILY are set in CMake.
@@ -118,8 +138,29 @@
  * 0 to keep the tick interrupt running at all times.  Not all FreeRTOS ports
  * support tickless mode. See
  * https://www.freertos.org/low-power-tickless-rtos.html Defaults to 0 if left
- * undefined. */
-#define configUSE_TICKLESS_IDLE                    0
+ * undefined.
+ * Configurable via CMake parameter DMOSI_TICKLESS_IDLE.  The architecture
+ * config defines DMOSI_ARCH_HAS_TICKLESS_IDLE when the port implements
+ * vPortSuppressTicksAndSleep(); other ports need an application-provided
+ * portSUPPRESS_TICKS_AND_SLEEP. */
+#ifndef DMOSI_TICKLESS_IDLE
+    #define DMOSI_TICKLESS_IDLE    0
+#endif
+#define configUSE_TICKLESS_IDLE                    DMOSI_TICKLESS_IDLE
+
+#if ( configUSE_TICKLESS_IDLE != 0 ) && !defined( DMOSI_ARCH_HAS_TICKLESS_IDLE ) && !defined( portSUPPRESS_TICKS_AND_SLEEP )
+    #error "DMOSI_TICKLESS_IDLE requires a port with tickless support or a custom portSUPPRESS_TICKS_AND_SLEEP"
+#endif
+
+/* The dmosi power management layer picks the sleep state and runs the
+ * registered module hooks around every tickless sleep (see
+ * dmosi_pm_register_hook()). */
+#if ( configUSE_TICKLESS_IDLE != 0 )
+    extern uint64_t dmosi_pm_pre_sleep( uint64_t idle_ticks );
+    extern void dmosi_pm_post_sleep( uint64_t idle_ticks );
+    #define configPRE_SLEEP_PROCESSING( x )     ( x ) = ( TickType_t ) dmosi_pm_pre_sleep( ( uint64_t ) ( x ) )
+    #define configPOST_SLEEP_PROCESSING( x )    dmosi_pm_post_sleep( ( uint64_t ) ( x ) )
+#endif
 
 /* configMAX_PRIORITIES Sets the number of available task priorities.  Tasks can
  * be assigned priorities of 0 to (configMAX_PRIORITIES - 1).  Zero is the
@@ -166,8 +207,9 @@
 /* Each task has an array of task notifications.
  * configTASK_NOTIFICATION_ARRAY_ENTRIES sets the number of indexes in the
  * array. See https://www.freertos.org/RTOS-task-notifications.html  Defaults to
- * 1 if left undefined. */
-#define configTASK_NOTIFICATION_ARRAY_ENTRIES      1
+ * 1 if left undefined. dmosi reserves indexes 1 and 2 for its wait engines
+ * and events (see src/dmosi_notify.h). */
+#define configTASK_NOTIFICATION_ARRAY_ENTRIES      3
 
 /* configQUEUE_REGISTRY_SIZE sets the maximum number of queues and semaphores
  * that can be referenced from the queue registry.  Only required when using a
@@ -388,8 +430,27 @@
  * writer must provide the stack overflow callback when
  * configCHECK_FOR_STACK_OVERFLOW is set to 1. See
  * https://www.freertos.org/Stacks-and-stack-overflow-checking.html  Defaults to
- * 0 if left undefined. */
-#define configCHECK_FOR_STACK_OVERFLOW        2
+ * 0 if left undefined.
+ *
+ * With DMOSI_STACK_LIMIT_HW (implied by DMOSI_MPU, whose restricted task
+ * stacks are MPU regions of their own) the port loads PSPLIM on each context
+ * switch, so an overflow raises a UsageFault at the offending push; the
+ * pattern check would only add overhead. */
+#if DMOSI_STACK_LIMIT_HW && !defined( DMOSI_ARCH_HAS_STACK_LIMIT )
+    #error "DMOSI_STACK_LIMIT_HW requires a port with a hardware stack limit (ARMv8-M mainline)"
+#endif
+
+#if DMOSI_MPU || DMOSI_STACK_LIMIT_HW
+    #define configCHECK_FOR_STACK_OVERFLOW    0
+#else
+    #define configCHECK_FOR_STACK_OVERFLOW    2
+#endif
+
+/* Set configRECORD_STACK_HIGH_ADDRESS to 1 to store the start address of the
+ * stack in the TCB, which vTaskGetInfo() then reports together with the
+ * saved stack pointer. dmosi_thread_get_info() and the stack advisor derive
+ * the current stack usage of a thread from them. */
+#define configRECORD_STACK_HIGH_ADDRESS    1
 
 /******************************************************************************/
 /* Run time and task stats gathering related definitions. *********************/
@@ -404,22 +465,39 @@
 
 /* portCONFIGURE_TIMER_FOR_RUN_TIME_STATS and portGET_RUN_TIME_COUNTER_VALUE
  * are required by FreeRTOS when configGENERATE_RUN_TIME_STATS == 1.
- * Dmod_GetUptime() provides a system-wide millisecond uptime counter that is
- * used as the run-time stats clock source.  The timer configuration is a
- * no-op because Dmod_GetUptime() does not require explicit timer setup.
- * Override these macros in the architecture-specific FreeRTOSConfigArch.h
- * (or your application's config) if a higher-resolution counter is needed. */
+ * Architectures with a free-running cycle counter select it in their
+ * FreeRTOSConfigArch.h (DMOSI_ARCH_RUNTIME_DWT, DMOSI_ARCH_RUNTIME_MCYCLE or
+ * DMOSI_ARCH_RUNTIME_CNTVCT); dmosi_runtime_counter() extends it to 64 bits
+ * and dmosi_runtime_get_counter_hz() reports its frequency.  Elsewhere
+ * dmosi_get_time_us() provides a lock-free 64-bit microsecond clock built
+ * from the tick count and the architecture's sub-tick counter, which needs
+ * no timer setup.  To use a different counter (e.g. a general-purpose
+ * hardware timer), define both macros in the architecture-specific
+ * FreeRTOSConfigArch.h or your application's config, together with
+ * DMOSI_RUN_TIME_COUNTER_HZ so dmosi knows the counter frequency. */
+#if !defined( portGET_RUN_TIME_COUNTER_VALUE ) && \
+    ( defined( DMOSI_ARCH_RUNTIME_DWT ) || defined( DMOSI_ARCH_RUNTIME_MCYCLE ) || defined( DMOSI_ARCH_RUNTIME_CNTVCT ) )
+    extern void dmosi_runtime_counter_init( void );
+    extern uint64_t dmosi_runtime_counter( void );
+    #ifndef portCONFIGURE_TIMER_FOR_RUN_TIME_STATS
+        #define portCONFIGURE_TIMER_FOR_RUN_TIME_STATS()    dmosi_runtime_counter_init()
+    #endif
+    #define portGET_RUN_TIME_COUNTER_VALUE()    dmosi_runtime_counter()
+#endif
+
 #ifndef portCONFIGURE_TIMER_FOR_RUN_TIME_STATS
     #define portCONFIGURE_TIMER_FOR_RUN_TIME_STATS()    do {} while( 0 )
 #endif
 
 #ifndef portGET_RUN_TIME_COUNTER_VALUE
-    #define portGET_RUN_TIME_COUNTER_VALUE()    Dmod_GetUptime()
+    extern uint64_t dmosi_get_time_us( void );
+    #define portGET_RUN_TIME_COUNTER_VALUE()    dmosi_get_time_us()
+    #define DMOSI_RUN_TIME_COUNTER_HZ           1000000ULL
 #endif
 
 /* configRUN_TIME_COUNTER_TYPE must match the return type of the counter macro
- * above.  Dmod_GetUptime() returns Dmod_Timestamp_t (uint64_t), so use the
- * same width to avoid truncation of the uptime value. */
+ * above.  dmosi_get_time_us() returns uint64_t, so use the same width to
+ * avoid truncation of the counter value. */
 #ifndef configRUN_TIME_COUNTER_TYPE
     #define configRUN_TIME_COUNTER_TYPE    uint64_t
 #endif
@@ -430,6 +508,68 @@
  * undefined. */
 #define configUSE_TRACE_FACILITY                1
 
+/* DMOSI_TRACE hooks the trace macros below into the dmosi trace recorder
+ * (see dmosi_trace_start()). Configurable via the CMake option of the same
+ * name; when disabled the kernel's empty default macros are used. */
+#ifndef DMOSI_TRACE
+    #define DMOSI_TRACE    0
+#endif
+#if ( DMOSI_TRACE != 0 )
+    extern void dmosi_trace_task_switched_in( const void * task );
+    extern void dmosi_trace_task_switched_out( const void * task );
+    extern void dmosi_trace_task_create( void * task );
+    extern void dmosi_trace_task_delete( const void * task );
+    extern void dmosi_trace_task_notify( const void * task, uint32_t index );
+    extern void dmosi_trace_queue_create( void * queue );
+    extern void dmosi_trace_queue_delete( void * queue );
+    extern void dmosi_trace_queue_send( void * queue, int passed, int from_isr );
+    extern void dmosi_trace_queue_receive( void * queue, int passed, int from_isr );
+    extern void dmosi_trace_queue_block( void * queue, int sending );
+    extern void dmosi_trace_timer_expired( const void * timer );
+    extern void dmosi_trace_isr_enter( uint32_t irq );
+    extern void dmosi_trace_isr_exit( void );
+
+    #define traceTASK_SWITCHED_IN()                       dmosi_trace_task_switched_in( pxCurrentTCB )
+    #define traceTASK_SWITCHED_OUT()                      dmosi_trace_task_switched_out( pxCurrentTCB )
+    #define traceTASK_CREATE( pxNewTCB )                  dmosi_trace_task_create( pxNewTCB )
+    /* pxTCB is the notified task in all three kernel notify functions */
+    #define traceTASK_NOTIFY( uxIndexToNotify )           dmosi_trace_task_notify( pxTCB, ( uint32_t ) ( uxIndexToNotify ) )
+    #define traceTASK_NOTIFY_FROM_ISR( uxIndexToNotify )  dmosi_trace_task_notify( pxTCB, ( uint32_t ) ( uxIndexToNotify ) )
+    #define traceTASK_NOTIFY_GIVE_FROM_ISR( uxIndexToNotify ) \
+    dmosi_trace_task_notify( pxTCB, ( uint32_t ) ( uxIndexToNotify ) )
+    #define traceQUEUE_CREATE( pxNewQueue )               dmosi_trace_queue_create( pxNewQueue )
+    #define traceQUEUE_DELETE( pxQueue )                  dmosi_trace_queue_delete( pxQueue )
+    #define traceQUEUE_SEND( pxQueue )                    dmosi_trace_queue_send( pxQueue, 1, 0 )
+    #define traceQUEUE_SEND_FAILED( pxQueue )             dmosi_trace_queue_send( pxQueue, 0, 0 )
+    #define traceQUEUE_SEND_FROM_ISR( pxQueue )           dmosi_trace_queue_send( pxQueue, 1, 1 )
+    #define traceQUEUE_SEND_FROM_ISR_FAILED( pxQueue )    dmosi_trace_queue_send( pxQueue, 0, 1 )
+    #define traceQUEUE_RECEIVE( pxQueue )                 dmosi_trace_queue_receive( pxQueue, 1, 0 )
+    #define traceQUEUE_RECEIVE_FAILED( pxQueue )          dmosi_trace_queue_receive( pxQueue, 0, 0 )
+    #define traceQUEUE_RECEIVE_FROM_ISR( pxQueue )        dmosi_trace_queue_receive( pxQueue, 1, 1 )
+    #define traceQUEUE_RECEIVE_FROM_ISR_FAILED( pxQueue ) dmosi_trace_queue_receive( pxQueue, 0, 1 )
+    #define traceBLOCKING_ON_QUEUE_SEND( pxQueue )        dmosi_trace_queue_block( pxQueue, 1 )
+    #define traceBLOCKING_ON_QUEUE_RECEIVE( pxQueue )     dmosi_trace_queue_block( pxQueue, 0 )
+    #define traceTIMER_EXPIRED( pxTimer )                 dmosi_trace_timer_expired( pxTimer )
+    /* Interrupts of the port itself (tick, ...) on ports providing these hooks */
+    #define traceISR_ENTER()                              dmosi_trace_isr_enter( 0xFFFFFFFFUL )
+    #define traceISR_EXIT()                               dmosi_trace_isr_exit()
+    #define traceISR_EXIT_TO_SCHEDULER()                  dmosi_trace_isr_exit()
+#endif
+
+/* Drops tasks deleted with vTaskDelete() directly, bypassing dmosi, from the
+ * dmosi thread registry. Always installed; chained with the trace recorder
+ * when DMOSI_TRACE is enabled. */
+extern void dmosi_thread_task_deleted( void * task );
+#if ( DMOSI_TRACE != 0 )
+    #define traceTASK_DELETE( pxTaskToDelete )       \
+    do {                                             \
+        dmosi_thread_task_deleted( pxTaskToDelete ); \
+        dmosi_trace_task_delete( pxTaskToDelete );   \
+    } while( 0 )
+#else
+    #define traceTASK_DELETE( pxTaskToDelete )    dmosi_thread_task_deleted( pxTaskToDelete )
+#endif
+
 /* Set to 1 to include the vTaskList() and vTaskGetRunTimeStats() functions in
  * the build.  Set to 0 to exclude these functions from the build.  These two
  * functions introduce a dependency on string formatting functions that would
@@ -505,8 +645,11 @@
  * escalations originating from outside of the kernel code itself.  Set to 1 to
  * allow application tasks to raise privilege.  Defaults to 1 if left undefined.
  * Only used by the FreeRTOS Cortex-M MPU ports, not the standard ARMv7-M
- * Cortex-M port. */
-#define configENFORCE_SYSTEM_CALLS_FROM_KERNEL_ONLY               1
+ * Cortex-M port.
+ *
+ * DMOSI_MPU needs 0: the dmosi API entry points raise privilege while they
+ * run on behalf of an isolated thread (see src/dmosi_mpu.h). */
+#define configENFORCE_SYSTEM_CALLS_FROM_KERNEL_ONLY               ( DMOSI_MPU ? 0 : 1 )
 
 /* Set configALLOW_UNPRIVILEGED_CRITICAL_SECTIONS to 1 to allow unprivileged
  * tasks enter critical sections (effectively mask interrupts). Set to 0 to
@@ -518,8 +661,11 @@
 /* FreeRTOS Kernel version 10.6.0 introduced a new v2 MPU wrapper, namely
  * mpu_wrappers_v2.c. Set configUSE_MPU_WRAPPERS_V1 to 0 to use the new v2 MPU
  * wrapper. Set configUSE_MPU_WRAPPERS_V1 to 1 to use the old v1 MPU wrapper
- * (mpu_wrappers.c). Defaults to 0 if left undefined. */
-#define configUSE_MPU_WRAPPERS_V1                                 0
+ * (mpu_wrappers.c). Defaults to 0 if left undefined.
+ *
+ * DMOSI_MPU uses the v1 wrapper, which lets dmosi raise privilege for its
+ * own bookkeeping and accepts kernel objects created by privileged code. */
+#define configUSE_MPU_WRAPPERS_V1                                 ( DMOSI_MPU ? 1 : 0 )
 
 /* When using the v2 MPU wrapper, set configPROTECTED_KERNEL_OBJECT_POOL_SIZE to
  * the total number of kernel objects, which includes tasks, queues, semaphores,
@@ -550,11 +696,13 @@
 /******************************************************************************/
 
 /* Set configNUMBER_OF_CORES to the number of available processor cores.
- * Defaults to 1 if left undefined. */
-
-/*
- #define configNUMBER_OF_CORES                     [Num of available cores]
- */
+ * Defaults to 1 if left undefined.
+ * Configurable via CMake parameter DMOSI_NUMBER_OF_CORES.
+ * Arch-specific default is set in config/arch/<arch>/FreeRTOSConfigArch.h. */
+#ifndef DMOSI_NUMBER_OF_CORES
+    #define DMOSI_NUMBER_OF_CORES    1
+#endif
+#define configNUMBER_OF_CORES                     DMOSI_NUMBER_OF_CORES
 
 /* When using SMP (i.e. configNUMBER_OF_CORES is greater than one), set
  * configRUN_MULTIPLE_PRIORITIES to 0 to allow multiple tasks to run
@@ -571,7 +719,7 @@
  * vTaskCoreAffinityGet APIs can be used to set and retrieve which cores a task
  * can run on. If configUSE_CORE_AFFINITY is set to 0 then the FreeRTOS
  * scheduler is free to run any task on any available core. */
-#define configUSE_CORE_AFFINITY                   0
+#define configUSE_CORE_AFFINITY                   ( configNUMBER_OF_CORES > 1 )
 
 /* When using SMP with core affinity feature enabled, set
  * configTASK_DEFAULT_CORE_AFFINITY to change the default core affinity mask for
@@ -722,9 +870,9 @@
 #define INCLUDE_xTaskGetSchedulerState         1
 #define INCLUDE_xTaskGetCurrentTaskHandle      1
 #define INCLUDE_uxTaskGetStackHighWaterMark    1
-#define INCLUDE_xTaskGetIdleTaskHandle         0
+#define INCLUDE_xTaskGetIdleTaskHandle         1
 #define INCLUDE_eTaskGetState                  1
-#define INCLUDE_xTimerPendFunctionCall         0
+#define INCLUDE_xTimerPendFunctionCall         1
 #define INCLUDE_xTaskAbortDelay                0
 #define INCLUDE_xTaskGetHandle                 0
 #define INCLUDE_xTaskResumeFromISR             1
@@ -18,4 +18,8 @@
 #define FreeRTOS_SWI_Handler     dmosi_syscall_handler
 #define FreeRTOS_Tick_Handler    dmosi_tick_handler
 
+/* Run-time statistics use the virtual count of the generic timer
+ * (CNTVCT_EL0); its frequency is read from CNTFRQ_EL0. */
+#define DMOSI_ARCH_RUNTIME_CNTVCT    1
+
 #endif /* FREERTOS_CONFIG_ARCH_H */
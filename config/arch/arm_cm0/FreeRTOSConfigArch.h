@@ -15,6 +15,15 @@
     #define DMOSI_TICK_TYPE_WIDTH_IN_BITS    TICK_TYPE_WIDTH_32_BITS
 #endif
 
+/* The port implements SysTick-based tickless idle (vPortSuppressTicksAndSleep),
+ * so DMOSI_TICKLESS_IDLE can be enabled without a custom
+ * portSUPPRESS_TICKS_AND_SLEEP.  Sleep states deeper than WFI that stop the
+ * SysTick clock need a low-power timer based implementation instead. */
+#define DMOSI_ARCH_HAS_TICKLESS_IDLE    1
+
+/* dmosi_get_time_ns() refines the tick count with the SysTick current value. */
+#define DMOSI_ARCH_TIME_SYSTICK    1
+
 /* Cortex-M0/M0+ has an optional MPU. Disabled by default; set to 1 to enable. */
 #ifndef configENABLE_MPU
     #define configENABLE_MPU    0
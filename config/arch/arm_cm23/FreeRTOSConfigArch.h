@@ -23,6 +23,15 @@
     #define DMOSI_TICK_TYPE_WIDTH_IN_BITS    TICK_TYPE_WIDTH_32_BITS
 #endif
 
+/* The port implements SysTick-based tickless idle (vPortSuppressTicksAndSleep),
+ * so DMOSI_TICKLESS_IDLE can be enabled without a custom
+ * portSUPPRESS_TICKS_AND_SLEEP.  Sleep states deeper than WFI that stop the
+ * SysTick clock need a low-power timer based implementation instead. */
+#define DMOSI_ARCH_HAS_TICKLESS_IDLE    1
+
+/* dmosi_get_time_ns() refines the tick count with the SysTick current value. */
+#define DMOSI_ARCH_TIME_SYSTICK    1
+
 /* TrustZone disabled by default. Set to 1 together with
  * configRUN_FREERTOS_SECURE_ONLY=0 to enable TrustZone support. */
 #ifndef configENABLE_TRUSTZONE
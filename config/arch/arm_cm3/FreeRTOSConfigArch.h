@@ -15,6 +15,19 @@
     #define DMOSI_TICK_TYPE_WIDTH_IN_BITS    TICK_TYPE_WIDTH_32_BITS
 #endif
 
+/* The port implements SysTick-based tickless idle (vPortSuppressTicksAndSleep),
+ * so DMOSI_TICKLESS_IDLE can be enabled without a custom
+ * portSUPPRESS_TICKS_AND_SLEEP.  Sleep states deeper than WFI that stop the
+ * SysTick clock need a low-power timer based implementation instead. */
+#define DMOSI_ARCH_HAS_TICKLESS_IDLE    1
+
+/* dmosi_get_time_ns() refines the tick count with the SysTick current value. */
+#define DMOSI_ARCH_TIME_SYSTICK    1
+
+/* Run-time statistics count CPU cycles with the DWT cycle counter (CYCCNT),
+ * falling back to dmosi_get_time_us() on parts that do not implement it. */
+#define DMOSI_ARCH_RUNTIME_DWT    1
+
 /* Map FreeRTOS ARM Cortex-M3 interrupt handler names to the dmosi system
  * interrupt interface.  This lets users install dmosi_syscall_handler,
  * dmosi_context_switch_handler, and dmosi_tick_handler directly in their
@@ -19,6 +19,19 @@
     #define DMOSI_TICK_TYPE_WIDTH_IN_BITS    TICK_TYPE_WIDTH_32_BITS
 #endif
 
+/* The port implements SysTick-based tickless idle (vPortSuppressTicksAndSleep),
+ * so DMOSI_TICKLESS_IDLE can be enabled without a custom
+ * portSUPPRESS_TICKS_AND_SLEEP.  Sleep states deeper than WFI that stop the
+ * SysTick clock need a low-power timer based implementation instead. */
+#define DMOSI_ARCH_HAS_TICKLESS_IDLE    1
+
+/* dmosi_get_time_ns() refines the tick count with the SysTick current value. */
+#define DMOSI_ARCH_TIME_SYSTICK    1
+
+/* Run-time statistics count CPU cycles with the DWT cycle counter (CYCCNT),
+ * falling back to dmosi_get_time_us() on parts that do not implement it. */
+#define DMOSI_ARCH_RUNTIME_DWT    1
+
 /* Interrupt priority configuration for ARM Cortex-M7.
  *
  * On ARM Cortex-M, interrupt priorities are stored in the most-significant bits
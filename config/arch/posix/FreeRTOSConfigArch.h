@@ -28,4 +28,7 @@ extern uint32_t ulPortGetRunTime( void );
  * always safe to report "not inside an interrupt" here. */
 #define xPortIsInsideInterrupt()    ( 0 )
 
+/* dmosi_get_time_ns() reads the host's CLOCK_MONOTONIC directly. */
+#define DMOSI_ARCH_TIME_CLOCK_GETTIME    1
+
 #endif /* FREERTOS_CONFIG_ARCH_H */
@@ -13,4 +13,8 @@
     #define DMOSI_TICK_TYPE_WIDTH_IN_BITS    TICK_TYPE_WIDTH_32_BITS
 #endif
 
+/* Run-time statistics count CPU cycles with the machine cycle counter
+ * (mcycle), which runs at configCPU_CLOCK_HZ. */
+#define DMOSI_ARCH_RUNTIME_MCYCLE    1
+
 #endif /* FREERTOS_CONFIG_ARCH_H */
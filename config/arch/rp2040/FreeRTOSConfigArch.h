@@ -0,0 +1,29 @@
+/*
+ * Architecture-specific FreeRTOS configuration for the GCC RP2040 port.
+ *
+ * The GCC_RP2040 port (portable/ThirdParty/GCC/RP2040) targets the Raspberry
+ * Pi RP2040 and runs the scheduler on both Cortex-M0+ cores by default; set
+ * DMOSI_NUMBER_OF_CORES=1 to keep the second core for bare-metal code.
+ *
+ * The port supports 16-bit and 32-bit tick types only and has no FPU.
+ */
+
+#ifndef FREERTOS_CONFIG_ARCH_H
+#define FREERTOS_CONFIG_ARCH_H
+
+/* The RP2040 port supports only 16-bit and 32-bit tick types. */
+#ifndef DMOSI_TICK_TYPE_WIDTH_IN_BITS
+    #define DMOSI_TICK_TYPE_WIDTH_IN_BITS    TICK_TYPE_WIDTH_32_BITS
+#endif
+
+/* Both Cortex-M0+ cores */
+#ifndef DMOSI_NUMBER_OF_CORES
+    #define DMOSI_NUMBER_OF_CORES    2
+#endif
+
+/* The Cortex-M0+ MPU is not supported by this port. */
+#ifndef configENABLE_MPU
+    #define configENABLE_MPU    0
+#endif
+
+#endif /* FREERTOS_CONFIG_ARCH_H */
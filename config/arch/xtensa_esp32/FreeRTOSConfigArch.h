@@ -2,6 +2,9 @@
  * Architecture-specific FreeRTOS configuration for GCC Xtensa ESP32 port.
  *
  * The GCC_XTENSA_ESP32 port targets Espressif ESP32 class Xtensa MCUs.
+ * The classic ESP32 and the ESP32-S3 are dual-core, so the scheduler runs on
+ * both cores by default; set DMOSI_NUMBER_OF_CORES=1 for single-core parts
+ * such as the ESP32-S2.
  */
 
 #ifndef FREERTOS_CONFIG_ARCH_H
@@ -11,4 +14,9 @@
     #define DMOSI_TICK_TYPE_WIDTH_IN_BITS    TICK_TYPE_WIDTH_32_BITS
 #endif
 
+/* PRO_CPU and APP_CPU */
+#ifndef DMOSI_NUMBER_OF_CORES
+    #define DMOSI_NUMBER_OF_CORES    2
+#endif
+
 #endif /* FREERTOS_CONFIG_ARCH_H */
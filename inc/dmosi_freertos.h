@@ -0,0 +1,1857 @@
+#ifndef DMOSI_FREERTOS_H
+#define DMOSI_FREERTOS_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "dmosi.h"
+#include "FreeRTOS.h"
+
+/*
+ * FreeRTOS-specific extensions of the dmosi API.
+ *
+ * Everything declared here is provided only by the dmosi-freertos backend,
+ * in addition to the portable interface declared in dmosi.h.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//==============================================================================
+//                              Object pools
+//==============================================================================
+
+/**
+ * @brief Wrapper object types served by a fixed-size pool
+ */
+typedef enum {
+    DMOSI_POOL_MUTEX = 0,       /**< struct dmosi_mutex wrappers */
+    DMOSI_POOL_SEMAPHORE,       /**< struct dmosi_semaphore wrappers */
+    DMOSI_POOL_QUEUE,           /**< struct dmosi_queue wrappers */
+    DMOSI_POOL_TIMER,           /**< struct dmosi_timer wrappers */
+    DMOSI_POOL_FUTURE,          /**< struct dmosi_future objects */
+    DMOSI_POOL_TYPE_COUNT       /**< Number of pool types */
+} dmosi_pool_type_t;
+
+/**
+ * @brief Usage statistics of a wrapper object pool
+ */
+typedef struct {
+    size_t capacity;            /**< Number of blocks in the pool (0 = pool disabled) */
+    size_t in_use;              /**< Blocks currently allocated from the pool */
+    uint32_t hits;              /**< Allocations served from the pool */
+    uint32_t misses;            /**< Allocations that fell back to the heap */
+} dmosi_pool_stats_t;
+
+/**
+ * @brief Get usage statistics of a wrapper object pool
+ *
+ * @param type Pool to query
+ * @param stats Structure to fill
+ * @return int 0 on success, -EINVAL on invalid arguments
+ */
+int dmosi_pool_get_stats(dmosi_pool_type_t type, dmosi_pool_stats_t* stats);
+
+//==============================================================================
+//                              Heap statistics
+//==============================================================================
+
+/**
+ * @brief Capacity of a module name in the heap statistics (longer names are truncated)
+ */
+#define DMOSI_HEAP_MODULE_NAME_LENGTH    32
+
+/**
+ * @brief Heap usage statistics
+ */
+typedef struct {
+    size_t bytes_in_use;        /**< Bytes currently allocated */
+    size_t peak_bytes;          /**< High watermark of @ref bytes_in_use */
+    uint32_t allocations;       /**< Successful allocations so far */
+    uint32_t failures;          /**< Allocations that failed */
+} dmosi_heap_stats_t;
+
+/**
+ * @brief Heap usage statistics of one module
+ */
+typedef struct {
+    char module_name[DMOSI_HEAP_MODULE_NAME_LENGTH];   /**< Module name ("" = untagged and overflow) */
+    dmosi_heap_stats_t stats;                           /**< Statistics of the module */
+} dmosi_heap_module_stats_t;
+
+/**
+ * @brief Get the heap statistics of a module
+ *
+ * @param module_name Module name (NULL = totals over all modules)
+ * @param stats Structure to fill
+ * @return int 0 on success, -ENOENT if the module never allocated,
+ *         -ENOTSUP if DMOSI_HEAP_STATS is disabled, -EINVAL on invalid arguments
+ */
+int dmosi_heap_get_stats(const char* module_name, dmosi_heap_stats_t* stats);
+
+/**
+ * @brief Get the heap statistics of all modules
+ *
+ * @param entries Array to fill
+ * @param max_entries Capacity of @p entries
+ * @return size_t Number of entries filled
+ */
+size_t dmosi_heap_get_module_stats(dmosi_heap_module_stats_t* entries, size_t max_entries);
+
+//==============================================================================
+//                              Object statistics
+//==============================================================================
+
+/*
+ * With DMOSI_OBJECT_STATS enabled every mutex, semaphore and queue carries
+ * a statistics block and is kept in a registry of live objects, so the
+ * bottleneck among them can be found at run time. The option changes the
+ * size of the objects and their static storage, so it is exported to all
+ * users of the library; when it is disabled nothing is counted.
+ */
+
+#ifndef DMOSI_OBJECT_STATS
+    #define DMOSI_OBJECT_STATS    0
+#endif
+
+/**
+ * @brief Synchronization object types tracked by the object statistics
+ */
+typedef enum {
+    DMOSI_OBJECT_TYPE_MUTEX = 0,        /**< dmosi_mutex_t */
+    DMOSI_OBJECT_TYPE_SEMAPHORE,        /**< dmosi_semaphore_t */
+    DMOSI_OBJECT_TYPE_QUEUE             /**< dmosi_queue_t */
+} dmosi_object_type_t;
+
+/**
+ * @brief Usage statistics of a synchronization object
+ */
+typedef struct {
+    uint32_t operations;            /**< Successful locks, waits and posts, or items sent and received */
+    uint32_t blocked;               /**< Operations that had to wait */
+    uint32_t timeouts;              /**< Operations that gave up (-ETIMEDOUT or -EAGAIN) */
+    uint32_t high_water;            /**< Queues: most items queued; mutexes and semaphores: most waiting threads */
+    uint64_t wait_time_total_us;    /**< Total time spent waiting by blocked operations */
+    uint32_t wait_time_max_us;      /**< Longest wait of a single operation */
+} dmosi_object_stats_t;
+
+/**
+ * @brief Statistics of a live synchronization object
+ */
+typedef struct {
+    const void* object;             /**< Object handle (dmosi_mutex_t, dmosi_semaphore_t or dmosi_queue_t) */
+    dmosi_object_type_t type;       /**< Object type */
+    const char* name;               /**< Name set with dmosi_object_set_name(), NULL if none */
+    dmosi_object_stats_t stats;     /**< Statistics of the object */
+} dmosi_object_info_t;
+
+/**
+ * @brief Storage of the statistics block inside the object wrappers
+ *
+ * Private; only used to size the *_storage_t types below.
+ */
+typedef struct {
+    dmosi_object_stats_t stats;     /**< Private counters */
+    void* reserved[6];              /**< Private registry fields */
+} dmosi_object_stats_storage_t;
+
+/**
+ * @brief Name a synchronization object in the statistics
+ *
+ * @param object Object handle
+ * @param name Name to report (not copied, must stay valid; NULL = none)
+ * @return int 0 on success, -ENOENT if @p object is not a live object,
+ *         -ENOTSUP if DMOSI_OBJECT_STATS is disabled, -EINVAL on invalid arguments
+ */
+int dmosi_object_set_name(const void* object, const char* name);
+
+/**
+ * @brief Get the statistics of a synchronization object
+ *
+ * @param object Object handle
+ * @param stats Structure to fill
+ * @return int 0 on success, -ENOENT if @p object is not a live object,
+ *         -ENOTSUP if DMOSI_OBJECT_STATS is disabled, -EINVAL on invalid arguments
+ */
+int dmosi_object_get_stats(const void* object, dmosi_object_stats_t* stats);
+
+/**
+ * @brief Enumerate the live synchronization objects with their statistics
+ *
+ * @param entries Array to fill
+ * @param max_entries Capacity of @p entries
+ * @return size_t Number of entries filled (0 if DMOSI_OBJECT_STATS is disabled)
+ */
+size_t dmosi_object_get_all(dmosi_object_info_t* entries, size_t max_entries);
+
+//==============================================================================
+//                              Static allocation
+//==============================================================================
+
+/*
+ * Caller-provided storage for the *_create_static() functions.
+ *
+ * Each storage type holds the dmosi wrapper together with the embedded
+ * FreeRTOS control block, so an object created from it needs no heap memory
+ * at all and can be placed in any RAM region (e.g. tightly-coupled memory).
+ * The layout is private: treat these types as opaque and only reserve them.
+ * The storage must stay valid until the object is destroyed.
+ */
+
+/**
+ * @brief Storage for a statically allocated mutex
+ */
+typedef struct {
+    StaticSemaphore_t control;      /**< Kernel control block */
+    uint64_t reserved_wait_time;    /**< Private wait time counter (sets the alignment) */
+    void* reserved[14];             /**< Private wrapper fields */
+#if DMOSI_OBJECT_STATS
+    dmosi_object_stats_storage_t stats; /**< Private statistics block */
+#endif
+} dmosi_mutex_storage_t;
+
+/**
+ * @brief Storage for a statically allocated semaphore
+ */
+typedef struct {
+    void* reserved[5];              /**< Private semaphore fields */
+#if DMOSI_OBJECT_STATS
+    dmosi_object_stats_storage_t stats; /**< Private statistics block */
+#endif
+} dmosi_semaphore_storage_t;
+
+/**
+ * @brief Storage for a statically allocated queue (item buffer excluded)
+ */
+typedef struct {
+    StaticQueue_t control;          /**< Kernel control block */
+    void* reserved[5];              /**< Private wrapper fields */
+#if DMOSI_OBJECT_STATS
+    dmosi_object_stats_storage_t stats; /**< Private statistics block */
+#endif
+} dmosi_queue_storage_t;
+
+/**
+ * @brief Storage for a statically allocated timer
+ */
+typedef struct {
+    StaticTimer_t control;          /**< Kernel control block */
+    void* reserved[6];              /**< Private wrapper fields */
+} dmosi_timer_storage_t;
+
+/**
+ * @brief Storage for a statically allocated thread (stack excluded)
+ */
+typedef struct {
+    StaticTask_t control;           /**< Kernel task control block */
+    uint64_t reserved_cpu_time;     /**< Private run-time counter (sets the alignment) */
+    void* reserved[62];             /**< Private wrapper fields, including the CPU usage samples */
+} dmosi_thread_storage_t;
+
+/**
+ * @brief Create a mutex in caller-provided storage
+ *
+ * @param storage Storage for the mutex
+ * @param recursive Whether the mutex should be recursive
+ * @return dmosi_mutex_t Created mutex handle, NULL on failure
+ */
+dmosi_mutex_t dmosi_mutex_create_static(dmosi_mutex_storage_t* storage, bool recursive);
+
+/**
+ * @brief Create a counting semaphore in caller-provided storage
+ *
+ * @param storage Storage for the semaphore
+ * @param initial_count Initial count for the semaphore
+ * @param max_count Maximum count for the semaphore
+ * @return dmosi_semaphore_t Created semaphore handle, NULL on failure
+ */
+dmosi_semaphore_t dmosi_semaphore_create_static(dmosi_semaphore_storage_t* storage, uint32_t initial_count, uint32_t max_count);
+
+/**
+ * @brief Create a queue in caller-provided storage
+ *
+ * @param storage Storage for the queue
+ * @param item_size Size of each item in the queue
+ * @param queue_length Maximum number of items in the queue
+ * @param buffer Item buffer of at least @p item_size * @p queue_length bytes
+ * @return dmosi_queue_t Created queue handle, NULL on failure
+ */
+dmosi_queue_t dmosi_queue_create_static(dmosi_queue_storage_t* storage, size_t item_size, uint32_t queue_length, void* buffer);
+
+/**
+ * @brief Create a timer in caller-provided storage
+ *
+ * @param storage Storage for the timer
+ * @param callback Callback function to execute when timer expires
+ * @param arg Argument to pass to the callback function
+ * @param period_ms Timer period in milliseconds
+ * @param auto_reload Whether the timer should auto-reload
+ * @return dmosi_timer_t Created timer handle, NULL on failure
+ */
+dmosi_timer_t dmosi_timer_create_static(dmosi_timer_storage_t* storage, dmosi_timer_callback_t callback, void* arg, uint32_t period_ms, bool auto_reload);
+
+/**
+ * @brief Create a thread with caller-provided control block and stack
+ *
+ * @param storage Storage for the thread and its task control block
+ * @param entry Entry function for the thread
+ * @param arg Argument to pass to the entry function
+ * @param priority Thread priority
+ * @param stack Stack buffer (aligned to StackType_t)
+ * @param stack_size Size of @p stack in bytes
+ * @param name Name of the thread (cannot be NULL)
+ * @param process Process to associate the thread with (NULL = current process)
+ * @return dmosi_thread_t Created thread handle, NULL on failure
+ */
+dmosi_thread_t dmosi_thread_create_static(dmosi_thread_storage_t* storage, dmosi_thread_entry_t entry, void* arg, int priority, void* stack, size_t stack_size, const char* name, dmosi_process_t process);
+
+//==============================================================================
+//                              High-resolution time
+//==============================================================================
+
+/**
+ * @brief Get the monotonic time in nanoseconds
+ *
+ * 64-bit, lock-free and safe to call from interrupts. The resolution is that
+ * of the architecture's sub-tick counter (SysTick on Cortex-M,
+ * CLOCK_MONOTONIC on POSIX) and one tick elsewhere.
+ *
+ * @return uint64_t Nanoseconds since the scheduler started
+ */
+uint64_t dmosi_get_time_ns(void);
+
+/**
+ * @brief Get the monotonic time in microseconds
+ *
+ * @return uint64_t Microseconds since the scheduler started
+ */
+uint64_t dmosi_get_time_us(void);
+
+//==============================================================================
+//                              Tick-domain timeouts
+//==============================================================================
+
+/**
+ * @brief Tick timeout meaning "wait forever" for the *_ticks functions
+ */
+#define DMOSI_TICKS_FOREVER     UINT32_MAX
+
+/**
+ * @brief Convert milliseconds to ticks
+ *
+ * Rounds up to whole ticks. Millisecond timeouts and sleeps of the backend
+ * wait one tick more than this, because the tick in progress when a wait
+ * starts may be almost over; they never end before the requested time.
+ *
+ * @param ms Time in milliseconds
+ * @return uint32_t Tick count, saturated below DMOSI_TICKS_FOREVER
+ */
+uint32_t dmosi_ms_to_ticks(uint32_t ms);
+
+/**
+ * @brief Convert ticks to milliseconds, rounding down
+ *
+ * @param ticks Tick count
+ * @return uint32_t Milliseconds, saturated at UINT32_MAX
+ */
+uint32_t dmosi_ticks_to_ms(uint32_t ticks);
+
+/**
+ * @brief dmosi_queue_send() with a timeout in ticks
+ *
+ * @param queue Queue handle
+ * @param item Pointer to the item to send
+ * @param ticks Timeout in ticks (0 = no wait, DMOSI_TICKS_FOREVER = wait forever)
+ * @return int 0 on success, negative error code on failure
+ */
+int dmosi_queue_send_ticks(dmosi_queue_t queue, const void* item, uint32_t ticks);
+
+/**
+ * @brief dmosi_queue_receive() with a timeout in ticks
+ *
+ * @param queue Queue handle
+ * @param item Pointer to buffer to receive the item
+ * @param ticks Timeout in ticks (0 = no wait, DMOSI_TICKS_FOREVER = wait forever)
+ * @return int 0 on success, negative error code on failure
+ */
+int dmosi_queue_receive_ticks(dmosi_queue_t queue, void* item, uint32_t ticks);
+
+/**
+ * @brief dmosi_semaphore_wait() with a timeout in ticks
+ *
+ * @param semaphore Semaphore handle
+ * @param count Number of units to take
+ * @param ticks Timeout in ticks (0 = no wait, DMOSI_TICKS_FOREVER = wait forever)
+ * @return int 0 on success, negative error code on failure
+ */
+int dmosi_semaphore_wait_ticks(dmosi_semaphore_t semaphore, uint32_t count, uint32_t ticks);
+
+/**
+ * @brief dmosi_thread_sleep() with a duration in ticks
+ *
+ * @param ticks Ticks to sleep (0 = yield to threads of equal priority)
+ */
+void dmosi_thread_sleep_ticks(uint32_t ticks);
+
+//==============================================================================
+//                              Thread priority
+//==============================================================================
+
+/**
+ * @brief Change the priority of a thread
+ *
+ * @param thread Thread handle (NULL = current thread)
+ * @param priority New priority (0 .. configMAX_PRIORITIES - 1)
+ * @return int 0 on success, -EINVAL if @p priority is out of range,
+ *         -ESRCH if the thread has terminated
+ */
+int dmosi_thread_set_priority(dmosi_thread_t thread, int priority);
+
+//==============================================================================
+//                              Periodic threads
+//==============================================================================
+
+/*
+ * A periodic schedule keeps an absolute wake-up time that advances by exactly
+ * one period per activation (xTaskDelayUntil), so the execution time of a
+ * control loop does not add drift the way a relative dmosi_thread_sleep()
+ * does. Periods that are not a whole number of ticks are tracked with a
+ * sub-tick remainder and are exact on average.
+ *
+ *     dmosi_periodic_t p;
+ *     dmosi_periodic_init(&p, 2500);          // 400 Hz
+ *     for (;;) {
+ *         control_step();
+ *         dmosi_periodic_wait(&p);
+ *     }
+ */
+
+/**
+ * @brief State of a periodic schedule
+ *
+ * The fields are private; read the statistics with dmosi_periodic_get_stats().
+ */
+typedef struct {
+    TickType_t wake_time;           /**< Tick of the last activation */
+    TickType_t period_ticks;        /**< Whole ticks per period */
+    uint32_t period_fraction;       /**< Sub-tick remainder, in 1/1000000 ticks */
+    uint32_t fraction_acc;          /**< Accumulated sub-tick remainder */
+    uint32_t period_us;             /**< Period in microseconds */
+    uint32_t activations;           /**< Completed waits */
+    uint32_t overruns;              /**< Waits entered after the deadline */
+    uint32_t missed_periods;        /**< Activations skipped by overruns */
+    TickType_t max_lateness_ticks;  /**< Worst lateness at a missed deadline */
+} dmosi_periodic_t;
+
+/**
+ * @brief Deadline statistics of a periodic schedule
+ */
+typedef struct {
+    uint32_t activations;           /**< Completed waits */
+    uint32_t overruns;              /**< Waits entered after the deadline had passed */
+    uint32_t missed_periods;        /**< Activations skipped because of overruns */
+    uint32_t max_lateness_us;       /**< Worst lateness at a missed deadline (tick resolution) */
+} dmosi_periodic_stats_t;
+
+/**
+ * @brief Initialize a periodic schedule starting now
+ *
+ * @param periodic Schedule to initialize
+ * @param period_us Period in microseconds (at least one tick)
+ * @return int 0 on success, -EINVAL on invalid arguments
+ */
+int dmosi_periodic_init(dmosi_periodic_t* periodic, uint32_t period_us);
+
+/**
+ * @brief Sleep until the next activation of a periodic schedule
+ *
+ * Missed activations are skipped so the schedule stays on its time grid.
+ *
+ * @param periodic Schedule initialized with dmosi_periodic_init()
+ * @return int Number of activations skipped (0 = on time), -ENOTSUP before
+ *         the scheduler started, -EINVAL if @p periodic is NULL
+ */
+int dmosi_periodic_wait(dmosi_periodic_t* periodic);
+
+/**
+ * @brief Get the deadline statistics of a periodic schedule
+ *
+ * @param periodic Schedule initialized with dmosi_periodic_init()
+ * @param stats Structure to fill
+ * @return int 0 on success, -EINVAL on invalid arguments
+ */
+int dmosi_periodic_get_stats(const dmosi_periodic_t* periodic, dmosi_periodic_stats_t* stats);
+
+//==============================================================================
+//                              Multi-core
+//==============================================================================
+
+/**
+ * @brief Get the number of cores the scheduler runs on
+ *
+ * @return uint32_t Number of cores (configNUMBER_OF_CORES)
+ */
+uint32_t dmosi_core_count(void);
+
+/**
+ * @brief Restrict the cores a thread may run on
+ *
+ * @param thread Thread handle (NULL = current thread)
+ * @param core_mask Bit mask of allowed cores (bit n = core n)
+ * @return int 0 on success, -EINVAL if @p core_mask selects no existing core,
+ *         -ESRCH if the thread has terminated
+ */
+int dmosi_thread_set_affinity(dmosi_thread_t thread, uint32_t core_mask);
+
+/**
+ * @brief Get the cores a thread may run on
+ *
+ * @param thread Thread handle (NULL = current thread)
+ * @param core_mask Set to the bit mask of allowed cores (bit n = core n)
+ * @return int 0 on success, -EINVAL if @p core_mask is NULL, -ESRCH if the
+ *         thread has terminated
+ */
+int dmosi_thread_get_affinity(dmosi_thread_t thread, uint32_t* core_mask);
+
+/**
+ * @brief Get the load of a core over the last DMOSI_CPU_WINDOW_SHORT_MS
+ *
+ * @param core Core index (0 .. dmosi_core_count() - 1)
+ * @param usage Set to the share of time the core was busy, in percent [0, 100]
+ * @return int 0 on success, -EINVAL on invalid arguments
+ */
+int dmosi_core_get_usage(uint32_t core, float* usage);
+
+//==============================================================================
+//                              Run-time statistics
+//==============================================================================
+
+/*
+ * The run-time counter is the architecture's cycle counter where one exists
+ * (DWT on Cortex-M3 and up, mcycle on RISC-V, the generic timer on AArch64)
+ * and the dmosi microsecond clock otherwise. A sampler records the counters
+ * of all threads and cores every DMOSI_CPU_SAMPLE_MS, so CPU usage can be
+ * reported over recent windows instead of only as a lifetime average.
+ */
+
+/**
+ * @brief Short CPU usage window, also used by _thread_get_info
+ */
+#define DMOSI_CPU_WINDOW_SHORT_MS    1000u
+
+/**
+ * @brief Long CPU usage window (the longest fully covered by the sample history)
+ */
+#define DMOSI_CPU_WINDOW_LONG_MS     10000u
+
+/**
+ * @brief Get the frequency of the run-time statistics counter
+ *
+ * @return uint64_t Counter frequency in Hz, 0 if unknown
+ */
+uint64_t dmosi_runtime_get_counter_hz(void);
+
+/**
+ * @brief Get the CPU usage of a thread over a recent time window
+ *
+ * @param thread Thread handle (NULL = current thread)
+ * @param window_ms Window length in milliseconds (0 = since the thread started)
+ * @param usage Set to the share of the window the thread ran, in percent [0, 100]
+ * @return int 0 on success, -ESRCH if the thread terminated, -EINVAL on invalid arguments
+ */
+int dmosi_thread_get_cpu_usage(dmosi_thread_t thread, uint32_t window_ms, float* usage);
+
+/**
+ * @brief Get the CPU usage of a process over a recent time window
+ *
+ * @param process Process handle (NULL = current process)
+ * @param window_ms Window length in milliseconds (0 = since start)
+ * @param usage Set to the share of the window its threads ran, in percent
+ *        (100 = one busy core)
+ * @return int 0 on success, -EINVAL on invalid arguments
+ */
+int dmosi_process_get_cpu_usage(dmosi_process_t process, uint32_t window_ms, float* usage);
+
+/**
+ * @brief Get the load of a core over a recent time window
+ *
+ * @param core Core index (0 .. dmosi_core_count() - 1)
+ * @param window_ms Window length in milliseconds (0 = since start)
+ * @param usage Set to the share of the window the core was busy, in percent [0, 100]
+ * @return int 0 on success, -EINVAL on invalid arguments
+ */
+int dmosi_core_get_cpu_usage(uint32_t core, uint32_t window_ms, float* usage);
+
+//==============================================================================
+//                              Thread stack cache
+//==============================================================================
+
+/*
+ * Optional (DMOSI_THREAD_CACHE_SIZE > 0). Threads created with
+ * dmosi_thread_create() run on a combined TCB/stack block of exactly the
+ * requested stack size. When such a thread is destroyed the block is kept
+ * for the next thread with the same stack size instead of being freed by
+ * the idle task, so recreating worker threads does not touch the heap. The
+ * task of a cached thread that finished without being destroyed, or that
+ * destroyed itself, is parked and reclaimed by the next thread creation or
+ * dmosi_thread_cache_trim().
+ */
+
+/**
+ * @brief Statistics of the thread stack cache
+ */
+typedef struct {
+    size_t cached_blocks;       /**< Blocks currently held by the cache */
+    size_t cached_bytes;        /**< Memory currently held by the cache */
+    uint32_t hits;              /**< Thread creations served from the cache */
+    uint32_t misses;            /**< Cacheable thread creations that allocated a new block */
+} dmosi_thread_cache_stats_t;
+
+/**
+ * @brief Get statistics of the thread stack cache
+ *
+ * @param stats Structure to fill
+ * @return int 0 on success, -EINVAL if @p stats is NULL, -ENOTSUP if the
+ *         cache is disabled (DMOSI_THREAD_CACHE_SIZE = 0)
+ */
+int dmosi_thread_cache_get_stats(dmosi_thread_cache_stats_t* stats);
+
+/**
+ * @brief Free all blocks held by the thread stack cache
+ *
+ * Parked tasks of finished cached threads are reclaimed first.
+ *
+ * @return size_t Number of bytes returned to the heap
+ */
+size_t dmosi_thread_cache_trim(void);
+
+//==============================================================================
+//                              Stack advisor
+//==============================================================================
+
+/*
+ * dmosi_thread_get_info() reports the current and the peak stack usage of a
+ * thread. The advisor collects both for many threads at once and suggests a
+ * stack_size for each, so over-provisioned stacks can be shrunk. The
+ * suggestion adds DMOSI_STACK_ADVISOR_MARGIN percent to the peak.
+ */
+
+/**
+ * @brief Stack usage of a thread and the stack size recommended for it
+ */
+typedef struct {
+    dmosi_thread_t thread;          /**< Thread handle */
+    dmosi_process_t process;        /**< Process of the thread */
+    size_t stack_size;              /**< Stack size in bytes */
+    size_t stack_current;           /**< Bytes in use when sampled */
+    size_t stack_peak;              /**< Most bytes in use so far (high-water mark) */
+    size_t recommended_size;        /**< Suggested stack_size for the thread */
+} dmosi_stack_advice_t;
+
+/**
+ * @brief Measure the stacks of all threads and recommend stack sizes
+ *
+ * The recommendation only covers the deepest path each thread has taken so
+ * far, so sample after the threads have gone through their worst case.
+ *
+ * @param process Only report threads of this process (NULL = all threads)
+ * @param entries Array to fill
+ * @param max_entries Capacity of @p entries
+ * @return size_t Number of entries filled
+ */
+size_t dmosi_thread_stack_advise(dmosi_process_t process, dmosi_stack_advice_t* entries, size_t max_entries);
+
+//==============================================================================
+//                              Memory protection
+//==============================================================================
+
+/*
+ * With DMOSI_MPU (ARMv8-M mainline ports) a process can be isolated: its
+ * threads are created as restricted FreeRTOS tasks whose code runs
+ * unprivileged and may only access its own stack and the memory regions
+ * registered for the process, typically the module image and data pool
+ * set up by the module loader. The dmosi API entry points raise privilege
+ * while they run, so isolated threads use the dmosi API as usual; the
+ * extensions declared in this header are meant for privileged code only.
+ */
+
+#ifndef DMOSI_MPU
+    #define DMOSI_MPU    0
+#endif
+
+/**
+ * @brief Required alignment of the base and size of an MPU region in bytes
+ */
+#define DMOSI_MPU_REGION_ALIGNMENT    32u
+
+#define DMOSI_MPU_READ_ONLY     (1u << 0)   /**< Region can be read */
+#define DMOSI_MPU_READ_WRITE    (1u << 1)   /**< Region can be read and written */
+#define DMOSI_MPU_EXECUTE       (1u << 2)   /**< Code may be executed from the region */
+#define DMOSI_MPU_DEVICE        (1u << 3)   /**< Region is device memory (peripherals) */
+
+/**
+ * @brief Isolate a process
+ *
+ * Threads created for the process from now on run as restricted tasks;
+ * threads that already exist are not affected.
+ *
+ * @param process Process to isolate
+ * @return int 0 on success (also if already isolated), -ENOSPC if
+ *         DMOSI_MPU_MAX_PROCESSES processes are isolated already,
+ *         -ENOTSUP without DMOSI_MPU, -EINVAL if @p process is NULL
+ */
+int dmosi_mpu_isolate(dmosi_process_t process);
+
+/**
+ * @brief Grant the threads of an isolated process access to a memory region
+ *
+ * Also applied to the threads of the process that are already running
+ * (from their next context switch on). The number of regions per process
+ * is limited by the MPU: portNUM_CONFIGURABLE_REGIONS, i.e. three with
+ * configTOTAL_MPU_REGIONS = 8.
+ *
+ * @param process Isolated process
+ * @param base Start of the region (aligned to DMOSI_MPU_REGION_ALIGNMENT)
+ * @param size Size of the region in bytes (a non-zero multiple of
+ *             DMOSI_MPU_REGION_ALIGNMENT)
+ * @param access DMOSI_MPU_READ_ONLY or DMOSI_MPU_READ_WRITE, optionally
+ *               with DMOSI_MPU_EXECUTE and/or DMOSI_MPU_DEVICE
+ * @return int 0 on success, -ESRCH if @p process is not isolated, -ENOSPC
+ *         if all regions of the process are used, -ENOTSUP without
+ *         DMOSI_MPU, -EINVAL on invalid arguments
+ */
+int dmosi_mpu_add_region(dmosi_process_t process, void* base, size_t size, uint32_t access);
+
+/**
+ * @brief End the isolation of a process
+ *
+ * Called when the process is unloaded; its slot and regions are released.
+ * Threads that still run keep the regions they had.
+ *
+ * @param process Isolated process
+ * @return int 0 on success, -ESRCH if @p process is not isolated,
+ *         -ENOTSUP without DMOSI_MPU
+ */
+int dmosi_mpu_release(dmosi_process_t process);
+
+/**
+ * @brief Check whether a process is isolated
+ *
+ * @param process Process to check
+ * @return true if threads created for @p process run as restricted tasks
+ */
+bool dmosi_mpu_is_isolated(dmosi_process_t process);
+
+//==============================================================================
+//                              Mutex extensions
+//==============================================================================
+
+/**
+ * @brief Contention statistics of a mutex
+ */
+typedef struct {
+    uint32_t locks;                 /**< Successful acquisitions (recursive relocks excluded) */
+    uint32_t contended;             /**< Acquisitions that had to wait for another owner */
+    uint32_t timeouts;              /**< Attempts that gave up (trylock failures included) */
+    uint64_t wait_time_total_us;    /**< Total time spent waiting by contended acquisitions */
+    uint32_t wait_time_max_us;      /**< Longest wait of a single acquisition */
+} dmosi_mutex_stats_t;
+
+/**
+ * @brief Try to lock a mutex without blocking
+ *
+ * @param mutex Mutex handle to lock
+ * @return int 0 on success, -EAGAIN if the mutex is held by another thread,
+ *         negative error code on failure
+ */
+int dmosi_mutex_trylock(dmosi_mutex_t mutex);
+
+/**
+ * @brief Lock a mutex, waiting at most @p timeout_ms
+ *
+ * @param mutex Mutex handle to lock
+ * @param timeout_ms Timeout in milliseconds (0 = no wait, -1 = wait forever)
+ * @return int 0 on success, negative error code on failure
+ */
+int dmosi_mutex_lock_timeout(dmosi_mutex_t mutex, int32_t timeout_ms);
+
+/**
+ * @brief Set the priority ceiling of a mutex
+ *
+ * The owner of a mutex with a ceiling is raised to the ceiling priority for
+ * as long as it holds the mutex; threads above the ceiling are refused the
+ * lock with -EINVAL.
+ *
+ * @param mutex Mutex handle
+ * @param ceiling Ceiling priority (0 .. configMAX_PRIORITIES - 1, -1 = none)
+ * @return int 0 on success, -EBUSY if the mutex is held, -EINVAL on invalid arguments
+ */
+int dmosi_mutex_set_ceiling(dmosi_mutex_t mutex, int ceiling);
+
+/**
+ * @brief Get contention statistics of a mutex
+ *
+ * @param mutex Mutex handle
+ * @param stats Structure to fill
+ * @return int 0 on success, -EINVAL on invalid arguments
+ */
+int dmosi_mutex_get_stats(dmosi_mutex_t mutex, dmosi_mutex_stats_t* stats);
+
+//==============================================================================
+//                              Queue batches
+//==============================================================================
+
+/**
+ * @brief Send a batch of items to a queue
+ *
+ * Sends up to @p count items, blocking only until at least @p min_count of
+ * them were sent. @p timeout_ms is a single deadline for the whole batch.
+ * Safe to call from an interrupt handler, where it never blocks.
+ *
+ * @param queue Queue handle
+ * @param items Array of @p count items
+ * @param count Maximum number of items to send
+ * @param min_count Minimum number of items to send before returning (<= @p count)
+ * @param sent Set to the number of items actually sent (can be NULL)
+ * @param timeout_ms Timeout in milliseconds (0 = no wait, -1 = wait forever)
+ * @return int 0 if at least @p min_count items were sent, negative error code otherwise
+ */
+int dmosi_queue_send_batch(dmosi_queue_t queue, const void* items, size_t count, size_t min_count, size_t* sent, int32_t timeout_ms);
+
+/**
+ * @brief Receive a batch of items from a queue
+ *
+ * Receives up to @p count items, blocking only until at least @p min_count
+ * of them were received. @p timeout_ms is a single deadline for the whole
+ * batch. Safe to call from an interrupt handler, where it never blocks.
+ *
+ * @param queue Queue handle
+ * @param items Buffer for @p count items
+ * @param count Maximum number of items to receive
+ * @param min_count Minimum number of items to receive before returning (<= @p count)
+ * @param received Set to the number of items actually received (can be NULL)
+ * @param timeout_ms Timeout in milliseconds (0 = no wait, -1 = wait forever)
+ * @return int 0 if at least @p min_count items were received, negative error code otherwise
+ */
+int dmosi_queue_receive_batch(dmosi_queue_t queue, void* items, size_t count, size_t min_count, size_t* received, int32_t timeout_ms);
+
+//==============================================================================
+//                              Byte streams
+//==============================================================================
+
+/*
+ * A dmosi stream is a byte ring for exactly one writer and one reader (either
+ * of which may be an interrupt handler), like a FreeRTOS stream buffer. Besides
+ * the copying send/receive calls it offers zero-copy access: the writer fills
+ * ring memory in place between dmosi_stream_reserve() and dmosi_stream_commit(),
+ * and the reader processes it in place between dmosi_stream_peek() and
+ * dmosi_stream_consume().
+ */
+
+/**
+ * @brief Byte stream handle
+ */
+typedef struct dmosi_stream* dmosi_stream_t;
+
+/**
+ * @brief Create a byte stream
+ *
+ * @param size Capacity of the stream in bytes
+ * @param trigger_level Bytes that must be available before a blocked reader
+ *        is woken (0 is treated as 1)
+ * @return dmosi_stream_t Created stream handle, NULL on failure
+ */
+dmosi_stream_t dmosi_stream_create(size_t size, size_t trigger_level);
+
+/**
+ * @brief Destroy a byte stream
+ *
+ * @param stream Stream handle to destroy
+ */
+void dmosi_stream_destroy(dmosi_stream_t stream);
+
+/**
+ * @brief Set the trigger level of a byte stream
+ *
+ * @param stream Stream handle
+ * @param trigger_level Bytes that must be available before a blocked reader
+ *        is woken (1 to the stream size)
+ * @return int 0 on success, -EINVAL on invalid arguments
+ */
+int dmosi_stream_set_trigger_level(dmosi_stream_t stream, size_t trigger_level);
+
+/**
+ * @brief Get the number of bytes stored in a byte stream
+ *
+ * @param stream Stream handle
+ * @return size_t Bytes available for reading (0 if @p stream is NULL)
+ */
+size_t dmosi_stream_bytes_available(dmosi_stream_t stream);
+
+/**
+ * @brief Write bytes to a byte stream
+ *
+ * @param stream Stream handle
+ * @param data Bytes to write
+ * @param len Number of bytes to write
+ * @param sent Set to the number of bytes actually written (can be NULL)
+ * @param timeout_ms Timeout in milliseconds (0 = no wait, -1 = wait forever)
+ * @return int 0 if all bytes were written, negative error code otherwise
+ */
+int dmosi_stream_send(dmosi_stream_t stream, const void* data, size_t len, size_t* sent, int32_t timeout_ms);
+
+/**
+ * @brief Read bytes from a byte stream
+ *
+ * @param stream Stream handle
+ * @param buffer Buffer for the bytes
+ * @param len Size of @p buffer in bytes
+ * @param received Set to the number of bytes actually read (can be NULL)
+ * @param timeout_ms Timeout in milliseconds (0 = no wait, -1 = wait forever)
+ * @return int 0 if at least one byte was read, negative error code otherwise
+ */
+int dmosi_stream_receive(dmosi_stream_t stream, void* buffer, size_t len, size_t* received, int32_t timeout_ms);
+
+/**
+ * @brief Reserve free space in a byte stream for in-place writing
+ *
+ * @param stream Stream handle
+ * @param data Set to the start of the reserved region
+ * @param len In: maximum bytes wanted; out: contiguous bytes actually reserved
+ * @param timeout_ms Timeout in milliseconds (0 = no wait, -1 = wait forever)
+ * @return int 0 on success, negative error code on failure
+ */
+int dmosi_stream_reserve(dmosi_stream_t stream, void** data, size_t* len, int32_t timeout_ms);
+
+/**
+ * @brief Publish bytes written in place after dmosi_stream_reserve()
+ *
+ * @param stream Stream handle
+ * @param len Number of bytes written (at most the reserved length)
+ * @return int 0 on success, -EINVAL on invalid arguments
+ */
+int dmosi_stream_commit(dmosi_stream_t stream, size_t len);
+
+/**
+ * @brief Look at stored bytes of a byte stream without copying them
+ *
+ * @param stream Stream handle
+ * @param data Set to the start of the stored region
+ * @param len In: maximum bytes wanted; out: contiguous bytes actually available
+ * @param timeout_ms Timeout in milliseconds (0 = no wait, -1 = wait forever)
+ * @return int 0 if at least one byte is available, negative error code otherwise
+ */
+int dmosi_stream_peek(dmosi_stream_t stream, const void** data, size_t* len, int32_t timeout_ms);
+
+/**
+ * @brief Release bytes looked at with dmosi_stream_peek()
+ *
+ * @param stream Stream handle
+ * @param len Number of bytes processed (at most the peeked length)
+ * @return int 0 on success, -EINVAL on invalid arguments
+ */
+int dmosi_stream_consume(dmosi_stream_t stream, size_t len);
+
+//==============================================================================
+//                              Message buffers
+//==============================================================================
+
+/**
+ * @brief Message buffer handle (FreeRTOS message buffer)
+ */
+typedef struct dmosi_message_buffer* dmosi_message_buffer_t;
+
+/**
+ * @brief Create a message buffer
+ *
+ * @param size Capacity in bytes; each message also takes a length header of
+ *        sizeof(configMESSAGE_BUFFER_LENGTH_TYPE) bytes
+ * @return dmosi_message_buffer_t Created message buffer handle, NULL on failure
+ */
+dmosi_message_buffer_t dmosi_message_buffer_create(size_t size);
+
+/**
+ * @brief Destroy a message buffer
+ *
+ * @param mb Message buffer handle to destroy
+ */
+void dmosi_message_buffer_destroy(dmosi_message_buffer_t mb);
+
+/**
+ * @brief Send a message to a message buffer
+ *
+ * @param mb Message buffer handle
+ * @param message Message to send
+ * @param len Length of the message in bytes
+ * @param timeout_ms Timeout in milliseconds (0 = no wait, -1 = wait forever)
+ * @return int 0 on success, -EMSGSIZE if the message can never fit, negative error code on failure
+ */
+int dmosi_message_buffer_send(dmosi_message_buffer_t mb, const void* message, size_t len, int32_t timeout_ms);
+
+/**
+ * @brief Receive a message from a message buffer
+ *
+ * @param mb Message buffer handle
+ * @param buffer Buffer for the message
+ * @param buffer_size Size of @p buffer in bytes
+ * @param len Set to the length of the received message (can be NULL)
+ * @param timeout_ms Timeout in milliseconds (0 = no wait, -1 = wait forever)
+ * @return int 0 on success, -EMSGSIZE if the next message does not fit, negative error code on failure
+ */
+int dmosi_message_buffer_receive(dmosi_message_buffer_t mb, void* buffer, size_t buffer_size, size_t* len, int32_t timeout_ms);
+
+//==============================================================================
+//                              Lock-free rings
+//==============================================================================
+
+/*
+ * A dmosi ring is a fixed-size item queue for exactly one producer and one
+ * consumer, built on C11 atomics instead of kernel critical sections. Pushing
+ * never disables interrupts, which makes it suitable for handing data from
+ * high-rate interrupts to a task. The consumer may block; it then parks on a
+ * task notification that the producer only has to send when the ring was
+ * drained.
+ */
+
+/**
+ * @brief Single-producer/single-consumer ring handle
+ */
+typedef struct dmosi_ring* dmosi_ring_t;
+
+/**
+ * @brief Create a single-producer/single-consumer ring
+ *
+ * @param item_size Size of each item in bytes
+ * @param capacity Minimum number of items; rounded up to a power of two
+ * @return dmosi_ring_t Created ring handle, NULL on failure
+ */
+dmosi_ring_t dmosi_ring_create(size_t item_size, uint32_t capacity);
+
+/**
+ * @brief Destroy a single-producer/single-consumer ring
+ *
+ * @param ring Ring handle to destroy
+ */
+void dmosi_ring_destroy(dmosi_ring_t ring);
+
+/**
+ * @brief Get the number of slots of a ring
+ *
+ * @param ring Ring handle
+ * @return size_t Capacity in items (0 if @p ring is NULL)
+ */
+size_t dmosi_ring_capacity(dmosi_ring_t ring);
+
+/**
+ * @brief Get the number of items stored in a ring
+ *
+ * @param ring Ring handle
+ * @return size_t Number of stored items (0 if @p ring is NULL)
+ */
+size_t dmosi_ring_count(dmosi_ring_t ring);
+
+/**
+ * @brief Push an item into a ring (producer side, never blocks)
+ *
+ * @param ring Ring handle
+ * @param item Pointer to the item to push
+ * @return int 0 on success, -EAGAIN if the ring is full, -EINVAL on invalid arguments
+ */
+int dmosi_ring_push(dmosi_ring_t ring, const void* item);
+
+/**
+ * @brief Pop an item from a ring (consumer side)
+ *
+ * @param ring Ring handle
+ * @param item Buffer to receive the item
+ * @param timeout_ms Timeout in milliseconds (0 = no wait, -1 = wait forever)
+ * @return int 0 on success, negative error code on failure
+ */
+int dmosi_ring_pop(dmosi_ring_t ring, void* item, int32_t timeout_ms);
+
+//==============================================================================
+//                              Events
+//==============================================================================
+
+/*
+ * A dmosi event is a binary signal. Bound to a single waiter thread it is
+ * delivered through that thread's task notifications (on an index of its own,
+ * so it never collides with thread join), which is much cheaper than a
+ * semaphore. Unbound events fall back to a binary semaphore so any number of
+ * threads may wait on them.
+ */
+
+/**
+ * @brief Event handle
+ */
+typedef struct dmosi_event* dmosi_event_t;
+
+/**
+ * @brief Create an event
+ *
+ * @param waiter Thread that will wait on the event (NULL = any thread, semaphore-backed)
+ * @return dmosi_event_t Created event handle, NULL on failure
+ */
+dmosi_event_t dmosi_event_create(dmosi_thread_t waiter);
+
+/**
+ * @brief Destroy an event
+ *
+ * @param event Event handle to destroy
+ */
+void dmosi_event_destroy(dmosi_event_t event);
+
+/**
+ * @brief Signal an event (task or interrupt context)
+ *
+ * @param event Event handle
+ * @return int 0 on success, -EINVAL if @p event is NULL
+ */
+int dmosi_event_signal(dmosi_event_t event);
+
+/**
+ * @brief Wait for an event to be signalled and consume the signal
+ *
+ * @param event Event handle
+ * @param timeout_ms Timeout in milliseconds (0 = no wait, -1 = wait forever)
+ * @return int 0 on success, -EPERM if called by a thread the event is not
+ *         bound to, negative error code on failure
+ */
+int dmosi_event_wait(dmosi_event_t event, int32_t timeout_ms);
+
+//==============================================================================
+//                              Event groups
+//==============================================================================
+
+/*
+ * A dmosi event group wraps a FreeRTOS event group: a set of flag bits that
+ * any number of threads can wait on, for any or all of a mask. Setting bits
+ * from an interrupt is deferred to the timer daemon task by FreeRTOS, so it
+ * takes effect shortly after the handler returns.
+ */
+
+/**
+ * @brief Bits usable in an event group
+ *
+ * The top byte of the FreeRTOS event bits is reserved for kernel control.
+ */
+#if ( configTICK_TYPE_WIDTH_IN_BITS == TICK_TYPE_WIDTH_16_BITS )
+    #define DMOSI_EVENT_GROUP_BITS          0x00FFUL
+#else
+    #define DMOSI_EVENT_GROUP_BITS          0x00FFFFFFUL
+#endif
+
+/**
+ * @brief dmosi_event_group_wait() flag: wait for all bits instead of any
+ */
+#define DMOSI_EVENT_GROUP_WAIT_ALL          (1u << 0)
+
+/**
+ * @brief dmosi_event_group_wait() flag: clear the awaited bits on success
+ */
+#define DMOSI_EVENT_GROUP_CLEAR_ON_EXIT     (1u << 1)
+
+/**
+ * @brief Event group handle
+ */
+typedef struct dmosi_event_group* dmosi_event_group_t;
+
+/**
+ * @brief Create an event group with all bits cleared
+ *
+ * @return dmosi_event_group_t Created event group handle, NULL on failure
+ */
+dmosi_event_group_t dmosi_event_group_create(void);
+
+/**
+ * @brief Destroy an event group
+ *
+ * Threads still waiting on the group are released with their wait failed.
+ *
+ * @param group Event group handle to destroy
+ */
+void dmosi_event_group_destroy(dmosi_event_group_t group);
+
+/**
+ * @brief Set bits of an event group (task or interrupt context)
+ *
+ * @param group Event group handle
+ * @param bits Bits to set (within DMOSI_EVENT_GROUP_BITS)
+ * @return int 0 on success, -EAGAIN if an interrupt could not defer the
+ *         update (timer command queue full), -EINVAL on invalid arguments
+ */
+int dmosi_event_group_set(dmosi_event_group_t group, uint32_t bits);
+
+/**
+ * @brief Clear bits of an event group (task or interrupt context)
+ *
+ * @param group Event group handle
+ * @param bits Bits to clear (within DMOSI_EVENT_GROUP_BITS)
+ * @return int 0 on success, -EAGAIN if an interrupt could not defer the
+ *         update, -EINVAL on invalid arguments
+ */
+int dmosi_event_group_clear(dmosi_event_group_t group, uint32_t bits);
+
+/**
+ * @brief Get the current bits of an event group (task or interrupt context)
+ *
+ * @param group Event group handle
+ * @return uint32_t Current bits (0 if @p group is NULL)
+ */
+uint32_t dmosi_event_group_get(dmosi_event_group_t group);
+
+/**
+ * @brief Wait for any or all of a set of bits
+ *
+ * @param group Event group handle
+ * @param bits Bits to wait for (non-zero, within DMOSI_EVENT_GROUP_BITS)
+ * @param flags DMOSI_EVENT_GROUP_WAIT_ALL and/or DMOSI_EVENT_GROUP_CLEAR_ON_EXIT
+ * @param result Filled with the bits at the time the wait ended, before any
+ *               clearing (optional)
+ * @param timeout_ms Timeout in milliseconds (0 = no wait, -1 = wait forever)
+ * @return int 0 if the condition was met, negative error code otherwise
+ */
+int dmosi_event_group_wait(dmosi_event_group_t group, uint32_t bits, uint32_t flags, uint32_t* result, int32_t timeout_ms);
+
+//==============================================================================
+//                              Multiple object wait
+//==============================================================================
+
+/*
+ * dmosi_wait_multiple() blocks on several queues, semaphores and futures at
+ * once and reports which of them is ready, like a FreeRTOS queue set: the
+ * caller then takes the item or unit with a zero timeout, or polls the future. Objects stay usable on their
+ * own and can be waited on by several threads in parallel; with more than
+ * one consumer the follow-up take may still find the object empty.
+ */
+
+/**
+ * @brief Maximum number of objects in one dmosi_wait_multiple() call
+ */
+#define DMOSI_WAIT_MULTIPLE_MAX     16
+
+/**
+ * @brief Kinds of objects dmosi_wait_multiple() can wait on
+ */
+typedef enum {
+    DMOSI_WAIT_QUEUE = 0,           /**< dmosi_queue_t; ready when it holds an item */
+    DMOSI_WAIT_SEMAPHORE,           /**< dmosi_semaphore_t; ready when a unit can be taken */
+    DMOSI_WAIT_FUTURE               /**< dmosi_future_t; ready once completed */
+} dmosi_wait_type_t;
+
+/**
+ * @brief Object waited on by dmosi_wait_multiple()
+ */
+typedef struct {
+    dmosi_wait_type_t type;         /**< Kind of @ref object */
+    void* object;                   /**< dmosi_queue_t, dmosi_semaphore_t or dmosi_future_t */
+} dmosi_wait_object_t;
+
+/**
+ * @brief Wait until one of several queues, semaphores or futures is ready
+ *
+ * @param objects Objects to wait on
+ * @param count Number of objects (1 .. DMOSI_WAIT_MULTIPLE_MAX)
+ * @param timeout_ms Timeout in milliseconds (0 = no wait, -1 = wait forever)
+ * @return int Index of the first ready object in @p objects, -EAGAIN or
+ *         -ETIMEDOUT if none became ready, -EINVAL on invalid arguments
+ */
+int dmosi_wait_multiple(const dmosi_wait_object_t* objects, size_t count, int32_t timeout_ms);
+
+//==============================================================================
+//                              Work queues
+//==============================================================================
+
+/*
+ * A dmosi work queue runs short jobs on a fixed set of worker threads that
+ * are created once, instead of paying for a task creation per job. Work
+ * items are caller-owned, so submitting allocates nothing and is allowed
+ * from interrupts; each item doubles as the completion handle of its job.
+ */
+
+/**
+ * @brief Work queue handle
+ */
+typedef struct dmosi_workqueue* dmosi_workqueue_t;
+
+/**
+ * @brief Function run by a work item
+ *
+ * @param arg Argument given to dmosi_work_init()
+ */
+typedef void (*dmosi_work_fn_t)(void* arg);
+
+/**
+ * @brief Caller-provided work item
+ *
+ * Must be initialized with dmosi_work_init() and stay valid while pending
+ * or running.
+ */
+typedef struct {
+    void* reserved[6];              /**< Private work item fields */
+} dmosi_work_t;
+
+/**
+ * @brief Create a work queue with pre-created worker threads
+ *
+ * @param worker_count Number of worker threads (> 0)
+ * @param priority Priority of the worker threads
+ * @param stack_size Stack size of each worker thread in bytes
+ * @param name Name of the worker threads (cannot be NULL)
+ * @param process Process the workers belong to (NULL = current process)
+ * @return dmosi_workqueue_t Created work queue handle, NULL on failure
+ */
+dmosi_workqueue_t dmosi_workqueue_create(size_t worker_count, int priority, size_t stack_size, const char* name, dmosi_process_t process);
+
+/**
+ * @brief Destroy a work queue, canceling items that have not started
+ *
+ * @param wq Work queue handle to destroy
+ */
+void dmosi_workqueue_destroy(dmosi_workqueue_t wq);
+
+/**
+ * @brief Prepare a work item
+ *
+ * @param work Work item storage
+ * @param fn Function to run on a worker
+ * @param arg Argument passed to @p fn
+ * @return int 0 on success, -EINVAL on invalid arguments
+ */
+int dmosi_work_init(dmosi_work_t* work, dmosi_work_fn_t fn, void* arg);
+
+/**
+ * @brief Submit a work item (task or interrupt context, never blocks)
+ *
+ * @param wq Work queue handle
+ * @param work Initialized work item
+ * @return int 0 on success, -EBUSY if @p work is already pending or running,
+ *         -ESHUTDOWN if the work queue is being destroyed, -EINVAL on invalid arguments
+ */
+int dmosi_workqueue_submit(dmosi_workqueue_t wq, dmosi_work_t* work);
+
+/**
+ * @brief Cancel a pending work item
+ *
+ * @param wq Work queue handle the item was submitted to
+ * @param work Work item
+ * @return int 0 on success, -EBUSY if the item is already running,
+ *         -ENOENT if it is not pending, -EINVAL on invalid arguments
+ */
+int dmosi_workqueue_cancel(dmosi_workqueue_t wq, dmosi_work_t* work);
+
+/**
+ * @brief Wait for a submitted work item to finish
+ *
+ * @param work Work item
+ * @param timeout_ms Timeout in milliseconds (0 = no wait, -1 = wait forever)
+ * @return int 0 if the item ran, -ECANCELED if it was canceled, -EINVAL if it
+ *         was never submitted, negative error code on failure
+ */
+int dmosi_work_wait(dmosi_work_t* work, int32_t timeout_ms);
+
+//==============================================================================
+//                              Futures
+//==============================================================================
+
+/*
+ * A future carries the result of an asynchronous operation from its producer
+ * to its consumers: the requester sends a future along with the request, the
+ * server completes it with the result (from a task or an interrupt), and the
+ * requester waits for it, polls it, waits for it together with other objects
+ * in dmosi_wait_multiple(), or has a callback run on a work queue. Waiters
+ * are woken through task notifications and futures come from a static pool
+ * (DMOSI_FUTURE_POOL_SIZE); dmosi_future_reset() makes one reusable for the
+ * next request, so a request/response cycle needs no heap at all.
+ */
+
+/**
+ * @brief Future handle
+ */
+typedef struct dmosi_future* dmosi_future_t;
+
+/**
+ * @brief Callback run on a work queue when a future is completed
+ *
+ * May destroy @p future; must not reset it.
+ *
+ * @param future Completed future
+ * @param result Result given to dmosi_future_complete()
+ * @param arg Argument given to dmosi_future_on_complete()
+ */
+typedef void (*dmosi_future_callback_t)(dmosi_future_t future, intptr_t result, void* arg);
+
+/**
+ * @brief Create a pending future
+ *
+ * @return dmosi_future_t Created future handle, NULL on failure
+ */
+dmosi_future_t dmosi_future_create(void);
+
+/**
+ * @brief Destroy a future, canceling or waiting for its callback
+ *
+ * @param future Future handle to destroy
+ */
+void dmosi_future_destroy(dmosi_future_t future);
+
+/**
+ * @brief Return a completed future to the pending state for reuse
+ *
+ * @param future Future handle
+ * @return int 0 on success, -EBUSY if threads wait on the future or its
+ *         callback has not finished, -EINVAL if @p future is NULL
+ */
+int dmosi_future_reset(dmosi_future_t future);
+
+/**
+ * @brief Complete a future with a result (task or interrupt context, never blocks)
+ *
+ * @param future Future handle
+ * @param result Result handed to the waiters and the callback
+ * @return int 0 on success, -EALREADY if the future was already completed,
+ *         -ESHUTDOWN if the work queue of the callback is being destroyed,
+ *         -EINVAL if @p future is NULL
+ */
+int dmosi_future_complete(dmosi_future_t future, intptr_t result);
+
+/**
+ * @brief Get the result of a future without waiting
+ *
+ * @param future Future handle
+ * @param result Filled with the result when completed (may be NULL)
+ * @return int 0 if completed, -EAGAIN if still pending, -EINVAL if
+ *         @p future is NULL
+ */
+int dmosi_future_poll(dmosi_future_t future, intptr_t* result);
+
+/**
+ * @brief Wait for a future to be completed
+ *
+ * @param future Future handle
+ * @param result Filled with the result when completed (may be NULL)
+ * @param timeout_ms Timeout in milliseconds (0 = no wait, -1 = wait forever)
+ * @return int 0 on success, -EAGAIN or -ETIMEDOUT if the future was not
+ *         completed in time, negative error code on failure
+ */
+int dmosi_future_wait(dmosi_future_t future, intptr_t* result, int32_t timeout_ms);
+
+/**
+ * @brief Run a callback on a work queue when a future is completed
+ *
+ * @param future Future handle
+ * @param wq Work queue running the callback
+ * @param callback Callback to run
+ * @param arg Argument passed to @p callback
+ * @return int 0 on success, -EBUSY if a callback is already attached,
+ *         -EINVAL on invalid arguments, negative error code if the callback
+ *         could not be submitted
+ */
+int dmosi_future_on_complete(dmosi_future_t future, dmosi_workqueue_t wq, dmosi_future_callback_t callback, void* arg);
+
+//==============================================================================
+//                              Deferred interrupt work
+//==============================================================================
+
+/*
+ * dmosi_defer_from_isr() hands a function call from an interrupt handler to
+ * a single deferred-work daemon task shared by all drivers, so non-trivial
+ * interrupt processing needs neither a task per driver nor a caller-owned
+ * work item. Pending calls sit in a fixed-size lock-free ring; the daemon
+ * is created by dmosi_init() with a static stack and runs them in order.
+ */
+
+/**
+ * @brief Run a function on the deferred-work daemon (any context, never blocks)
+ *
+ * @param fn Function to call
+ * @param arg Argument passed to @p fn
+ * @return int 0 on success, -EAGAIN if the pending ring is full,
+ *         -ENOTSUP if the daemon is not running (dmosi_init() not called),
+ *         -EINVAL if @p fn is NULL
+ */
+int dmosi_defer_from_isr(dmosi_work_fn_t fn, void* arg);
+
+/**
+ * @brief Get the number of deferred calls rejected because the ring was full
+ *
+ * @return uint32_t Rejected calls since boot
+ */
+uint32_t dmosi_defer_get_dropped(void);
+
+//==============================================================================
+//                              Timer wheel
+//==============================================================================
+
+/*
+ * A dmosi timer wheel keeps caller-owned timers in a hierarchical wheel, so
+ * starting and stopping is O(1) in the caller's context instead of a command
+ * queued to the FreeRTOS timer daemon. Expired timers are processed as one
+ * batch and their callbacks run on dedicated dispatch threads, or directly
+ * in the advancing context (DMOSI_WHEEL_TIMER_DIRECT), which may be an
+ * interrupt calling dmosi_timer_wheel_advance().
+ */
+
+/**
+ * @brief Timer wheel handle
+ */
+typedef struct dmosi_timer_wheel* dmosi_timer_wheel_t;
+
+/**
+ * @brief Caller-provided wheel timer
+ *
+ * Must be initialized with dmosi_wheel_timer_init() and stay valid while
+ * active or being dispatched.
+ */
+typedef struct {
+    void* reserved[12];             /**< Private wheel timer fields */
+} dmosi_wheel_timer_t;
+
+/**
+ * @brief Re-arm the timer after each expiry
+ */
+#define DMOSI_WHEEL_TIMER_PERIODIC    (1u << 0)
+
+/**
+ * @brief Run the callback in the context advancing the wheel
+ *
+ * The callback bypasses the dispatch threads and runs on the service thread
+ * or inside dmosi_timer_wheel_advance(), so it must be short and must not
+ * block when the wheel is advanced from an interrupt.
+ */
+#define DMOSI_WHEEL_TIMER_DIRECT      (1u << 1)
+
+/**
+ * @brief Create a timer wheel
+ *
+ * @param dispatch_threads Number of callback dispatch threads (0 = run on the service thread)
+ * @param priority Priority of the service and dispatch threads
+ * @param stack_size Stack size of each thread in bytes
+ * @param name Name of the threads (cannot be NULL)
+ * @param process Process the threads belong to (NULL = current process)
+ * @return dmosi_timer_wheel_t Created timer wheel handle, NULL on failure
+ */
+dmosi_timer_wheel_t dmosi_timer_wheel_create(size_t dispatch_threads, int priority, size_t stack_size, const char* name, dmosi_process_t process);
+
+/**
+ * @brief Destroy a timer wheel, dropping its armed timers
+ *
+ * @param wheel Timer wheel handle to destroy
+ */
+void dmosi_timer_wheel_destroy(dmosi_timer_wheel_t wheel);
+
+/**
+ * @brief Process expired timers now (task or interrupt context)
+ *
+ * @param wheel Timer wheel handle
+ */
+void dmosi_timer_wheel_advance(dmosi_timer_wheel_t wheel);
+
+/**
+ * @brief Prepare a wheel timer
+ *
+ * @param timer Timer storage
+ * @param wheel Timer wheel the timer runs on
+ * @param callback Callback function to execute when the timer expires
+ * @param arg Argument to pass to the callback function
+ * @param flags DMOSI_WHEEL_TIMER_* flags
+ * @return int 0 on success, -EINVAL on invalid arguments
+ */
+int dmosi_wheel_timer_init(dmosi_wheel_timer_t* timer, dmosi_timer_wheel_t wheel, dmosi_timer_callback_t callback, void* arg, uint32_t flags);
+
+/**
+ * @brief Start or restart a wheel timer (task or interrupt context, O(1))
+ *
+ * @param timer Initialized timer
+ * @param timeout_ms Time until the (first) expiry in milliseconds (> 0)
+ * @return int 0 on success, -EINVAL on invalid arguments
+ */
+int dmosi_wheel_timer_start(dmosi_wheel_timer_t* timer, uint32_t timeout_ms);
+
+/**
+ * @brief Stop a wheel timer (task or interrupt context, O(1))
+ *
+ * @param timer Initialized timer
+ * @return int 0 if the timer was active, -ENOENT if it was not, -EINVAL if @p timer is NULL
+ */
+int dmosi_wheel_timer_stop(dmosi_wheel_timer_t* timer);
+
+/**
+ * @brief Check whether a wheel timer is armed
+ *
+ * @param timer Initialized timer
+ * @return bool true if the timer will expire, false otherwise
+ */
+bool dmosi_wheel_timer_is_active(dmosi_wheel_timer_t* timer);
+
+//==============================================================================
+//                              Power management
+//==============================================================================
+
+/*
+ * With DMOSI_TICKLESS_IDLE enabled the idle task stops the tick interrupt
+ * while nothing is scheduled and sleeps until the next timeout. Before each
+ * sleep the deepest state allowed by the active latency constraints is
+ * selected and the registered hooks are called, so a module can stop its
+ * clocks, enter a deeper low-power mode or veto the sleep. Only
+ * DMOSI_PM_STATE_SLEEP is available until the platform declares deeper
+ * states with dmosi_pm_set_state_latency().
+ */
+
+/**
+ * @brief Sleep states, from shallowest to deepest
+ */
+typedef enum {
+    DMOSI_PM_STATE_ACTIVE = 0,      /**< No sleep */
+    DMOSI_PM_STATE_SLEEP,           /**< Core clock stopped (wait for interrupt) */
+    DMOSI_PM_STATE_STOP,            /**< Most clocks stopped, RAM retained */
+    DMOSI_PM_STATE_STANDBY,         /**< Deepest state with a timed wake-up */
+    DMOSI_PM_STATE_COUNT
+} dmosi_pm_state_t;
+
+/**
+ * @brief Pre/post-sleep hooks of a module
+ */
+typedef struct dmosi_pm_hook {
+    /**
+     * Called before sleeping in @p state for up to @p idle_us microseconds.
+     * Returns nonzero if the hook has performed the sleep itself, in which
+     * case the port does not wait for an interrupt.
+     */
+    int (*pre_sleep)(dmosi_pm_state_t state, uint32_t idle_us, void* arg);
+    void (*post_sleep)(dmosi_pm_state_t state, void* arg);     /**< Called after waking up */
+    void* arg;                          /**< Argument passed to both hooks */
+    struct dmosi_pm_hook* next;         /**< Private */
+} dmosi_pm_hook_t;
+
+/**
+ * @brief Wake-up latency constraint
+ */
+typedef struct dmosi_pm_constraint {
+    uint32_t max_latency_us;            /**< Private */
+    struct dmosi_pm_constraint* next;   /**< Private */
+} dmosi_pm_constraint_t;
+
+/**
+ * @brief Declare the exit latency of a sleep state
+ *
+ * @param state Sleep state (DMOSI_PM_STATE_SLEEP or deeper)
+ * @param exit_latency_us Wake-up latency in microseconds (UINT32_MAX = not available)
+ * @return int 0 on success, -EINVAL if @p state is invalid
+ */
+int dmosi_pm_set_state_latency(dmosi_pm_state_t state, uint32_t exit_latency_us);
+
+/**
+ * @brief Register pre/post-sleep hooks
+ *
+ * Hooks run in the idle task with interrupts disabled and must not block.
+ *
+ * @param hook Caller-filled hook structure, valid until unregistered
+ * @return int 0 on success, -EEXIST if already registered, -EINVAL if @p hook is NULL
+ */
+int dmosi_pm_register_hook(dmosi_pm_hook_t* hook);
+
+/**
+ * @brief Unregister pre/post-sleep hooks
+ *
+ * @param hook Hook registered with dmosi_pm_register_hook()
+ * @return int 0 on success, -ENOENT if not registered, -EINVAL if @p hook is NULL
+ */
+int dmosi_pm_unregister_hook(dmosi_pm_hook_t* hook);
+
+/**
+ * @brief Limit the wake-up latency of idle sleep
+ *
+ * @param constraint Caller-provided constraint, valid until removed
+ * @param max_latency_us Largest acceptable wake-up latency (0 = no tickless sleep)
+ * @return int 0 on success, -EEXIST if already active, -EINVAL if @p constraint is NULL
+ */
+int dmosi_pm_constraint_add(dmosi_pm_constraint_t* constraint, uint32_t max_latency_us);
+
+/**
+ * @brief Remove a wake-up latency constraint
+ *
+ * @param constraint Constraint added with dmosi_pm_constraint_add()
+ * @return int 0 on success, -ENOENT if not active, -EINVAL if @p constraint is NULL
+ */
+int dmosi_pm_constraint_remove(dmosi_pm_constraint_t* constraint);
+
+/**
+ * @brief Pick the deepest sleep state allowed for an idle period
+ *
+ * @param idle_us Expected idle time in microseconds
+ * @return dmosi_pm_state_t Deepest allowed state, DMOSI_PM_STATE_ACTIVE if none
+ */
+dmosi_pm_state_t dmosi_pm_select_state(uint32_t idle_us);
+
+/**
+ * @brief Prepare for a tickless sleep (configPRE_SLEEP_PROCESSING)
+ *
+ * Called by the port; a custom portSUPPRESS_TICKS_AND_SLEEP must call it
+ * with interrupts disabled before sleeping.
+ *
+ * @param idle_ticks Expected idle time in ticks
+ * @return uint64_t Ticks to sleep, 0 to skip the port's wait for interrupt
+ */
+uint64_t dmosi_pm_pre_sleep(uint64_t idle_ticks);
+
+/**
+ * @brief Finish a tickless sleep (configPOST_SLEEP_PROCESSING)
+ *
+ * @param idle_ticks Idle time the port expected, in ticks
+ */
+void dmosi_pm_post_sleep(uint64_t idle_ticks);
+
+//==============================================================================
+//                              Trace recorder
+//==============================================================================
+
+/*
+ * With DMOSI_TRACE enabled the FreeRTOS trace macros record compact binary
+ * events into one lock-free ring per core: context switches, task creation
+ * and deletion, queue, semaphore and mutex operations, task notifications,
+ * timer expiries and interrupt entry/exit. Recording never blocks or takes
+ * a lock; when a ring is full new events are dropped and counted.
+ *
+ * A drain thread streams the events out with dmosi_trace_read(), e.g. to a
+ * UART or a file, as raw dmosi_trace_event_t records. Converting them to
+ * the Chrome/Perfetto trace JSON on the host is a direct mapping: one pid
+ * per core, a tid per task (named by the DMOSI_TRACE_EVENT_NAME records),
+ * "B"/"E" pairs for SWITCH_IN/SWITCH_OUT and ISR_ENTER/ISR_EXIT and "i"
+ * instant events for everything else, with ts = timestamp_ns / 1000.
+ */
+
+/**
+ * @brief Trace event types
+ */
+typedef enum {
+    DMOSI_TRACE_EVENT_TASK_SWITCH_IN = 1, /**< Task started running (object = task) */
+    DMOSI_TRACE_EVENT_TASK_SWITCH_OUT,    /**< Task stopped running (object = task) */
+    DMOSI_TRACE_EVENT_TASK_CREATE,        /**< Task created or alive when tracing started (arg = priority) */
+    DMOSI_TRACE_EVENT_TASK_DELETE,        /**< Task deleted */
+    DMOSI_TRACE_EVENT_TASK_NOTIFY,        /**< Task notified (arg = notification index) */
+    DMOSI_TRACE_EVENT_NAME,               /**< Four bytes of the object's name in arg, first byte lowest; ends with a chunk containing a NUL */
+    DMOSI_TRACE_EVENT_QUEUE_CREATE,       /**< Queue, semaphore or mutex created */
+    DMOSI_TRACE_EVENT_QUEUE_DELETE,       /**< Queue, semaphore or mutex deleted */
+    DMOSI_TRACE_EVENT_QUEUE_SEND,         /**< Item sent, semaphore or mutex given */
+    DMOSI_TRACE_EVENT_QUEUE_SEND_FAILED,  /**< Send or give failed (full or timed out) */
+    DMOSI_TRACE_EVENT_QUEUE_RECEIVE,      /**< Item received, semaphore or mutex taken */
+    DMOSI_TRACE_EVENT_QUEUE_RECEIVE_FAILED, /**< Receive or take failed (empty or timed out) */
+    DMOSI_TRACE_EVENT_QUEUE_BLOCK_SEND,   /**< Current task blocks sending to a full queue */
+    DMOSI_TRACE_EVENT_QUEUE_BLOCK_RECEIVE, /**< Current task blocks on an empty queue or a taken mutex */
+    DMOSI_TRACE_EVENT_TIMER_EXPIRED,      /**< Software or wheel timer expired (object = timer) */
+    DMOSI_TRACE_EVENT_ISR_ENTER,          /**< Interrupt entered (arg = IRQ number, DMOSI_TRACE_IRQ_KERNEL for kernel interrupts) */
+    DMOSI_TRACE_EVENT_ISR_EXIT            /**< Interrupt left */
+} dmosi_trace_event_type_t;
+
+/**
+ * @brief Queue event flag: the operation was called from an interrupt
+ *
+ * The low byte of arg of DMOSI_TRACE_EVENT_QUEUE_* events holds the kernel
+ * queue type (queueQUEUE_TYPE_BASE, queueQUEUE_TYPE_MUTEX, ...).
+ */
+#define DMOSI_TRACE_ARG_FROM_ISR    (1u << 8)
+
+/**
+ * @brief IRQ number recorded for interrupts entered by the kernel itself
+ */
+#define DMOSI_TRACE_IRQ_KERNEL      0xFFFFFFFFu
+
+/**
+ * @brief Trace event record
+ *
+ * Fixed 24-byte layout on all targets, so raw records can be streamed to
+ * the host and decoded there without knowing the target's pointer size.
+ */
+typedef struct {
+    uint64_t timestamp_ns;  /**< dmosi_get_time_ns() when the event was recorded */
+    uint64_t object;        /**< Kernel object (task, queue or timer) address, 0 if none */
+    uint32_t arg;           /**< Event-specific argument */
+    uint8_t type;           /**< dmosi_trace_event_type_t */
+    uint8_t core;           /**< Core the event was recorded on */
+    uint16_t lost;          /**< Events dropped on this core right before this one (saturated) */
+} dmosi_trace_event_t;
+
+_Static_assert(sizeof(dmosi_trace_event_t) == 24, "dmosi_trace_event_t layout must not depend on the target");
+
+/**
+ * @brief Start recording trace events
+ *
+ * Records a DMOSI_TRACE_EVENT_TASK_CREATE and the name of every existing
+ * task first, so the host can label tasks created before the start.
+ *
+ * @return int 0 on success, -ENOTSUP if DMOSI_TRACE is disabled
+ */
+int dmosi_trace_start(void);
+
+/**
+ * @brief Stop recording trace events
+ *
+ * Events already recorded stay available to dmosi_trace_read().
+ */
+void dmosi_trace_stop(void);
+
+/**
+ * @brief Check whether trace events are being recorded
+ *
+ * @return bool true between dmosi_trace_start() and dmosi_trace_stop()
+ */
+bool dmosi_trace_is_running(void);
+
+/**
+ * @brief Take recorded events out of the per-core rings
+ *
+ * Takes events from all cores in turn, so a busy core does not starve the
+ * others; events of one core are returned in order, merging cores by
+ * timestamp is left to the host. Never blocks.
+ *
+ * @param events Array to fill
+ * @param max_events Capacity of @p events
+ * @return size_t Number of events filled (0 if none are pending)
+ */
+size_t dmosi_trace_read(dmosi_trace_event_t* events, size_t max_events);
+
+/**
+ * @brief Get the number of events dropped because a ring was full
+ *
+ * @return uint32_t Events dropped since boot, over all cores
+ */
+uint32_t dmosi_trace_get_dropped(void);
+
+/**
+ * @brief Record entry into an interrupt handler
+ *
+ * To be called first thing in application interrupt handlers that should
+ * appear in the trace. Does nothing while tracing is stopped.
+ *
+ * @param irq Interrupt number
+ */
+void dmosi_trace_isr_enter(uint32_t irq);
+
+/**
+ * @brief Record exit from an interrupt handler
+ */
+void dmosi_trace_isr_exit(void);
+
+/*
+ * Kernel trace hooks, called from the FreeRTOS trace macros defined in
+ * FreeRTOSConfig.h when DMOSI_TRACE is enabled.
+ */
+void dmosi_trace_task_switched_in(const void* task);
+void dmosi_trace_task_switched_out(const void* task);
+void dmosi_trace_task_create(void* task);
+void dmosi_trace_task_delete(const void* task);
+void dmosi_trace_task_notify(const void* task, uint32_t index);
+void dmosi_trace_queue_create(void* queue);
+void dmosi_trace_queue_delete(void* queue);
+void dmosi_trace_queue_send(void* queue, int passed, int from_isr);
+void dmosi_trace_queue_receive(void* queue, int passed, int from_isr);
+void dmosi_trace_queue_block(void* queue, int sending);
+void dmosi_trace_timer_expired(const void* timer);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* DMOSI_FREERTOS_H */
@@ -0,0 +1,244 @@
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+#include <errno.h>
+#include "dmosi.h"
+#include "dmosi_freertos.h"
+#include "dmosi_notify.h"
+#include "FreeRTOS.h"
+#include "task.h"
+
+/**
+ * @brief Priority of the deferred-work daemon
+ *
+ * Configurable via the CMake parameter of the same name. The default runs
+ * deferred calls ahead of all application threads, like the timer task.
+ */
+#ifndef DMOSI_DEFER_PRIORITY
+    #define DMOSI_DEFER_PRIORITY    ( configMAX_PRIORITIES - 1 )
+#endif
+
+/**
+ * @brief Stack size of the deferred-work daemon in bytes
+ *
+ * Configurable via the CMake parameter of the same name.
+ */
+#ifndef DMOSI_DEFER_STACK_SIZE
+    #define DMOSI_DEFER_STACK_SIZE  2048
+#endif
+
+/**
+ * @brief Number of deferred calls that can be pending at once
+ *
+ * Configurable via the CMake parameter of the same name (must be a power
+ * of two).
+ */
+#ifndef DMOSI_DEFER_QUEUE_SIZE
+    #define DMOSI_DEFER_QUEUE_SIZE  32
+#endif
+
+#if ( DMOSI_DEFER_QUEUE_SIZE & ( DMOSI_DEFER_QUEUE_SIZE - 1 ) ) != 0 || DMOSI_DEFER_QUEUE_SIZE < 2
+    #error "DMOSI_DEFER_QUEUE_SIZE must be a power of two"
+#endif
+
+#if ( DMOSI_DEFER_PRIORITY ) < 0 || ( DMOSI_DEFER_PRIORITY ) >= configMAX_PRIORITIES
+    #error "DMOSI_DEFER_PRIORITY must be in the range 0 .. configMAX_PRIORITIES - 1"
+#endif
+
+#define DEFER_MASK    ( ( uint32_t ) DMOSI_DEFER_QUEUE_SIZE - 1U )
+
+/**
+ * @brief Slot of the pending ring
+ *
+ * @ref seq tells which side owns the slot: equal to the position a
+ * producer is about to write, it is free; one past it, the call is
+ * complete and may be run.
+ */
+struct defer_slot {
+    _Atomic uint32_t seq;           /**< Position sequence of the slot */
+    dmosi_work_fn_t fn;             /**< Function to call */
+    void* arg;                      /**< Argument of @ref fn */
+};
+
+/**
+ * @brief Pending deferred calls
+ *
+ * A bounded multi-producer queue in the style of D. Vyukov's (see the
+ * trace recorder): a producer claims a position with a single
+ * compare-and-swap, so interrupts on any core and nested interrupts can
+ * queue calls without a lock. The daemon is the only consumer.
+ */
+static struct {
+    _Atomic uint32_t head;          /**< Next position to write */
+    uint32_t tail;                  /**< Next position to run (daemon only) */
+    struct defer_slot slots[DMOSI_DEFER_QUEUE_SIZE];
+} g_defer_ring;
+
+static _Atomic uint32_t g_defer_dropped = 0;                /**< Calls rejected since boot */
+static bool g_defer_started = false;                        /**< dmosi_defer_start() has run */
+static TaskHandle_t _Atomic g_defer_task = NULL;            /**< Daemon task (NULL = not running) */
+static StaticTask_t g_defer_tcb;
+static StackType_t g_defer_stack[DMOSI_DEFER_STACK_SIZE / sizeof(StackType_t)];
+
+/**
+ * @brief Take the oldest complete call of the ring
+ *
+ * Only called by the daemon.
+ *
+ * @param fn Filled with the function
+ * @param arg Filled with its argument
+ * @return bool true if a call was taken, false if none is pending
+ */
+static bool defer_take(dmosi_work_fn_t* fn, void** arg)
+{
+    uint32_t pos = g_defer_ring.tail;
+    struct defer_slot* slot = &g_defer_ring.slots[pos & DEFER_MASK];
+
+    // Empty, or the oldest call is still being written (its producer notifies)
+    if (atomic_load_explicit(&slot->seq, memory_order_acquire) != pos + 1U) {
+        return false;
+    }
+
+    *fn = slot->fn;
+    *arg = slot->arg;
+    g_defer_ring.tail = pos + 1U;
+    atomic_store_explicit(&slot->seq, pos + DMOSI_DEFER_QUEUE_SIZE, memory_order_release);
+
+    return true;
+}
+
+/**
+ * @brief Deferred-work daemon
+ *
+ * Runs pending calls in order and sleeps on its task notification while
+ * the ring is empty. A notification given after the last check is
+ * remembered by the kernel, so no wake-up is lost.
+ *
+ * @param arg Unused
+ */
+static void defer_daemon_entry(void* arg)
+{
+    (void)arg;
+
+    for (;;) {
+        dmosi_work_fn_t fn;
+        void* call_arg;
+
+        while (defer_take(&fn, &call_arg)) {
+            fn(call_arg);
+        }
+
+        ulTaskNotifyTakeIndexed(DMOSI_NOTIFY_INDEX_DEFAULT, pdTRUE, portMAX_DELAY);
+    }
+}
+
+/**
+ * @brief Start the deferred-work daemon (idempotent)
+ *
+ * Called by dmosi_init(). The task uses static memory, so it can be
+ * created before the scheduler starts and survives dmosi_deinit().
+ */
+void dmosi_defer_start(void)
+{
+    taskENTER_CRITICAL();
+    bool create = !g_defer_started;
+    if (create) {
+        g_defer_started = true;
+        for (uint32_t i = 0; i < DMOSI_DEFER_QUEUE_SIZE; i++) {
+            atomic_init(&g_defer_ring.slots[i].seq, i);
+        }
+        atomic_init(&g_defer_ring.head, 0);
+        g_defer_ring.tail = 0;
+    }
+    taskEXIT_CRITICAL();
+
+    if (!create) {
+        return;
+    }
+
+    TaskHandle_t task = xTaskCreateStatic(defer_daemon_entry, "dmosi_defer",
+                                          sizeof(g_defer_stack) / sizeof(g_defer_stack[0]),
+                                          NULL, DMOSI_DEFER_PRIORITY, g_defer_stack, &g_defer_tcb);
+    if (task == NULL) {
+        DMOD_LOG_ERROR("Failed to create deferred work daemon\n");
+        return;
+    }
+
+    atomic_store_explicit(&g_defer_task, task, memory_order_release);
+}
+
+//==============================================================================
+//                              DEFERRED WORK API Implementation
+//==============================================================================
+
+/**
+ * @brief Run a function on the deferred-work daemon
+ *
+ * Queues the call without blocking or allocating, so it may be used from
+ * any interrupt that is allowed to call FreeRTOS "FromISR" functions, as
+ * well as from tasks. Calls run one after another in the order they were
+ * queued, at DMOSI_DEFER_PRIORITY; a call that blocks delays all later
+ * ones, so long jobs belong on a work queue instead.
+ *
+ * @param fn Function to call
+ * @param arg Argument passed to @p fn
+ * @return int 0 on success, -EAGAIN if the pending ring is full,
+ *         -ENOTSUP if the daemon is not running (dmosi_init() not called),
+ *         -EINVAL if @p fn is NULL
+ */
+int dmosi_defer_from_isr(dmosi_work_fn_t fn, void* arg)
+{
+    if (fn == NULL) {
+        return -EINVAL;
+    }
+
+    TaskHandle_t task = atomic_load_explicit(&g_defer_task, memory_order_acquire);
+    if (task == NULL) {
+        return -ENOTSUP;
+    }
+
+    uint32_t pos = atomic_load_explicit(&g_defer_ring.head, memory_order_relaxed);
+    struct defer_slot* slot;
+
+    for (;;) {
+        slot = &g_defer_ring.slots[pos & DEFER_MASK];
+        int32_t diff = (int32_t)(atomic_load_explicit(&slot->seq, memory_order_acquire) - pos);
+
+        if (diff == 0) {
+            if (atomic_compare_exchange_weak_explicit(&g_defer_ring.head, &pos, pos + 1U,
+                                                      memory_order_relaxed, memory_order_relaxed)) {
+                break;
+            }
+        } else if (diff < 0) {
+            // Full: the oldest call has not been run yet
+            atomic_fetch_add_explicit(&g_defer_dropped, 1U, memory_order_relaxed);
+            return -EAGAIN;
+        } else {
+            pos = atomic_load_explicit(&g_defer_ring.head, memory_order_relaxed);
+        }
+    }
+
+    slot->fn = fn;
+    slot->arg = arg;
+    atomic_store_explicit(&slot->seq, pos + 1U, memory_order_release);
+
+    if (xPortIsInsideInterrupt()) {
+        BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+        vTaskNotifyGiveIndexedFromISR(task, DMOSI_NOTIFY_INDEX_DEFAULT, &xHigherPriorityTaskWoken);
+        portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
+    } else {
+        xTaskNotifyGiveIndexed(task, DMOSI_NOTIFY_INDEX_DEFAULT);
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Get the number of deferred calls rejected because the ring was full
+ *
+ * @return uint32_t Rejected calls since boot
+ */
+uint32_t dmosi_defer_get_dropped(void)
+{
+    return atomic_load_explicit(&g_defer_dropped, memory_order_relaxed);
+}
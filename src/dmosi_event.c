@@ -0,0 +1,177 @@
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+#include <errno.h>
+#include "dmosi.h"
+#include "dmosi_freertos.h"
+#include "dmosi_notify.h"
+#include "dmosi_ticks.h"
+#include "FreeRTOS.h"
+#include "task.h"
+
+extern TaskHandle_t dmosi_thread_get_task_handle(dmosi_thread_t thread);
+
+/**
+ * @brief Internal structure of an event
+ *
+ * A bound event signals its waiter task directly through a task notification
+ * on DMOSI_NOTIFY_INDEX_EVENT; @ref pending records the signal so that
+ * several events bound to the same task do not consume each other's wake-ups.
+ * An unbound event (any number of waiters) is backed by a binary semaphore.
+ */
+struct dmosi_event {
+    TaskHandle_t waiter;            /**< Bound waiter task (NULL = semaphore-backed) */
+    atomic_bool pending;            /**< Signalled and not yet consumed (bound events) */
+    dmosi_semaphore_t semaphore;    /**< Backing binary semaphore (unbound events) */
+};
+
+//==============================================================================
+//                              EVENT API Implementation
+//==============================================================================
+
+/**
+ * @brief Create an event
+ *
+ * An event bound to @p waiter is signalled through that thread's task
+ * notifications and costs no kernel object; only @p waiter may wait on it.
+ * Passing NULL creates an event any number of threads may wait on, backed
+ * by a binary semaphore.
+ *
+ * @param waiter Thread that will wait on the event (NULL = any thread)
+ * @return dmosi_event_t Created event handle, NULL on failure
+ */
+dmosi_event_t dmosi_event_create(dmosi_thread_t waiter)
+{
+    struct dmosi_event* event = pvPortMalloc(sizeof(*event));
+    if (event == NULL) {
+        DMOD_LOG_ERROR("Failed to allocate memory for event\n");
+        return NULL;
+    }
+
+    event->waiter = NULL;
+    event->semaphore = NULL;
+    atomic_init(&event->pending, false);
+
+    if (waiter != NULL) {
+        event->waiter = dmosi_thread_get_task_handle(waiter);
+        if (event->waiter == NULL) {
+            DMOD_LOG_ERROR("Event waiter thread has no task\n");
+            vPortFree(event);
+            return NULL;
+        }
+    } else {
+        event->semaphore = dmosi_semaphore_create(0, 1);
+        if (event->semaphore == NULL) {
+            vPortFree(event);
+            return NULL;
+        }
+    }
+
+    return event;
+}
+
+/**
+ * @brief Destroy an event
+ *
+ * @param event Event handle to destroy
+ */
+void dmosi_event_destroy(dmosi_event_t event)
+{
+    if (event == NULL) {
+        return;
+    }
+
+    dmosi_semaphore_destroy(event->semaphore);
+    vPortFree(event);
+}
+
+/**
+ * @brief Signal an event
+ *
+ * Signals do not accumulate: signalling an event that is already signalled
+ * has no further effect. Safe to call from both task and interrupt context;
+ * from an interrupt at most one context switch is requested, on exit from
+ * the handler.
+ *
+ * @param event Event handle
+ * @return int 0 on success, -EINVAL if @p event is NULL
+ */
+int dmosi_event_signal(dmosi_event_t event)
+{
+    if (event == NULL) {
+        return -EINVAL;
+    }
+
+    if (event->semaphore != NULL) {
+        int result = dmosi_semaphore_post(event->semaphore, 1);
+        return (result == -EOVERFLOW) ? 0 : result;  // Already signalled
+    }
+
+    atomic_store_explicit(&event->pending, true, memory_order_release);
+
+    if (xPortIsInsideInterrupt()) {
+        BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+        vTaskNotifyGiveIndexedFromISR(event->waiter, DMOSI_NOTIFY_INDEX_EVENT, &xHigherPriorityTaskWoken);
+        portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
+    } else {
+        xTaskNotifyGiveIndexed(event->waiter, DMOSI_NOTIFY_INDEX_EVENT);
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Wait for an event to be signalled
+ *
+ * Consumes the signal. For a bound event only the waiter thread given at
+ * creation may call this.
+ *
+ * @param event Event handle
+ * @param timeout_ms Timeout in milliseconds (0 = no wait, -1 = wait forever)
+ * @return int 0 on success, -EPERM if called by a thread the event is not
+ *         bound to, negative error code on failure
+ */
+int dmosi_event_wait(dmosi_event_t event, int32_t timeout_ms)
+{
+    if (event == NULL) {
+        return -EINVAL;
+    }
+
+    if (event->semaphore != NULL) {
+        return dmosi_semaphore_wait(event->semaphore, 1, timeout_ms);
+    }
+
+    if (xTaskGetCurrentTaskHandle() != event->waiter) {
+        return -EPERM;
+    }
+
+    if (atomic_exchange_explicit(&event->pending, false, memory_order_acquire)) {
+        return 0;
+    }
+
+    if (timeout_ms == 0) {
+        return -EAGAIN;  // Would block
+    }
+
+    if (!dmosi_is_started()) {
+        return -ENOTSUP;
+    }
+
+    TickType_t ticks = dmosi_ticks_from_timeout(timeout_ms);
+
+    TimeOut_t timeout;
+    vTaskSetTimeOutState(&timeout);
+
+    for (;;) {
+        ulTaskNotifyTakeIndexed(DMOSI_NOTIFY_INDEX_EVENT, pdTRUE, ticks);
+
+        // A wake-up may belong to another event bound to this task
+        if (atomic_exchange_explicit(&event->pending, false, memory_order_acquire)) {
+            return 0;
+        }
+
+        if (xTaskCheckForTimeOut(&timeout, &ticks) == pdTRUE) {
+            return -ETIMEDOUT;  // Timeout occurred
+        }
+    }
+}
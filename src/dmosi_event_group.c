@@ -0,0 +1,203 @@
+#include <stdlib.h>
+#include <stdbool.h>
+#include <errno.h>
+#include "dmosi.h"
+#include "dmosi_freertos.h"
+#include "dmosi_ticks.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include "event_groups.h"
+
+/**
+ * @brief Internal structure of an event group
+ *
+ * Wraps a FreeRTOS event group together with its embedded control block,
+ * so creating a group takes a single allocation.
+ */
+struct dmosi_event_group {
+    EventGroupHandle_t handle;      /**< FreeRTOS event group handle */
+    StaticEventGroup_t buffer;      /**< Embedded FreeRTOS control block */
+};
+
+/**
+ * @brief Check that a bit mask fits the usable event group bits
+ *
+ * @param bits Bit mask
+ * @return true if @p bits only uses DMOSI_EVENT_GROUP_BITS
+ */
+static bool event_group_bits_valid(uint32_t bits)
+{
+    return (bits & ~(uint32_t)DMOSI_EVENT_GROUP_BITS) == 0;
+}
+
+//==============================================================================
+//                              EVENT GROUP API Implementation
+//==============================================================================
+
+/**
+ * @brief Create an event group with all bits cleared
+ *
+ * @return dmosi_event_group_t Created event group handle, NULL on failure
+ */
+dmosi_event_group_t dmosi_event_group_create(void)
+{
+    struct dmosi_event_group* group = pvPortMalloc(sizeof(*group));
+    if (group == NULL) {
+        DMOD_LOG_ERROR("Failed to allocate memory for event group\n");
+        return NULL;
+    }
+
+    group->handle = xEventGroupCreateStatic(&group->buffer);
+    if (group->handle == NULL) {
+        DMOD_LOG_ERROR("Failed to create FreeRTOS event group\n");
+        vPortFree(group);
+        return NULL;
+    }
+
+    return group;
+}
+
+/**
+ * @brief Destroy an event group
+ *
+ * Threads still waiting on the group are released with their wait failed.
+ *
+ * @param group Event group handle to destroy
+ */
+void dmosi_event_group_destroy(dmosi_event_group_t group)
+{
+    if (group == NULL) {
+        return;
+    }
+
+    vEventGroupDelete(group->handle);
+    vPortFree(group);
+}
+
+/**
+ * @brief Set bits of an event group
+ *
+ * Wakes every thread whose wait condition becomes true. Safe to call from
+ * both task and interrupt context; from an interrupt FreeRTOS defers the
+ * update to the timer daemon task, which runs as soon as the handler
+ * returns (the daemon has the highest priority).
+ *
+ * @param group Event group handle
+ * @param bits Bits to set (within DMOSI_EVENT_GROUP_BITS)
+ * @return int 0 on success, -EAGAIN if an interrupt could not defer the
+ *         update (timer command queue full), -EINVAL on invalid arguments
+ */
+int dmosi_event_group_set(dmosi_event_group_t group, uint32_t bits)
+{
+    if (group == NULL || !event_group_bits_valid(bits)) {
+        DMOD_LOG_ERROR("Invalid event group or bits (0x%lx)\n", (unsigned long)bits);
+        return -EINVAL;
+    }
+
+    if (xPortIsInsideInterrupt()) {
+        BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+        BaseType_t result = xEventGroupSetBitsFromISR(group->handle, (EventBits_t)bits, &xHigherPriorityTaskWoken);
+
+        portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
+
+        return (result == pdPASS) ? 0 : -EAGAIN;
+    }
+
+    (void)xEventGroupSetBits(group->handle, (EventBits_t)bits);
+    return 0;
+}
+
+/**
+ * @brief Clear bits of an event group
+ *
+ * Safe to call from both task and interrupt context (deferred to the timer
+ * daemon task from an interrupt, like dmosi_event_group_set()).
+ *
+ * @param group Event group handle
+ * @param bits Bits to clear (within DMOSI_EVENT_GROUP_BITS)
+ * @return int 0 on success, -EAGAIN if an interrupt could not defer the
+ *         update, -EINVAL on invalid arguments
+ */
+int dmosi_event_group_clear(dmosi_event_group_t group, uint32_t bits)
+{
+    if (group == NULL || !event_group_bits_valid(bits)) {
+        DMOD_LOG_ERROR("Invalid event group or bits (0x%lx)\n", (unsigned long)bits);
+        return -EINVAL;
+    }
+
+    if (xPortIsInsideInterrupt()) {
+        return (xEventGroupClearBitsFromISR(group->handle, (EventBits_t)bits) == pdPASS) ? 0 : -EAGAIN;
+    }
+
+    (void)xEventGroupClearBits(group->handle, (EventBits_t)bits);
+    return 0;
+}
+
+/**
+ * @brief Get the current bits of an event group
+ *
+ * Safe to call from both task and interrupt context.
+ *
+ * @param group Event group handle
+ * @return uint32_t Current bits (0 if @p group is NULL)
+ */
+uint32_t dmosi_event_group_get(dmosi_event_group_t group)
+{
+    if (group == NULL) {
+        return 0;
+    }
+
+    EventBits_t bits = xPortIsInsideInterrupt() ? xEventGroupGetBitsFromISR(group->handle)
+                                                : xEventGroupGetBits(group->handle);
+    return (uint32_t)(bits & DMOSI_EVENT_GROUP_BITS);
+}
+
+/**
+ * @brief Wait for any or all of a set of bits
+ *
+ * With DMOSI_EVENT_GROUP_CLEAR_ON_EXIT the awaited bits are cleared
+ * atomically with the successful return, so exactly one waiter consumes
+ * them when several wait for the same bits.
+ *
+ * @param group Event group handle
+ * @param bits Bits to wait for (non-zero, within DMOSI_EVENT_GROUP_BITS)
+ * @param flags DMOSI_EVENT_GROUP_WAIT_ALL and/or DMOSI_EVENT_GROUP_CLEAR_ON_EXIT
+ * @param result Filled with the bits at the time the wait ended, before any
+ *               clearing (optional)
+ * @param timeout_ms Timeout in milliseconds (0 = no wait, -1 = wait forever)
+ * @return int 0 if the condition was met, negative error code otherwise
+ */
+int dmosi_event_group_wait(dmosi_event_group_t group, uint32_t bits, uint32_t flags, uint32_t* result, int32_t timeout_ms)
+{
+    if (group == NULL || bits == 0 || !event_group_bits_valid(bits)) {
+        DMOD_LOG_ERROR("Invalid event group or bits (0x%lx)\n", (unsigned long)bits);
+        return -EINVAL;
+    }
+
+    if (timeout_ms != 0 && !dmosi_is_started()) {
+        return -ENOTSUP;
+    }
+
+    TickType_t ticks = dmosi_ticks_from_timeout(timeout_ms);
+
+    bool wait_all = (flags & DMOSI_EVENT_GROUP_WAIT_ALL) != 0;
+    EventBits_t value = xEventGroupWaitBits(group->handle,
+                                            (EventBits_t)bits,
+                                            (flags & DMOSI_EVENT_GROUP_CLEAR_ON_EXIT) ? pdTRUE : pdFALSE,
+                                            wait_all ? pdTRUE : pdFALSE,
+                                            ticks);
+    uint32_t current = (uint32_t)(value & DMOSI_EVENT_GROUP_BITS);
+
+    if (result != NULL) {
+        *result = current;
+    }
+
+    bool met = wait_all ? ((current & bits) == bits) : ((current & bits) != 0);
+    if (met) {
+        return 0;
+    } else if (ticks == 0) {
+        return -EAGAIN;  // Would block
+    } else {
+        return -ETIMEDOUT;  // Timeout occurred
+    }
+}
@@ -1,6 +1,8 @@
 #include <stdbool.h>
+#include <stdint.h>
 #include "dmosi.h"
 #include "dmod.h"
+#include "dmosi_mpu.h"
 #include "FreeRTOS.h"
 #include "task.h"
 
@@ -33,8 +35,42 @@ __attribute__((weak)) void vApplicationStackOverflowHook( TaskHandle_t xTask, ch
 }
 #endif /* configCHECK_FOR_STACK_OVERFLOW */
 
+#if DMOSI_STACK_LIMIT_HW
+// ARMv8-M System Control Block fault registers
+#define SCB_SHCSR                   ( *( volatile uint32_t* )0xE000ED24UL )
+#define SCB_SHCSR_USGFAULTENA       ( 1UL << 18 )
+#define SCB_CFSR                    ( *( volatile uint32_t* )0xE000ED28UL )
+#define SCB_CFSR_STKOF              ( 1UL << 20 )
+
+/**
+ * @brief UsageFault handler reporting stack overflows caught by PSPLIM
+ *
+ * With DMOSI_STACK_LIMIT_HW a push below the stack limit of a task raises a
+ * UsageFault (STKOF) instead of triggering vApplicationStackOverflowHook().
+ * Install this handler in the UsageFault vector to get the same report;
+ * dmosi_init() enables the UsageFault so it does not escalate to a HardFault.
+ */
+__attribute__((weak)) void dmosi_usage_fault_handler( void )
+{
+    // The fault handler runs on the main stack, but the task's dmosi state
+    // may still be corrupted; see vApplicationStackOverflowHook()
+    Dmod_SetForceKernelWrite(true);
+    if ((SCB_CFSR & SCB_CFSR_STKOF) != 0) {
+        DMOD_LOG_ERROR("Stack overflow detected in task: %s\n", pcTaskGetName(NULL));
+    } else {
+        DMOD_LOG_ERROR("Usage fault (CFSR 0x%08lx)\n", (unsigned long)SCB_CFSR);
+    }
+
+    // Disable interrupts and halt the system
+    taskDISABLE_INTERRUPTS();
+    while(1);
+}
+#endif /* DMOSI_STACK_LIMIT_HW */
+
 extern void dmosi_thread_set_init_process(dmosi_process_t process);
 extern void dmosi_thread_unregister_current(void);
+extern void dmosi_runtime_start(void);
+extern void dmosi_defer_start(void);
 
 static dmosi_process_t g_system_process = NULL;
 
@@ -44,6 +80,8 @@ static dmosi_process_t g_system_process = NULL;
 
 DMOD_INPUT_API_DECLARATION( dmosi, 1.0, bool, _init, (void) )
 {
+    DMOSI_MPU_PRIVILEGED_SCOPE();
+
     if (g_system_process != NULL) {
         DMOD_LOG_ERROR("dmosi already initialized\n");
         return false;
@@ -55,7 +93,14 @@ DMOD_INPUT_API_DECLARATION( dmosi, 1.0, bool, _init, (void) )
         return false;
     }
 
+#if DMOSI_STACK_LIMIT_HW
+    // Route stack limit violations to dmosi_usage_fault_handler()
+    SCB_SHCSR |= SCB_SHCSR_USGFAULTENA;
+#endif
+
     dmosi_thread_set_init_process(g_system_process);
+    dmosi_runtime_start();
+    dmosi_defer_start();
 
     if (xTaskGetSchedulerState() == taskSCHEDULER_NOT_STARTED) {
         vTaskStartScheduler();
@@ -82,6 +127,8 @@ DMOD_INPUT_API_DECLARATION( dmosi, 1.0, bool, _is_started, (void) )
 
 DMOD_INPUT_API_DECLARATION( dmosi, 1.0, bool, _deinit, (void) )
 {
+    DMOSI_MPU_PRIVILEGED_SCOPE();
+
     if (g_system_process == NULL) {
         return true;
     }
@@ -0,0 +1,394 @@
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdatomic.h>
+#include <errno.h>
+#include "dmosi.h"
+#include "dmosi_freertos.h"
+#include "dmosi_pool.h"
+#include "dmosi_wait.h"
+#include "FreeRTOS.h"
+#include "task.h"
+
+/**
+ * @brief Life cycle of a future
+ */
+enum future_state {
+    FUTURE_PENDING = 0,     /**< Not completed yet */
+    FUTURE_DONE,            /**< Completed, @ref dmosi_future::result is valid */
+};
+
+/**
+ * @brief Internal structure of a future
+ *
+ * Waiters register a watcher on @ref watchers and are woken through their
+ * task notification on DMOSI_NOTIFY_INDEX_WAIT, the same way as for
+ * dmosi_wait_multiple(), which can therefore wait on futures too. The
+ * callback runs from the embedded work item, so neither waiting nor the
+ * callback allocates anything.
+ */
+struct dmosi_future {
+    atomic_uint state;                  /**< One of enum future_state */
+    intptr_t result;                    /**< Result given to dmosi_future_complete() */
+    dmosi_watch_list_t watchers;        /**< Threads waiting for the completion */
+    dmosi_workqueue_t wq;               /**< Work queue of the callback (NULL = no callback) */
+    dmosi_future_callback_t callback;   /**< Callback run on completion */
+    void* callback_arg;                 /**< Argument passed to @ref callback */
+    TaskHandle_t callback_task;         /**< Worker running @ref callback (NULL if not running) */
+    struct dmosi_future* next_zombie;   /**< Next future released from its own callback */
+    dmosi_work_t work;                  /**< Work item running @ref callback */
+};
+
+/**
+ * @brief Pool serving struct dmosi_future objects (see DMOSI_FUTURE_POOL_SIZE)
+ */
+DMOSI_POOL_DEFINE(g_dmosi_future_pool, struct dmosi_future, DMOSI_FUTURE_POOL_SIZE);
+
+/**
+ * @brief Futures destroyed from their own callback
+ *
+ * The worker still marks the work item done after the callback returned, so
+ * such a future is only returned to the pool by a later create or destroy
+ * call, once its work item has finished. Protected by a kernel critical
+ * section.
+ */
+static struct dmosi_future* g_future_zombies = NULL;
+
+/**
+ * @brief Return the futures whose callback has finished to the pool
+ */
+static void future_reap(void)
+{
+    taskENTER_CRITICAL();
+    struct dmosi_future* zombie = g_future_zombies;
+    g_future_zombies = NULL;
+    taskEXIT_CRITICAL();
+
+    while (zombie != NULL) {
+        struct dmosi_future* next = zombie->next_zombie;
+
+        if (dmosi_work_wait(&zombie->work, 0) == 0) {
+            dmosi_pool_free(&g_dmosi_future_pool, zombie);
+        } else {
+            taskENTER_CRITICAL();
+            zombie->next_zombie = g_future_zombies;
+            g_future_zombies = zombie;
+            taskEXIT_CRITICAL();
+        }
+
+        zombie = next;
+    }
+}
+
+/**
+ * @brief Work function running the callback of a completed future
+ *
+ * @param arg Future
+ */
+static void future_callback_work(void* arg)
+{
+    struct dmosi_future* future = (struct dmosi_future*)arg;
+
+    taskENTER_CRITICAL();
+    future->callback_task = xTaskGetCurrentTaskHandle();
+    taskEXIT_CRITICAL();
+
+    future->callback(future, future->result, future->callback_arg);
+
+    // A future destroyed by its callback is parked on the zombie list, so
+    // its memory is still valid here
+    taskENTER_CRITICAL();
+    future->callback_task = NULL;
+    taskEXIT_CRITICAL();
+}
+
+/**
+ * @brief Initialize a future as pending, without a callback
+ *
+ * @param future Future to initialize
+ */
+static void future_init(struct dmosi_future* future)
+{
+    atomic_init(&future->state, FUTURE_PENDING);
+    future->result = 0;
+    dmosi_watch_init(&future->watchers);
+    future->wq = NULL;
+    future->callback = NULL;
+    future->callback_arg = NULL;
+    future->callback_task = NULL;
+    future->next_zombie = NULL;
+    dmosi_work_init(&future->work, future_callback_work, future);
+}
+
+//==============================================================================
+//                              FUTURE API Implementation
+//==============================================================================
+
+/**
+ * @brief Create a pending future
+ *
+ * Served from a static pool of DMOSI_FUTURE_POOL_SIZE futures, falling back
+ * to the heap when it is exhausted.
+ *
+ * @return dmosi_future_t Created future handle, NULL on failure
+ */
+dmosi_future_t dmosi_future_create(void)
+{
+    future_reap();
+
+    struct dmosi_future* future = dmosi_pool_alloc(&g_dmosi_future_pool);
+    if (future == NULL) {
+        DMOD_LOG_ERROR("Failed to allocate memory for future\n");
+        return NULL;
+    }
+
+    future_init(future);
+
+    return future;
+}
+
+/**
+ * @brief Destroy a future
+ *
+ * A callback that has not started yet is canceled; one that is running is
+ * waited for. The callback itself may destroy its future as well. No thread
+ * may be waiting on the future.
+ *
+ * @param future Future handle to destroy
+ */
+void dmosi_future_destroy(dmosi_future_t future)
+{
+    if (future == NULL) {
+        return;
+    }
+
+    future_reap();
+
+    if (future->wq != NULL && dmosi_workqueue_cancel(future->wq, &future->work) == -EBUSY) {
+        taskENTER_CRITICAL();
+        bool self = (future->callback_task == xTaskGetCurrentTaskHandle());
+        if (self) {
+            future->next_zombie = g_future_zombies;
+            g_future_zombies = future;
+        }
+        taskEXIT_CRITICAL();
+
+        if (self) {
+            return;
+        }
+
+        dmosi_work_wait(&future->work, -1);
+    }
+
+    dmosi_pool_free(&g_dmosi_future_pool, future);
+}
+
+/**
+ * @brief Return a completed future to the pending state for reuse
+ *
+ * Drops the callback. Must only be called once no producer can complete
+ * the future anymore.
+ *
+ * @param future Future handle
+ * @return int 0 on success, -EBUSY if threads wait on the future or its
+ *         callback has not finished, -EINVAL if @p future is NULL
+ */
+int dmosi_future_reset(dmosi_future_t future)
+{
+    if (future == NULL) {
+        return -EINVAL;
+    }
+
+    int result = 0;
+
+    taskENTER_CRITICAL();
+    if (atomic_load_explicit(&future->watchers.head, memory_order_relaxed) != NULL) {
+        result = -EBUSY;
+    } else if (future->wq != NULL && dmosi_work_wait(&future->work, 0) == -EAGAIN) {
+        result = -EBUSY;  // Callback pending or running
+    } else {
+        future_init(future);
+    }
+    taskEXIT_CRITICAL();
+
+    return result;
+}
+
+/**
+ * @brief Complete a future with a result
+ *
+ * Wakes all threads waiting on the future and submits its callback, if one
+ * is attached. Never blocks. Safe to call from both task and interrupt
+ * context; from an interrupt at most one context switch is requested, on
+ * exit from the handler.
+ *
+ * @param future Future handle
+ * @param result Result handed to the waiters and the callback
+ * @return int 0 on success, -EALREADY if the future was already completed,
+ *         -ESHUTDOWN if the work queue of the callback is being destroyed
+ *         (the future is completed nonetheless), -EINVAL if @p future is NULL
+ */
+int dmosi_future_complete(dmosi_future_t future, intptr_t result)
+{
+    if (future == NULL) {
+        return -EINVAL;
+    }
+
+    bool isr = xPortIsInsideInterrupt();
+    UBaseType_t saved = 0;
+    dmosi_workqueue_t wq = NULL;
+    bool completed = false;
+
+    // Attaching a callback takes the same critical section, so exactly one
+    // side sees both the callback and the completion and submits the work
+    if (isr) {
+        saved = taskENTER_CRITICAL_FROM_ISR();
+    } else {
+        taskENTER_CRITICAL();
+    }
+    if (atomic_load_explicit(&future->state, memory_order_relaxed) == FUTURE_PENDING) {
+        future->result = result;
+        atomic_store_explicit(&future->state, FUTURE_DONE, memory_order_release);
+        wq = future->wq;
+        completed = true;
+    }
+    if (isr) {
+        taskEXIT_CRITICAL_FROM_ISR(saved);
+    } else {
+        taskEXIT_CRITICAL();
+    }
+
+    if (!completed) {
+        return -EALREADY;
+    }
+
+    dmosi_watch_notify(&future->watchers);
+
+    if (wq != NULL) {
+        return dmosi_workqueue_submit(wq, &future->work);
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Get the result of a future without waiting
+ *
+ * @param future Future handle
+ * @param result Filled with the result when completed (may be NULL)
+ * @return int 0 if completed, -EAGAIN if still pending, -EINVAL if
+ *         @p future is NULL
+ */
+int dmosi_future_poll(dmosi_future_t future, intptr_t* result)
+{
+    if (future == NULL) {
+        return -EINVAL;
+    }
+
+    if (atomic_load_explicit(&future->state, memory_order_acquire) != FUTURE_DONE) {
+        return -EAGAIN;
+    }
+
+    if (result != NULL) {
+        *result = future->result;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Wait for a future to be completed
+ *
+ * Any number of threads may wait on the same future.
+ *
+ * @param future Future handle
+ * @param result Filled with the result when completed (may be NULL)
+ * @param timeout_ms Timeout in milliseconds (0 = no wait, -1 = wait forever)
+ * @return int 0 on success, -EAGAIN or -ETIMEDOUT if the future was not
+ *         completed in time, negative error code on failure
+ */
+int dmosi_future_wait(dmosi_future_t future, intptr_t* result, int32_t timeout_ms)
+{
+    if (future == NULL) {
+        return -EINVAL;
+    }
+
+    if (dmosi_future_poll(future, result) == 0) {
+        return 0;
+    }
+
+    const dmosi_wait_object_t object = { .type = DMOSI_WAIT_FUTURE, .object = future };
+    int ready = dmosi_wait_multiple(&object, 1, timeout_ms);
+    if (ready < 0) {
+        return ready;
+    }
+
+    return dmosi_future_poll(future, result);
+}
+
+/**
+ * @brief Run a callback on a work queue when a future is completed
+ *
+ * If the future is already completed, the callback is submitted right away.
+ * Only one callback can be attached to a future.
+ *
+ * @param future Future handle
+ * @param wq Work queue running the callback
+ * @param callback Callback to run
+ * @param arg Argument passed to @p callback
+ * @return int 0 on success, -EBUSY if a callback is already attached,
+ *         -EINVAL on invalid arguments, negative error code if the callback
+ *         could not be submitted
+ */
+int dmosi_future_on_complete(dmosi_future_t future, dmosi_workqueue_t wq, dmosi_future_callback_t callback, void* arg)
+{
+    if (future == NULL || wq == NULL || callback == NULL) {
+        return -EINVAL;
+    }
+
+    int result = 0;
+    bool submit = false;
+
+    taskENTER_CRITICAL();
+    if (future->wq != NULL) {
+        result = -EBUSY;
+    } else {
+        future->wq = wq;
+        future->callback = callback;
+        future->callback_arg = arg;
+        submit = (atomic_load_explicit(&future->state, memory_order_relaxed) == FUTURE_DONE);
+    }
+    taskEXIT_CRITICAL();
+
+    if (submit) {
+        result = dmosi_workqueue_submit(wq, &future->work);
+    }
+
+    return result;
+}
+
+//==============================================================================
+//                              Multiple object wait support
+//==============================================================================
+
+/**
+ * @brief Get the watcher list of a future
+ *
+ * @param future Future handle
+ * @return dmosi_watch_list_t* Watcher list of @p future
+ */
+dmosi_watch_list_t* dmosi_future_watch_list(dmosi_future_t future)
+{
+    return &future->watchers;
+}
+
+/**
+ * @brief Check whether a future is completed
+ *
+ * @param future Future handle
+ * @return true if a wait on @p future would not block
+ */
+bool dmosi_future_ready(dmosi_future_t future)
+{
+    return atomic_load_explicit(&future->state, memory_order_acquire) == FUTURE_DONE;
+}
@@ -1,62 +1,116 @@
+#include <stddef.h>
+#include <stdint.h>
 #include "FreeRTOS.h"
 #include "dmod_sal.h"
 #include "dmosi.h"
+#include "dmosi_heap.h"
+
+extern const char* dmosi_thread_current_module_name(uint32_t* heap_slot);
 
 /**
  * @brief Custom memory allocation function for FreeRTOS
- * 
+ *
  * This function is used by FreeRTOS for dynamic memory allocation. It redirects
  * to the DMOD memory allocator, passing the current thread's module name for
- * tracking purposes.
- * 
+ * tracking purposes. The name is taken from the per-thread cache, so the
+ * owning process is not resolved again on every allocation.
+ *
+ * With DMOSI_HEAP_STATS enabled every block carries a small header so its
+ * size can be accounted to the owning module (see dmosi_heap_get_stats()).
+ * The module's statistics slot is cached next to its name, so accounting
+ * adds one short critical section and no name lookup.
+ *
  * @param size Size of memory to allocate in bytes
  * @return void* Pointer to allocated memory, or NULL on failure
  */
 void* pvPortMalloc(size_t size)
 {
-    return Dmod_MallocEx(size, dmosi_thread_get_module_name(NULL));
+#if DMOSI_HEAP_STATS
+    uint32_t slot;
+    const char* module_name = dmosi_thread_current_module_name(&slot);
+
+    return dmosi_heap_stats_malloc(size, module_name, slot);
+#else
+    return Dmod_MallocEx(size, dmosi_thread_current_module_name(NULL));
+#endif
 }
 
 /**
  * @brief Custom memory deallocation function for FreeRTOS
- * 
+ *
  * This function is used by FreeRTOS for freeing dynamically allocated memory.
  * It redirects to the DMOD memory deallocator.
- * 
+ *
  * @param ptr Pointer to memory to free
  */
 void vPortFree(void* ptr)
 {
+#if DMOSI_HEAP_STATS
+    dmosi_heap_stats_release(ptr);
+#else
     Dmod_Free(ptr);
+#endif
+}
+
+/**
+ * @brief Move a block returned by pvPortMalloc() to another module
+ *
+ * Blocks allocated before the owning thread was registered are attributed
+ * to the creator; this hands them over in the DMOD allocator and, with
+ * DMOSI_HEAP_STATS enabled, in the per-module statistics.
+ *
+ * @param ptr Block returned by pvPortMalloc()
+ * @param module_name New owner module
+ */
+void dmosi_heap_retag(void* ptr, const char* module_name)
+{
+    if (ptr == NULL || module_name == NULL) {
+        return;
+    }
+
+#if DMOSI_HEAP_STATS
+    dmosi_heap_stats_retag(ptr, module_name);
+#else
+    Dmod_RetagEx(ptr, module_name);
+#endif
 }
 
 /**
  * @brief Get the current free heap size
- * 
+ *
  * This function is used by FreeRTOS to query the amount of free heap memory available.
- * Since we are using a custom allocator, we return 0 to indicate that this information
- * is not available.
+ * The DMOD allocator does not report its capacity, so the result is derived from
+ * DMOSI_HEAP_SIZE and the bytes accounted by pvPortMalloc(). Returns 0 when
+ * DMOSI_HEAP_SIZE or DMOSI_HEAP_STATS is not configured.
  */
 size_t xPortGetFreeHeapSize(void)
 {
+#if DMOSI_HEAP_STATS
+    return dmosi_heap_stats_free_size(DMOSI_HEAP_SIZE, false);
+#else
     return 0;
+#endif
 }
 
 /**
  * @brief Get the minimum ever free heap size
- * 
+ *
  * This function is used by FreeRTOS to query the minimum amount of free heap memory
- * that has been available since the system started. Since we are using a custom allocator,
- * we return 0 to indicate that this information is not available.
+ * that has been available since the system started. Derived like
+ * xPortGetFreeHeapSize() from the high watermark of the accounted bytes.
  */
 size_t xPortGetMinimumEverFreeHeapSize(void)
 {
+#if DMOSI_HEAP_STATS
+    return dmosi_heap_stats_free_size(DMOSI_HEAP_SIZE, true);
+#else
     return 0;
+#endif
 }
 
 /**
  * @brief Initialize memory blocks (not needed for custom allocator)
- * 
+ *
  * This function is called by FreeRTOS to initialize memory blocks when using certain
  * heap implementations. Since we are using a custom allocator, we do not need to
  * perform any initialization here.
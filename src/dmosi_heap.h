@@ -0,0 +1,91 @@
+#ifndef DMOSI_HEAP_H
+#define DMOSI_HEAP_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "dmosi_freertos.h"
+
+/**
+ * @brief Default heap statistics configuration
+ *
+ * Configurable via the CMake parameters of the same name. With
+ * DMOSI_HEAP_STATS disabled pvPortMalloc() calls the DMOD allocator
+ * directly and no per-block header is added.
+ */
+#ifndef DMOSI_HEAP_STATS
+    #define DMOSI_HEAP_STATS            1
+#endif
+#ifndef DMOSI_HEAP_STATS_MODULES
+    #define DMOSI_HEAP_STATS_MODULES    16
+#endif
+#ifndef DMOSI_HEAP_SIZE
+    #define DMOSI_HEAP_SIZE             0
+#endif
+
+/**
+ * @brief Module slot collecting untagged allocations and table overflow
+ */
+#define DMOSI_HEAP_STATS_OTHER          DMOSI_HEAP_STATS_MODULES
+
+/**
+ * @brief Look up (or add) the statistics slot of a module
+ *
+ * Compares module names, so callers resolve the slot once and keep it (see
+ * dmosi_thread_current_module_name()).
+ *
+ * @param module_name Module name (NULL = untagged)
+ * @return uint32_t Slot index, DMOSI_HEAP_STATS_OTHER if untagged or the table is full
+ */
+uint32_t dmosi_heap_stats_slot(const char* module_name);
+
+/**
+ * @brief Allocate an accounted block from the DMOD allocator
+ *
+ * The block carries a header with its size and module slot, padded to
+ * portBYTE_ALIGNMENT.
+ *
+ * @param size Requested size in bytes
+ * @param module_name Module to tag the block with in the DMOD allocator
+ * @param slot Statistics slot of @p module_name
+ * @return void* Pointer to the allocated memory, NULL on failure
+ */
+void* dmosi_heap_stats_malloc(size_t size, const char* module_name, uint32_t slot);
+
+/**
+ * @brief Free a block returned by dmosi_heap_stats_malloc()
+ *
+ * @param ptr Block pointer (can be NULL)
+ */
+void dmosi_heap_stats_release(void* ptr);
+
+/**
+ * @brief Move a block returned by dmosi_heap_stats_malloc() to another module
+ *
+ * Retags the block in the DMOD allocator and moves its accounting.
+ *
+ * @param ptr Block pointer
+ * @param module_name New owner module
+ */
+void dmosi_heap_stats_retag(void* ptr, const char* module_name);
+
+/**
+ * @brief Derive the free heap size from the accounted bytes
+ *
+ * @param heap_size Bytes available to the DMOD allocator (0 = unknown)
+ * @param minimum true for the minimum ever free size instead of the current one
+ * @return size_t Free bytes, 0 if @p heap_size is unknown
+ */
+size_t dmosi_heap_stats_free_size(size_t heap_size, bool minimum);
+
+/**
+ * @brief Move a block returned by pvPortMalloc() to another module
+ *
+ * Retags the block in the DMOD allocator and moves its accounting.
+ *
+ * @param ptr Block returned by pvPortMalloc()
+ * @param module_name New owner module
+ */
+void dmosi_heap_retag(void* ptr, const char* module_name);
+
+#endif /* DMOSI_HEAP_H */
@@ -0,0 +1,356 @@
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <errno.h>
+#include "dmod_sal.h"
+#include "dmosi.h"
+#include "dmosi_heap.h"
+#include "FreeRTOS.h"
+#include "task.h"
+
+/*
+ * Kept apart from dmosi_heap.c so applications (and the tests) that provide
+ * their own pvPortMalloc() can still link the statistics API and the
+ * accounted allocation path.
+ */
+
+/**
+ * @brief Accounting header placed in front of every block
+ *
+ * Records what has to be subtracted again when the block is freed, since
+ * the DMOD allocator does not report block sizes back.
+ */
+typedef struct {
+    size_t size;        /**< Requested size in bytes */
+    uint32_t slot;      /**< Module statistics slot */
+} heap_header_t;
+
+/**
+ * @brief Size of the block header, rounded so the returned block stays aligned
+ */
+#define HEAP_HEADER_SIZE \
+    ((sizeof(heap_header_t) + portBYTE_ALIGNMENT - 1) & ~(size_t)(portBYTE_ALIGNMENT - 1))
+
+/**
+ * @brief Get the accounting header of a block returned by dmosi_heap_stats_malloc()
+ *
+ * @param ptr Block pointer
+ * @return heap_header_t* Header in front of the block
+ */
+static inline heap_header_t* heap_header(void* ptr)
+{
+    return (heap_header_t*)((uint8_t*)ptr - HEAP_HEADER_SIZE);
+}
+
+/**
+ * @brief Per-module heap statistics
+ *
+ * Slots are added on first use and never removed, so a slot index stays
+ * valid in the headers of live blocks. The extra last slot collects
+ * untagged allocations and modules beyond the table.
+ */
+static dmosi_heap_module_stats_t g_modules[DMOSI_HEAP_STATS_MODULES + 1];
+static size_t g_module_count = 0;       /**< Named slots in use */
+static dmosi_heap_stats_t g_totals;     /**< Statistics over all modules */
+static size_t g_used_gross = 0;         /**< Bytes taken from the allocator, headers included */
+static size_t g_peak_gross = 0;         /**< High watermark of @ref g_used_gross */
+
+/**
+ * @brief Update a high watermark
+ *
+ * @param stats Statistics whose peak to update
+ */
+static inline void heap_stats_update_peak(dmosi_heap_stats_t* stats)
+{
+    if (stats->bytes_in_use > stats->peak_bytes) {
+        stats->peak_bytes = stats->bytes_in_use;
+    }
+}
+
+/**
+ * @brief Find the slot of a module name
+ *
+ * Must be called with the scheduler suspended or from a critical section.
+ *
+ * @param module_name Module name
+ * @return int Slot index, -1 if the module has no slot
+ */
+static int heap_stats_find_locked(const char* module_name)
+{
+    for (size_t i = 0; i < g_module_count; i++) {
+        if (strncmp(g_modules[i].module_name, module_name, DMOSI_HEAP_MODULE_NAME_LENGTH - 1) == 0) {
+            return (int)i;
+        }
+    }
+
+    return -1;
+}
+
+//==============================================================================
+//                              HEAP STATISTICS Implementation
+//==============================================================================
+
+/**
+ * @brief Look up (or add) the statistics slot of a module
+ *
+ * @param module_name Module name (NULL = untagged)
+ * @return uint32_t Slot index, DMOSI_HEAP_STATS_OTHER if untagged or the table is full
+ */
+uint32_t dmosi_heap_stats_slot(const char* module_name)
+{
+    if (module_name == NULL || module_name[0] == '\0') {
+        return DMOSI_HEAP_STATS_OTHER;
+    }
+
+    uint32_t slot = DMOSI_HEAP_STATS_OTHER;
+
+    vTaskSuspendAll();
+    int found = heap_stats_find_locked(module_name);
+    if (found >= 0) {
+        slot = (uint32_t)found;
+    } else if (g_module_count < DMOSI_HEAP_STATS_MODULES) {
+        slot = (uint32_t)g_module_count;
+        strncpy(g_modules[slot].module_name, module_name, DMOSI_HEAP_MODULE_NAME_LENGTH - 1);
+        g_modules[slot].module_name[DMOSI_HEAP_MODULE_NAME_LENGTH - 1] = '\0';
+        g_module_count++;
+    }
+    (void)xTaskResumeAll();
+
+    return slot;
+}
+
+/**
+ * @brief Account a successful allocation
+ *
+ * @param slot Module slot
+ * @param size Requested size in bytes
+ * @param gross Size taken from the allocator including overhead
+ */
+static void heap_stats_alloc(uint32_t slot, size_t size, size_t gross)
+{
+    dmosi_heap_stats_t* stats = &g_modules[slot].stats;
+
+    taskENTER_CRITICAL();
+    stats->bytes_in_use += size;
+    stats->allocations++;
+    heap_stats_update_peak(stats);
+
+    g_totals.bytes_in_use += size;
+    g_totals.allocations++;
+    heap_stats_update_peak(&g_totals);
+
+    g_used_gross += gross;
+    if (g_used_gross > g_peak_gross) {
+        g_peak_gross = g_used_gross;
+    }
+    taskEXIT_CRITICAL();
+}
+
+/**
+ * @brief Account a released allocation
+ *
+ * @param slot Module slot the block is accounted to
+ * @param size Requested size in bytes
+ * @param gross Size taken from the allocator including overhead
+ */
+static void heap_stats_free(uint32_t slot, size_t size, size_t gross)
+{
+    taskENTER_CRITICAL();
+    g_modules[slot].stats.bytes_in_use -= size;
+    g_totals.bytes_in_use -= size;
+    g_used_gross -= gross;
+    taskEXIT_CRITICAL();
+}
+
+/**
+ * @brief Account a failed allocation
+ *
+ * @param slot Module slot
+ */
+static void heap_stats_failure(uint32_t slot)
+{
+    taskENTER_CRITICAL();
+    g_modules[slot].stats.failures++;
+    g_totals.failures++;
+    taskEXIT_CRITICAL();
+}
+
+/**
+ * @brief Move a live allocation to another module
+ *
+ * The allocation is not counted again for the new module.
+ *
+ * @param from Module slot the block is accounted to
+ * @param to New module slot
+ * @param size Requested size in bytes
+ */
+static void heap_stats_move(uint32_t from, uint32_t to, size_t size)
+{
+    if (from == to) {
+        return;
+    }
+
+    taskENTER_CRITICAL();
+    g_modules[from].stats.bytes_in_use -= size;
+    g_modules[to].stats.bytes_in_use += size;
+    heap_stats_update_peak(&g_modules[to].stats);
+    taskEXIT_CRITICAL();
+}
+
+/**
+ * @brief Allocate an accounted block from the DMOD allocator
+ *
+ * @param size Requested size in bytes
+ * @param module_name Module to tag the block with in the DMOD allocator
+ * @param slot Statistics slot of @p module_name
+ * @return void* Pointer to the allocated memory, NULL on failure
+ */
+void* dmosi_heap_stats_malloc(size_t size, const char* module_name, uint32_t slot)
+{
+    if (size > SIZE_MAX - HEAP_HEADER_SIZE) {
+        heap_stats_failure(slot);
+        return NULL;
+    }
+
+    uint8_t* block = Dmod_MallocEx(HEAP_HEADER_SIZE + size, module_name);
+    if (block == NULL) {
+        heap_stats_failure(slot);
+        return NULL;
+    }
+
+    heap_header_t* header = (heap_header_t*)block;
+    header->size = size;
+    header->slot = slot;
+    heap_stats_alloc(slot, size, HEAP_HEADER_SIZE + size);
+
+    return block + HEAP_HEADER_SIZE;
+}
+
+/**
+ * @brief Free a block returned by dmosi_heap_stats_malloc()
+ *
+ * @param ptr Block pointer (can be NULL)
+ */
+void dmosi_heap_stats_release(void* ptr)
+{
+    if (ptr == NULL) {
+        return;
+    }
+
+    heap_header_t* header = heap_header(ptr);
+    heap_stats_free(header->slot, header->size, HEAP_HEADER_SIZE + header->size);
+    Dmod_Free(header);
+}
+
+/**
+ * @brief Move a block returned by dmosi_heap_stats_malloc() to another module
+ *
+ * @param ptr Block pointer
+ * @param module_name New owner module
+ */
+void dmosi_heap_stats_retag(void* ptr, const char* module_name)
+{
+    heap_header_t* header = heap_header(ptr);
+    uint32_t slot = dmosi_heap_stats_slot(module_name);
+
+    heap_stats_move(header->slot, slot, header->size);
+    header->slot = slot;
+    Dmod_RetagEx(header, module_name);
+}
+
+/**
+ * @brief Derive the free heap size from the accounted bytes
+ *
+ * The DMOD allocator does not report its capacity, so it has to be given
+ * (DMOSI_HEAP_SIZE for xPortGetFreeHeapSize()). Headers are counted as used.
+ *
+ * @param heap_size Bytes available to the DMOD allocator (0 = unknown)
+ * @param minimum true for the minimum ever free size instead of the current one
+ * @return size_t Free bytes, 0 if @p heap_size is unknown
+ */
+size_t dmosi_heap_stats_free_size(size_t heap_size, bool minimum)
+{
+    size_t used = minimum ? g_peak_gross : g_used_gross;
+
+    return (used < heap_size) ? heap_size - used : 0;
+}
+
+/**
+ * @brief Get the heap statistics of a module
+ *
+ * Counts the memory allocated through pvPortMalloc(), i.e. by the kernel
+ * and the dmosi objects, attributed to the module of the allocating thread.
+ * Updating the counters is a few additions in one short critical section
+ * per allocation, with the module's slot cached on the thread.
+ *
+ * @param module_name Module name (NULL = totals over all modules)
+ * @param stats Structure to fill
+ * @return int 0 on success, -ENOENT if the module never allocated,
+ *         -ENOTSUP if DMOSI_HEAP_STATS is disabled, -EINVAL on invalid arguments
+ */
+int dmosi_heap_get_stats(const char* module_name, dmosi_heap_stats_t* stats)
+{
+    if (stats == NULL) {
+        return -EINVAL;
+    }
+
+#if !DMOSI_HEAP_STATS
+    (void)module_name;
+    return -ENOTSUP;
+#else
+    int result = 0;
+
+    // The name table is protected by suspending the scheduler, the counters
+    // by the critical section they are updated in
+    vTaskSuspendAll();
+    const dmosi_heap_stats_t* source = &g_totals;
+    if (module_name != NULL) {
+        int found = heap_stats_find_locked(module_name);
+        source = (found >= 0) ? &g_modules[found].stats : NULL;
+    }
+    if (source != NULL) {
+        taskENTER_CRITICAL();
+        *stats = *source;
+        taskEXIT_CRITICAL();
+    } else {
+        result = -ENOENT;
+    }
+    (void)xTaskResumeAll();
+
+    return result;
+#endif
+}
+
+/**
+ * @brief Get the heap statistics of all modules
+ *
+ * Fills one entry per module that allocated memory, followed by an entry
+ * with an empty name for untagged allocations and modules that did not fit
+ * into the DMOSI_HEAP_STATS_MODULES table (only if it is non-empty).
+ *
+ * @param entries Array to fill
+ * @param max_entries Capacity of @p entries
+ * @return size_t Number of entries filled
+ */
+size_t dmosi_heap_get_module_stats(dmosi_heap_module_stats_t* entries, size_t max_entries)
+{
+    if (entries == NULL || !DMOSI_HEAP_STATS) {
+        return 0;
+    }
+
+    size_t count = 0;
+
+    taskENTER_CRITICAL();
+    for (size_t i = 0; i < g_module_count && count < max_entries; i++) {
+        entries[count++] = g_modules[i];
+    }
+
+    const dmosi_heap_module_stats_t* other = &g_modules[DMOSI_HEAP_STATS_OTHER];
+    if (count < max_entries && (other->stats.allocations > 0 || other->stats.failures > 0)) {
+        entries[count++] = *other;
+    }
+    taskEXIT_CRITICAL();
+
+    return count;
+}
@@ -0,0 +1,210 @@
+#include <stdlib.h>
+#include <stdbool.h>
+#include <errno.h>
+#include "dmosi.h"
+#include "dmosi_freertos.h"
+#include "dmosi_ticks.h"
+#include "FreeRTOS.h"
+#include "message_buffer.h"
+
+/**
+ * @brief Internal structure to wrap FreeRTOS message buffer handle
+ *
+ * The control block is embedded and the message storage follows the
+ * structure, so a message buffer needs a single allocation.
+ */
+struct dmosi_message_buffer {
+    MessageBufferHandle_t handle;       /**< FreeRTOS message buffer handle */
+    StaticMessageBuffer_t buffer;       /**< Embedded FreeRTOS control block */
+    size_t size;                        /**< Capacity in bytes, length headers included */
+};
+
+/**
+ * @brief Convert a dmosi timeout to ticks for a message buffer operation
+ *
+ * @param timeout_ms Timeout in milliseconds (0 = no wait, -1 = wait forever)
+ * @param ticks Set to the timeout in ticks
+ * @return int 0 on success, -ENOTSUP if blocking is requested before the scheduler started
+ */
+static int message_buffer_timeout_to_ticks(int32_t timeout_ms, TickType_t* ticks)
+{
+    if (timeout_ms == 0) {
+        // No wait
+        *ticks = 0;
+        return 0;
+    }
+
+    if (!dmosi_is_started()) {
+        return -ENOTSUP;
+    }
+
+    *ticks = dmosi_ticks_from_timeout(timeout_ms);
+
+    return 0;
+}
+
+//==============================================================================
+//                              MESSAGE BUFFER API Implementation
+//==============================================================================
+
+/**
+ * @brief Create a message buffer
+ *
+ * Every stored message also occupies sizeof(configMESSAGE_BUFFER_LENGTH_TYPE)
+ * bytes for its length header, which must be accounted for in @p size.
+ *
+ * @param size Capacity of the message buffer in bytes
+ * @return dmosi_message_buffer_t Created message buffer handle, NULL on failure
+ */
+dmosi_message_buffer_t dmosi_message_buffer_create(size_t size)
+{
+    if (size <= sizeof(configMESSAGE_BUFFER_LENGTH_TYPE)) {
+        DMOD_LOG_ERROR("Invalid message buffer size: %zu\n", size);
+        return NULL;
+    }
+
+    // Older kernels need one spare byte beyond the requested size
+    struct dmosi_message_buffer* mb = pvPortMalloc(sizeof(*mb) + size + 1);
+    if (mb == NULL) {
+        DMOD_LOG_ERROR("Failed to allocate memory for message buffer\n");
+        return NULL;
+    }
+
+    mb->size = size;
+    mb->handle = xMessageBufferCreateStatic(size, (uint8_t*)(mb + 1), &mb->buffer);
+    if (mb->handle == NULL) {
+        DMOD_LOG_ERROR("Failed to create FreeRTOS message buffer\n");
+        vPortFree(mb);
+        return NULL;
+    }
+
+    return mb;
+}
+
+/**
+ * @brief Destroy a message buffer
+ *
+ * @param mb Message buffer handle to destroy
+ */
+void dmosi_message_buffer_destroy(dmosi_message_buffer_t mb)
+{
+    if (mb == NULL) {
+        return;
+    }
+
+    if (mb->handle != NULL) {
+        vMessageBufferDelete(mb->handle);
+    }
+
+    vPortFree(mb);
+}
+
+/**
+ * @brief Send a message to a message buffer
+ *
+ * The message is stored as a whole or not at all. Blocks until there is
+ * room for it or the timeout expires. Safe to call from both task and
+ * interrupt context; from an interrupt it never blocks.
+ *
+ * @param mb Message buffer handle
+ * @param message Message to send
+ * @param len Length of the message in bytes
+ * @param timeout_ms Timeout in milliseconds (0 = no wait, -1 = wait forever)
+ * @return int 0 on success, -EMSGSIZE if the message can never fit, negative error code on failure
+ */
+int dmosi_message_buffer_send(dmosi_message_buffer_t mb, const void* message, size_t len, int32_t timeout_ms)
+{
+    if (mb == NULL || message == NULL || len == 0) {
+        DMOD_LOG_ERROR("Invalid message buffer or message (NULL)\n");
+        return -EINVAL;
+    }
+
+    if (len > mb->size - sizeof(configMESSAGE_BUFFER_LENGTH_TYPE)) {
+        return -EMSGSIZE;
+    }
+
+    if (xPortIsInsideInterrupt()) {
+        BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+        size_t sent = xMessageBufferSendFromISR(mb->handle, message, len, &xHigherPriorityTaskWoken);
+
+        portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
+
+        return (sent == len) ? 0 : -EAGAIN;  // Would block, ISR cannot wait
+    }
+
+    TickType_t ticks;
+    int result = message_buffer_timeout_to_ticks(timeout_ms, &ticks);
+    if (result != 0) {
+        return result;
+    }
+
+    if (xMessageBufferSend(mb->handle, message, len, ticks) == len) {
+        return 0;
+    } else if (ticks == 0) {
+        return -EAGAIN;  // Would block
+    } else {
+        return -ETIMEDOUT;  // Timeout occurred
+    }
+}
+
+/**
+ * @brief Receive a message from a message buffer
+ *
+ * Blocks until a message is available or the timeout expires. A message
+ * larger than @p buffer_size is left in the message buffer. Safe to call
+ * from both task and interrupt context; from an interrupt it never blocks.
+ *
+ * @param mb Message buffer handle
+ * @param buffer Buffer for the message
+ * @param buffer_size Size of @p buffer in bytes
+ * @param len Set to the length of the received message (can be NULL)
+ * @param timeout_ms Timeout in milliseconds (0 = no wait, -1 = wait forever)
+ * @return int 0 on success, -EMSGSIZE if the next message does not fit, negative error code on failure
+ */
+int dmosi_message_buffer_receive(dmosi_message_buffer_t mb, void* buffer, size_t buffer_size, size_t* len, int32_t timeout_ms)
+{
+    if (len != NULL) {
+        *len = 0;
+    }
+
+    if (mb == NULL || buffer == NULL || buffer_size == 0) {
+        DMOD_LOG_ERROR("Invalid message buffer or buffer (NULL)\n");
+        return -EINVAL;
+    }
+
+    // FreeRTOS returns 0 both for "empty" and "too small", so tell them apart
+    if (xMessageBufferNextLengthBytes(mb->handle) > buffer_size) {
+        return -EMSGSIZE;
+    }
+
+    size_t received;
+    TickType_t ticks = 0;
+
+    if (xPortIsInsideInterrupt()) {
+        BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+        received = xMessageBufferReceiveFromISR(mb->handle, buffer, buffer_size, &xHigherPriorityTaskWoken);
+
+        portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
+    } else {
+        int result = message_buffer_timeout_to_ticks(timeout_ms, &ticks);
+        if (result != 0) {
+            return result;
+        }
+
+        received = xMessageBufferReceive(mb->handle, buffer, buffer_size, ticks);
+    }
+
+    if (received > 0) {
+        if (len != NULL) {
+            *len = received;
+        }
+        return 0;
+    }
+
+    // A message that arrived while blocked may still be too large
+    if (xMessageBufferNextLengthBytes(mb->handle) > buffer_size) {
+        return -EMSGSIZE;
+    }
+
+    return (ticks == 0) ? -EAGAIN : -ETIMEDOUT;
+}
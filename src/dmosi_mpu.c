@@ -0,0 +1,250 @@
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <errno.h>
+#include "dmosi.h"
+#include "dmosi_freertos.h"
+#include "dmosi_mpu.h"
+#include "FreeRTOS.h"
+#include "task.h"
+
+#if DMOSI_MPU
+
+/**
+ * @brief Number of processes that can be isolated at the same time
+ *
+ * Configurable via the CMake parameter of the same name.
+ */
+#ifndef DMOSI_MPU_MAX_PROCESSES
+    #define DMOSI_MPU_MAX_PROCESSES    8
+#endif
+
+#define MPU_ACCESS_MASK    ( DMOSI_MPU_READ_ONLY | DMOSI_MPU_READ_WRITE | DMOSI_MPU_EXECUTE | DMOSI_MPU_DEVICE )
+
+/**
+ * @brief Isolation domain of one process
+ */
+struct mpu_domain {
+    dmosi_process_t process;        /**< Isolated process (NULL = free slot) */
+    size_t count;                   /**< Regions in use */
+    MemoryRegion_t regions[portNUM_CONFIGURABLE_REGIONS]; /**< Regions granted to the threads */
+};
+
+/**
+ * @brief Isolated processes, protected by a kernel critical section
+ */
+static struct mpu_domain g_mpu_domains[DMOSI_MPU_MAX_PROCESSES];
+
+/**
+ * @brief Find the domain of a process
+ *
+ * Must be called inside a critical section.
+ *
+ * @param process Process handle (NULL finds a free slot)
+ * @return struct mpu_domain* Domain, NULL if none
+ */
+static struct mpu_domain* mpu_find_locked(dmosi_process_t process)
+{
+    for (size_t i = 0; i < DMOSI_MPU_MAX_PROCESSES; i++) {
+        if (g_mpu_domains[i].process == process) {
+            return &g_mpu_domains[i];
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * @brief Translate dmosi access flags to FreeRTOS region parameters
+ *
+ * @param access DMOSI_MPU_* flags
+ * @return uint32_t tskMPU_REGION_* parameters
+ */
+static uint32_t mpu_region_parameters(uint32_t access)
+{
+    uint32_t parameters = (access & DMOSI_MPU_READ_WRITE) ? tskMPU_REGION_READ_WRITE : tskMPU_REGION_READ_ONLY;
+
+    if ((access & DMOSI_MPU_EXECUTE) == 0) {
+        parameters |= tskMPU_REGION_EXECUTE_NEVER;
+    }
+    parameters |= (access & DMOSI_MPU_DEVICE) ? tskMPU_REGION_DEVICE_MEMORY : tskMPU_REGION_NORMAL_MEMORY;
+
+    return parameters;
+}
+
+/**
+ * @brief Get the MPU regions of an isolated process
+ *
+ * @param process Process handle
+ * @param regions Filled with the regions of @p process
+ * @return true if @p process is isolated
+ */
+bool dmosi_mpu_get_regions(dmosi_process_t process, MemoryRegion_t* regions)
+{
+    if (process == NULL) {
+        return false;
+    }
+
+    taskENTER_CRITICAL();
+    struct mpu_domain* domain = mpu_find_locked(process);
+    if (domain != NULL) {
+        memcpy(regions, domain->regions, sizeof(domain->regions));
+    }
+    taskEXIT_CRITICAL();
+
+    return domain != NULL;
+}
+
+#endif /* DMOSI_MPU */
+
+//==============================================================================
+//                              MEMORY PROTECTION API Implementation
+//==============================================================================
+
+/**
+ * @brief Isolate a process
+ *
+ * @param process Process to isolate
+ * @return int 0 on success, negative error code on failure
+ */
+int dmosi_mpu_isolate(dmosi_process_t process)
+{
+    if (process == NULL) {
+        return -EINVAL;
+    }
+
+#if !DMOSI_MPU
+    return -ENOTSUP;
+#else
+    int result = 0;
+
+    taskENTER_CRITICAL();
+    if (mpu_find_locked(process) == NULL) {
+        struct mpu_domain* domain = mpu_find_locked(NULL);
+        if (domain != NULL) {
+            memset(domain, 0, sizeof(*domain));
+            domain->process = process;
+        } else {
+            result = -ENOSPC;
+        }
+    }
+    taskEXIT_CRITICAL();
+
+    if (result != 0) {
+        DMOD_LOG_ERROR("Cannot isolate more than %d processes\n", DMOSI_MPU_MAX_PROCESSES);
+    }
+
+    return result;
+#endif
+}
+
+/**
+ * @brief Grant the threads of an isolated process access to a memory region
+ *
+ * @param process Isolated process
+ * @param base Start of the region
+ * @param size Size of the region in bytes
+ * @param access DMOSI_MPU_* access flags
+ * @return int 0 on success, negative error code on failure
+ */
+int dmosi_mpu_add_region(dmosi_process_t process, void* base, size_t size, uint32_t access)
+{
+    if (process == NULL || base == NULL || size == 0) {
+        return -EINVAL;
+    }
+
+#if !DMOSI_MPU
+    (void)access;
+    return -ENOTSUP;
+#else
+    // Exactly one of the two access levels, nothing else
+    bool read_only = (access & DMOSI_MPU_READ_ONLY) != 0;
+    bool read_write = (access & DMOSI_MPU_READ_WRITE) != 0;
+    if ((access & ~MPU_ACCESS_MASK) != 0 || read_only == read_write) {
+        DMOD_LOG_ERROR("Invalid MPU region access flags (0x%lx)\n", (unsigned long)access);
+        return -EINVAL;
+    }
+
+    if (((uintptr_t)base % DMOSI_MPU_REGION_ALIGNMENT) != 0 || (size % DMOSI_MPU_REGION_ALIGNMENT) != 0 ||
+        size > UINT32_MAX || (uintptr_t)base > UINTPTR_MAX - size) {
+        DMOD_LOG_ERROR("MPU region %p (%lu bytes) is not aligned to %u bytes\n",
+                       base, (unsigned long)size, DMOSI_MPU_REGION_ALIGNMENT);
+        return -EINVAL;
+    }
+
+    MemoryRegion_t regions[portNUM_CONFIGURABLE_REGIONS];
+    int result = 0;
+
+    taskENTER_CRITICAL();
+    struct mpu_domain* domain = mpu_find_locked(process);
+    if (domain == NULL) {
+        result = -ESRCH;
+    } else if (domain->count >= portNUM_CONFIGURABLE_REGIONS) {
+        result = -ENOSPC;
+    } else {
+        MemoryRegion_t* region = &domain->regions[domain->count++];
+        region->pvBaseAddress = base;
+        region->ulLengthInBytes = (uint32_t)size;
+        region->ulParameters = mpu_region_parameters(access);
+        memcpy(regions, domain->regions, sizeof(regions));
+    }
+    taskEXIT_CRITICAL();
+
+    if (result == 0) {
+        dmosi_thread_mpu_update(process, regions);
+    }
+
+    return result;
+#endif
+}
+
+/**
+ * @brief End the isolation of a process
+ *
+ * @param process Isolated process
+ * @return int 0 on success, negative error code on failure
+ */
+int dmosi_mpu_release(dmosi_process_t process)
+{
+    if (process == NULL) {
+        return -ESRCH;
+    }
+
+#if !DMOSI_MPU
+    return -ENOTSUP;
+#else
+    taskENTER_CRITICAL();
+    struct mpu_domain* domain = mpu_find_locked(process);
+    if (domain != NULL) {
+        domain->process = NULL;
+    }
+    taskEXIT_CRITICAL();
+
+    return (domain != NULL) ? 0 : -ESRCH;
+#endif
+}
+
+/**
+ * @brief Check whether a process is isolated
+ *
+ * @param process Process to check
+ * @return true if threads created for @p process run as restricted tasks
+ */
+bool dmosi_mpu_is_isolated(dmosi_process_t process)
+{
+#if !DMOSI_MPU
+    (void)process;
+    return false;
+#else
+    if (process == NULL) {
+        return false;
+    }
+
+    taskENTER_CRITICAL();
+    bool isolated = (mpu_find_locked(process) != NULL);
+    taskEXIT_CRITICAL();
+
+    return isolated;
+#endif
+}
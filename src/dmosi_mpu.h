@@ -0,0 +1,83 @@
+#ifndef DMOSI_MPU_H
+#define DMOSI_MPU_H
+
+#include <stdbool.h>
+#include "dmosi.h"
+#include "dmosi_freertos.h"
+#include "FreeRTOS.h"
+#include "task.h"
+
+#if DMOSI_MPU
+
+/**
+ * @brief Raise the privilege of the calling thread
+ *
+ * Interrupt handlers are always privileged, and an SVC from a handler would
+ * escalate to a HardFault, so only unprivileged thread mode is raised.
+ *
+ * @return BaseType_t pdTRUE if the privilege was raised and must be reset
+ */
+static inline BaseType_t dmosi_mpu_raise(void)
+{
+    if (xPortIsInsideInterrupt() || portIS_PRIVILEGED() != pdFALSE) {
+        return pdFALSE;
+    }
+
+    portRAISE_PRIVILEGE();
+    portMEMORY_BARRIER();
+    return pdTRUE;
+}
+
+/**
+ * @brief Drop the privilege raised by dmosi_mpu_raise() again
+ *
+ * @param raised Result of dmosi_mpu_raise()
+ */
+static inline void dmosi_mpu_restore(BaseType_t* raised)
+{
+    if (*raised != pdFALSE) {
+        portMEMORY_BARRIER();
+        portRESET_PRIVILEGE();
+        portMEMORY_BARRIER();
+    }
+}
+
+/**
+ * @brief Run the rest of the enclosing function privileged
+ *
+ * Placed at the top of every dmosi API entry point: the backend state the
+ * call touches lies outside the regions of an isolated caller. The
+ * privilege is reset on every return path.
+ */
+#define DMOSI_MPU_PRIVILEGED_SCOPE() \
+    BaseType_t dmosi_mpu_raised __attribute__((cleanup(dmosi_mpu_restore))) = dmosi_mpu_raise()
+
+/**
+ * @brief Get the MPU regions of an isolated process
+ *
+ * Implemented by the memory protection module.
+ *
+ * @param process Process handle
+ * @param regions Filled with the regions of @p process; unused entries are
+ *                zeroed (portNUM_CONFIGURABLE_REGIONS entries)
+ * @return true if @p process is isolated
+ */
+bool dmosi_mpu_get_regions(dmosi_process_t process, MemoryRegion_t* regions);
+
+/**
+ * @brief Apply new MPU regions to the running threads of a process
+ *
+ * Implemented by the thread module.
+ *
+ * @param process Isolated process
+ * @param regions Regions of @p process (portNUM_CONFIGURABLE_REGIONS entries)
+ */
+void dmosi_thread_mpu_update(dmosi_process_t process, const MemoryRegion_t* regions);
+
+#else
+
+#define DMOSI_MPU_PRIVILEGED_SCOPE()    ((void)0)
+
+#endif /* DMOSI_MPU */
+
+#endif /* DMOSI_MPU_H */
@@ -1,22 +1,526 @@
 #include <stdlib.h>
 #include <stdbool.h>
+#include <stdatomic.h>
 #include <errno.h>
 #include "dmosi.h"
+#include "dmosi_pool.h"
+#include "dmosi_freertos.h"
+#include "dmosi_notify.h"
+#include "dmosi_object_stats.h"
+#include "dmosi_ticks.h"
+#include "dmosi_mpu.h"
 #include "FreeRTOS.h"
+#include "task.h"
 #include "semphr.h"
 
 /**
- * @brief Internal structure to wrap FreeRTOS mutex handle
- * 
- * This structure wraps the FreeRTOS SemaphoreHandle_t and stores
- * whether the mutex is recursive, allowing us to use the correct
- * FreeRTOS API functions for lock/unlock operations.
+ * @brief Number of fast-path retries before a contended lock blocks
+ *
+ * Configurable via the CMake parameter of the same name. Spinning only pays
+ * off when the owner is running on another core, so it is ignored on
+ * single-core builds.
+ */
+#ifndef DMOSI_MUTEX_SPIN_COUNT
+    #define DMOSI_MUTEX_SPIN_COUNT    0
+#endif
+
+/**
+ * @brief Internal mutex structure
+ *
+ * The lock itself is the atomic @ref owner word: an uncontended lock or
+ * unlock is a single compare-and-swap without any kernel call.
+ *
+ * Contenders queue on the embedded FreeRTOS mutex, so they block with the
+ * kernel's priority inheritance among themselves. The contender holding the
+ * kernel mutex waits for the owner word to be released on a task
+ * notification. The kernel's inheritance only reaches the holder of the
+ * kernel mutex, which is not the owner of a word taken on the fast path, so
+ * every contender lends the owner its priority itself (xTaskPriorityInherit())
+ * before it blocks, and sets MUTEX_CONTENDED in the word so the owner takes
+ * the slow unlock path. Only the effective priority is raised, so base
+ * priority changes of the owner and priority ceilings are unaffected.
+ *
+ * The kernel drops an inherited priority together with the last mutex it
+ * counts as held, and it does not count owner words. Mutexes with a lent
+ * priority are therefore kept on g_mutex_lent, and the priority is given
+ * back only when the owner releases the last of them. While the owner holds
+ * a kernel mutex as well, one held count is pinned on its behalf so the
+ * kernel does not drop the priority early when that mutex is given.
+ *
+ * Whoever acquires the word through the kernel mutex keeps holding it until
+ * unlock, and the fast path stays disabled while anybody waits.
  */
 struct dmosi_mutex {
-    SemaphoreHandle_t handle;  /**< FreeRTOS semaphore handle */
-    bool recursive;            /**< Whether the mutex is recursive */
+    SemaphoreHandle_t handle;       /**< FreeRTOS mutex contenders queue on */
+    StaticSemaphore_t buffer;       /**< Embedded FreeRTOS control block */
+    atomic_uintptr_t owner;         /**< Owning task and MUTEX_CONTENDED (0 = unlocked) */
+    uint32_t depth;                 /**< Recursion depth (owner-only) */
+    atomic_uint waiters;            /**< Tasks in the slow path */
+    TaskHandle_t word_waiter;       /**< Kernel-mutex holder waiting for @ref owner */
+    bool kernel_held;               /**< Whether the owner also holds @ref handle */
+    bool lent;                      /**< Whether the mutex is on g_mutex_lent */
+    bool pinned;                    /**< Whether it carries the owner's pinned held count */
+    struct dmosi_mutex* lent_next;  /**< Next mutex on g_mutex_lent */
+    uint32_t locks;                 /**< Successful first-level acquisitions (owner-updated) */
+    uint32_t contended;             /**< Acquisitions that had to wait (owner-updated) */
+    atomic_uint timeouts;           /**< Lock attempts that gave up */
+    uint64_t wait_us_total;         /**< Microseconds spent waiting by contended acquisitions */
+    uint32_t wait_us_max;           /**< Longest wait of a single acquisition in microseconds */
+    UBaseType_t ceiling;            /**< Priority ceiling (MUTEX_NO_CEILING if none) */
+    UBaseType_t ceiling_saved;      /**< Owner's base priority before the ceiling raise */
+    bool ceiling_raised;            /**< Whether the owner was raised to @ref ceiling */
+    bool recursive;                 /**< Whether the mutex is recursive */
+    bool is_static;                 /**< Whether the wrapper lives in caller-provided storage */
+#if DMOSI_OBJECT_STATS
+    dmosi_object_record_t stats;    /**< Registry entry and high watermark of @ref waiters */
+#endif
 };
 
+/**
+ * @brief Owner word bit telling the owner to take the slow unlock path
+ *
+ * Set by contenders waiting for the word or lending the owner their
+ * priority. Task handles point to word-aligned control blocks, so the bit
+ * is never part of a handle.
+ */
+#define MUTEX_CONTENDED    ((uintptr_t)1)
+
+/**
+ * @brief Value of dmosi_mutex::ceiling for mutexes without a priority ceiling
+ */
+#define MUTEX_NO_CEILING    ((UBaseType_t)-1)
+
+_Static_assert(sizeof(struct dmosi_mutex) <= sizeof(dmosi_mutex_storage_t),
+               "dmosi_mutex_storage_t is too small for struct dmosi_mutex");
+_Static_assert(_Alignof(struct dmosi_mutex) <= _Alignof(dmosi_mutex_storage_t),
+               "dmosi_mutex_storage_t is under-aligned for struct dmosi_mutex");
+
+/**
+ * @brief Pool serving struct dmosi_mutex wrappers (see DMOSI_MUTEX_POOL_SIZE)
+ */
+DMOSI_POOL_DEFINE(g_dmosi_mutex_pool, struct dmosi_mutex, DMOSI_MUTEX_POOL_SIZE);
+
+/**
+ * @brief Mutexes whose owner runs with a priority lent by a contender
+ *
+ * Linked through dmosi_mutex::lent_next and protected by a kernel critical
+ * section. Only contended mutexes are on it, so it stays short.
+ */
+static struct dmosi_mutex* g_mutex_lent = NULL;
+
+/**
+ * @brief Whether the scheduler has been seen running
+ *
+ * Cached so the fast path does not have to ask the kernel: once started,
+ * the scheduler only stops for good with vTaskEndScheduler().
+ */
+static volatile bool g_mutex_started = false;
+
+#if configNUMBER_OF_CORES == 1 && !DMOSI_MPU
+/**
+ * @brief Task running on the (only) core, maintained by the kernel
+ */
+extern struct tskTaskControlBlock* volatile pxCurrentTCB;
+#endif
+
+/**
+ * @brief Initialize a mutex wrapper and create its kernel object in place
+ *
+ * The kernel mutex is never recursive: recursion is tracked in the wrapper.
+ *
+ * @param mutex Wrapper to initialize
+ * @param recursive Whether the mutex should be recursive
+ * @param is_static Whether the wrapper lives in caller-provided storage
+ * @return true on success, false if the kernel object could not be created
+ */
+static bool mutex_init(struct dmosi_mutex* mutex, bool recursive, bool is_static)
+{
+    mutex->handle = xSemaphoreCreateMutexStatic(&mutex->buffer);
+    atomic_init(&mutex->owner, 0);
+    mutex->depth = 0;
+    atomic_init(&mutex->waiters, 0);
+    mutex->word_waiter = NULL;
+    mutex->kernel_held = false;
+    mutex->lent = false;
+    mutex->pinned = false;
+    mutex->lent_next = NULL;
+    mutex->locks = 0;
+    mutex->contended = 0;
+    atomic_init(&mutex->timeouts, 0);
+    mutex->wait_us_total = 0;
+    mutex->wait_us_max = 0;
+    mutex->ceiling = MUTEX_NO_CEILING;
+    mutex->ceiling_saved = 0;
+    mutex->ceiling_raised = false;
+    mutex->recursive = recursive;
+    mutex->is_static = is_static;
+#if DMOSI_OBJECT_STATS
+    if (mutex->handle != NULL) {
+        dmosi_object_register(&mutex->stats, mutex, DMOSI_OBJECT_TYPE_MUTEX);
+    }
+#endif
+    return mutex->handle != NULL;
+}
+
+/**
+ * @brief Check whether the scheduler has been started
+ *
+ * @return true once the scheduler runs; until then there is nothing to lock
+ */
+static inline bool mutex_started(void)
+{
+    if (!g_mutex_started && xTaskGetSchedulerState() != taskSCHEDULER_NOT_STARTED) {
+        g_mutex_started = true;
+    }
+    return g_mutex_started;
+}
+
+/**
+ * @brief Get the calling task
+ *
+ * Reads the kernel's record of the running task directly where that is
+ * allowed, so the fast path makes no kernel call: on a single core it only
+ * changes while the caller is switched out.
+ *
+ * @return TaskHandle_t Calling task
+ */
+static inline TaskHandle_t mutex_self(void)
+{
+#if configNUMBER_OF_CORES == 1 && !DMOSI_MPU
+    return (TaskHandle_t)pxCurrentTCB;
+#else
+    return xTaskGetCurrentTaskHandle();
+#endif
+}
+
+/**
+ * @brief Get the owner task of a mutex
+ *
+ * @param mutex Mutex to query
+ * @return TaskHandle_t Owning task, NULL if unlocked
+ */
+static inline TaskHandle_t mutex_owner(struct dmosi_mutex* mutex)
+{
+    uintptr_t word = atomic_load_explicit(&mutex->owner, memory_order_relaxed);
+    return (TaskHandle_t)(word & ~MUTEX_CONTENDED);
+}
+
+/**
+ * @brief Try to take the owner word without blocking
+ *
+ * @param mutex Mutex to lock
+ * @param self Calling task
+ * @return true if the word was taken
+ */
+static bool mutex_try_fast(struct dmosi_mutex* mutex, TaskHandle_t self)
+{
+    uintptr_t expected = 0;
+    return atomic_compare_exchange_strong(&mutex->owner, &expected, (uintptr_t)self);
+}
+
+/**
+ * @brief Complete a first-level acquisition of the owner word
+ *
+ * @param mutex Mutex that was locked
+ */
+static void mutex_taken(struct dmosi_mutex* mutex)
+{
+    mutex->depth = 1;
+    mutex->locks++;
+}
+
+/**
+ * @brief Lend the caller's priority to the owner of the word
+ *
+ * Marks the word contended, so the owner takes the slow unlock path, and
+ * puts the mutex on g_mutex_lent. Must be called inside a critical section.
+ *
+ * @param mutex Mutex the caller waits for
+ * @return true if the word is owned, false if it is free
+ */
+static bool mutex_lend_locked(struct dmosi_mutex* mutex)
+{
+    uintptr_t word = atomic_load_explicit(&mutex->owner, memory_order_seq_cst);
+    do {
+        if (word == 0) {
+            return false;
+        }
+    } while (!atomic_compare_exchange_weak(&mutex->owner, &word, word | MUTEX_CONTENDED));
+
+    if (!mutex->lent) {
+        mutex->lent = true;
+        mutex->lent_next = g_mutex_lent;
+        g_mutex_lent = mutex;
+    }
+
+    // Lasts until the owner releases its last lent mutex, even if the
+    // caller gives up first
+    (void)xTaskPriorityInherit((TaskHandle_t)(word & ~MUTEX_CONTENDED));
+    return true;
+}
+
+/**
+ * @brief Take a mutex off g_mutex_lent
+ *
+ * Must be called inside a critical section.
+ *
+ * @param mutex Mutex to unlink
+ * @return true if it carried the pinned held count of its owner
+ */
+static bool mutex_unlink_locked(struct dmosi_mutex* mutex)
+{
+    if (!mutex->lent) {
+        return false;
+    }
+
+    for (struct dmosi_mutex** link = &g_mutex_lent; *link != NULL; link = &(*link)->lent_next) {
+        if (*link == mutex) {
+            *link = mutex->lent_next;
+            break;
+        }
+    }
+
+    bool pinned = mutex->pinned;
+    mutex->lent = false;
+    mutex->pinned = false;
+    mutex->lent_next = NULL;
+    return pinned;
+}
+
+/**
+ * @brief Find a mutex on g_mutex_lent owned by a task
+ *
+ * Must be called inside a critical section.
+ *
+ * @param owner Owning task
+ * @return struct dmosi_mutex* Pinned mutex if there is one, otherwise any
+ *         matching mutex, NULL if none
+ */
+static struct dmosi_mutex* mutex_find_lent_locked(TaskHandle_t owner)
+{
+    struct dmosi_mutex* found = NULL;
+    for (struct dmosi_mutex* mutex = g_mutex_lent; mutex != NULL; mutex = mutex->lent_next) {
+        if (mutex_owner(mutex) == owner) {
+            if (mutex->pinned) {
+                return mutex;
+            }
+            if (found == NULL) {
+                found = mutex;
+            }
+        }
+    }
+    return found;
+}
+
+/**
+ * @brief Give back the priority lent through a released mutex
+ *
+ * The priority is kept while the caller still holds another lent mutex.
+ * Otherwise the kernel drops it, unless the caller holds a kernel mutex with
+ * inheritance of its own. Must be called inside a critical section, after
+ * the owner word was released.
+ *
+ * @param mutex Released mutex
+ * @param self Calling task, its former owner
+ */
+static void mutex_unlend_locked(struct dmosi_mutex* mutex, TaskHandle_t self)
+{
+    bool pinned = mutex_unlink_locked(mutex);
+
+    struct dmosi_mutex* other = mutex_find_lent_locked(self);
+    if (other != NULL) {
+        if (pinned) {
+            other->pinned = true;
+        }
+        return;
+    }
+
+    // The disinherit releases one held count: the pinned one, or one taken
+    // just for it
+    if (!pinned) {
+        (void)pvTaskIncrementMutexHeldCount();
+    }
+    (void)xTaskPriorityDisinherit(self);
+}
+
+/**
+ * @brief Pin a held count for the lent mutexes of the caller
+ *
+ * Called before a kernel mutex is given, which would drop the lent priority
+ * together with the last held count. Must be called inside a critical
+ * section.
+ *
+ * @param self Calling task
+ */
+static void mutex_pin_locked(TaskHandle_t self)
+{
+    struct dmosi_mutex* mutex = mutex_find_lent_locked(self);
+    if (mutex != NULL && !mutex->pinned) {
+        (void)pvTaskIncrementMutexHeldCount();
+        mutex->pinned = true;
+    }
+}
+
+/**
+ * @brief Acquire a mutex, blocking for at most @p ticks
+ *
+ * @param mutex Mutex to lock
+ * @param ticks Timeout in ticks (0 = no wait, portMAX_DELAY = wait forever)
+ * @return int 0 on success, -EDEADLK if a non-recursive mutex is already held
+ *         by the caller, -EAGAIN or -ETIMEDOUT if it could not be acquired
+ */
+static int mutex_acquire(struct dmosi_mutex* mutex, TickType_t ticks)
+{
+    if (!mutex_started()) {
+        return 0; // there is nothing to lock if the RTOS has not started
+    }
+
+    TaskHandle_t self = mutex_self();
+
+    // Fast path: uncontended lock is a single CAS
+    if (atomic_load_explicit(&mutex->waiters, memory_order_relaxed) == 0 && mutex_try_fast(mutex, self)) {
+        mutex_taken(mutex);
+        return 0;
+    }
+
+    if (mutex_owner(mutex) == self) {
+        if (!mutex->recursive) {
+            return -EDEADLK;
+        }
+        mutex->depth++;
+        return 0;
+    }
+
+#if configNUMBER_OF_CORES > 1 && DMOSI_MUTEX_SPIN_COUNT > 0
+    // The owner may be running on another core and about to release
+    for (uint32_t i = 0; i < DMOSI_MUTEX_SPIN_COUNT; i++) {
+        if (atomic_load_explicit(&mutex->owner, memory_order_relaxed) == 0 &&
+            atomic_load_explicit(&mutex->waiters, memory_order_relaxed) == 0 &&
+            mutex_try_fast(mutex, self)) {
+            mutex_taken(mutex);
+            return 0;
+        }
+    }
+#endif
+
+    // Blocking is not possible while the scheduler is suspended
+    if (ticks == 0 || xTaskGetSchedulerState() != taskSCHEDULER_RUNNING) {
+        atomic_fetch_add_explicit(&mutex->timeouts, 1, memory_order_relaxed);
+        return -EAGAIN;  // Would block
+    }
+
+    uint64_t wait_start = dmosi_get_time_us();
+    TimeOut_t timeout;
+    vTaskSetTimeOutState(&timeout);
+
+    unsigned int waiting = atomic_fetch_add_explicit(&mutex->waiters, 1, memory_order_seq_cst) + 1;
+#if DMOSI_OBJECT_STATS
+    dmosi_object_account_level(&mutex->stats, waiting);
+#else
+    (void)waiting;
+#endif
+
+    // The kernel passes the priority of a contender blocked below on to
+    // the holder of the kernel mutex only, so the owner gets it here
+    taskENTER_CRITICAL();
+    (void)mutex_lend_locked(mutex);
+    taskEXIT_CRITICAL();
+
+    // Queue behind other contenders with kernel priority inheritance
+    if (xSemaphoreTake(mutex->handle, ticks) != pdTRUE) {
+        atomic_fetch_sub_explicit(&mutex->waiters, 1, memory_order_seq_cst);
+        atomic_fetch_add_explicit(&mutex->timeouts, 1, memory_order_relaxed);
+        return -ETIMEDOUT;
+    }
+    (void)xTaskCheckForTimeOut(&timeout, &ticks);
+
+    // Wait for the (fast-path) owner to release the word
+    for (;;) {
+        bool acquired;
+        bool owned = true;
+
+        taskENTER_CRITICAL();
+        acquired = mutex_try_fast(mutex, self);
+        if (acquired) {
+            mutex->word_waiter = NULL;
+        } else {
+            mutex->word_waiter = self;
+            owned = mutex_lend_locked(mutex);
+        }
+        taskEXIT_CRITICAL();
+
+        if (acquired) {
+            break;
+        }
+        if (!owned) {
+            continue; // released on another core in between
+        }
+
+        if (xTaskCheckForTimeOut(&timeout, &ticks) == pdTRUE) {
+            taskENTER_CRITICAL();
+            mutex->word_waiter = NULL;
+            atomic_fetch_sub_explicit(&mutex->waiters, 1, memory_order_seq_cst);
+            taskEXIT_CRITICAL();
+            xSemaphoreGive(mutex->handle);
+            atomic_fetch_add_explicit(&mutex->timeouts, 1, memory_order_relaxed);
+            return -ETIMEDOUT;
+        }
+
+        ulTaskNotifyTakeIndexed(DMOSI_NOTIFY_INDEX_WAIT, pdTRUE, ticks);
+    }
+
+    atomic_fetch_sub_explicit(&mutex->waiters, 1, memory_order_seq_cst);
+    mutex->kernel_held = true;
+    mutex_taken(mutex);
+
+    // Now the owner, so the counters can be updated without further locking
+    uint64_t waited = dmosi_get_time_us() - wait_start;
+    mutex->contended++;
+    mutex->wait_us_total += waited;
+    if (waited > mutex->wait_us_max) {
+        mutex->wait_us_max = (waited < UINT32_MAX) ? (uint32_t)waited : UINT32_MAX;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Acquire a mutex and apply its priority ceiling
+ *
+ * On the first-level acquisition of a mutex with a ceiling the owner is
+ * raised to the ceiling right away (immediate ceiling protocol), so no task
+ * that may lock the mutex can preempt it while it is held.
+ *
+ * @param mutex Mutex to lock
+ * @param ticks Timeout in ticks (0 = no wait, portMAX_DELAY = wait forever)
+ * @return int 0 on success, -EINVAL if the caller's priority is above the
+ *         ceiling, otherwise as mutex_acquire()
+ */
+static int mutex_take(struct dmosi_mutex* mutex, TickType_t ticks)
+{
+    UBaseType_t ceiling = mutex->ceiling;
+
+    if (ceiling == MUTEX_NO_CEILING || !mutex_started()) {
+        return mutex_acquire(mutex, ticks);
+    }
+
+    UBaseType_t base = uxTaskBasePriorityGet(NULL);
+    if (base > ceiling) {
+        return -EINVAL;
+    }
+
+    int result = mutex_acquire(mutex, ticks);
+    if (result == 0 && mutex->depth == 1) {
+        mutex->ceiling_saved = base;
+        mutex->ceiling_raised = (base < ceiling);
+        if (mutex->ceiling_raised) {
+            vTaskPrioritySet(NULL, ceiling);
+        }
+    }
+
+    return result;
+}
+
 //==============================================================================
 //                              MUTEX API Implementation
 //==============================================================================
@@ -25,47 +529,80 @@ struct dmosi_mutex {
  * @brief Create a mutex
  * 
  * Creates either a regular mutex or a recursive mutex based on the
- * recursive parameter using FreeRTOS API.
+ * recursive parameter.
  * 
  * @param recursive Whether the mutex should be recursive
  * @return dmosi_mutex_t Created mutex handle, NULL on failure
  */
 DMOD_INPUT_API_DECLARATION( dmosi, 1.0, dmosi_mutex_t, _mutex_create, (bool recursive) )
 {
-    struct dmosi_mutex* mutex = (struct dmosi_mutex*)pvPortMalloc(sizeof(*mutex));
+    DMOSI_MPU_PRIVILEGED_SCOPE();
+
+    struct dmosi_mutex* mutex = (struct dmosi_mutex*)dmosi_pool_alloc(&g_dmosi_mutex_pool);
     if (mutex == NULL) {
         return NULL;
     }
 
-    if (recursive) {
-        mutex->handle = xSemaphoreCreateRecursiveMutex();
-    } else {
-        mutex->handle = xSemaphoreCreateMutex();
+    if (!mutex_init(mutex, recursive, false)) {
+        dmosi_pool_free(&g_dmosi_mutex_pool, mutex);
+        return NULL;
+    }
+
+    return (dmosi_mutex_t)mutex;
+}
+
+/**
+ * @brief Create a mutex in caller-provided storage
+ *
+ * Works like dmosi_mutex_create() but uses @p storage for both the wrapper
+ * and the FreeRTOS control block, so no memory is allocated. The storage
+ * must stay valid until dmosi_mutex_destroy() is called.
+ *
+ * @param storage Storage for the mutex
+ * @param recursive Whether the mutex should be recursive
+ * @return dmosi_mutex_t Created mutex handle, NULL on failure
+ */
+dmosi_mutex_t dmosi_mutex_create_static(dmosi_mutex_storage_t* storage, bool recursive)
+{
+    if (storage == NULL) {
+        return NULL;
     }
 
-    if (mutex->handle == NULL) {
-        vPortFree(mutex);
+    struct dmosi_mutex* mutex = (struct dmosi_mutex*)storage;
+    if (!mutex_init(mutex, recursive, true)) {
         return NULL;
     }
 
-    mutex->recursive = recursive;
     return (dmosi_mutex_t)mutex;
 }
 
 /**
  * @brief Destroy a mutex
  * 
- * Destroys a mutex and frees associated resources.
+ * Destroys a mutex and frees associated resources. For a mutex created
+ * with dmosi_mutex_create_static() the caller-provided storage is released
+ * back to the caller and may be reused once this returns.
  * 
  * @param mutex Mutex handle to destroy
  */
 DMOD_INPUT_API_DECLARATION( dmosi, 1.0, void, _mutex_destroy, (dmosi_mutex_t mutex) )
 {
+    DMOSI_MPU_PRIVILEGED_SCOPE();
+
     if (mutex == NULL) {
         return;
     }
 
     struct dmosi_mutex* mtx = (struct dmosi_mutex*)mutex;
+
+#if DMOSI_OBJECT_STATS
+    dmosi_object_unregister(&mtx->stats);
+#endif
+
+    // A contender that gave up may have left the mutex lent
+    taskENTER_CRITICAL();
+    (void)mutex_unlink_locked(mtx);
+    taskEXIT_CRITICAL();
     
     // Defensive check: handle should never be NULL for a valid mutex,
     // but check anyway to prevent undefined behavior
@@ -73,67 +610,198 @@ DMOD_INPUT_API_DECLARATION( dmosi, 1.0, void, _mutex_destroy, (dmosi_mutex_t mut
         vSemaphoreDelete(mtx->handle);
     }
     
-    vPortFree(mtx);
+    if (!mtx->is_static) {
+        dmosi_pool_free(&g_dmosi_mutex_pool, mtx);
+    }
 }
 
 /**
  * @brief Lock a mutex
  * 
- * Locks a mutex, blocking until the mutex is available.
- * Uses the appropriate FreeRTOS API based on whether the mutex is recursive.
+ * Locks a mutex, blocking until the mutex is available. An uncontended
+ * lock takes the owner word with a single compare-and-swap.
  * 
  * @param mutex Mutex handle to lock
  * @return int 0 on success, negative error code on failure
  */
 DMOD_INPUT_API_DECLARATION( dmosi, 1.0, int, _mutex_lock, (dmosi_mutex_t mutex) )
 {
+    DMOSI_MPU_PRIVILEGED_SCOPE();
+
     if (mutex == NULL) {
         return -EINVAL;
     }
 
-    if (!dmosi_is_started()) {
-        return 0; // there is nothing to lock if the RTOS has not started
+    int result = mutex_take((struct dmosi_mutex*)mutex, portMAX_DELAY);
+    return (result == -ETIMEDOUT) ? -EIO : result;
+}
+
+/**
+ * @brief Try to lock a mutex without blocking
+ *
+ * Recursive mutexes already held by the caller are relocked.
+ *
+ * @param mutex Mutex handle to lock
+ * @return int 0 on success, -EAGAIN if the mutex is held by another thread,
+ *         negative error code on failure
+ */
+int dmosi_mutex_trylock(dmosi_mutex_t mutex)
+{
+    if (mutex == NULL) {
+        return -EINVAL;
+    }
+
+    return mutex_take((struct dmosi_mutex*)mutex, 0);
+}
+
+/**
+ * @brief Lock a mutex, waiting at most @p timeout_ms
+ *
+ * Recursive mutexes already held by the caller are relocked without waiting.
+ *
+ * @param mutex Mutex handle to lock
+ * @param timeout_ms Timeout in milliseconds (0 = no wait, -1 = wait forever)
+ * @return int 0 on success, negative error code on failure
+ */
+int dmosi_mutex_lock_timeout(dmosi_mutex_t mutex, int32_t timeout_ms)
+{
+    if (mutex == NULL) {
+        return -EINVAL;
+    }
+
+    TickType_t ticks = dmosi_ticks_from_timeout(timeout_ms);
+
+    return mutex_take((struct dmosi_mutex*)mutex, ticks);
+}
+
+/**
+ * @brief Set the priority ceiling of a mutex
+ *
+ * While a mutex with a ceiling is held its owner runs at least at the
+ * ceiling priority, which must be the highest priority of all threads that
+ * lock it. Threads above the ceiling are refused the lock. Ceilings of
+ * nested mutexes are undone correctly when they are unlocked in reverse
+ * order of locking.
+ *
+ * @param mutex Mutex handle
+ * @param ceiling Ceiling priority (0 .. configMAX_PRIORITIES - 1, -1 = none)
+ * @return int 0 on success, -EBUSY if the mutex is held, -EINVAL on invalid arguments
+ */
+int dmosi_mutex_set_ceiling(dmosi_mutex_t mutex, int ceiling)
+{
+    if (mutex == NULL || ceiling < -1 || ceiling >= (int)configMAX_PRIORITIES) {
+        return -EINVAL;
     }
 
     struct dmosi_mutex* mtx = (struct dmosi_mutex*)mutex;
-    BaseType_t result;
 
-    if (mtx->recursive) {
-        result = xSemaphoreTakeRecursive(mtx->handle, portMAX_DELAY);
-    } else {
-        result = xSemaphoreTake(mtx->handle, portMAX_DELAY);
+    if (atomic_load_explicit(&mtx->owner, memory_order_acquire) != 0) {
+        return -EBUSY;
+    }
+
+    mtx->ceiling = (ceiling < 0) ? MUTEX_NO_CEILING : (UBaseType_t)ceiling;
+
+    return 0;
+}
+
+/**
+ * @brief Get contention statistics of a mutex
+ *
+ * The counters are updated by the owner without locking, so the snapshot
+ * may be slightly inconsistent while the mutex is in use.
+ *
+ * @param mutex Mutex handle
+ * @param stats Structure to fill
+ * @return int 0 on success, -EINVAL on invalid arguments
+ */
+int dmosi_mutex_get_stats(dmosi_mutex_t mutex, dmosi_mutex_stats_t* stats)
+{
+    if (mutex == NULL || stats == NULL) {
+        return -EINVAL;
     }
 
-    return (result == pdTRUE) ? 0 : -EIO;
+    struct dmosi_mutex* mtx = (struct dmosi_mutex*)mutex;
+
+    stats->locks = mtx->locks;
+    stats->contended = mtx->contended;
+    stats->timeouts = atomic_load_explicit(&mtx->timeouts, memory_order_relaxed);
+    stats->wait_time_total_us = mtx->wait_us_total;
+    stats->wait_time_max_us = mtx->wait_us_max;
+
+    return 0;
 }
 
 /**
  * @brief Unlock a mutex
  * 
- * Unlocks a previously locked mutex.
- * Uses the appropriate FreeRTOS API based on whether the mutex is recursive.
+ * Unlocks a previously locked mutex. An unlock with nobody waiting or
+ * lending the owner a priority is a single compare-and-swap.
  * 
  * @param mutex Mutex handle to unlock
  * @return int 0 on success, negative error code on failure
  */
 DMOD_INPUT_API_DECLARATION( dmosi, 1.0, int, _mutex_unlock, (dmosi_mutex_t mutex) )
 {
+    DMOSI_MPU_PRIVILEGED_SCOPE();
+
     if (mutex == NULL) {
         return -EINVAL;
     }
 
-    if (!dmosi_is_started()) {
+    if (!mutex_started()) {
         return 0; // there is nothing to unlock if the RTOS has not started
     }
 
     struct dmosi_mutex* mtx = (struct dmosi_mutex*)mutex;
-    BaseType_t result;
+    TaskHandle_t self = mutex_self();
+
+    if (mutex_owner(mtx) != self) {
+        return -EPERM;
+    }
+
+    if (mtx->recursive && mtx->depth > 1) {
+        mtx->depth--;
+        return 0;
+    }
+
+    bool kernel_held = mtx->kernel_held;
+    bool ceiling_raised = mtx->ceiling_raised;
+    UBaseType_t ceiling = mtx->ceiling;
+    UBaseType_t ceiling_saved = mtx->ceiling_saved;
+    mtx->kernel_held = false;
+    mtx->ceiling_raised = false;
+    mtx->depth = 0;
+
+    // Fast path: fails if a contender marked the word in the meantime
+    uintptr_t expected = (uintptr_t)self;
+    if (kernel_held || !atomic_compare_exchange_strong(&mtx->owner, &expected, 0)) {
+        taskENTER_CRITICAL();
+        // Sequentially consistent so a contender registering concurrently
+        // either sees the word free or is seen through the waiter count below
+        atomic_store_explicit(&mtx->owner, 0, memory_order_seq_cst);
+        if (atomic_load_explicit(&mtx->waiters, memory_order_seq_cst) > 0) {
+            TaskHandle_t waiter = mtx->word_waiter;
+            mtx->word_waiter = NULL;
+            if (waiter != NULL) {
+                xTaskNotifyGiveIndexed(waiter, DMOSI_NOTIFY_INDEX_WAIT);
+            }
+        }
+        mutex_unlend_locked(mtx, self);
+        if (kernel_held) {
+            mutex_pin_locked(self);
+        }
+        taskEXIT_CRITICAL();
+
+        if (kernel_held) {
+            xSemaphoreGive(mtx->handle);
+        }
+    }
 
-    if (mtx->recursive) {
-        result = xSemaphoreGiveRecursive(mtx->handle);
-    } else {
-        result = xSemaphoreGive(mtx->handle);
+    // Drop the ceiling only once the mutex is free, so nothing can preempt
+    // the owner in between. A priority set by the owner meanwhile is kept.
+    if (ceiling_raised && uxTaskBasePriorityGet(NULL) == ceiling) {
+        vTaskPrioritySet(NULL, ceiling_saved);
     }
 
-    return (result == pdTRUE) ? 0 : -EPERM;
+    return 0;
 }
@@ -0,0 +1,23 @@
+#ifndef DMOSI_NOTIFY_H
+#define DMOSI_NOTIFY_H
+
+#include "FreeRTOS.h"
+
+/**
+ * @brief Task notification indexes used by the dmosi backend
+ *
+ * Index 0 is the FreeRTOS default and is shared by thread join, the timer
+ * delete fence and any application code using the non-indexed notification
+ * API. The dmosi wait engines and events use their own indexes so a stray
+ * notification from one never satisfies (or is swallowed by) a wait of
+ * another, and signalling an event does not wake a task blocked elsewhere.
+ * Every user loops on its own predicate, so spurious wake-ups are harmless.
+ */
+#define DMOSI_NOTIFY_INDEX_DEFAULT    0   /**< Thread join, timer delete fence, deferred-work daemon */
+#define DMOSI_NOTIFY_INDEX_WAIT       1   /**< Semaphore, stream and ring wait engines */
+#define DMOSI_NOTIFY_INDEX_EVENT      2   /**< Events bound to a waiter thread */
+
+_Static_assert(configTASK_NOTIFICATION_ARRAY_ENTRIES > DMOSI_NOTIFY_INDEX_EVENT,
+               "configTASK_NOTIFICATION_ARRAY_ENTRIES is too small for dmosi");
+
+#endif /* DMOSI_NOTIFY_H */
@@ -0,0 +1,248 @@
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <errno.h>
+#include "dmosi.h"
+#include "dmosi_freertos.h"
+#include "dmosi_object_stats.h"
+#include "FreeRTOS.h"
+#include "task.h"
+
+#if DMOSI_OBJECT_STATS
+
+/**
+ * @brief Registry of live mutexes, semaphores and queues
+ *
+ * Protected by a kernel critical section; objects are only added and
+ * removed on create and destroy.
+ */
+static dmosi_object_record_t* g_objects = NULL;
+
+/**
+ * @brief Find the statistics block of an object
+ *
+ * Must be called inside a critical section.
+ *
+ * @param object Object handle
+ * @return dmosi_object_record_t* Statistics block, NULL if not a live object
+ */
+static dmosi_object_record_t* object_find_locked(const void* object)
+{
+    for (dmosi_object_record_t* record = g_objects; record != NULL; record = record->next) {
+        if (record->object == object) {
+            return record;
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * @brief Take a snapshot of the statistics of an object
+ *
+ * Mutexes keep their own contention counters (see dmosi_mutex_get_stats()),
+ * so only their high watermark lives in the statistics block.
+ *
+ * Must be called inside a critical section.
+ *
+ * @param record Statistics block of the object
+ * @param stats Structure to fill
+ */
+static void object_snapshot_locked(const dmosi_object_record_t* record, dmosi_object_stats_t* stats)
+{
+    if (record->type == DMOSI_OBJECT_TYPE_MUTEX) {
+        dmosi_mutex_stats_t mutex_stats;
+        (void)dmosi_mutex_get_stats((dmosi_mutex_t)record->object, &mutex_stats);
+        stats->operations = mutex_stats.locks;
+        stats->blocked = mutex_stats.contended;
+        stats->timeouts = mutex_stats.timeouts;
+        stats->wait_time_total_us = mutex_stats.wait_time_total_us;
+        stats->wait_time_max_us = mutex_stats.wait_time_max_us;
+    } else {
+        stats->operations = atomic_load_explicit(&record->operations, memory_order_relaxed);
+        stats->blocked = atomic_load_explicit(&record->blocked, memory_order_relaxed);
+        stats->timeouts = atomic_load_explicit(&record->timeouts, memory_order_relaxed);
+        stats->wait_time_total_us = record->wait_us_total;
+        stats->wait_time_max_us = record->wait_us_max;
+    }
+    stats->high_water = atomic_load_explicit(&record->high_water, memory_order_relaxed);
+}
+
+/**
+ * @brief Reset a statistics block and add the object to the registry
+ *
+ * @param record Statistics block of the object
+ * @param object Object handle
+ * @param type Object type
+ */
+void dmosi_object_register(dmosi_object_record_t* record, const void* object, dmosi_object_type_t type)
+{
+    record->object = object;
+    record->name = NULL;
+    atomic_init(&record->operations, 0);
+    atomic_init(&record->blocked, 0);
+    atomic_init(&record->timeouts, 0);
+    atomic_init(&record->high_water, 0);
+    record->wait_us_max = 0;
+    record->wait_us_total = 0;
+    record->type = (uint8_t)type;
+
+    taskENTER_CRITICAL();
+    record->next = g_objects;
+    record->pprev = &g_objects;
+    if (g_objects != NULL) {
+        g_objects->pprev = &record->next;
+    }
+    g_objects = record;
+    taskEXIT_CRITICAL();
+}
+
+/**
+ * @brief Remove an object from the registry
+ *
+ * @param record Statistics block of the object
+ */
+void dmosi_object_unregister(dmosi_object_record_t* record)
+{
+    taskENTER_CRITICAL();
+    if (record->pprev != NULL) {
+        *record->pprev = record->next;
+        if (record->next != NULL) {
+            record->next->pprev = record->pprev;
+        }
+        record->pprev = NULL;
+        record->next = NULL;
+    }
+    taskEXIT_CRITICAL();
+}
+
+/**
+ * @brief Account a blocked operation and its wait time
+ *
+ * Usable from any context (the pair of wait time fields is updated in an
+ * interrupt-safe critical section).
+ *
+ * @param record Statistics block of the object
+ * @param wait_start_us dmosi_get_time_us() when the operation started waiting
+ */
+void dmosi_object_account_wait(dmosi_object_record_t* record, uint64_t wait_start_us)
+{
+    uint64_t waited = dmosi_get_time_us() - wait_start_us;
+
+    atomic_fetch_add_explicit(&record->blocked, 1, memory_order_relaxed);
+
+    UBaseType_t saved = taskENTER_CRITICAL_FROM_ISR();
+    record->wait_us_total += waited;
+    if (waited > record->wait_us_max) {
+        record->wait_us_max = (waited < UINT32_MAX) ? (uint32_t)waited : UINT32_MAX;
+    }
+    taskEXIT_CRITICAL_FROM_ISR(saved);
+}
+
+#endif /* DMOSI_OBJECT_STATS */
+
+//==============================================================================
+//                              OBJECT STATISTICS Implementation
+//==============================================================================
+
+/**
+ * @brief Name a synchronization object in the statistics
+ *
+ * @param object Object handle (dmosi_mutex_t, dmosi_semaphore_t or dmosi_queue_t)
+ * @param name Name to report (not copied, must stay valid; NULL = none)
+ * @return int 0 on success, -ENOENT if @p object is not a live object,
+ *         -ENOTSUP if DMOSI_OBJECT_STATS is disabled, -EINVAL on invalid arguments
+ */
+int dmosi_object_set_name(const void* object, const char* name)
+{
+    if (object == NULL) {
+        return -EINVAL;
+    }
+
+#if !DMOSI_OBJECT_STATS
+    (void)name;
+    return -ENOTSUP;
+#else
+    int result = 0;
+
+    taskENTER_CRITICAL();
+    dmosi_object_record_t* record = object_find_locked(object);
+    if (record != NULL) {
+        record->name = name;
+    } else {
+        result = -ENOENT;
+    }
+    taskEXIT_CRITICAL();
+
+    return result;
+#endif
+}
+
+/**
+ * @brief Get the statistics of a synchronization object
+ *
+ * The counters are updated without locking, so the snapshot may be
+ * slightly inconsistent while the object is in use.
+ *
+ * @param object Object handle (dmosi_mutex_t, dmosi_semaphore_t or dmosi_queue_t)
+ * @param stats Structure to fill
+ * @return int 0 on success, -ENOENT if @p object is not a live object,
+ *         -ENOTSUP if DMOSI_OBJECT_STATS is disabled, -EINVAL on invalid arguments
+ */
+int dmosi_object_get_stats(const void* object, dmosi_object_stats_t* stats)
+{
+    if (object == NULL || stats == NULL) {
+        return -EINVAL;
+    }
+
+#if !DMOSI_OBJECT_STATS
+    return -ENOTSUP;
+#else
+    int result = 0;
+
+    taskENTER_CRITICAL();
+    dmosi_object_record_t* record = object_find_locked(object);
+    if (record != NULL) {
+        object_snapshot_locked(record, stats);
+    } else {
+        result = -ENOENT;
+    }
+    taskEXIT_CRITICAL();
+
+    return result;
+#endif
+}
+
+/**
+ * @brief Enumerate the live synchronization objects with their statistics
+ *
+ * Newest objects come first.
+ *
+ * @param entries Array to fill
+ * @param max_entries Capacity of @p entries
+ * @return size_t Number of entries filled (0 if DMOSI_OBJECT_STATS is disabled)
+ */
+size_t dmosi_object_get_all(dmosi_object_info_t* entries, size_t max_entries)
+{
+    if (entries == NULL) {
+        return 0;
+    }
+
+    size_t count = 0;
+
+#if DMOSI_OBJECT_STATS
+    taskENTER_CRITICAL();
+    for (dmosi_object_record_t* record = g_objects; record != NULL && count < max_entries; record = record->next) {
+        dmosi_object_info_t* entry = &entries[count++];
+        entry->object = record->object;
+        entry->type = (dmosi_object_type_t)record->type;
+        entry->name = record->name;
+        object_snapshot_locked(record, &entry->stats);
+    }
+    taskEXIT_CRITICAL();
+#else
+    (void)max_entries;
+#endif
+
+    return count;
+}
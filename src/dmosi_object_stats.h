@@ -0,0 +1,95 @@
+#ifndef DMOSI_OBJECT_STATS_H
+#define DMOSI_OBJECT_STATS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+#include "dmosi_freertos.h"
+
+#if DMOSI_OBJECT_STATS
+
+/**
+ * @brief Statistics block embedded in mutex, semaphore and queue wrappers
+ *
+ * The counters of the fast paths are relaxed atomics, so they can be
+ * updated from any context without a critical section; only the wait times
+ * are updated under one, on the already slow blocking path.
+ */
+typedef struct dmosi_object_record {
+    struct dmosi_object_record* next;   /**< Next live object in the registry */
+    struct dmosi_object_record** pprev; /**< Link pointing to this record */
+    const void* object;                 /**< Object handle */
+    const char* name;                   /**< Name set by the user (NULL if none) */
+    atomic_uint operations;             /**< See dmosi_object_stats_t */
+    atomic_uint blocked;                /**< See dmosi_object_stats_t */
+    atomic_uint timeouts;               /**< See dmosi_object_stats_t */
+    atomic_uint high_water;             /**< See dmosi_object_stats_t */
+    uint32_t wait_us_max;               /**< See dmosi_object_stats_t */
+    uint64_t wait_us_total;             /**< See dmosi_object_stats_t */
+    uint8_t type;                       /**< dmosi_object_type_t */
+} dmosi_object_record_t;
+
+_Static_assert(sizeof(dmosi_object_record_t) <= sizeof(dmosi_object_stats_storage_t),
+               "dmosi_object_stats_storage_t is too small for dmosi_object_record_t");
+_Static_assert(_Alignof(dmosi_object_record_t) <= _Alignof(dmosi_object_stats_storage_t),
+               "dmosi_object_stats_storage_t is under-aligned for dmosi_object_record_t");
+
+/**
+ * @brief Reset a statistics block and add the object to the registry
+ *
+ * @param record Statistics block of the object
+ * @param object Object handle
+ * @param type Object type
+ */
+void dmosi_object_register(dmosi_object_record_t* record, const void* object, dmosi_object_type_t type);
+
+/**
+ * @brief Remove an object from the registry
+ *
+ * @param record Statistics block of the object
+ */
+void dmosi_object_unregister(dmosi_object_record_t* record);
+
+/**
+ * @brief Account a blocked operation and its wait time
+ *
+ * @param record Statistics block of the object
+ * @param wait_start_us dmosi_get_time_us() when the operation started waiting
+ */
+void dmosi_object_account_wait(dmosi_object_record_t* record, uint64_t wait_start_us);
+
+/**
+ * @brief Account the outcome of an operation
+ *
+ * @param record Statistics block of the object
+ * @param done Operations (e.g. items moved) that succeeded
+ * @param failed Whether the operation gave up
+ */
+static inline void dmosi_object_account(dmosi_object_record_t* record, uint32_t done, bool failed)
+{
+    if (done > 0) {
+        atomic_fetch_add_explicit(&record->operations, done, memory_order_relaxed);
+    }
+    if (failed) {
+        atomic_fetch_add_explicit(&record->timeouts, 1, memory_order_relaxed);
+    }
+}
+
+/**
+ * @brief Raise the high watermark of an object
+ *
+ * @param record Statistics block of the object
+ * @param level Current level (items queued or threads waiting)
+ */
+static inline void dmosi_object_account_level(dmosi_object_record_t* record, uint32_t level)
+{
+    unsigned int seen = atomic_load_explicit(&record->high_water, memory_order_relaxed);
+    while (level > seen &&
+           !atomic_compare_exchange_weak_explicit(&record->high_water, &seen, level,
+                                                  memory_order_relaxed, memory_order_relaxed)) {
+    }
+}
+
+#endif /* DMOSI_OBJECT_STATS */
+
+#endif /* DMOSI_OBJECT_STATS_H */
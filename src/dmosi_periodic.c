@@ -0,0 +1,156 @@
+#include <stdint.h>
+#include <errno.h>
+#include "dmosi.h"
+#include "dmosi_freertos.h"
+#include "FreeRTOS.h"
+#include "task.h"
+
+/**
+ * @brief Number of microseconds per second
+ */
+#define PERIODIC_US_PER_SECOND    1000000ULL
+
+/**
+ * @brief Check whether tick @p now lies strictly after tick @p deadline
+ *
+ * Wrap-safe as long as both values are less than half the tick range apart.
+ *
+ * @param now Current tick count
+ * @param deadline Deadline to compare against
+ * @return true if @p deadline has passed
+ */
+static inline bool periodic_deadline_passed(TickType_t now, TickType_t deadline)
+{
+    return (TickType_t)(now - deadline - 1) < (portMAX_DELAY / 2);
+}
+
+/**
+ * @brief Get the length of the next period in ticks
+ *
+ * The sub-tick remainder of the period is carried from one activation to the
+ * next, so a period that is not a whole number of ticks alternates between
+ * the two neighbouring tick counts and stays exact on average.
+ *
+ * @param periodic Periodic schedule
+ * @return TickType_t Ticks until the next activation
+ */
+static TickType_t periodic_next_increment(dmosi_periodic_t* periodic)
+{
+    TickType_t increment = periodic->period_ticks;
+
+    periodic->fraction_acc += periodic->period_fraction;
+    if (periodic->fraction_acc >= PERIODIC_US_PER_SECOND) {
+        periodic->fraction_acc -= PERIODIC_US_PER_SECOND;
+        increment++;
+    }
+
+    return increment;
+}
+
+//==============================================================================
+//                              PERIODIC API Implementation
+//==============================================================================
+
+/**
+ * @brief Initialize a periodic schedule
+ *
+ * The first period starts now. Periods are measured from absolute wake-up
+ * times, so the execution time of the loop body does not accumulate.
+ *
+ * @param periodic Schedule to initialize
+ * @param period_us Period in microseconds (at least one tick)
+ * @return int 0 on success, -EINVAL on invalid arguments
+ */
+int dmosi_periodic_init(dmosi_periodic_t* periodic, uint32_t period_us)
+{
+    if (periodic == NULL) {
+        return -EINVAL;
+    }
+
+    // Period in units of 1/PERIODIC_US_PER_SECOND ticks
+    uint64_t scaled = (uint64_t)period_us * configTICK_RATE_HZ;
+    if (scaled < PERIODIC_US_PER_SECOND || scaled / PERIODIC_US_PER_SECOND >= portMAX_DELAY / 2) {
+        DMOD_LOG_ERROR("Invalid period: %u us\n", (unsigned)period_us);
+        return -EINVAL;
+    }
+
+    periodic->wake_time = xPortIsInsideInterrupt() ? xTaskGetTickCountFromISR() : xTaskGetTickCount();
+    periodic->period_ticks = (TickType_t)(scaled / PERIODIC_US_PER_SECOND);
+    periodic->period_fraction = (uint32_t)(scaled % PERIODIC_US_PER_SECOND);
+    periodic->fraction_acc = 0;
+    periodic->period_us = period_us;
+    periodic->activations = 0;
+    periodic->overruns = 0;
+    periodic->missed_periods = 0;
+    periodic->max_lateness_ticks = 0;
+
+    return 0;
+}
+
+/**
+ * @brief Sleep until the next activation of a periodic schedule
+ *
+ * When the caller has already passed one or more deadlines the overrun is
+ * recorded and the missed activations are skipped, so the loop resumes on
+ * the original time grid instead of running several bodies back to back.
+ *
+ * @param periodic Schedule initialized with dmosi_periodic_init()
+ * @return int Number of activations skipped (0 = on time), -ENOTSUP before
+ *         the scheduler started, -EINVAL if @p periodic is NULL
+ */
+int dmosi_periodic_wait(dmosi_periodic_t* periodic)
+{
+    if (periodic == NULL) {
+        return -EINVAL;
+    }
+
+    if (!dmosi_is_started() || xPortIsInsideInterrupt()) {
+        return -ENOTSUP;
+    }
+
+    TickType_t now = xTaskGetTickCount();
+    TickType_t increment = periodic_next_increment(periodic);
+    int missed = 0;
+
+    if (periodic_deadline_passed(now, periodic->wake_time + increment)) {
+        TickType_t lateness = now - (periodic->wake_time + increment);
+        if (lateness > periodic->max_lateness_ticks) {
+            periodic->max_lateness_ticks = lateness;
+        }
+        periodic->overruns++;
+
+        do {
+            periodic->wake_time += increment;
+            increment = periodic_next_increment(periodic);
+            missed++;
+        } while (periodic_deadline_passed(now, periodic->wake_time + increment));
+
+        periodic->missed_periods += (uint32_t)missed;
+    }
+
+    (void)xTaskDelayUntil(&periodic->wake_time, increment);
+    periodic->activations++;
+
+    return missed;
+}
+
+/**
+ * @brief Get the deadline statistics of a periodic schedule
+ *
+ * @param periodic Schedule initialized with dmosi_periodic_init()
+ * @param stats Structure to fill
+ * @return int 0 on success, -EINVAL on invalid arguments
+ */
+int dmosi_periodic_get_stats(const dmosi_periodic_t* periodic, dmosi_periodic_stats_t* stats)
+{
+    if (periodic == NULL || stats == NULL) {
+        return -EINVAL;
+    }
+
+    stats->activations = periodic->activations;
+    stats->overruns = periodic->overruns;
+    stats->missed_periods = periodic->missed_periods;
+    stats->max_lateness_us = (uint32_t)((uint64_t)periodic->max_lateness_ticks * PERIODIC_US_PER_SECOND / configTICK_RATE_HZ);
+
+    return 0;
+}
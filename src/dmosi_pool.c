@@ -0,0 +1,130 @@
+#include <stdlib.h>
+#include <stdbool.h>
+#include <errno.h>
+#include "dmosi.h"
+#include "dmosi_pool.h"
+#include "FreeRTOS.h"
+#include "task.h"
+
+extern struct dmosi_pool g_dmosi_mutex_pool;
+extern struct dmosi_pool g_dmosi_semaphore_pool;
+extern struct dmosi_pool g_dmosi_queue_pool;
+extern struct dmosi_pool g_dmosi_timer_pool;
+extern struct dmosi_pool g_dmosi_future_pool;
+
+/**
+ * @brief Pools indexed by dmosi_pool_type_t
+ */
+static struct dmosi_pool* const g_pools[DMOSI_POOL_TYPE_COUNT] = {
+    [DMOSI_POOL_MUTEX]     = &g_dmosi_mutex_pool,
+    [DMOSI_POOL_SEMAPHORE] = &g_dmosi_semaphore_pool,
+    [DMOSI_POOL_QUEUE]     = &g_dmosi_queue_pool,
+    [DMOSI_POOL_TIMER]     = &g_dmosi_timer_pool,
+    [DMOSI_POOL_FUTURE]    = &g_dmosi_future_pool,
+};
+
+/**
+ * @brief Check whether a block belongs to the static storage of a pool
+ *
+ * @param pool Pool to check against
+ * @param block Block pointer
+ * @return true if @p block was handed out from @p pool's storage
+ */
+static bool pool_owns(const struct dmosi_pool* pool, const void* block)
+{
+    const uint8_t* p = (const uint8_t*)block;
+    return p >= pool->storage && p < pool->storage + pool->capacity * pool->block_size;
+}
+
+//==============================================================================
+//                              POOL Implementation
+//==============================================================================
+
+/**
+ * @brief Allocate a block from a pool
+ *
+ * Serves the block from the pool's static storage in O(1) when one is free,
+ * otherwise falls back to pvPortMalloc().
+ *
+ * @param pool Pool to allocate from
+ * @return void* Allocated block, NULL on failure
+ */
+void* dmosi_pool_alloc(struct dmosi_pool* pool)
+{
+    void* block = NULL;
+
+    taskENTER_CRITICAL();
+    if (pool->free_list != NULL) {
+        block = pool->free_list;
+        pool->free_list = *(void**)block;
+    } else if (pool->next_unused < pool->capacity) {
+        block = pool->storage + pool->next_unused * pool->block_size;
+        pool->next_unused++;
+    }
+
+    if (block != NULL) {
+        pool->in_use++;
+        pool->hits++;
+    } else {
+        pool->misses++;
+    }
+    taskEXIT_CRITICAL();
+
+    if (block == NULL) {
+        block = pvPortMalloc(pool->block_size);
+    }
+
+    return block;
+}
+
+/**
+ * @brief Release a block previously obtained from dmosi_pool_alloc()
+ *
+ * Blocks from the pool's static storage go back to its free list; blocks
+ * that were served by the pvPortMalloc() fallback are freed to the heap.
+ *
+ * @param pool Pool the block was allocated from
+ * @param block Block to release (NULL is ignored)
+ */
+void dmosi_pool_free(struct dmosi_pool* pool, void* block)
+{
+    if (block == NULL) {
+        return;
+    }
+
+    if (!pool_owns(pool, block)) {
+        vPortFree(block);
+        return;
+    }
+
+    taskENTER_CRITICAL();
+    *(void**)block = pool->free_list;
+    pool->free_list = block;
+    pool->in_use--;
+    taskEXIT_CRITICAL();
+}
+
+/**
+ * @brief Get usage statistics of a wrapper object pool
+ *
+ * @param type Pool to query
+ * @param stats Structure to fill
+ * @return int 0 on success, -EINVAL on invalid arguments
+ */
+int dmosi_pool_get_stats(dmosi_pool_type_t type, dmosi_pool_stats_t* stats)
+{
+    if (stats == NULL || (int)type < 0 || type >= DMOSI_POOL_TYPE_COUNT) {
+        return -EINVAL;
+    }
+
+    struct dmosi_pool* pool = g_pools[type];
+
+    taskENTER_CRITICAL();
+    stats->capacity = pool->capacity;
+    stats->in_use   = pool->in_use;
+    stats->hits     = pool->hits;
+    stats->misses   = pool->misses;
+    taskEXIT_CRITICAL();
+
+    return 0;
+}
@@ -0,0 +1,76 @@
+#ifndef DMOSI_POOL_H
+#define DMOSI_POOL_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "dmosi_freertos.h"
+
+/**
+ * @brief Default capacities of the wrapper object pools
+ *
+ * Configurable via the CMake parameters of the same name. A capacity of 0
+ * disables the pool for that object type, so every wrapper is allocated with
+ * pvPortMalloc() as before.
+ */
+#ifndef DMOSI_MUTEX_POOL_SIZE
+    #define DMOSI_MUTEX_POOL_SIZE        8
+#endif
+#ifndef DMOSI_SEMAPHORE_POOL_SIZE
+    #define DMOSI_SEMAPHORE_POOL_SIZE    8
+#endif
+#ifndef DMOSI_QUEUE_POOL_SIZE
+    #define DMOSI_QUEUE_POOL_SIZE        8
+#endif
+#ifndef DMOSI_TIMER_POOL_SIZE
+    #define DMOSI_TIMER_POOL_SIZE        8
+#endif
+#ifndef DMOSI_FUTURE_POOL_SIZE
+    #define DMOSI_FUTURE_POOL_SIZE       8
+#endif
+
+/**
+ * @brief Fixed-size block pool serving dmosi wrapper structures
+ *
+ * Blocks are handed out from a static array: first from the free list of
+ * previously released blocks, then from the never-used tail of the array.
+ * Both paths are O(1) and only hold a short kernel critical section, never
+ * the heap lock. When the pool is exhausted, allocations fall back to
+ * pvPortMalloc() and are counted as misses.
+ */
+struct dmosi_pool {
+    uint8_t* storage;      /**< Backing array of @ref capacity blocks */
+    size_t block_size;     /**< Size of a single block in bytes */
+    size_t capacity;       /**< Number of blocks in @ref storage */
+    size_t next_unused;    /**< Index of the first block never handed out */
+    size_t in_use;         /**< Number of blocks currently allocated from the pool */
+    void* free_list;       /**< Singly-linked list of released blocks */
+    uint32_t hits;         /**< Allocations served from the pool */
+    uint32_t misses;       /**< Allocations that fell back to pvPortMalloc() */
+};
+
+/**
+ * @brief Define a pool for objects of @p type with @p count static blocks
+ *
+ * The storage array always has at least one element so that a capacity of 0
+ * still compiles; the pool itself then reports a capacity of 0 and never
+ * hands out that block.
+ */
+#define DMOSI_POOL_DEFINE(name, type, count)                                   \
+    _Static_assert(sizeof(type) >= sizeof(void*),                              \
+                   "pool blocks must be able to hold a free-list link");       \
+    static type name##_storage[((count) > 0) ? (count) : 1];                   \
+    struct dmosi_pool name = {                                                 \
+        .storage     = (uint8_t*)name##_storage,                               \
+        .block_size  = sizeof(type),                                           \
+        .capacity    = (count),                                                \
+        .next_unused = 0,                                                      \
+        .in_use      = 0,                                                      \
+        .free_list   = NULL,                                                   \
+        .hits        = 0,                                                      \
+        .misses      = 0,                                                      \
+    }
+
+void* dmosi_pool_alloc(struct dmosi_pool* pool);
+void dmosi_pool_free(struct dmosi_pool* pool, void* block);
+
+#endif /* DMOSI_POOL_H */
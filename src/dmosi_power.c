@@ -0,0 +1,303 @@
+#include <stdint.h>
+#include <stdbool.h>
+#include <errno.h>
+#include "dmosi.h"
+#include "dmosi_freertos.h"
+#include "FreeRTOS.h"
+#include "task.h"
+
+/**
+ * @brief Exit latency marking a sleep state the platform does not provide
+ */
+#define PM_STATE_UNAVAILABLE    UINT32_MAX
+
+/**
+ * @brief Exit latency of each sleep state in microseconds
+ *
+ * Only the plain wait-for-interrupt state is available until the platform
+ * declares deeper ones with dmosi_pm_set_state_latency().
+ */
+static uint32_t g_state_latency_us[DMOSI_PM_STATE_COUNT] = {
+    [DMOSI_PM_STATE_ACTIVE]  = 0,
+    [DMOSI_PM_STATE_SLEEP]   = 0,
+    [DMOSI_PM_STATE_STOP]    = PM_STATE_UNAVAILABLE,
+    [DMOSI_PM_STATE_STANDBY] = PM_STATE_UNAVAILABLE,
+};
+
+static dmosi_pm_hook_t* g_hooks = NULL;                 /**< Registered sleep hooks */
+static dmosi_pm_constraint_t* g_constraints = NULL;     /**< Active latency constraints */
+static uint32_t g_max_latency_us = UINT32_MAX;          /**< Tightest active constraint */
+static dmosi_pm_state_t g_sleep_state = DMOSI_PM_STATE_ACTIVE;  /**< State of the current sleep */
+
+/**
+ * @brief Recompute the tightest latency constraint
+ *
+ * Must be called inside a critical section.
+ */
+static void pm_update_max_latency_locked(void)
+{
+    uint32_t max_latency_us = UINT32_MAX;
+
+    for (dmosi_pm_constraint_t* c = g_constraints; c != NULL; c = c->next) {
+        if (c->max_latency_us < max_latency_us) {
+            max_latency_us = c->max_latency_us;
+        }
+    }
+
+    g_max_latency_us = max_latency_us;
+}
+
+/**
+ * @brief Convert an idle time in ticks to microseconds
+ *
+ * @param idle_ticks Idle time in ticks
+ * @return uint32_t Idle time in microseconds, saturated at UINT32_MAX
+ */
+static uint32_t pm_ticks_to_us(uint64_t idle_ticks)
+{
+    if (idle_ticks >= (uint64_t)UINT32_MAX * configTICK_RATE_HZ / 1000000ULL) {
+        return UINT32_MAX;
+    }
+
+    return (uint32_t)(idle_ticks * 1000000ULL / configTICK_RATE_HZ);
+}
+
+//==============================================================================
+//                              POWER MANAGEMENT API Implementation
+//==============================================================================
+
+/**
+ * @brief Declare the exit latency of a sleep state
+ *
+ * @param state Sleep state (DMOSI_PM_STATE_SLEEP or deeper)
+ * @param exit_latency_us Time from wake-up event to running code, in
+ *        microseconds (UINT32_MAX = state not available)
+ * @return int 0 on success, -EINVAL if @p state is invalid
+ */
+int dmosi_pm_set_state_latency(dmosi_pm_state_t state, uint32_t exit_latency_us)
+{
+    if (state <= DMOSI_PM_STATE_ACTIVE || state >= DMOSI_PM_STATE_COUNT) {
+        return -EINVAL;
+    }
+
+    taskENTER_CRITICAL();
+    g_state_latency_us[state] = exit_latency_us;
+    taskEXIT_CRITICAL();
+
+    return 0;
+}
+
+/**
+ * @brief Register pre/post-sleep hooks
+ *
+ * The caller fills @ref dmosi_pm_hook_t::pre_sleep, @ref dmosi_pm_hook_t::post_sleep
+ * and @ref dmosi_pm_hook_t::arg; the structure must stay valid until it is
+ * unregistered. Hooks run in the idle task with interrupts disabled, so they
+ * must not block.
+ *
+ * @param hook Hook to register
+ * @return int 0 on success, -EINVAL if @p hook is NULL, -EEXIST if already registered
+ */
+int dmosi_pm_register_hook(dmosi_pm_hook_t* hook)
+{
+    if (hook == NULL) {
+        return -EINVAL;
+    }
+
+    int result = 0;
+
+    taskENTER_CRITICAL();
+    for (dmosi_pm_hook_t* h = g_hooks; h != NULL; h = h->next) {
+        if (h == hook) {
+            result = -EEXIST;
+            break;
+        }
+    }
+    if (result == 0) {
+        hook->next = g_hooks;
+        g_hooks = hook;
+    }
+    taskEXIT_CRITICAL();
+
+    return result;
+}
+
+/**
+ * @brief Unregister pre/post-sleep hooks
+ *
+ * @param hook Hook registered with dmosi_pm_register_hook()
+ * @return int 0 on success, -EINVAL if @p hook is NULL, -ENOENT if not registered
+ */
+int dmosi_pm_unregister_hook(dmosi_pm_hook_t* hook)
+{
+    if (hook == NULL) {
+        return -EINVAL;
+    }
+
+    int result = -ENOENT;
+
+    taskENTER_CRITICAL();
+    for (dmosi_pm_hook_t** link = &g_hooks; *link != NULL; link = &(*link)->next) {
+        if (*link == hook) {
+            *link = hook->next;
+            hook->next = NULL;
+            result = 0;
+            break;
+        }
+    }
+    taskEXIT_CRITICAL();
+
+    return result;
+}
+
+/**
+ * @brief Add a wake-up latency constraint
+ *
+ * While the constraint is active idle only enters sleep states whose exit
+ * latency does not exceed @p max_latency_us. A constraint of 0 keeps the
+ * core out of tickless sleep altogether.
+ *
+ * @param constraint Caller-provided constraint, valid until removed
+ * @param max_latency_us Largest acceptable wake-up latency in microseconds
+ * @return int 0 on success, -EINVAL if @p constraint is NULL, -EEXIST if already active
+ */
+int dmosi_pm_constraint_add(dmosi_pm_constraint_t* constraint, uint32_t max_latency_us)
+{
+    if (constraint == NULL) {
+        return -EINVAL;
+    }
+
+    int result = 0;
+
+    taskENTER_CRITICAL();
+    for (dmosi_pm_constraint_t* c = g_constraints; c != NULL; c = c->next) {
+        if (c == constraint) {
+            result = -EEXIST;
+            break;
+        }
+    }
+    if (result == 0) {
+        constraint->max_latency_us = max_latency_us;
+        constraint->next = g_constraints;
+        g_constraints = constraint;
+        if (max_latency_us < g_max_latency_us) {
+            g_max_latency_us = max_latency_us;
+        }
+    }
+    taskEXIT_CRITICAL();
+
+    return result;
+}
+
+/**
+ * @brief Remove a wake-up latency constraint
+ *
+ * @param constraint Constraint added with dmosi_pm_constraint_add()
+ * @return int 0 on success, -EINVAL if @p constraint is NULL, -ENOENT if not active
+ */
+int dmosi_pm_constraint_remove(dmosi_pm_constraint_t* constraint)
+{
+    if (constraint == NULL) {
+        return -EINVAL;
+    }
+
+    int result = -ENOENT;
+
+    taskENTER_CRITICAL();
+    for (dmosi_pm_constraint_t** link = &g_constraints; *link != NULL; link = &(*link)->next) {
+        if (*link == constraint) {
+            *link = constraint->next;
+            constraint->next = NULL;
+            pm_update_max_latency_locked();
+            result = 0;
+            break;
+        }
+    }
+    taskEXIT_CRITICAL();
+
+    return result;
+}
+
+/**
+ * @brief Pick the deepest sleep state allowed for an idle period
+ *
+ * A state qualifies when the platform provides it, its exit latency meets
+ * every active constraint and it is shorter than the idle period itself.
+ *
+ * @param idle_us Expected idle time in microseconds
+ * @return dmosi_pm_state_t Deepest allowed state, DMOSI_PM_STATE_ACTIVE if none
+ */
+dmosi_pm_state_t dmosi_pm_select_state(uint32_t idle_us)
+{
+    uint32_t max_latency_us = g_max_latency_us;
+
+    if (max_latency_us == 0) {
+        return DMOSI_PM_STATE_ACTIVE;
+    }
+
+    for (int state = DMOSI_PM_STATE_COUNT - 1; state > DMOSI_PM_STATE_ACTIVE; state--) {
+        uint32_t latency_us = g_state_latency_us[state];
+        if (latency_us != PM_STATE_UNAVAILABLE && latency_us <= max_latency_us && latency_us < idle_us) {
+            return (dmosi_pm_state_t)state;
+        }
+    }
+
+    return DMOSI_PM_STATE_ACTIVE;
+}
+
+/**
+ * @brief Prepare for a tickless sleep
+ *
+ * Called through configPRE_SLEEP_PROCESSING by the port's tickless idle
+ * implementation with interrupts disabled. Selects the sleep state and runs
+ * the pre-sleep hooks.
+ *
+ * @param idle_ticks Expected idle time in ticks
+ * @return uint64_t Idle time to sleep for; 0 tells the port to skip its own
+ *         wait for interrupt (sleep not allowed, or performed by a hook)
+ */
+uint64_t dmosi_pm_pre_sleep(uint64_t idle_ticks)
+{
+    uint32_t idle_us = pm_ticks_to_us(idle_ticks);
+    dmosi_pm_state_t state = dmosi_pm_select_state(idle_us);
+
+    g_sleep_state = state;
+    if (state == DMOSI_PM_STATE_ACTIVE) {
+        return 0;
+    }
+
+    bool handled = false;
+    for (dmosi_pm_hook_t* h = g_hooks; h != NULL; h = h->next) {
+        if (h->pre_sleep != NULL && h->pre_sleep(state, idle_us, h->arg) != 0) {
+            handled = true;
+        }
+    }
+
+    return handled ? 0 : idle_ticks;
+}
+
+/**
+ * @brief Finish a tickless sleep
+ *
+ * Called through configPOST_SLEEP_PROCESSING after the wake-up, still with
+ * interrupts disabled. Runs the post-sleep hooks for the state entered by
+ * the matching dmosi_pm_pre_sleep().
+ *
+ * @param idle_ticks Idle time the port expected, in ticks
+ */
+void dmosi_pm_post_sleep(uint64_t idle_ticks)
+{
+    (void)idle_ticks;
+
+    dmosi_pm_state_t state = g_sleep_state;
+    g_sleep_state = DMOSI_PM_STATE_ACTIVE;
+    if (state == DMOSI_PM_STATE_ACTIVE) {
+        return;
+    }
+
+    for (dmosi_pm_hook_t* h = g_hooks; h != NULL; h = h->next) {
+        if (h->post_sleep != NULL) {
+            h->post_sleep(state, h->arg);
+        }
+    }
+}
@@ -2,18 +2,137 @@
 #include <stdbool.h>
 #include <errno.h>
 #include "dmosi.h"
+#include "dmosi_pool.h"
+#include "dmosi_freertos.h"
+#include "dmosi_object_stats.h"
+#include "dmosi_wait.h"
+#include "dmosi_ticks.h"
+#include "dmosi_mpu.h"
 #include "FreeRTOS.h"
+#include "task.h"
 #include "queue.h"
 
 /**
  * @brief Internal structure to wrap FreeRTOS queue handle
  * 
- * This structure wraps the FreeRTOS QueueHandle_t.
+ * This structure wraps the FreeRTOS QueueHandle_t together with its
+ * embedded control block. Only the item storage is allocated separately.
  */
 struct dmosi_queue {
     QueueHandle_t handle;  /**< FreeRTOS queue handle */
+    StaticQueue_t buffer;  /**< Embedded FreeRTOS control block */
+    uint8_t* storage;      /**< Item storage (item_size * queue_length bytes) */
+    size_t item_size;      /**< Size of each item in bytes */
+    bool is_static;        /**< Whether the wrapper and storage are caller-provided */
+    dmosi_watch_list_t watchers; /**< Threads in dmosi_wait_multiple() on this queue */
+#if DMOSI_OBJECT_STATS
+    dmosi_object_record_t stats; /**< Usage statistics */
+#endif
 };
 
+_Static_assert(sizeof(struct dmosi_queue) <= sizeof(dmosi_queue_storage_t),
+               "dmosi_queue_storage_t is too small for struct dmosi_queue");
+_Static_assert(_Alignof(struct dmosi_queue) <= _Alignof(dmosi_queue_storage_t),
+               "dmosi_queue_storage_t is under-aligned for struct dmosi_queue");
+
+/**
+ * @brief Pool serving struct dmosi_queue wrappers (see DMOSI_QUEUE_POOL_SIZE)
+ */
+DMOSI_POOL_DEFINE(g_dmosi_queue_pool, struct dmosi_queue, DMOSI_QUEUE_POOL_SIZE);
+
+/**
+ * @brief Initialize a queue wrapper and create its kernel object in place
+ *
+ * @param queue Wrapper to initialize
+ * @param item_size Size of each item in the queue
+ * @param queue_length Maximum number of items in the queue
+ * @param storage Item storage of at least item_size * queue_length bytes
+ * @param is_static Whether the wrapper and storage are caller-provided
+ * @return true on success, false if the kernel object could not be created
+ */
+static bool queue_init(struct dmosi_queue* queue, size_t item_size, uint32_t queue_length, uint8_t* storage, bool is_static)
+{
+    queue->storage = storage;
+    queue->item_size = item_size;
+    queue->is_static = is_static;
+    dmosi_watch_init(&queue->watchers);
+    queue->handle = xQueueCreateStatic(queue_length, item_size, storage, &queue->buffer);
+#if DMOSI_OBJECT_STATS
+    if (queue->handle != NULL) {
+        dmosi_object_register(&queue->stats, queue, DMOSI_OBJECT_TYPE_QUEUE);
+    }
+#endif
+    return queue->handle != NULL;
+}
+
+/**
+ * @brief Account the outcome of a queue operation (DMOSI_OBJECT_STATS)
+ *
+ * @param queue Queue
+ * @param done Items moved
+ * @param failed Whether the operation gave up
+ * @param sending Whether items were sent (updates the high watermark)
+ */
+static inline void queue_account(struct dmosi_queue* queue, size_t done, bool failed, bool sending)
+{
+#if DMOSI_OBJECT_STATS
+    dmosi_object_account(&queue->stats, (uint32_t)done, failed);
+    if (sending && done > 0) {
+        dmosi_object_account_level(&queue->stats, (uint32_t)uxQueueMessagesWaitingFromISR(queue->handle));
+    }
+#else
+    (void)queue;
+    (void)done;
+    (void)failed;
+    (void)sending;
+#endif
+}
+
+/**
+ * @brief Send an item from task context, waiting for a free slot
+ *
+ * Only called once a non-blocking attempt failed, so with
+ * DMOSI_OBJECT_STATS every call is counted and timed as a blocked send.
+ *
+ * @param queue Queue
+ * @param item Item to send
+ * @param ticks Timeout in ticks (> 0)
+ * @return BaseType_t pdTRUE if the item was sent
+ */
+static BaseType_t queue_send_blocking(struct dmosi_queue* queue, const void* item, TickType_t ticks)
+{
+#if DMOSI_OBJECT_STATS
+    uint64_t wait_start = dmosi_get_time_us();
+    BaseType_t result = xQueueSend(queue->handle, item, ticks);
+    dmosi_object_account_wait(&queue->stats, wait_start);
+    return result;
+#else
+    return xQueueSend(queue->handle, item, ticks);
+#endif
+}
+
+/**
+ * @brief Receive an item from task context, waiting for one to arrive
+ *
+ * @see queue_send_blocking()
+ *
+ * @param queue Queue
+ * @param item Buffer for the item
+ * @param ticks Timeout in ticks (> 0)
+ * @return BaseType_t pdTRUE if an item was received
+ */
+static BaseType_t queue_receive_blocking(struct dmosi_queue* queue, void* item, TickType_t ticks)
+{
+#if DMOSI_OBJECT_STATS
+    uint64_t wait_start = dmosi_get_time_us();
+    BaseType_t result = xQueueReceive(queue->handle, item, ticks);
+    dmosi_object_account_wait(&queue->stats, wait_start);
+    return result;
+#else
+    return xQueueReceive(queue->handle, item, ticks);
+#endif
+}
+
 //==============================================================================
 //                              QUEUE API Implementation
 //==============================================================================
@@ -30,21 +149,59 @@ struct dmosi_queue {
  */
 DMOD_INPUT_API_DECLARATION( dmosi, 1.0, dmosi_queue_t, _queue_create, (size_t item_size, uint32_t queue_length) )
 {
+    DMOSI_MPU_PRIVILEGED_SCOPE();
+
     if (item_size == 0 || queue_length == 0) {
         DMOD_LOG_ERROR("Invalid queue parameters: item_size=%zu, queue_length=%u\n", item_size, queue_length);
         return NULL;
     }
 
-    struct dmosi_queue* queue = pvPortMalloc(sizeof(*queue));
+    struct dmosi_queue* queue = dmosi_pool_alloc(&g_dmosi_queue_pool);
     if (queue == NULL) {
         DMOD_LOG_ERROR("Failed to allocate memory for queue\n");
         return NULL;
     }
 
-    queue->handle = xQueueCreate(queue_length, item_size);
-    if (queue->handle == NULL) {
+    uint8_t* storage = pvPortMalloc(item_size * queue_length);
+    if (storage == NULL) {
+        DMOD_LOG_ERROR("Failed to allocate memory for queue storage\n");
+        dmosi_pool_free(&g_dmosi_queue_pool, queue);
+        return NULL;
+    }
+
+    if (!queue_init(queue, item_size, queue_length, storage, false)) {
+        DMOD_LOG_ERROR("Failed to create FreeRTOS queue\n");
+        vPortFree(storage);
+        dmosi_pool_free(&g_dmosi_queue_pool, queue);
+        return NULL;
+    }
+
+    return queue;
+}
+
+/**
+ * @brief Create a queue in caller-provided storage
+ *
+ * Works like dmosi_queue_create() but uses @p storage for the wrapper and
+ * the FreeRTOS control block and @p buffer for the items, so no memory is
+ * allocated. Both must stay valid until dmosi_queue_destroy() is called.
+ *
+ * @param storage Storage for the queue
+ * @param item_size Size of each item in the queue
+ * @param queue_length Maximum number of items in the queue
+ * @param buffer Item buffer of at least @p item_size * @p queue_length bytes
+ * @return dmosi_queue_t Created queue handle, NULL on failure
+ */
+dmosi_queue_t dmosi_queue_create_static(dmosi_queue_storage_t* storage, size_t item_size, uint32_t queue_length, void* buffer)
+{
+    if (storage == NULL || buffer == NULL || item_size == 0 || queue_length == 0) {
+        DMOD_LOG_ERROR("Invalid queue parameters: item_size=%zu, queue_length=%u\n", item_size, queue_length);
+        return NULL;
+    }
+
+    struct dmosi_queue* queue = (struct dmosi_queue*)storage;
+    if (!queue_init(queue, item_size, queue_length, (uint8_t*)buffer, true)) {
         DMOD_LOG_ERROR("Failed to create FreeRTOS queue\n");
-        vPortFree(queue);
         return NULL;
     }
 
@@ -54,40 +211,47 @@ DMOD_INPUT_API_DECLARATION( dmosi, 1.0, dmosi_queue_t, _queue_create, (size_t it
 /**
  * @brief Destroy a queue
  * 
- * Destroys a queue and frees associated resources.
+ * Destroys a queue and frees associated resources. For a queue created
+ * with dmosi_queue_create_static() the caller-provided storage and item
+ * buffer may be reused once this returns.
  * 
  * @param queue Queue handle to destroy
  */
 DMOD_INPUT_API_DECLARATION( dmosi, 1.0, void, _queue_destroy, (dmosi_queue_t queue) )
 {
+    DMOSI_MPU_PRIVILEGED_SCOPE();
+
     if (queue == NULL) {
         return;
     }
     
+#if DMOSI_OBJECT_STATS
+    dmosi_object_unregister(&queue->stats);
+#endif
+
     // Defensive check: handle should never be NULL for a valid queue,
     // but check anyway to prevent undefined behavior
     if (queue->handle != NULL) {
         vQueueDelete(queue->handle);
     }
     
-    vPortFree(queue);
+    if (!queue->is_static) {
+        vPortFree(queue->storage);
+        dmosi_pool_free(&g_dmosi_queue_pool, queue);
+    }
 }
 
 /**
- * @brief Send data to a queue
+ * @brief Send an item within a timeout in ticks
  *
- * Sends an item to the back of the queue, blocking until space is available
- * or the timeout expires. Safe to call from both task and interrupt context:
- * the FreeRTOS "FromISR" API is used automatically when called from an
- * interrupt handler, in which case the send never blocks regardless of
- * @p timeout_ms.
+ * Common implementation of dmosi_queue_send() and dmosi_queue_send_ticks().
  *
  * @param queue Queue handle
  * @param item Pointer to the item to send
- * @param timeout_ms Timeout in milliseconds (0 = no wait, -1 = wait forever)
+ * @param ticks Timeout in ticks (0 = no wait, portMAX_DELAY = wait forever)
  * @return int 0 on success, negative error code on failure
  */
-DMOD_INPUT_API_DECLARATION( dmosi, 1.0, int, _queue_send, (dmosi_queue_t queue, const void* item, int32_t timeout_ms) )
+static int queue_send(dmosi_queue_t queue, const void* item, TickType_t ticks)
 {
     if (queue == NULL || item == NULL) {
         DMOD_LOG_ERROR("Invalid queue or item (NULL)\n");
@@ -97,31 +261,63 @@ DMOD_INPUT_API_DECLARATION( dmosi, 1.0, int, _queue_send, (dmosi_queue_t queue,
     if (xPortIsInsideInterrupt()) {
         BaseType_t xHigherPriorityTaskWoken = pdFALSE;
         BaseType_t result = xQueueSendFromISR(queue->handle, item, &xHigherPriorityTaskWoken);
+        queue_account(queue, (result == pdTRUE) ? 1 : 0, result != pdTRUE, true);
+        if (result == pdTRUE) {
+            dmosi_watch_notify(&queue->watchers);
+        }
 
         portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
 
         return (result == pdTRUE) ? 0 : -EAGAIN;  // Would block, ISR cannot wait
     }
 
-    if (timeout_ms != 0 && !dmosi_is_started()) {
+    if (ticks != 0 && !dmosi_is_started()) {
         return -ENOTSUP;
     }
 
-    TickType_t ticks;
+    BaseType_t result = xQueueSend(queue->handle, item, 0);
+    if (result != pdTRUE && ticks > 0) {
+        result = queue_send_blocking(queue, item, ticks);
+    }
+    queue_account(queue, (result == pdTRUE) ? 1 : 0, result != pdTRUE, true);
 
-    if (timeout_ms < 0) {
-        // Wait forever
-        ticks = portMAX_DELAY;
-    } else if (timeout_ms == 0) {
-        // No wait
-        ticks = 0;
+    if (result == pdTRUE) {
+        dmosi_watch_notify(&queue->watchers);
+        return 0;
+    } else if (ticks == 0) {
+        return -EAGAIN;  // Would block
     } else {
-        // Convert milliseconds to ticks
-        ticks = pdMS_TO_TICKS(timeout_ms);
+        return -ETIMEDOUT;  // Timeout occurred
     }
+}
 
-    BaseType_t result = xQueueSend(queue->handle, item, ticks);
+/**
+ * @brief Receive an item within a timeout in ticks
+ *
+ * Common implementation of dmosi_queue_receive() and dmosi_queue_receive_ticks().
+ *
+ * @param queue Queue handle
+ * @param item Pointer to buffer to receive the item
+ * @param ticks Timeout in ticks (0 = no wait, portMAX_DELAY = wait forever)
+ * @return int 0 on success, negative error code on failure
+ */
+static int queue_receive(dmosi_queue_t queue, void* item, TickType_t ticks)
+{
+    if (queue == NULL || item == NULL) {
+        DMOD_LOG_ERROR("Invalid queue or item buffer (NULL)\n");
+        return -EINVAL;
+    }
+
+    if (ticks != 0 && !dmosi_is_started()) {
+        return -ENOTSUP;
+    }
 
+    BaseType_t result = xQueueReceive(queue->handle, item, 0);
+    if (result != pdTRUE && ticks > 0) {
+        result = queue_receive_blocking(queue, item, ticks);
+    }
+    queue_account(queue, (result == pdTRUE) ? 1 : 0, result != pdTRUE, false);
+    
     if (result == pdTRUE) {
         return 0;
     } else if (ticks == 0) {
@@ -131,6 +327,27 @@ DMOD_INPUT_API_DECLARATION( dmosi, 1.0, int, _queue_send, (dmosi_queue_t queue,
     }
 }
 
+/**
+ * @brief Send data to a queue
+ *
+ * Sends an item to the back of the queue, blocking until space is available
+ * or the timeout expires. Safe to call from both task and interrupt context:
+ * the FreeRTOS "FromISR" API is used automatically when called from an
+ * interrupt handler, in which case the send never blocks regardless of
+ * @p timeout_ms.
+ *
+ * @param queue Queue handle
+ * @param item Pointer to the item to send
+ * @param timeout_ms Timeout in milliseconds (0 = no wait, -1 = wait forever)
+ * @return int 0 on success, negative error code on failure
+ */
+DMOD_INPUT_API_DECLARATION( dmosi, 1.0, int, _queue_send, (dmosi_queue_t queue, const void* item, int32_t timeout_ms) )
+{
+    DMOSI_MPU_PRIVILEGED_SCOPE();
+
+    return queue_send(queue, item, dmosi_ticks_from_timeout(timeout_ms));
+}
+
 /**
  * @brief Receive data from a queue
  * 
@@ -144,31 +361,242 @@ DMOD_INPUT_API_DECLARATION( dmosi, 1.0, int, _queue_send, (dmosi_queue_t queue,
  */
 DMOD_INPUT_API_DECLARATION( dmosi, 1.0, int, _queue_receive, (dmosi_queue_t queue, void* item, int32_t timeout_ms) )
 {
-    if (queue == NULL || item == NULL) {
-        DMOD_LOG_ERROR("Invalid queue or item buffer (NULL)\n");
+    DMOSI_MPU_PRIVILEGED_SCOPE();
+
+    return queue_receive(queue, item, dmosi_ticks_from_timeout(timeout_ms));
+}
+
+/**
+ * @brief Send data to a queue with a timeout in ticks
+ *
+ * Skips the millisecond conversion of dmosi_queue_send(); otherwise
+ * identical, including the behaviour in interrupt context.
+ *
+ * @param queue Queue handle
+ * @param item Pointer to the item to send
+ * @param ticks Timeout in ticks (0 = no wait, DMOSI_TICKS_FOREVER = wait forever)
+ * @return int 0 on success, negative error code on failure
+ */
+int dmosi_queue_send_ticks(dmosi_queue_t queue, const void* item, uint32_t ticks)
+{
+    return queue_send(queue, item, dmosi_ticks_from_api(ticks));
+}
+
+/**
+ * @brief Receive data from a queue with a timeout in ticks
+ *
+ * Skips the millisecond conversion of dmosi_queue_receive().
+ *
+ * @param queue Queue handle
+ * @param item Pointer to buffer to receive the item
+ * @param ticks Timeout in ticks (0 = no wait, DMOSI_TICKS_FOREVER = wait forever)
+ * @return int 0 on success, negative error code on failure
+ */
+int dmosi_queue_receive_ticks(dmosi_queue_t queue, void* item, uint32_t ticks)
+{
+    return queue_receive(queue, item, dmosi_ticks_from_api(ticks));
+}
+
+/**
+ * @brief Send a batch of items to a queue
+ *
+ * Sends up to @p count items from the @p items array, in order. Items are
+ * moved in bursts with the scheduler suspended, so a receiver is woken at
+ * most once per burst instead of once per item. Only the wake-ups are
+ * batched: the kernel queue has no multi-item copy and its storage layout is
+ * private, so every item still takes one xQueueSend() with its own short
+ * critical section. The call blocks only while fewer than @p min_count items
+ * have been sent; @p timeout_ms is a single deadline for the whole batch.
+ *
+ * From an interrupt handler the call never blocks and requests at most one
+ * context switch, on exit from the handler.
+ *
+ * @param queue Queue handle
+ * @param items Array of @p count items
+ * @param count Maximum number of items to send
+ * @param min_count Minimum number of items to send before returning (<= @p count)
+ * @param sent Set to the number of items actually sent (can be NULL)
+ * @param timeout_ms Timeout in milliseconds (0 = no wait, -1 = wait forever)
+ * @return int 0 if at least @p min_count items were sent, negative error code otherwise
+ */
+int dmosi_queue_send_batch(dmosi_queue_t queue, const void* items, size_t count, size_t min_count, size_t* sent, int32_t timeout_ms)
+{
+    size_t done = 0;
+
+    if (sent != NULL) {
+        *sent = 0;
+    }
+
+    if (queue == NULL || (items == NULL && count > 0) || min_count > count) {
+        DMOD_LOG_ERROR("Invalid queue batch parameters\n");
         return -EINVAL;
     }
 
-    if (timeout_ms != 0 && !dmosi_is_started()) {
+    const uint8_t* next = (const uint8_t*)items;
+
+    if (xPortIsInsideInterrupt()) {
+        BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+
+        while (done < count && xQueueSendFromISR(queue->handle, next, &xHigherPriorityTaskWoken) == pdTRUE) {
+            next += queue->item_size;
+            done++;
+        }
+
+        queue_account(queue, done, done < min_count, true);
+        if (done > 0) {
+            dmosi_watch_notify(&queue->watchers);
+        }
+        portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
+
+        if (sent != NULL) {
+            *sent = done;
+        }
+        return (done >= min_count) ? 0 : -EAGAIN;  // Would block, ISR cannot wait
+    }
+
+    if (timeout_ms != 0 && min_count > 0 && !dmosi_is_started()) {
         return -ENOTSUP;
     }
 
-    TickType_t ticks;
-    
-    if (timeout_ms < 0) {
-        // Wait forever
-        ticks = portMAX_DELAY;
-    } else if (timeout_ms == 0) {
-        // No wait
-        ticks = 0;
+    TickType_t ticks = dmosi_ticks_from_timeout(timeout_ms);
+
+    TickType_t remaining = ticks;
+    TimeOut_t timeout;
+    vTaskSetTimeOutState(&timeout);
+
+    for (;;) {
+        // Move everything that fits without blocking in one burst
+        size_t burst_start = done;
+        vTaskSuspendAll();
+        while (done < count && xQueueSend(queue->handle, next, 0) == pdTRUE) {
+            next += queue->item_size;
+            done++;
+        }
+        (void)xTaskResumeAll();
+        if (done > burst_start) {
+            dmosi_watch_notify(&queue->watchers);
+        }
+
+        if (done >= min_count || xTaskCheckForTimeOut(&timeout, &remaining) == pdTRUE) {
+            break;
+        }
+
+        // Block for a single free slot, then try another burst
+        if (queue_send_blocking(queue, next, remaining) != pdTRUE) {
+            break;
+        }
+        dmosi_watch_notify(&queue->watchers);
+        next += queue->item_size;
+        done++;
+    }
+
+    queue_account(queue, done, done < min_count, true);
+
+    if (sent != NULL) {
+        *sent = done;
+    }
+
+    if (done >= min_count) {
+        return 0;
+    } else if (ticks == 0) {
+        return -EAGAIN;  // Would block
     } else {
-        // Convert milliseconds to ticks
-        ticks = pdMS_TO_TICKS(timeout_ms);
+        return -ETIMEDOUT;  // Timeout occurred
     }
+}
 
-    BaseType_t result = xQueueReceive(queue->handle, item, ticks);
-    
-    if (result == pdTRUE) {
+/**
+ * @brief Receive a batch of items from a queue
+ *
+ * Receives up to @p count items into the @p items array, in queue order.
+ * Items are moved in bursts with the scheduler suspended, so a sender is
+ * woken at most once per burst instead of once per item. As for
+ * dmosi_queue_send_batch(), only the wake-ups are batched; every item still
+ * takes one xQueueReceive(). The call blocks only while fewer than
+ * @p min_count items have been received; @p timeout_ms is a single deadline
+ * for the whole batch.
+ *
+ * From an interrupt handler the call never blocks and requests at most one
+ * context switch, on exit from the handler.
+ *
+ * @param queue Queue handle
+ * @param items Buffer for @p count items
+ * @param count Maximum number of items to receive
+ * @param min_count Minimum number of items to receive before returning (<= @p count)
+ * @param received Set to the number of items actually received (can be NULL)
+ * @param timeout_ms Timeout in milliseconds (0 = no wait, -1 = wait forever)
+ * @return int 0 if at least @p min_count items were received, negative error code otherwise
+ */
+int dmosi_queue_receive_batch(dmosi_queue_t queue, void* items, size_t count, size_t min_count, size_t* received, int32_t timeout_ms)
+{
+    size_t done = 0;
+
+    if (received != NULL) {
+        *received = 0;
+    }
+
+    if (queue == NULL || (items == NULL && count > 0) || min_count > count) {
+        DMOD_LOG_ERROR("Invalid queue batch parameters\n");
+        return -EINVAL;
+    }
+
+    uint8_t* next = (uint8_t*)items;
+
+    if (xPortIsInsideInterrupt()) {
+        BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+
+        while (done < count && xQueueReceiveFromISR(queue->handle, next, &xHigherPriorityTaskWoken) == pdTRUE) {
+            next += queue->item_size;
+            done++;
+        }
+
+        queue_account(queue, done, done < min_count, false);
+        portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
+
+        if (received != NULL) {
+            *received = done;
+        }
+        return (done >= min_count) ? 0 : -EAGAIN;  // Would block, ISR cannot wait
+    }
+
+    if (timeout_ms != 0 && min_count > 0 && !dmosi_is_started()) {
+        return -ENOTSUP;
+    }
+
+    TickType_t ticks = dmosi_ticks_from_timeout(timeout_ms);
+
+    TickType_t remaining = ticks;
+    TimeOut_t timeout;
+    vTaskSetTimeOutState(&timeout);
+
+    for (;;) {
+        // Drain everything available without blocking in one burst
+        vTaskSuspendAll();
+        while (done < count && xQueueReceive(queue->handle, next, 0) == pdTRUE) {
+            next += queue->item_size;
+            done++;
+        }
+        (void)xTaskResumeAll();
+
+        if (done >= min_count || xTaskCheckForTimeOut(&timeout, &remaining) == pdTRUE) {
+            break;
+        }
+
+        // Block for a single item, then try another burst
+        if (queue_receive_blocking(queue, next, remaining) != pdTRUE) {
+            break;
+        }
+        next += queue->item_size;
+        done++;
+    }
+
+    queue_account(queue, done, done < min_count, false);
+
+    if (received != NULL) {
+        *received = done;
+    }
+
+    if (done >= min_count) {
         return 0;
     } else if (ticks == 0) {
         return -EAGAIN;  // Would block
@@ -176,3 +604,28 @@ DMOD_INPUT_API_DECLARATION( dmosi, 1.0, int, _queue_receive, (dmosi_queue_t queu
         return -ETIMEDOUT;  // Timeout occurred
     }
 }
+
+/**
+ * @brief Get the watcher list of a queue
+ *
+ * Lets dmosi_wait_multiple() register on the queue without exposing the
+ * queue structure.
+ *
+ * @param queue Queue handle
+ * @return dmosi_watch_list_t* Watcher list of @p queue
+ */
+dmosi_watch_list_t* dmosi_queue_watch_list(dmosi_queue_t queue)
+{
+    return &queue->watchers;
+}
+
+/**
+ * @brief Check whether a queue holds an item
+ *
+ * @param queue Queue handle
+ * @return true if a receive would not block
+ */
+bool dmosi_queue_ready(dmosi_queue_t queue)
+{
+    return uxQueueMessagesWaitingFromISR(queue->handle) > 0;
+}
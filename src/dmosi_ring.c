@@ -0,0 +1,284 @@
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <stdatomic.h>
+#include <errno.h>
+#include "dmosi.h"
+#include "dmosi_freertos.h"
+#include "dmosi_notify.h"
+#include "dmosi_ticks.h"
+#include "FreeRTOS.h"
+#include "task.h"
+
+/**
+ * @brief Size of a cache line / coherency granule in bytes
+ *
+ * Configurable via the CMake parameter of the same name. The producer and
+ * consumer indices are placed in separate lines of this size so that the two
+ * sides never write to the same line.
+ */
+#ifndef DMOSI_CACHE_LINE_SIZE
+    #define DMOSI_CACHE_LINE_SIZE    64
+#endif
+
+/**
+ * @brief Internal structure of a single-producer/single-consumer ring
+ *
+ * Both indices run freely and are reduced with @ref mask, so a full ring
+ * holds all @ref mask + 1 slots. Each side keeps a private copy of the other
+ * side's index and only reloads it when the ring looks full (or empty), so
+ * the common case touches no line written by the other side.
+ *
+ * Neither side ever enters a critical section. The only kernel call is the
+ * wake-up of a consumer parked on an empty ring.
+ */
+struct dmosi_ring {
+    uint8_t* storage;               /**< Slot storage ((mask + 1) * item_size bytes) */
+    size_t item_size;               /**< Size of each item in bytes */
+    size_t mask;                    /**< Number of slots minus one */
+    void* allocation;               /**< Block returned by pvPortMalloc() */
+
+    _Alignas(DMOSI_CACHE_LINE_SIZE)
+    atomic_size_t head;             /**< Next slot to write (producer-owned) */
+    size_t tail_cache;              /**< Producer's copy of @ref tail */
+
+    _Alignas(DMOSI_CACHE_LINE_SIZE)
+    atomic_size_t tail;             /**< Next slot to read (consumer-owned) */
+    size_t head_cache;              /**< Consumer's copy of @ref head */
+    _Atomic(TaskHandle_t) waiter;   /**< Consumer parked on an empty ring (NULL if none) */
+};
+
+/**
+ * @brief Round a slot count up to the next power of two
+ *
+ * @param n Requested number of slots (> 0)
+ * @return size_t Smallest power of two >= @p n, 0 on overflow
+ */
+static size_t ring_round_up_pow2(size_t n)
+{
+    size_t p = 1;
+    while (p < n) {
+        if (p > SIZE_MAX / 2) {
+            return 0;
+        }
+        p <<= 1;
+    }
+    return p;
+}
+
+/**
+ * @brief Wake the consumer if it is parked on the ring
+ *
+ * @param ring Ring handle
+ */
+static void ring_wake_consumer(struct dmosi_ring* ring)
+{
+    TaskHandle_t waiter = atomic_load_explicit(&ring->waiter, memory_order_seq_cst);
+    if (waiter == NULL || !atomic_compare_exchange_strong(&ring->waiter, &waiter, NULL)) {
+        return;
+    }
+
+    if (xPortIsInsideInterrupt()) {
+        BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+        vTaskNotifyGiveIndexedFromISR(waiter, DMOSI_NOTIFY_INDEX_WAIT, &xHigherPriorityTaskWoken);
+        portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
+    } else {
+        xTaskNotifyGiveIndexed(waiter, DMOSI_NOTIFY_INDEX_WAIT);
+    }
+}
+
+//==============================================================================
+//                              RING API Implementation
+//==============================================================================
+
+/**
+ * @brief Create a single-producer/single-consumer ring
+ *
+ * @param item_size Size of each item in bytes
+ * @param capacity Minimum number of items; rounded up to a power of two
+ * @return dmosi_ring_t Created ring handle, NULL on failure
+ */
+dmosi_ring_t dmosi_ring_create(size_t item_size, uint32_t capacity)
+{
+    size_t slots = (capacity > 0) ? ring_round_up_pow2(capacity) : 0;
+
+    if (item_size == 0 || slots == 0 || slots > SIZE_MAX / item_size) {
+        DMOD_LOG_ERROR("Invalid ring parameters: item_size=%zu, capacity=%u\n", item_size, capacity);
+        return NULL;
+    }
+
+    // pvPortMalloc() only guarantees portBYTE_ALIGNMENT, so align by hand
+    size_t size = (DMOSI_CACHE_LINE_SIZE - 1) + sizeof(struct dmosi_ring) + slots * item_size;
+    void* allocation = pvPortMalloc(size);
+    if (allocation == NULL) {
+        DMOD_LOG_ERROR("Failed to allocate memory for ring\n");
+        return NULL;
+    }
+
+    uintptr_t aligned = ((uintptr_t)allocation + (DMOSI_CACHE_LINE_SIZE - 1)) & ~(uintptr_t)(DMOSI_CACHE_LINE_SIZE - 1);
+    struct dmosi_ring* ring = (struct dmosi_ring*)aligned;
+
+    ring->storage = (uint8_t*)(ring + 1);
+    ring->item_size = item_size;
+    ring->mask = slots - 1;
+    ring->allocation = allocation;
+    atomic_init(&ring->head, 0);
+    ring->tail_cache = 0;
+    atomic_init(&ring->tail, 0);
+    ring->head_cache = 0;
+    atomic_init(&ring->waiter, NULL);
+
+    return ring;
+}
+
+/**
+ * @brief Destroy a single-producer/single-consumer ring
+ *
+ * No task may be blocked on the ring when it is destroyed.
+ *
+ * @param ring Ring handle to destroy
+ */
+void dmosi_ring_destroy(dmosi_ring_t ring)
+{
+    if (ring == NULL) {
+        return;
+    }
+
+    vPortFree(ring->allocation);
+}
+
+/**
+ * @brief Get the number of slots of a ring
+ *
+ * @param ring Ring handle
+ * @return size_t Capacity in items (0 if @p ring is NULL)
+ */
+size_t dmosi_ring_capacity(dmosi_ring_t ring)
+{
+    return (ring != NULL) ? ring->mask + 1 : 0;
+}
+
+/**
+ * @brief Get the number of items stored in a ring
+ *
+ * The value is a snapshot and may change immediately if the other side is
+ * active.
+ *
+ * @param ring Ring handle
+ * @return size_t Number of stored items (0 if @p ring is NULL)
+ */
+size_t dmosi_ring_count(dmosi_ring_t ring)
+{
+    if (ring == NULL) {
+        return 0;
+    }
+
+    size_t tail = atomic_load_explicit(&ring->tail, memory_order_acquire);
+    size_t head = atomic_load_explicit(&ring->head, memory_order_acquire);
+    return head - tail;
+}
+
+/**
+ * @brief Push an item into a ring (producer side)
+ *
+ * Never blocks and never disables interrupts, so it can be called from any
+ * interrupt priority. Only when the consumer is parked on an empty ring is
+ * it woken through a task notification, which is a kernel call and hence
+ * limited to interrupts at or below configMAX_SYSCALL_INTERRUPT_PRIORITY.
+ *
+ * @param ring Ring handle
+ * @param item Pointer to the item to push
+ * @return int 0 on success, -EAGAIN if the ring is full, -EINVAL on invalid arguments
+ */
+int dmosi_ring_push(dmosi_ring_t ring, const void* item)
+{
+    if (ring == NULL || item == NULL) {
+        return -EINVAL;
+    }
+
+    size_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+
+    if (head - ring->tail_cache > ring->mask) {
+        ring->tail_cache = atomic_load_explicit(&ring->tail, memory_order_acquire);
+        if (head - ring->tail_cache > ring->mask) {
+            return -EAGAIN;  // Full
+        }
+    }
+
+    memcpy(ring->storage + (head & ring->mask) * ring->item_size, item, ring->item_size);
+
+    // Sequentially consistent so the waiter check below cannot miss a consumer
+    // that parks right after seeing the ring empty
+    atomic_store_explicit(&ring->head, head + 1, memory_order_seq_cst);
+
+    ring_wake_consumer(ring);
+
+    return 0;
+}
+
+/**
+ * @brief Pop an item from a ring (consumer side)
+ *
+ * Takes the oldest item without entering a critical section. When the ring
+ * is empty the consumer parks on a task notification until the producer
+ * pushes or the timeout expires. Can be called from an interrupt handler,
+ * where it never blocks.
+ *
+ * @param ring Ring handle
+ * @param item Buffer to receive the item
+ * @param timeout_ms Timeout in milliseconds (0 = no wait, -1 = wait forever)
+ * @return int 0 on success, negative error code on failure
+ */
+int dmosi_ring_pop(dmosi_ring_t ring, void* item, int32_t timeout_ms)
+{
+    if (ring == NULL || item == NULL) {
+        return -EINVAL;
+    }
+
+    TickType_t ticks;
+
+    if (timeout_ms == 0 || xPortIsInsideInterrupt()) {
+        // No wait
+        ticks = 0;
+    } else if (!dmosi_is_started()) {
+        return -ENOTSUP;
+    } else {
+        ticks = dmosi_ticks_from_timeout(timeout_ms);
+    }
+
+    bool no_wait = (ticks == 0);
+    TimeOut_t timeout;
+    if (!no_wait) {
+        vTaskSetTimeOutState(&timeout);
+    }
+
+    size_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+
+    for (;;) {
+        if (tail == ring->head_cache) {
+            ring->head_cache = atomic_load_explicit(&ring->head, memory_order_acquire);
+        }
+
+        if (tail != ring->head_cache) {
+            memcpy(item, ring->storage + (tail & ring->mask) * ring->item_size, ring->item_size);
+            atomic_store_explicit(&ring->tail, tail + 1, memory_order_release);
+            return 0;
+        }
+
+        if (no_wait) {
+            return -EAGAIN;  // Would block
+        }
+
+        if (xTaskCheckForTimeOut(&timeout, &ticks) == pdTRUE) {
+            return -ETIMEDOUT;  // Timeout occurred
+        }
+
+        // Park, then re-check so a push racing with the registration is not missed
+        atomic_store_explicit(&ring->waiter, xTaskGetCurrentTaskHandle(), memory_order_seq_cst);
+        if (atomic_load_explicit(&ring->head, memory_order_seq_cst) == tail) {
+            ulTaskNotifyTakeIndexed(DMOSI_NOTIFY_INDEX_WAIT, pdTRUE, ticks);
+        }
+        atomic_store_explicit(&ring->waiter, NULL, memory_order_relaxed);
+    }
+}
@@ -0,0 +1,416 @@
+#include <stdint.h>
+#include <stdbool.h>
+#include <errno.h>
+#include "dmosi.h"
+#include "dmosi_freertos.h"
+#include "dmosi_runtime.h"
+#include "dmosi_ticks.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include "timers.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+    #include <unistd.h>
+#endif
+
+//==============================================================================
+//                              Run-time counter sources
+//==============================================================================
+
+#if defined(DMOSI_ARCH_RUNTIME_DWT)
+
+/*
+ * Cortex-M debug and DWT registers (ARMv7-M and ARMv8-M mainline)
+ */
+#define RUNTIME_DEMCR               ( *( volatile uint32_t* ) 0xE000EDFCUL )
+#define RUNTIME_DEMCR_TRCENA        ( 1UL << 24 )
+#define RUNTIME_DWT_CTRL            ( *( volatile uint32_t* ) 0xE0001000UL )
+#define RUNTIME_DWT_CTRL_CYCCNTENA  ( 1UL << 0 )
+#define RUNTIME_DWT_CTRL_NOCYCCNT   ( 1UL << 25 )
+#define RUNTIME_DWT_CYCCNT          ( *( volatile uint32_t* ) 0xE0001004UL )
+#define RUNTIME_DWT_LAR             ( *( volatile uint32_t* ) 0xE0001FB0UL )
+#define RUNTIME_DWT_LAR_KEY         0xC5ACCE55UL
+
+static bool g_dwt_available = false;    /**< CYCCNT implemented and running */
+static uint32_t g_dwt_last = 0;         /**< CYCCNT at the previous read */
+static uint64_t g_dwt_high = 0;         /**< Wrap-arounds of CYCCNT, in units of 2^32 */
+
+/**
+ * @brief Enable the DWT cycle counter
+ *
+ * Falls back to dmosi_get_time_us() on parts that do not implement CYCCNT.
+ */
+void dmosi_runtime_counter_init(void)
+{
+    RUNTIME_DEMCR |= RUNTIME_DEMCR_TRCENA;
+    RUNTIME_DWT_LAR = RUNTIME_DWT_LAR_KEY;   // Only locked on some Cortex-M7 parts
+
+    if ((RUNTIME_DWT_CTRL & RUNTIME_DWT_CTRL_NOCYCCNT) != 0) {
+        return;
+    }
+
+    RUNTIME_DWT_CYCCNT = 0;
+    RUNTIME_DWT_CTRL |= RUNTIME_DWT_CTRL_CYCCNTENA;
+    g_dwt_last = 0;
+    g_dwt_high = 0;
+    g_dwt_available = true;
+}
+
+/**
+ * @brief Read the run-time counter
+ *
+ * Extends the 32-bit CYCCNT to 64 bits. The scheduler reads the counter on
+ * every context switch and the CPU usage sampler at least every
+ * DMOSI_CPU_SAMPLE_MS, far more often than CYCCNT wraps.
+ *
+ * @return uint64_t CPU cycles since the scheduler started
+ */
+uint64_t dmosi_runtime_counter(void)
+{
+    if (!g_dwt_available) {
+        return dmosi_get_time_us();
+    }
+
+    UBaseType_t saved = taskENTER_CRITICAL_FROM_ISR();
+    uint32_t now = RUNTIME_DWT_CYCCNT;
+    if (now < g_dwt_last) {
+        g_dwt_high += (uint64_t)1 << 32;
+    }
+    g_dwt_last = now;
+    uint64_t value = g_dwt_high | now;
+    taskEXIT_CRITICAL_FROM_ISR(saved);
+
+    return value;
+}
+
+/**
+ * @brief Get the run-time counter frequency
+ *
+ * @return uint64_t Counter frequency in Hz
+ */
+static uint64_t runtime_counter_hz(void)
+{
+    return g_dwt_available ? (uint64_t)configCPU_CLOCK_HZ : 1000000ULL;
+}
+
+#elif defined(DMOSI_ARCH_RUNTIME_MCYCLE)
+
+static uint64_t g_mcycle_base = 0;      /**< mcycle when the scheduler started */
+
+/**
+ * @brief Read the 64-bit machine cycle counter
+ *
+ * @return uint64_t Cycles since reset
+ */
+static inline uint64_t runtime_read_mcycle(void)
+{
+#if __riscv_xlen == 32
+    uint32_t high;
+    uint32_t low;
+    uint32_t check;
+
+    // Re-read if the low half wrapped between the two reads of the high half
+    do {
+        __asm__ volatile ("csrr %0, mcycleh" : "=r"(high));
+        __asm__ volatile ("csrr %0, mcycle" : "=r"(low));
+        __asm__ volatile ("csrr %0, mcycleh" : "=r"(check));
+    } while (high != check);
+
+    return ((uint64_t)high << 32) | low;
+#else
+    uint64_t value;
+    __asm__ volatile ("csrr %0, mcycle" : "=r"(value));
+    return value;
+#endif
+}
+
+/**
+ * @brief Start counting run time from now
+ */
+void dmosi_runtime_counter_init(void)
+{
+    g_mcycle_base = runtime_read_mcycle();
+}
+
+/**
+ * @brief Read the run-time counter
+ *
+ * @return uint64_t CPU cycles since the scheduler started
+ */
+uint64_t dmosi_runtime_counter(void)
+{
+    return runtime_read_mcycle() - g_mcycle_base;
+}
+
+/**
+ * @brief Get the run-time counter frequency
+ *
+ * @return uint64_t Counter frequency in Hz
+ */
+static uint64_t runtime_counter_hz(void)
+{
+    return (uint64_t)configCPU_CLOCK_HZ;
+}
+
+#elif defined(DMOSI_ARCH_RUNTIME_CNTVCT)
+
+static uint64_t g_cntvct_base = 0;      /**< CNTVCT_EL0 when the scheduler started */
+
+/**
+ * @brief Read the virtual count of the generic timer
+ *
+ * @return uint64_t Generic timer count
+ */
+static inline uint64_t runtime_read_cntvct(void)
+{
+    uint64_t value;
+    __asm__ volatile ("isb\n\tmrs %0, cntvct_el0" : "=r"(value) : : "memory");
+    return value;
+}
+
+/**
+ * @brief Start counting run time from now
+ */
+void dmosi_runtime_counter_init(void)
+{
+    g_cntvct_base = runtime_read_cntvct();
+}
+
+/**
+ * @brief Read the run-time counter
+ *
+ * @return uint64_t Generic timer counts since the scheduler started
+ */
+uint64_t dmosi_runtime_counter(void)
+{
+    return runtime_read_cntvct() - g_cntvct_base;
+}
+
+/**
+ * @brief Get the run-time counter frequency
+ *
+ * @return uint64_t Counter frequency in Hz, as programmed by the firmware
+ */
+static uint64_t runtime_counter_hz(void)
+{
+    uint64_t hz;
+    __asm__ volatile ("mrs %0, cntfrq_el0" : "=r"(hz));
+    return hz;
+}
+
+#elif defined(DMOSI_RUN_TIME_COUNTER_HZ)
+
+/**
+ * @brief Get the run-time counter frequency
+ *
+ * @return uint64_t Counter frequency in Hz
+ */
+static uint64_t runtime_counter_hz(void)
+{
+    return (uint64_t)DMOSI_RUN_TIME_COUNTER_HZ;
+}
+
+#elif defined(__unix__) || defined(__APPLE__)
+
+/**
+ * @brief Get the run-time counter frequency
+ *
+ * The POSIX port counts process CPU time in clock ticks.
+ *
+ * @return uint64_t Counter frequency in Hz
+ */
+static uint64_t runtime_counter_hz(void)
+{
+    long clk_tck = sysconf(_SC_CLK_TCK);
+    return (clk_tck > 0) ? (uint64_t)clk_tck : 0;
+}
+
+#else
+
+/**
+ * @brief Get the run-time counter frequency
+ *
+ * The counter was supplied through portGET_RUN_TIME_COUNTER_VALUE without
+ * DMOSI_RUN_TIME_COUNTER_HZ, so its frequency is unknown.
+ *
+ * @return uint64_t Always 0
+ */
+static inline uint64_t runtime_counter_hz(void)
+{
+    return 0;
+}
+
+#endif
+
+//==============================================================================
+//                              CPU usage sampler
+//==============================================================================
+
+/*
+ * Every DMOSI_CPU_SAMPLE_MS a software timer records the run-time counter,
+ * the counters of all registered threads and those of the idle tasks in a
+ * ring of DMOSI_CPU_SAMPLES entries. A windowed usage is the counter delta
+ * between the newest ring entry at least the window length old and now, so
+ * a query costs O(1) per thread and nothing walks the kernel task lists.
+ */
+
+static StaticTimer_t g_sampler_buffer;                 /**< Sampler timer storage */
+static TimerHandle_t g_sampler = NULL;                 /**< Sampler timer */
+static configRUN_TIME_COUNTER_TYPE g_sample_time[DMOSI_CPU_SAMPLES];   /**< Run-time counter at each sample */
+static configRUN_TIME_COUNTER_TYPE g_idle_samples[configNUMBER_OF_CORES][DMOSI_CPU_SAMPLES];   /**< Idle task counters */
+static uint32_t g_sample_count = 0;                    /**< Samples taken so far */
+
+/**
+ * @brief Get the idle task of a core
+ *
+ * @param core Core index
+ * @return TaskHandle_t Idle task (NULL before the scheduler started)
+ */
+static TaskHandle_t runtime_idle_task(uint32_t core)
+{
+#if configNUMBER_OF_CORES > 1
+    return xTaskGetIdleTaskHandleForCore((BaseType_t)core);
+#else
+    (void)core;
+    return xTaskGetIdleTaskHandle();
+#endif
+}
+
+/**
+ * @brief Sampler timer callback
+ *
+ * @param timer Sampler timer
+ */
+static void runtime_sample(TimerHandle_t timer)
+{
+    (void)timer;
+
+    taskENTER_CRITICAL();
+    uint32_t seq = g_sample_count;
+    uint32_t index = seq % DMOSI_CPU_SAMPLES;
+
+    g_sample_time[index] = portGET_RUN_TIME_COUNTER_VALUE();
+    for (uint32_t core = 0; core < (uint32_t)configNUMBER_OF_CORES; core++) {
+        TaskHandle_t idle = runtime_idle_task(core);
+        g_idle_samples[core][index] = (idle != NULL) ? ulTaskGetRunTimeCounter(idle) : 0;
+    }
+    dmosi_thread_runtime_sample(seq);
+
+    // Wrapping would alias old samples; restart the history instead
+    g_sample_count = (seq + 1 < DMOSI_CPU_NO_SAMPLE) ? seq + 1 : 0;
+    taskEXIT_CRITICAL();
+}
+
+/**
+ * @brief Start the CPU usage sampler (idempotent)
+ *
+ * Called by dmosi_init(); the timer command is queued if the scheduler has
+ * not started yet.
+ */
+void dmosi_runtime_start(void)
+{
+    taskENTER_CRITICAL();
+    bool create = (g_sampler == NULL);
+    if (create) {
+        g_sampler = xTimerCreateStatic("dmosi_cpu", dmosi_ticks_from_ms(DMOSI_CPU_SAMPLE_MS),
+                                       pdTRUE, NULL, runtime_sample, &g_sampler_buffer);
+    }
+    taskEXIT_CRITICAL();
+
+    if (create && g_sampler != NULL) {
+        (void)xTimerStart(g_sampler, 0);
+    }
+}
+
+/**
+ * @brief Find the samples bounding a CPU usage window ending now
+ *
+ * Picks the newest sample that is at least @p window_ms old. Without enough
+ * history the window starts at the oldest sample still kept, or at the
+ * start of the counter while the ring has not wrapped.
+ *
+ * Must be called inside a critical section.
+ *
+ * @param window_ms Window length in milliseconds (0 = since start)
+ * @param window Filled with the window position
+ */
+void dmosi_runtime_window_locked(uint32_t window_ms, dmosi_cpu_window_t* window)
+{
+    window->now = portGET_RUN_TIME_COUNTER_VALUE();
+    window->seq = DMOSI_CPU_NO_SAMPLE;
+    window->start = 0;
+
+    uint64_t hz = runtime_counter_hz();
+    if (window_ms == 0 || hz == 0 || g_sample_count == 0) {
+        return;
+    }
+
+    configRUN_TIME_COUNTER_TYPE span = (configRUN_TIME_COUNTER_TYPE)((uint64_t)window_ms * hz / 1000ULL);
+    uint32_t available = (g_sample_count < DMOSI_CPU_SAMPLES) ? g_sample_count : DMOSI_CPU_SAMPLES;
+
+    for (uint32_t k = 0; k < available; k++) {
+        uint32_t seq = g_sample_count - 1 - k;
+        configRUN_TIME_COUNTER_TYPE time = g_sample_time[seq % DMOSI_CPU_SAMPLES];
+        if (window->now - time >= span || (k + 1 == available && g_sample_count >= DMOSI_CPU_SAMPLES)) {
+            window->seq = seq;
+            window->start = time;
+            return;
+        }
+    }
+}
+
+//==============================================================================
+//                              RUN-TIME STATISTICS API Implementation
+//==============================================================================
+
+/**
+ * @brief Get the frequency of the run-time statistics counter
+ *
+ * @return uint64_t Counter frequency in Hz, 0 if unknown
+ */
+uint64_t dmosi_runtime_get_counter_hz(void)
+{
+    return runtime_counter_hz();
+}
+
+/**
+ * @brief Get the load of a core over a recent time window
+ *
+ * @param core Core index (0 .. dmosi_core_count() - 1)
+ * @param window_ms Window length in milliseconds (0 = since start)
+ * @param usage Set to the share of the window the core was busy, in percent [0, 100]
+ * @return int 0 on success, -EINVAL on invalid arguments
+ */
+int dmosi_core_get_cpu_usage(uint32_t core, uint32_t window_ms, float* usage)
+{
+    if (usage == NULL || core >= (uint32_t)configNUMBER_OF_CORES) {
+        return -EINVAL;
+    }
+
+    TaskHandle_t idle = runtime_idle_task(core);
+    if (idle == NULL) {
+        *usage = 0.0f;
+        return 0;
+    }
+
+    dmosi_cpu_window_t window;
+
+    taskENTER_CRITICAL();
+    dmosi_runtime_window_locked(window_ms, &window);
+    configRUN_TIME_COUNTER_TYPE idle_time = ulTaskGetRunTimeCounter(idle);
+    if (window.seq != DMOSI_CPU_NO_SAMPLE) {
+        idle_time -= g_idle_samples[core][window.seq % DMOSI_CPU_SAMPLES];
+    }
+    taskEXIT_CRITICAL();
+
+    if (window.now == window.start) {
+        *usage = 0.0f;
+        return 0;
+    }
+
+    // The idle counter lags by the idle task's current slice, so clamp
+    float idle_share = dmosi_runtime_share(idle_time, &window);
+    *usage = (idle_share < 100.0f) ? 100.0f - idle_share : 0.0f;
+
+    return 0;
+}
@@ -0,0 +1,79 @@
+#ifndef DMOSI_RUNTIME_H
+#define DMOSI_RUNTIME_H
+
+#include <stdint.h>
+#include "FreeRTOS.h"
+
+/**
+ * @brief Interval between two CPU usage samples in milliseconds
+ *
+ * Configurable via the CMake parameter of the same name. Windowed CPU usage
+ * has this granularity: a window covers at least the requested time and at
+ * most one interval more.
+ */
+#ifndef DMOSI_CPU_SAMPLE_MS
+    #define DMOSI_CPU_SAMPLE_MS     500
+#endif
+
+/**
+ * @brief Number of CPU usage samples kept per thread and core
+ *
+ * Fixed because the samples are part of dmosi_thread_storage_t. With the
+ * default interval the history covers the 10 s window.
+ */
+#define DMOSI_CPU_SAMPLES           21
+
+/**
+ * @brief Sequence number meaning "no sample"
+ */
+#define DMOSI_CPU_NO_SAMPLE         UINT32_MAX
+
+/**
+ * @brief Position of a CPU usage window in the sample history
+ */
+typedef struct {
+    uint32_t seq;                               /**< First sample of the window (DMOSI_CPU_NO_SAMPLE = since start) */
+    configRUN_TIME_COUNTER_TYPE start;          /**< Counter value at the start of the window */
+    configRUN_TIME_COUNTER_TYPE now;            /**< Counter value at the end of the window */
+} dmosi_cpu_window_t;
+
+/**
+ * @brief Start the CPU usage sampler (idempotent)
+ */
+void dmosi_runtime_start(void);
+
+/**
+ * @brief Find the samples bounding a CPU usage window ending now
+ *
+ * Must be called inside a critical section, which also has to cover the
+ * reads of the per-thread samples.
+ *
+ * @param window_ms Window length in milliseconds (0 = since start)
+ * @param window Filled with the window position
+ */
+void dmosi_runtime_window_locked(uint32_t window_ms, dmosi_cpu_window_t* window);
+
+/**
+ * @brief Record the run-time counters of all registered threads
+ *
+ * Implemented by the thread registry; called by the sampler inside a
+ * critical section.
+ *
+ * @param seq Sequence number of the sample
+ */
+void dmosi_thread_runtime_sample(uint32_t seq);
+
+/**
+ * @brief Compute a CPU share from counter deltas
+ *
+ * @param busy Counter ticks spent running
+ * @param window Window the ticks were measured over
+ * @return float Share in percent, not clamped
+ */
+static inline float dmosi_runtime_share(configRUN_TIME_COUNTER_TYPE busy, const dmosi_cpu_window_t* window)
+{
+    configRUN_TIME_COUNTER_TYPE span = window->now - window->start;
+    return (span > 0U) ? (float)busy / (float)span * 100.0f : 0.0f;
+}
+
+#endif /* DMOSI_RUNTIME_H */
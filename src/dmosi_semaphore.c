@@ -2,18 +2,175 @@
 #include <stdbool.h>
 #include <errno.h>
 #include "dmosi.h"
+#include "dmosi_pool.h"
+#include "dmosi_freertos.h"
+#include "dmosi_notify.h"
+#include "dmosi_object_stats.h"
+#include "dmosi_wait.h"
+#include "dmosi_ticks.h"
+#include "dmosi_mpu.h"
 #include "FreeRTOS.h"
-#include "semphr.h"
+#include "task.h"
 
 /**
- * @brief Internal structure to wrap FreeRTOS semaphore handle
- * 
- * This structure wraps the FreeRTOS SemaphoreHandle_t.
+ * @brief A task blocked in dmosi_semaphore_wait()
+ *
+ * Lives on the waiting task's stack and is linked into the semaphore's wait
+ * list for the duration of the wait.
+ */
+struct semaphore_waiter {
+    struct semaphore_waiter* next;  /**< Next waiter (lower or equal priority) */
+    TaskHandle_t task;              /**< Waiting task */
+    UBaseType_t priority;           /**< Priority of the task when it started waiting */
+    uint32_t needed;                /**< Number of units requested */
+    volatile bool granted;          /**< Set once the units were handed over */
+};
+
+/**
+ * @brief Internal counting semaphore
+ *
+ * The count is a plain counter protected by a kernel critical section, so a
+ * wait or post of any number of units is a single atomic operation. Blocked
+ * tasks wait on a dedicated task notification index and are granted their
+ * units in priority order (FIFO among equal priorities); a large request at
+ * the head is never starved by smaller ones behind it.
  */
 struct dmosi_semaphore {
-    SemaphoreHandle_t handle;  /**< FreeRTOS semaphore handle */
+    uint32_t count;                     /**< Units currently available */
+    uint32_t max_count;                 /**< Maximum number of units */
+    struct semaphore_waiter* waiters;   /**< Blocked tasks, highest priority first */
+    bool is_static;                     /**< Whether the wrapper lives in caller-provided storage */
+    dmosi_watch_list_t watchers;        /**< Threads in dmosi_wait_multiple() on this semaphore */
+#if DMOSI_OBJECT_STATS
+    dmosi_object_record_t stats;        /**< Usage statistics */
+#endif
 };
 
+_Static_assert(sizeof(struct dmosi_semaphore) <= sizeof(dmosi_semaphore_storage_t),
+               "dmosi_semaphore_storage_t is too small for struct dmosi_semaphore");
+_Static_assert(_Alignof(struct dmosi_semaphore) <= _Alignof(dmosi_semaphore_storage_t),
+               "dmosi_semaphore_storage_t is under-aligned for struct dmosi_semaphore");
+
+/**
+ * @brief Pool serving struct dmosi_semaphore wrappers (see DMOSI_SEMAPHORE_POOL_SIZE)
+ */
+DMOSI_POOL_DEFINE(g_dmosi_semaphore_pool, struct dmosi_semaphore, DMOSI_SEMAPHORE_POOL_SIZE);
+
+/**
+ * @brief Validate semaphore creation parameters
+ *
+ * @param initial_count Initial count for the semaphore
+ * @param max_count Maximum count for the semaphore
+ * @return true if the parameters are valid
+ */
+static bool semaphore_params_valid(uint32_t initial_count, uint32_t max_count)
+{
+    if (max_count == 0 || initial_count > max_count) {
+        DMOD_LOG_ERROR("Invalid semaphore parameters: initial_count=%u, max_count=%u\n", initial_count, max_count);
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Initialize a semaphore
+ *
+ * @param semaphore Semaphore to initialize
+ * @param initial_count Initial count for the semaphore
+ * @param max_count Maximum count for the semaphore
+ * @param is_static Whether the wrapper lives in caller-provided storage
+ */
+static void semaphore_init(struct dmosi_semaphore* semaphore, uint32_t initial_count, uint32_t max_count, bool is_static)
+{
+    semaphore->count = initial_count;
+    semaphore->max_count = max_count;
+    semaphore->waiters = NULL;
+    semaphore->is_static = is_static;
+    dmosi_watch_init(&semaphore->watchers);
+#if DMOSI_OBJECT_STATS
+    dmosi_object_register(&semaphore->stats, semaphore, DMOSI_OBJECT_TYPE_SEMAPHORE);
+#endif
+}
+
+/**
+ * @brief Account the outcome of a wait or post (DMOSI_OBJECT_STATS)
+ *
+ * @param semaphore Semaphore
+ * @param passed Whether the operation succeeded
+ */
+static inline void semaphore_account(struct dmosi_semaphore* semaphore, bool passed)
+{
+#if DMOSI_OBJECT_STATS
+    dmosi_object_account(&semaphore->stats, passed ? 1U : 0U, !passed);
+#else
+    (void)semaphore;
+    (void)passed;
+#endif
+}
+
+/**
+ * @brief Insert a waiter into the wait list in priority order
+ *
+ * Must be called inside a critical section.
+ *
+ * @param semaphore Semaphore to wait on
+ * @param waiter Waiter to insert (behind waiters of equal priority)
+ */
+static void semaphore_enqueue_locked(struct dmosi_semaphore* semaphore, struct semaphore_waiter* waiter)
+{
+    struct semaphore_waiter** link = &semaphore->waiters;
+    while (*link != NULL && (*link)->priority >= waiter->priority) {
+        link = &(*link)->next;
+    }
+    waiter->next = *link;
+    *link = waiter;
+}
+
+/**
+ * @brief Remove a waiter from the wait list
+ *
+ * Must be called inside a critical section.
+ *
+ * @param semaphore Semaphore the waiter is queued on
+ * @param waiter Waiter to remove (ignored if not queued)
+ */
+static void semaphore_dequeue_locked(struct dmosi_semaphore* semaphore, struct semaphore_waiter* waiter)
+{
+    for (struct semaphore_waiter** link = &semaphore->waiters; *link != NULL; link = &(*link)->next) {
+        if (*link == waiter) {
+            *link = waiter->next;
+            return;
+        }
+    }
+}
+
+/**
+ * @brief Hand available units to waiters at the head of the wait list
+ *
+ * Must be called inside a critical section (the ISR variant when
+ * @p higher_priority_task_woken is not NULL).
+ *
+ * @param semaphore Semaphore to grant from
+ * @param higher_priority_task_woken NULL in task context, otherwise collects
+ *        whether a context switch is required on ISR exit
+ */
+static void semaphore_grant_locked(struct dmosi_semaphore* semaphore, BaseType_t* higher_priority_task_woken)
+{
+    struct semaphore_waiter* waiter;
+
+    while ((waiter = semaphore->waiters) != NULL && semaphore->count >= waiter->needed) {
+        semaphore->count -= waiter->needed;
+        semaphore->waiters = waiter->next;
+        waiter->granted = true;
+
+        if (higher_priority_task_woken != NULL) {
+            vTaskNotifyGiveIndexedFromISR(waiter->task, DMOSI_NOTIFY_INDEX_WAIT, higher_priority_task_woken);
+        } else {
+            xTaskNotifyGiveIndexed(waiter->task, DMOSI_NOTIFY_INDEX_WAIT);
+        }
+    }
+}
+
 //==============================================================================
 //                              SEMAPHORE API Implementation
 //==============================================================================
@@ -21,8 +178,7 @@ struct dmosi_semaphore {
 /**
  * @brief Create a semaphore
  * 
- * Creates a counting semaphore with the specified initial and maximum counts
- * using FreeRTOS API.
+ * Creates a counting semaphore with the specified initial and maximum counts.
  * 
  * @param initial_count Initial count for the semaphore
  * @param max_count Maximum count for the semaphore
@@ -30,104 +186,219 @@ struct dmosi_semaphore {
  */
 DMOD_INPUT_API_DECLARATION( dmosi, 1.0, dmosi_semaphore_t, _semaphore_create, (uint32_t initial_count, uint32_t max_count) )
 {
-    if (max_count == 0 || initial_count > max_count) {
-        DMOD_LOG_ERROR("Invalid semaphore parameters: initial_count=%u, max_count=%u\n", initial_count, max_count);
+    DMOSI_MPU_PRIVILEGED_SCOPE();
+
+    if (!semaphore_params_valid(initial_count, max_count)) {
         return NULL;
     }
 
-    struct dmosi_semaphore* semaphore = pvPortMalloc(sizeof(*semaphore));
+    struct dmosi_semaphore* semaphore = dmosi_pool_alloc(&g_dmosi_semaphore_pool);
     if (semaphore == NULL) {
         DMOD_LOG_ERROR("Failed to allocate memory for semaphore\n");
         return NULL;
     }
 
-    semaphore->handle = xSemaphoreCreateCounting(max_count, initial_count);
-    if (semaphore->handle == NULL) {
-        DMOD_LOG_ERROR("Failed to create FreeRTOS counting semaphore\n");
-        vPortFree(semaphore);
+    semaphore_init(semaphore, initial_count, max_count, false);
+    return semaphore;
+}
+
+/**
+ * @brief Create a counting semaphore in caller-provided storage
+ *
+ * Works like dmosi_semaphore_create() but places the semaphore in
+ * @p storage, so no memory is allocated. The
+ * storage must stay valid until dmosi_semaphore_destroy() is called.
+ *
+ * @param storage Storage for the semaphore
+ * @param initial_count Initial count for the semaphore
+ * @param max_count Maximum count for the semaphore
+ * @return dmosi_semaphore_t Created semaphore handle, NULL on failure
+ */
+dmosi_semaphore_t dmosi_semaphore_create_static(dmosi_semaphore_storage_t* storage, uint32_t initial_count, uint32_t max_count)
+{
+    if (storage == NULL || !semaphore_params_valid(initial_count, max_count)) {
         return NULL;
     }
 
+    struct dmosi_semaphore* semaphore = (struct dmosi_semaphore*)storage;
+    semaphore_init(semaphore, initial_count, max_count, true);
     return semaphore;
 }
 
 /**
  * @brief Destroy a semaphore
  * 
- * Destroys a semaphore and frees associated resources.
+ * Destroys a semaphore and frees associated resources. For a semaphore
+ * created with dmosi_semaphore_create_static() the caller-provided storage
+ * may be reused once this returns.
  * 
  * @param semaphore Semaphore handle to destroy
  */
 DMOD_INPUT_API_DECLARATION( dmosi, 1.0, void, _semaphore_destroy, (dmosi_semaphore_t semaphore) )
 {
+    DMOSI_MPU_PRIVILEGED_SCOPE();
+
     if (semaphore == NULL) {
         return;
     }
+
+#if DMOSI_OBJECT_STATS
+    dmosi_object_unregister(&semaphore->stats);
+#endif
     
-    // Defensive check: handle should never be NULL for a valid semaphore,
-    // but check anyway to prevent undefined behavior
-    if (semaphore->handle != NULL) {
-        vSemaphoreDelete(semaphore->handle);
+    if (!semaphore->is_static) {
+        dmosi_pool_free(&g_dmosi_semaphore_pool, semaphore);
     }
-    
-    vPortFree(semaphore);
 }
 
 /**
- * @brief Wait on a semaphore (decrement)
- * 
- * Waits on a semaphore, blocking until the semaphore count is greater than zero
- * or the timeout expires.
- * 
+ * @brief Take units from a semaphore within a timeout in ticks
+ *
+ * Common implementation of dmosi_semaphore_wait() and
+ * dmosi_semaphore_wait_ticks().
+ *
  * @param semaphore Semaphore handle
  * @param count Number of semaphore units to take
- * @param timeout_ms Timeout in milliseconds (0 = no wait, -1 = wait forever)
+ * @param ticks Timeout in ticks (0 = no wait, portMAX_DELAY = wait forever)
  * @return int 0 on success, negative error code on failure
  */
-DMOD_INPUT_API_DECLARATION( dmosi, 2.0, int, _semaphore_wait, (dmosi_semaphore_t semaphore, uint32_t count, int32_t timeout_ms) )
+static int semaphore_wait(dmosi_semaphore_t semaphore, uint32_t count, TickType_t ticks)
 {
     if (semaphore == NULL) {
         DMOD_LOG_ERROR("Invalid semaphore handle (NULL)\n");
         return -EINVAL;
     }
 
-    if (timeout_ms != 0 && !dmosi_is_started()) {
+    if (count > semaphore->max_count) {
+        DMOD_LOG_ERROR("Cannot take %u units from a semaphore with max_count=%u\n", count, semaphore->max_count);
+        return -EINVAL;
+    }
+
+    if (ticks != 0 && !dmosi_is_started()) {
         return -ENOTSUP;
     }
 
-    TickType_t ticks;
-    
-    if (timeout_ms < 0) {
-        // Wait forever
-        ticks = portMAX_DELAY;
-    } else if (timeout_ms == 0) {
-        // No wait
-        ticks = 0;
-    } else {
-        // Convert milliseconds to ticks
-        ticks = pdMS_TO_TICKS(timeout_ms);
-    }
-
-    for (uint32_t i = 0; i < count; i++) {
-        BaseType_t result = xSemaphoreTake(semaphore->handle, ticks);
-        if (result != pdTRUE) {
-            if (ticks == 0) {
-                return -EAGAIN;  // Would block
-            } else {
-                return -ETIMEDOUT;  // Timeout occurred
-            }
+    struct semaphore_waiter waiter = {
+        .next = NULL,
+        .task = NULL,
+        .priority = 0,
+        .needed = count,
+        .granted = false,
+    };
+
+    taskENTER_CRITICAL();
+    // Only take directly when nobody is queued, so waiters are served in order
+    if (semaphore->waiters == NULL && semaphore->count >= count) {
+        semaphore->count -= count;
+        taskEXIT_CRITICAL();
+        semaphore_account(semaphore, true);
+        return 0;
+    }
+    if (ticks == 0) {
+        taskEXIT_CRITICAL();
+        semaphore_account(semaphore, false);
+        return -EAGAIN;  // Would block
+    }
+    waiter.task = xTaskGetCurrentTaskHandle();
+    waiter.priority = uxTaskPriorityGet(NULL);
+    semaphore_enqueue_locked(semaphore, &waiter);
+#if DMOSI_OBJECT_STATS
+    uint32_t waiting = 0;
+    for (const struct semaphore_waiter* queued = semaphore->waiters; queued != NULL; queued = queued->next) {
+        waiting++;
+    }
+    dmosi_object_account_level(&semaphore->stats, waiting);
+#endif
+    taskEXIT_CRITICAL();
+
+#if DMOSI_OBJECT_STATS
+    uint64_t wait_start = dmosi_get_time_us();
+#endif
+
+    TimeOut_t timeout;
+    vTaskSetTimeOutState(&timeout);
+
+    for (;;) {
+        ulTaskNotifyTakeIndexed(DMOSI_NOTIFY_INDEX_WAIT, pdTRUE, ticks);
+
+        if (waiter.granted) {
+#if DMOSI_OBJECT_STATS
+            dmosi_object_account_wait(&semaphore->stats, wait_start);
+#endif
+            semaphore_account(semaphore, true);
+            return 0;
+        }
+
+        if (xTaskCheckForTimeOut(&timeout, &ticks) == pdTRUE) {
+            break;
         }
     }
 
-    return 0;
+    bool granted;
+    taskENTER_CRITICAL();
+    // A post may have granted the units after the timeout was detected
+    granted = waiter.granted;
+    if (!granted) {
+        semaphore_dequeue_locked(semaphore, &waiter);
+        // This waiter may have been holding back smaller requests behind it
+        semaphore_grant_locked(semaphore, NULL);
+    }
+    taskEXIT_CRITICAL();
+
+#if DMOSI_OBJECT_STATS
+    dmosi_object_account_wait(&semaphore->stats, wait_start);
+#endif
+    semaphore_account(semaphore, granted);
+    if (!granted) {
+        // Units this waiter was holding back may now be free for others
+        dmosi_watch_notify(&semaphore->watchers);
+    }
+
+    return granted ? 0 : -ETIMEDOUT;
+}
+
+/**
+ * @brief Wait on a semaphore (decrement)
+ * 
+ * Takes @p count units atomically: either all of them are taken, or none.
+ * Blocks until enough units are available or the timeout expires; the
+ * timeout is a single deadline for the whole request, however many posts
+ * it takes to satisfy it.
+ * 
+ * @param semaphore Semaphore handle
+ * @param count Number of semaphore units to take
+ * @param timeout_ms Timeout in milliseconds (0 = no wait, -1 = wait forever)
+ * @return int 0 on success, negative error code on failure
+ */
+DMOD_INPUT_API_DECLARATION( dmosi, 2.0, int, _semaphore_wait, (dmosi_semaphore_t semaphore, uint32_t count, int32_t timeout_ms) )
+{
+    DMOSI_MPU_PRIVILEGED_SCOPE();
+
+    return semaphore_wait(semaphore, count, dmosi_ticks_from_timeout(timeout_ms));
+}
+
+/**
+ * @brief Wait on a semaphore with a timeout in ticks
+ *
+ * Skips the millisecond conversion of dmosi_semaphore_wait().
+ *
+ * @param semaphore Semaphore handle
+ * @param count Number of semaphore units to take
+ * @param ticks Timeout in ticks (0 = no wait, DMOSI_TICKS_FOREVER = wait forever)
+ * @return int 0 on success, negative error code on failure
+ */
+int dmosi_semaphore_wait_ticks(dmosi_semaphore_t semaphore, uint32_t count, uint32_t ticks)
+{
+    return semaphore_wait(semaphore, count, dmosi_ticks_from_api(ticks));
 }
 
 /**
  * @brief Post to a semaphore (increment)
  *
- * Increments the semaphore count, potentially unblocking a waiting thread.
- * Safe to call from both task and interrupt context: the FreeRTOS "FromISR"
- * API is used automatically when called from an interrupt handler.
+ * Releases @p count units atomically, potentially unblocking waiting threads.
+ * Fails without releasing anything if the maximum count would be exceeded.
+ * Safe to call from both task and interrupt context; from an interrupt at
+ * most one context switch is requested, on exit from the handler.
  *
  * @param semaphore Semaphore handle
  * @param count Number of semaphore units to release
@@ -135,32 +406,74 @@ DMOD_INPUT_API_DECLARATION( dmosi, 2.0, int, _semaphore_wait, (dmosi_semaphore_t
  */
 DMOD_INPUT_API_DECLARATION( dmosi, 2.0, int, _semaphore_post, (dmosi_semaphore_t semaphore, uint32_t count) )
 {
+    DMOSI_MPU_PRIVILEGED_SCOPE();
+
     if (semaphore == NULL) {
         DMOD_LOG_ERROR("Invalid semaphore handle (NULL)\n");
         return -EINVAL;
     }
 
+    bool overflow = false;
+
     if (xPortIsInsideInterrupt()) {
         BaseType_t xHigherPriorityTaskWoken = pdFALSE;
 
-        for (uint32_t i = 0; i < count; i++) {
-            BaseType_t result = xSemaphoreGiveFromISR(semaphore->handle, &xHigherPriorityTaskWoken);
-            if (result != pdTRUE) {
-                DMOD_LOG_ERROR("Failed to post semaphore from ISR (overflow or invalid state)\n");
-                return -EOVERFLOW;
-            }
+        UBaseType_t saved = taskENTER_CRITICAL_FROM_ISR();
+        if (count > semaphore->max_count - semaphore->count) {
+            overflow = true;
+        } else {
+            semaphore->count += count;
+            semaphore_grant_locked(semaphore, &xHigherPriorityTaskWoken);
         }
+        taskEXIT_CRITICAL_FROM_ISR(saved);
 
         portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
     } else {
-        for (uint32_t i = 0; i < count; i++) {
-            BaseType_t result = xSemaphoreGive(semaphore->handle);
-            if (result != pdTRUE) {
-                DMOD_LOG_ERROR("Failed to post semaphore (overflow or invalid state)\n");
-                return -EOVERFLOW;
-            }
+        taskENTER_CRITICAL();
+        if (count > semaphore->max_count - semaphore->count) {
+            overflow = true;
+        } else {
+            semaphore->count += count;
+            semaphore_grant_locked(semaphore, NULL);
         }
+        taskEXIT_CRITICAL();
     }
 
+    if (overflow) {
+        DMOD_LOG_ERROR("Failed to post semaphore (overflow)\n");
+        return -EOVERFLOW;
+    }
+
+    semaphore_account(semaphore, true);
+    dmosi_watch_notify(&semaphore->watchers);
+
     return 0;
 }
+
+/**
+ * @brief Get the watcher list of a semaphore
+ *
+ * Lets dmosi_wait_multiple() register on the semaphore without exposing
+ * the semaphore structure.
+ *
+ * @param semaphore Semaphore handle
+ * @return dmosi_watch_list_t* Watcher list of @p semaphore
+ */
+dmosi_watch_list_t* dmosi_semaphore_watch_list(dmosi_semaphore_t semaphore)
+{
+    return &semaphore->watchers;
+}
+
+/**
+ * @brief Check whether a unit can be taken from a semaphore
+ *
+ * Mirrors the direct path of dmosi_semaphore_wait(): queued waiters are
+ * served first. Must be called inside a critical section.
+ *
+ * @param semaphore Semaphore handle
+ * @return true if a wait for one unit would not block
+ */
+bool dmosi_semaphore_ready_locked(dmosi_semaphore_t semaphore)
+{
+    return semaphore->waiters == NULL && semaphore->count > 0;
+}
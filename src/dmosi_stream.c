@@ -0,0 +1,535 @@
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <errno.h>
+#include "dmosi.h"
+#include "dmosi_freertos.h"
+#include "dmosi_notify.h"
+#include "dmosi_ticks.h"
+#include "FreeRTOS.h"
+#include "task.h"
+
+/**
+ * @brief Internal structure of a byte stream
+ *
+ * A ring of @ref size bytes shared by a single writer and a single reader,
+ * following the same model as FreeRTOS stream buffers. The writer owns
+ * @ref head and the free region, the reader owns @ref tail and the filled
+ * region, so data is copied (or produced in place) outside of any critical
+ * section; only @ref count and the blocked-task slots are updated inside one.
+ * The buffer storage follows the structure in the same allocation.
+ */
+struct dmosi_stream {
+    uint8_t* buffer;            /**< Ring storage */
+    size_t size;                /**< Capacity of the ring in bytes */
+    size_t head;                /**< Next write position (writer-owned) */
+    size_t tail;                /**< Next read position (reader-owned) */
+    volatile size_t count;      /**< Bytes currently stored */
+    size_t trigger_level;       /**< Bytes required to unblock a reader */
+    size_t reserved;            /**< Bytes handed out by the last reserve (writer-owned) */
+    size_t peeked;              /**< Bytes handed out by the last peek (reader-owned) */
+    TaskHandle_t reader;        /**< Reader blocked waiting for data (NULL if none) */
+    size_t reader_needed;       /**< Bytes the blocked reader waits for */
+    TaskHandle_t writer;        /**< Writer blocked waiting for space (NULL if none) */
+    size_t writer_needed;       /**< Free bytes the blocked writer waits for */
+};
+
+/**
+ * @brief Get the number of bytes one side of the stream can work with
+ *
+ * @param stream Stream handle
+ * @param reader true for the stored bytes, false for the free bytes
+ * @return size_t Bytes available to that side
+ */
+static size_t stream_level(const struct dmosi_stream* stream, bool reader)
+{
+    return reader ? stream->count : stream->size - stream->count;
+}
+
+/**
+ * @brief Block until one side of the stream has enough bytes available
+ *
+ * Registers the caller in the blocked-task slot of its side and sleeps on
+ * the dmosi wait notification index until the other side has advanced far
+ * enough or the deadline passes. Must not be called from an interrupt.
+ *
+ * @param stream Stream handle
+ * @param reader true to wait for data, false to wait for free space
+ * @param needed Number of bytes to wait for
+ * @param ticks Timeout in ticks (0 = no wait, portMAX_DELAY = wait forever)
+ * @return int 0 when enough bytes are available, -EAGAIN or -ETIMEDOUT otherwise
+ */
+static int stream_wait(struct dmosi_stream* stream, bool reader, size_t needed, TickType_t ticks)
+{
+    TaskHandle_t* slot = reader ? &stream->reader : &stream->writer;
+    size_t* slot_needed = reader ? &stream->reader_needed : &stream->writer_needed;
+    bool no_wait = (ticks == 0);
+    TimeOut_t timeout;
+
+    vTaskSetTimeOutState(&timeout);
+
+    for (;;) {
+        bool ready;
+
+        taskENTER_CRITICAL();
+        ready = stream_level(stream, reader) >= needed;
+        if (ready || no_wait) {
+            *slot = NULL;
+        } else {
+            *slot = xTaskGetCurrentTaskHandle();
+            *slot_needed = needed;
+        }
+        taskEXIT_CRITICAL();
+
+        if (ready) {
+            return 0;
+        }
+
+        if (xTaskCheckForTimeOut(&timeout, &ticks) == pdTRUE) {
+            taskENTER_CRITICAL();
+            *slot = NULL;
+            taskEXIT_CRITICAL();
+            return no_wait ? -EAGAIN : -ETIMEDOUT;
+        }
+
+        ulTaskNotifyTakeIndexed(DMOSI_NOTIFY_INDEX_WAIT, pdTRUE, ticks);
+    }
+}
+
+/**
+ * @brief Publish bytes written by the writer or release bytes read by the reader
+ *
+ * Advances the owning side's position, updates the byte count and wakes the
+ * other side if it is blocked and now has enough bytes. Safe to call from
+ * both task and interrupt context; from an interrupt at most one context
+ * switch is requested, on exit from the handler.
+ *
+ * @param stream Stream handle
+ * @param writer true to publish written bytes, false to release read bytes
+ * @param n Number of bytes
+ */
+static void stream_advance(struct dmosi_stream* stream, bool writer, size_t n)
+{
+    bool in_isr = xPortIsInsideInterrupt();
+    BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+    UBaseType_t saved = 0;
+
+    if (in_isr) {
+        saved = taskENTER_CRITICAL_FROM_ISR();
+    } else {
+        taskENTER_CRITICAL();
+    }
+
+    TaskHandle_t* peer;
+    size_t peer_needed;
+    if (writer) {
+        stream->head = (stream->head + n) % stream->size;
+        stream->count += n;
+        peer = &stream->reader;
+        peer_needed = stream->reader_needed;
+    } else {
+        stream->tail = (stream->tail + n) % stream->size;
+        stream->count -= n;
+        peer = &stream->writer;
+        peer_needed = stream->writer_needed;
+    }
+
+    TaskHandle_t to_wake = NULL;
+    if (*peer != NULL && stream_level(stream, !writer) >= peer_needed) {
+        to_wake = *peer;
+        *peer = NULL;
+    }
+
+    if (to_wake != NULL) {
+        if (in_isr) {
+            vTaskNotifyGiveIndexedFromISR(to_wake, DMOSI_NOTIFY_INDEX_WAIT, &xHigherPriorityTaskWoken);
+        } else {
+            xTaskNotifyGiveIndexed(to_wake, DMOSI_NOTIFY_INDEX_WAIT);
+        }
+    }
+
+    if (in_isr) {
+        taskEXIT_CRITICAL_FROM_ISR(saved);
+        portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
+    } else {
+        taskEXIT_CRITICAL();
+    }
+}
+
+/**
+ * @brief Convert a dmosi timeout to ticks for a stream operation
+ *
+ * Interrupt handlers never block, so the timeout is ignored there.
+ *
+ * @param timeout_ms Timeout in milliseconds (0 = no wait, -1 = wait forever)
+ * @param ticks Set to the timeout in ticks
+ * @return int 0 on success, -ENOTSUP if blocking is requested before the scheduler started
+ */
+static int stream_timeout_to_ticks(int32_t timeout_ms, TickType_t* ticks)
+{
+    if (timeout_ms == 0 || xPortIsInsideInterrupt()) {
+        // No wait
+        *ticks = 0;
+        return 0;
+    }
+
+    if (!dmosi_is_started()) {
+        return -ENOTSUP;
+    }
+
+    *ticks = dmosi_ticks_from_timeout(timeout_ms);
+
+    return 0;
+}
+
+//==============================================================================
+//                              STREAM API Implementation
+//==============================================================================
+
+/**
+ * @brief Create a byte stream
+ *
+ * @param size Capacity of the stream in bytes
+ * @param trigger_level Bytes that must be available before a blocked reader
+ *        is woken (0 is treated as 1)
+ * @return dmosi_stream_t Created stream handle, NULL on failure
+ */
+dmosi_stream_t dmosi_stream_create(size_t size, size_t trigger_level)
+{
+    if (trigger_level == 0) {
+        trigger_level = 1;
+    }
+
+    if (size == 0 || trigger_level > size) {
+        DMOD_LOG_ERROR("Invalid stream parameters: size=%zu, trigger_level=%zu\n", size, trigger_level);
+        return NULL;
+    }
+
+    struct dmosi_stream* stream = pvPortMalloc(sizeof(*stream) + size);
+    if (stream == NULL) {
+        DMOD_LOG_ERROR("Failed to allocate memory for stream\n");
+        return NULL;
+    }
+
+    memset(stream, 0, sizeof(*stream));
+    stream->buffer = (uint8_t*)(stream + 1);
+    stream->size = size;
+    stream->trigger_level = trigger_level;
+
+    return stream;
+}
+
+/**
+ * @brief Destroy a byte stream
+ *
+ * No task may be blocked on the stream when it is destroyed.
+ *
+ * @param stream Stream handle to destroy
+ */
+void dmosi_stream_destroy(dmosi_stream_t stream)
+{
+    if (stream == NULL) {
+        return;
+    }
+
+    vPortFree(stream);
+}
+
+/**
+ * @brief Set the trigger level of a byte stream
+ *
+ * @param stream Stream handle
+ * @param trigger_level Bytes that must be available before a blocked reader
+ *        is woken (1 to the stream size)
+ * @return int 0 on success, -EINVAL on invalid arguments
+ */
+int dmosi_stream_set_trigger_level(dmosi_stream_t stream, size_t trigger_level)
+{
+    if (stream == NULL || trigger_level == 0 || trigger_level > stream->size) {
+        return -EINVAL;
+    }
+
+    taskENTER_CRITICAL();
+    stream->trigger_level = trigger_level;
+    taskEXIT_CRITICAL();
+
+    return 0;
+}
+
+/**
+ * @brief Get the number of bytes stored in a byte stream
+ *
+ * @param stream Stream handle
+ * @return size_t Bytes available for reading (0 if @p stream is NULL)
+ */
+size_t dmosi_stream_bytes_available(dmosi_stream_t stream)
+{
+    return (stream != NULL) ? stream->count : 0;
+}
+
+/**
+ * @brief Write bytes to a byte stream
+ *
+ * Blocks until there is room for all @p len bytes (or the whole stream, if
+ * @p len exceeds it) or the timeout expires, then writes as many bytes as
+ * fit. Safe to call from an interrupt handler, where it never blocks.
+ *
+ * @param stream Stream handle
+ * @param data Bytes to write
+ * @param len Number of bytes to write
+ * @param sent Set to the number of bytes actually written (can be NULL)
+ * @param timeout_ms Timeout in milliseconds (0 = no wait, -1 = wait forever)
+ * @return int 0 if all bytes were written, negative error code otherwise
+ */
+int dmosi_stream_send(dmosi_stream_t stream, const void* data, size_t len, size_t* sent, int32_t timeout_ms)
+{
+    if (sent != NULL) {
+        *sent = 0;
+    }
+
+    if (stream == NULL || (data == NULL && len > 0)) {
+        DMOD_LOG_ERROR("Invalid stream or data (NULL)\n");
+        return -EINVAL;
+    }
+
+    TickType_t ticks;
+    int result = stream_timeout_to_ticks(timeout_ms, &ticks);
+    if (result != 0) {
+        return result;
+    }
+
+    if (!xPortIsInsideInterrupt()) {
+        result = stream_wait(stream, false, (len < stream->size) ? len : stream->size, ticks);
+    }
+
+    size_t n = stream_level(stream, false);
+    if (n > len) {
+        n = len;
+    }
+
+    if (n > 0) {
+        // Copy in up to two segments: up to the end of the ring, then from its start
+        size_t first = stream->size - stream->head;
+        if (first > n) {
+            first = n;
+        }
+        memcpy(stream->buffer + stream->head, data, first);
+        memcpy(stream->buffer, (const uint8_t*)data + first, n - first);
+        stream_advance(stream, true, n);
+    }
+
+    if (sent != NULL) {
+        *sent = n;
+    }
+
+    if (n == len) {
+        return 0;
+    }
+    return (result != 0) ? result : -EAGAIN;
+}
+
+/**
+ * @brief Read bytes from a byte stream
+ *
+ * Blocks until at least the trigger level (or @p len, if smaller) bytes are
+ * available or the timeout expires, then reads up to @p len bytes. Safe to
+ * call from an interrupt handler, where it never blocks.
+ *
+ * @param stream Stream handle
+ * @param buffer Buffer for the bytes
+ * @param len Size of @p buffer in bytes
+ * @param received Set to the number of bytes actually read (can be NULL)
+ * @param timeout_ms Timeout in milliseconds (0 = no wait, -1 = wait forever)
+ * @return int 0 if at least one byte was read, negative error code otherwise
+ */
+int dmosi_stream_receive(dmosi_stream_t stream, void* buffer, size_t len, size_t* received, int32_t timeout_ms)
+{
+    if (received != NULL) {
+        *received = 0;
+    }
+
+    if (stream == NULL || buffer == NULL || len == 0) {
+        DMOD_LOG_ERROR("Invalid stream or buffer (NULL)\n");
+        return -EINVAL;
+    }
+
+    TickType_t ticks;
+    int result = stream_timeout_to_ticks(timeout_ms, &ticks);
+    if (result != 0) {
+        return result;
+    }
+
+    if (!xPortIsInsideInterrupt()) {
+        result = stream_wait(stream, true, (len < stream->trigger_level) ? len : stream->trigger_level, ticks);
+    }
+
+    // On timeout, hand out whatever is there even if below the trigger level
+    size_t n = stream_level(stream, true);
+    if (n > len) {
+        n = len;
+    }
+
+    if (n > 0) {
+        size_t first = stream->size - stream->tail;
+        if (first > n) {
+            first = n;
+        }
+        memcpy(buffer, stream->buffer + stream->tail, first);
+        memcpy((uint8_t*)buffer + first, stream->buffer, n - first);
+        stream_advance(stream, false, n);
+    }
+
+    if (received != NULL) {
+        *received = n;
+    }
+
+    if (n > 0) {
+        return 0;
+    }
+    return (result != 0) ? result : -EAGAIN;
+}
+
+/**
+ * @brief Reserve free space in a byte stream for in-place writing
+ *
+ * Hands out a pointer to the largest contiguous free region of at most
+ * @p len bytes, blocking until at least one byte is free or the timeout
+ * expires. The writer fills the region directly and publishes it with
+ * dmosi_stream_commit(). Safe to call from an interrupt handler, where it
+ * never blocks.
+ *
+ * @param stream Stream handle
+ * @param data Set to the start of the reserved region
+ * @param len In: maximum bytes wanted; out: bytes actually reserved
+ * @param timeout_ms Timeout in milliseconds (0 = no wait, -1 = wait forever)
+ * @return int 0 on success, negative error code on failure
+ */
+int dmosi_stream_reserve(dmosi_stream_t stream, void** data, size_t* len, int32_t timeout_ms)
+{
+    if (stream == NULL || data == NULL || len == NULL || *len == 0) {
+        return -EINVAL;
+    }
+
+    TickType_t ticks;
+    int result = stream_timeout_to_ticks(timeout_ms, &ticks);
+    if (result != 0) {
+        return result;
+    }
+
+    if (!xPortIsInsideInterrupt()) {
+        result = stream_wait(stream, false, 1, ticks);
+    } else if (stream_level(stream, false) == 0) {
+        result = -EAGAIN;
+    }
+
+    if (result != 0) {
+        stream->reserved = 0;
+        *len = 0;
+        return result;
+    }
+
+    size_t n = stream_level(stream, false);
+    if (n > stream->size - stream->head) {
+        n = stream->size - stream->head;
+    }
+    if (n > *len) {
+        n = *len;
+    }
+
+    stream->reserved = n;
+    *data = stream->buffer + stream->head;
+    *len = n;
+
+    return 0;
+}
+
+/**
+ * @brief Publish bytes written in place after dmosi_stream_reserve()
+ *
+ * @param stream Stream handle
+ * @param len Number of bytes written (at most the reserved length)
+ * @return int 0 on success, -EINVAL on invalid arguments
+ */
+int dmosi_stream_commit(dmosi_stream_t stream, size_t len)
+{
+    if (stream == NULL || len > stream->reserved) {
+        return -EINVAL;
+    }
+
+    stream->reserved = 0;
+    if (len > 0) {
+        stream_advance(stream, true, len);
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Look at stored bytes of a byte stream without copying them
+ *
+ * Hands out a pointer to the largest contiguous stored region of at most
+ * @p len bytes, blocking like dmosi_stream_receive() until the trigger
+ * level is reached or the timeout expires. The reader processes the region
+ * in place and releases it with dmosi_stream_consume(). Safe to call from
+ * an interrupt handler, where it never blocks.
+ *
+ * @param stream Stream handle
+ * @param data Set to the start of the stored region
+ * @param len In: maximum bytes wanted; out: bytes actually available
+ * @param timeout_ms Timeout in milliseconds (0 = no wait, -1 = wait forever)
+ * @return int 0 if at least one byte is available, negative error code otherwise
+ */
+int dmosi_stream_peek(dmosi_stream_t stream, const void** data, size_t* len, int32_t timeout_ms)
+{
+    if (stream == NULL || data == NULL || len == NULL || *len == 0) {
+        return -EINVAL;
+    }
+
+    TickType_t ticks;
+    int result = stream_timeout_to_ticks(timeout_ms, &ticks);
+    if (result != 0) {
+        return result;
+    }
+
+    if (!xPortIsInsideInterrupt()) {
+        result = stream_wait(stream, true, (*len < stream->trigger_level) ? *len : stream->trigger_level, ticks);
+    }
+
+    size_t n = stream_level(stream, true);
+    if (n > stream->size - stream->tail) {
+        n = stream->size - stream->tail;
+    }
+    if (n > *len) {
+        n = *len;
+    }
+
+    stream->peeked = n;
+    *data = stream->buffer + stream->tail;
+    *len = n;
+
+    if (n > 0) {
+        return 0;
+    }
+    return (result != 0) ? result : -EAGAIN;
+}
+
+/**
+ * @brief Release bytes looked at with dmosi_stream_peek()
+ *
+ * @param stream Stream handle
+ * @param len Number of bytes processed (at most the peeked length)
+ * @return int 0 on success, -EINVAL on invalid arguments
+ */
+int dmosi_stream_consume(dmosi_stream_t stream, size_t len)
+{
+    if (stream == NULL || len > stream->peeked) {
+        return -EINVAL;
+    }
+
+    stream->peeked = 0;
+    if (len > 0) {
+        stream_advance(stream, false, len);
+    }
+
+    return 0;
+}
@@ -6,11 +6,14 @@
 #include <errno.h>
 #include <stdint.h>
 #include <limits.h>
-#if defined(__unix__) || defined(__APPLE__)
-#include <unistd.h>
-#endif
+#include <string.h>
 #include "dmosi.h"
+#include "dmosi_freertos.h"
+#include "dmosi_heap.h"
+#include "dmosi_runtime.h"
+#include "dmosi_mpu.h"
 #include "dmod.h"
+#include "dmosi_ticks.h"
 #include "FreeRTOS.h"
 #include "task.h"
 #if DMOD_USE_PTHREAD && defined(__linux__)
@@ -53,6 +56,57 @@
  */
 static dmosi_process_t g_init_process = NULL;
 
+/**
+ * @brief Number of per-process buckets of the thread registry
+ *
+ * Configurable via the CMake parameter of the same name. Must be a power of two.
+ */
+#ifndef DMOSI_THREAD_REGISTRY_BUCKETS
+    #define DMOSI_THREAD_REGISTRY_BUCKETS    16
+#endif
+
+_Static_assert((DMOSI_THREAD_REGISTRY_BUCKETS & (DMOSI_THREAD_REGISTRY_BUCKETS - 1)) == 0,
+               "DMOSI_THREAD_REGISTRY_BUCKETS must be a power of two");
+
+/**
+ * @brief Number of stack/TCB blocks kept after threads are destroyed
+ *
+ * Configurable via the CMake parameter of the same name. 0 (the default)
+ * disables the cache.
+ */
+#ifndef DMOSI_THREAD_CACHE_SIZE
+    #define DMOSI_THREAD_CACHE_SIZE    0
+#endif
+
+/**
+ * @brief Largest thread stack in bytes served by the cache
+ */
+#ifndef DMOSI_THREAD_CACHE_MAX_STACK
+    #define DMOSI_THREAD_CACHE_MAX_STACK    16384
+#endif
+
+/**
+ * @brief Headroom the stack advisor adds to the peak usage, in percent
+ *
+ * Configurable via the CMake parameter of the same name.
+ */
+#ifndef DMOSI_STACK_ADVISOR_MARGIN
+    #define DMOSI_STACK_ADVISOR_MARGIN    25
+#endif
+
+/**
+ * @brief Bytes at the end of the stack that the overflow check owns
+ *
+ * The pattern check (configCHECK_FOR_STACK_OVERFLOW 2) reports an overflow
+ * as soon as this much of the stack limit end is overwritten, so it cannot
+ * be used by the thread.
+ */
+#if ( configCHECK_FOR_STACK_OVERFLOW > 1 )
+    #define THREAD_STACK_GUARD_SIZE    16U
+#else
+    #define THREAD_STACK_GUARD_SIZE    0U
+#endif
+
 /**
  * @brief Node for a single registered thread exit callback
  *
@@ -79,10 +133,453 @@ struct dmosi_thread {
     bool joined;                      /**< Whether thread has been joined */
     TaskHandle_t joiner;              /**< Handle of task waiting to join */
     dmosi_process_t process;          /**< Process that the thread belongs to */
+    const char* module_name;          /**< Cached module name of the process (NULL if none) */
+#if DMOSI_HEAP_STATS
+    uint32_t heap_slot;               /**< Heap statistics slot of @ref module_name */
+#endif
     size_t stack_size;                /**< Total stack size in bytes (0 if unknown) */
     struct dmosi_thread_exit_callback* exit_callbacks; /**< Registered exit callbacks (singly-linked) */
+    bool is_static;                   /**< Whether the wrapper, TCB and stack are caller-provided */
+    bool registered;                  /**< Whether the thread is linked into the registry */
+    struct thread_cache_block* cache_block; /**< Cached TCB and stack the task runs on (NULL if none) */
+    struct dmosi_thread* next_zombie; /**< Next parked cached thread or orphaned wrapper waiting to be reaped */
+    bool zombie;                      /**< Whether the thread is on the zombie list */
+    bool destroyed;                   /**< Whether the (cached) thread destroyed itself */
+#if DMOSI_MPU
+    void* mpu_block;                  /**< TCB and aligned stack of a restricted task (NULL if not isolated) */
+#endif
+    struct dmosi_thread* all_prev;    /**< Previous thread in the global registry list */
+    struct dmosi_thread* all_next;    /**< Next thread in the global registry list */
+    struct dmosi_thread* bucket_prev; /**< Previous thread in the per-process bucket */
+    struct dmosi_thread* bucket_next; /**< Next thread in the per-process bucket */
+    uint32_t cpu_first_sample;        /**< First CPU usage sample taken of the thread (DMOSI_CPU_NO_SAMPLE = none) */
+    configRUN_TIME_COUNTER_TYPE cpu_samples[DMOSI_CPU_SAMPLES]; /**< Run-time counter at each CPU usage sample */
 };
 
+/**
+ * @brief Registry of live threads
+ *
+ * Every thread with a live task is linked into the global list and into the
+ * bucket of its process, so enumeration neither allocates nor visits tasks
+ * that have no dmosi_thread. Both lists are intrusive and modified in a
+ * critical section; linking and unlinking are O(1). Walks only suspend the
+ * scheduler, so they do not hold off interrupts for O(n).
+ */
+static struct dmosi_thread* g_thread_list = NULL;
+static struct dmosi_thread* g_thread_buckets[DMOSI_THREAD_REGISTRY_BUCKETS];
+
+/**
+ * @brief Wrappers of adopted tasks that were deleted outside dmosi
+ *
+ * Unlinked from the registry by dmosi_thread_task_deleted() and freed by
+ * thread_orphans_reap(). Linked through next_zombie and protected by a
+ * kernel critical section.
+ */
+static struct dmosi_thread* g_thread_orphans = NULL;
+
+/**
+ * @brief Layout of dmosi_thread_storage_t used by dmosi_thread_create_static()
+ */
+struct dmosi_thread_static {
+    struct dmosi_thread thread;       /**< Thread wrapper */
+    StaticTask_t tcb;                 /**< FreeRTOS task control block */
+};
+
+_Static_assert(sizeof(struct dmosi_thread_static) <= sizeof(dmosi_thread_storage_t),
+               "dmosi_thread_storage_t is too small for struct dmosi_thread_static");
+_Static_assert(_Alignof(struct dmosi_thread_static) <= _Alignof(dmosi_thread_storage_t),
+               "dmosi_thread_storage_t is under-aligned for struct dmosi_thread_static");
+
+/**
+ * @brief TCB and stack of a thread served by the stack cache
+ *
+ * The stack follows the header, which is padded to portBYTE_ALIGNMENT. Such
+ * tasks are created with xTaskCreateStatic(), so deleting them never hands
+ * memory to the idle task; the block goes back to the cache instead.
+ */
+struct thread_cache_block {
+    struct thread_cache_block* next;  /**< Next free block */
+    size_t stack_size;                /**< Size of the stack following the header in bytes */
+    StaticTask_t tcb;                 /**< FreeRTOS task control block */
+};
+
+/**
+ * @brief Size of the block header, rounded so the stack that follows is aligned
+ */
+#define THREAD_CACHE_HEADER_SIZE \
+    ((sizeof(struct thread_cache_block) + portBYTE_ALIGNMENT - 1) & ~(size_t)(portBYTE_ALIGNMENT - 1))
+
+/**
+ * @brief Make sure another task is not executing before it is deleted
+ *
+ * On a single core a task that is not the caller cannot be running, so
+ * vTaskDelete() on it completes synchronously. Under SMP it may be running
+ * on another core, in which case the kernel would defer the deletion to the
+ * idle task; suspend it and wait until it switched out instead.
+ *
+ * @param handle Task that is about to be deleted (not the current task)
+ */
+static void thread_halt_task(TaskHandle_t handle)
+{
+#if configNUMBER_OF_CORES > 1
+    vTaskSuspend(handle);
+    while (eTaskGetState(handle) == eRunning) {
+        taskYIELD();
+    }
+#else
+    (void)handle;
+#endif
+}
+
+/**
+ * @brief Free blocks of the stack cache, protected by a critical section
+ */
+static struct thread_cache_block* g_thread_cache = NULL;
+static size_t g_thread_cache_count = 0;
+static uint32_t g_thread_cache_hits = 0;
+static uint32_t g_thread_cache_misses = 0;
+
+/**
+ * @brief Cached threads whose task is parked, protected by a critical section
+ *
+ * A cached thread cannot delete its own task, since the idle task would then
+ * still touch the TCB after the block was reused. A thread that finishes or
+ * is killed before it is destroyed, or that destroyed itself, therefore
+ * parks its task here; the next create or trim deletes it from another task
+ * and returns the block to the cache.
+ */
+static struct dmosi_thread* g_thread_zombies = NULL;
+
+/**
+ * @brief Return a block whose task has been deleted
+ *
+ * The block is cached when the cache has room and freed otherwise.
+ *
+ * @param block Block to release
+ */
+static void thread_cache_release(struct thread_cache_block* block)
+{
+    bool cached = false;
+
+#if DMOSI_THREAD_CACHE_SIZE > 0
+    taskENTER_CRITICAL();
+    if (g_thread_cache_count < DMOSI_THREAD_CACHE_SIZE) {
+        block->next = g_thread_cache;
+        g_thread_cache = block;
+        g_thread_cache_count++;
+        cached = true;
+    }
+    taskEXIT_CRITICAL();
+#endif
+
+    if (!cached) {
+        vPortFree(block);
+    }
+}
+
+/**
+ * @brief Park a cached thread's task on the zombie list
+ *
+ * Must be called from a critical section, right before the task is
+ * suspended for good.
+ *
+ * @param thread Thread to park
+ */
+static void thread_zombie_add_locked(struct dmosi_thread* thread)
+{
+    thread->next_zombie = g_thread_zombies;
+    g_thread_zombies = thread;
+    thread->zombie = true;
+}
+
+/**
+ * @brief Take a thread off the zombie list
+ *
+ * Must be called from a critical section.
+ *
+ * @param thread Thread on the zombie list
+ */
+static void thread_zombie_remove_locked(struct dmosi_thread* thread)
+{
+    struct dmosi_thread** link = &g_thread_zombies;
+    while (*link != thread) {
+        link = &(*link)->next_zombie;
+    }
+    *link = thread->next_zombie;
+    thread->next_zombie = NULL;
+    thread->zombie = false;
+}
+
+/**
+ * @brief Delete the parked tasks of the zombie list and recycle their blocks
+ *
+ * A zombie is only reaped once its task is actually suspended. Afterwards a
+ * finished thread behaves like a finished dynamically created one, and the
+ * wrapper of a thread that destroyed itself is freed.
+ */
+static void thread_cache_reap(void)
+{
+    for (;;) {
+        struct dmosi_thread* zombie = NULL;
+        TaskHandle_t handle = NULL;
+        struct thread_cache_block* block = NULL;
+        bool destroyed = false;
+
+        taskENTER_CRITICAL();
+        for (struct dmosi_thread* t = g_thread_zombies; t != NULL; t = t->next_zombie) {
+            if (eTaskGetState(t->handle) == eSuspended) {
+                zombie = t;
+                break;
+            }
+        }
+        if (zombie != NULL) {
+            thread_zombie_remove_locked(zombie);
+            handle = zombie->handle;
+            block = zombie->cache_block;
+            destroyed = zombie->destroyed;
+            zombie->cache_block = NULL;
+        }
+        taskEXIT_CRITICAL();
+
+        if (zombie == NULL) {
+            return;
+        }
+
+        thread_halt_task(handle);
+        vTaskDelete(handle);
+        thread_cache_release(block);
+        if (destroyed) {
+            vPortFree(zombie);
+        }
+    }
+}
+
+/**
+ * @brief Get a stack/TCB block for a new thread
+ *
+ * Reuses a cached block with exactly the requested stack size, or allocates
+ * a new one that will be cached when the thread is destroyed.
+ *
+ * @param stack_size Stack size in bytes, a multiple of sizeof(StackType_t)
+ * @return struct thread_cache_block* Block, NULL if the size is not cacheable
+ *         (or the cache is disabled, or memory is exhausted)
+ */
+static struct thread_cache_block* thread_cache_acquire(size_t stack_size)
+{
+#if DMOSI_THREAD_CACHE_SIZE > 0
+    if (stack_size > DMOSI_THREAD_CACHE_MAX_STACK) {
+        return NULL;
+    }
+
+    thread_cache_reap();
+
+    taskENTER_CRITICAL();
+    struct thread_cache_block** link = &g_thread_cache;
+    while (*link != NULL && (*link)->stack_size != stack_size) {
+        link = &(*link)->next;
+    }
+    struct thread_cache_block* block = *link;
+    if (block != NULL) {
+        *link = block->next;
+        g_thread_cache_count--;
+        g_thread_cache_hits++;
+    } else {
+        g_thread_cache_misses++;
+    }
+    taskEXIT_CRITICAL();
+
+    if (block == NULL) {
+        block = pvPortMalloc(THREAD_CACHE_HEADER_SIZE + stack_size);
+        if (block != NULL) {
+            block->stack_size = stack_size;
+        }
+    }
+
+    if (block != NULL) {
+        block->next = NULL;
+    }
+    return block;
+#else
+    (void)stack_size;
+    return NULL;
+#endif
+}
+
+/**
+ * @brief Get the registry bucket of a process
+ *
+ * @param process Process handle (can be NULL)
+ * @return struct dmosi_thread** Head of the bucket
+ */
+static struct dmosi_thread** thread_registry_bucket(dmosi_process_t process)
+{
+    // Processes are heap blocks, so drop the always-zero alignment bits
+    uintptr_t key = (uintptr_t)process / sizeof(void*);
+    return &g_thread_buckets[key & (DMOSI_THREAD_REGISTRY_BUCKETS - 1)];
+}
+
+/**
+ * @brief Link a thread into the registry
+ *
+ * Must not be called again for a registered thread before
+ * thread_registry_remove(). The process must not change while registered.
+ *
+ * @param thread Thread to link
+ */
+static void thread_registry_add(struct dmosi_thread* thread)
+{
+    struct dmosi_thread** bucket = thread_registry_bucket(thread->process);
+
+    taskENTER_CRITICAL();
+    thread->all_prev = NULL;
+    thread->all_next = g_thread_list;
+    if (g_thread_list != NULL) {
+        g_thread_list->all_prev = thread;
+    }
+    g_thread_list = thread;
+
+    thread->bucket_prev = NULL;
+    thread->bucket_next = *bucket;
+    if (*bucket != NULL) {
+        (*bucket)->bucket_prev = thread;
+    }
+    *bucket = thread;
+
+    thread->cpu_first_sample = DMOSI_CPU_NO_SAMPLE;
+    thread->registered = true;
+    taskEXIT_CRITICAL();
+}
+
+/**
+ * @brief Unlink a thread from the registry
+ *
+ * A no-op when the thread is not registered, so all termination paths may
+ * call it.
+ *
+ * @param thread Thread to unlink
+ */
+static void thread_registry_remove(struct dmosi_thread* thread)
+{
+    struct dmosi_thread** bucket = thread_registry_bucket(thread->process);
+
+    taskENTER_CRITICAL();
+    if (thread->registered) {
+        if (thread->all_prev != NULL) {
+            thread->all_prev->all_next = thread->all_next;
+        } else {
+            g_thread_list = thread->all_next;
+        }
+        if (thread->all_next != NULL) {
+            thread->all_next->all_prev = thread->all_prev;
+        }
+
+        if (thread->bucket_prev != NULL) {
+            thread->bucket_prev->bucket_next = thread->bucket_next;
+        } else {
+            *bucket = thread->bucket_next;
+        }
+        if (thread->bucket_next != NULL) {
+            thread->bucket_next->bucket_prev = thread->bucket_prev;
+        }
+
+        thread->registered = false;
+    }
+    taskEXIT_CRITICAL();
+}
+
+/**
+ * @brief traceTASK_DELETE hook
+ *
+ * dmosi unlinks a thread from the registry before deleting its task, so a
+ * task that is still registered here was deleted with vTaskDelete()
+ * directly. The wrapper of an adopted task (see _thread_current) belongs to
+ * nobody else, so it is unlinked and queued for thread_orphans_reap(); the
+ * wrapper of a thread created by dmosi stays with its owner.
+ *
+ * Called by the kernel inside a critical section, before the task is
+ * removed from its lists.
+ *
+ * @param task Task being deleted
+ */
+void dmosi_thread_task_deleted(void* task)
+{
+    struct dmosi_thread* thread = (struct dmosi_thread*)pvTaskGetThreadLocalStoragePointer(
+        (TaskHandle_t)task, DMOD_THREAD_TLS_INDEX);
+
+    if (thread == NULL || thread == DMOSI_THREAD_TLS_BOOTSTRAPPING ||
+        thread->entry != NULL || !thread->registered) {
+        return;
+    }
+
+    thread_registry_remove(thread);
+    thread->handle = NULL;
+    thread->next_zombie = g_thread_orphans;
+    g_thread_orphans = thread;
+}
+
+/**
+ * @brief Associate a thread with a process and refresh its cached module name
+ *
+ * The module name and its heap statistics slot are resolved once here
+ * instead of on every allocation made by the thread (see
+ * dmosi_thread_current_module_name()). Every assignment of
+ * thread->process must go through this helper so the cache never goes stale.
+ *
+ * @param thread Thread to update
+ * @param process Process to associate the thread with (can be NULL)
+ */
+static void thread_set_process(struct dmosi_thread* thread, dmosi_process_t process)
+{
+    thread->process = process;
+    thread->module_name = (process != NULL) ? dmosi_process_get_module_name(process) : NULL;
+#if DMOSI_HEAP_STATS
+    thread->heap_slot = dmosi_heap_stats_slot(thread->module_name);
+#endif
+}
+
+/**
+ * @brief Helper function to initialize a thread structure
+ * 
+ * @param thread Thread structure to initialize
+ * @param handle FreeRTOS task handle
+ * @param entry Thread entry function (can be NULL)
+ * @param arg Thread argument (can be NULL)
+ * @param process Process to associate the thread with (can be NULL)
+ * @param stack_size Total stack size in bytes (0 if unknown)
+ * @param is_static Whether the wrapper, TCB and stack are caller-provided
+ */
+static void thread_init(struct dmosi_thread* thread,
+                        TaskHandle_t handle,
+                        dmosi_thread_entry_t entry,
+                        void* arg,
+                        dmosi_process_t process,
+                        size_t stack_size,
+                        bool is_static)
+{
+    thread->handle = handle;
+    thread->entry = entry;
+    thread->arg = arg;
+    thread->completed = (entry == NULL);  // Mark as completed if no entry (e.g., main thread)
+    thread->joined = false;
+    thread->joiner = NULL;
+    thread_set_process(thread, process);
+    thread->stack_size = stack_size;
+    thread->exit_callbacks = NULL;
+    thread->is_static = is_static;
+    thread->registered = false;
+    thread->cache_block = NULL;
+    thread->next_zombie = NULL;
+    thread->zombie = false;
+    thread->destroyed = false;
+#if DMOSI_MPU
+    thread->mpu_block = NULL;
+#endif
+    thread->all_prev = NULL;
+    thread->all_next = NULL;
+    thread->bucket_prev = NULL;
+    thread->bucket_next = NULL;
+}
+
 /**
  * @brief Helper function to create and initialize a new thread structure
  * 
@@ -105,19 +602,65 @@ static struct dmosi_thread* thread_new(TaskHandle_t handle,
         return NULL;
     }
     
-    thread->handle = handle;
-    thread->entry = entry;
-    thread->arg = arg;
-    thread->completed = (entry == NULL);  // Mark as completed if no entry (e.g., main thread)
-    thread->joined = false;
-    thread->joiner = NULL;
-    thread->process = process;
-    thread->stack_size = stack_size;
-    thread->exit_callbacks = NULL;
-
+    thread_init(thread, handle, entry, arg, process, stack_size, false);
     return thread;
 }
 
+/**
+ * @brief Check whether a thread's TCB and stack are not owned by the kernel
+ *
+ * True for statically created threads, for threads served by the stack
+ * cache and for restricted tasks. Their tasks are parked rather than
+ * deleted when they terminate.
+ *
+ * @param thread Thread to check
+ * @return true if the TCB and stack are caller-provided or cached
+ */
+static bool thread_has_static_task(const struct dmosi_thread* thread)
+{
+#if DMOSI_MPU
+    if (thread->mpu_block != NULL) {
+        return true;
+    }
+#endif
+    return thread->is_static || thread->cache_block != NULL;
+}
+
+/**
+ * @brief Stop the FreeRTOS task of a terminating thread
+ *
+ * Tasks of dynamically created threads are deleted; the idle task reclaims
+ * their TCB and stack later. Tasks whose TCB and stack are caller-provided
+ * or cached are only suspended ("parked") instead: the idle task could
+ * otherwise still be touching the memory after dmosi_thread_destroy()
+ * returned it. _thread_destroy deletes them synchronously; cached ones are
+ * also put on the zombie list, so the next create or trim reclaims them
+ * even if the thread is never destroyed.
+ *
+ * Does not return when @p thread is the current thread.
+ *
+ * @param thread Thread whose task should be stopped
+ */
+static void thread_stop_task(struct dmosi_thread* thread)
+{
+    TaskHandle_t target = (thread->handle == xTaskGetCurrentTaskHandle()) ? NULL : thread->handle;
+
+    if (!thread_has_static_task(thread)) {
+        vTaskDelete(target);
+        return;
+    }
+
+    if (thread->cache_block != NULL) {
+        taskENTER_CRITICAL();
+        thread_zombie_add_locked(thread);
+        taskEXIT_CRITICAL();
+    }
+
+    do {
+        vTaskSuspend(target);
+    } while (target == NULL);
+}
+
 /**
  * @brief Detach and invoke all exit callbacks registered on a thread
  *
@@ -146,6 +689,55 @@ static void thread_invoke_exit_callbacks(struct dmosi_thread* thread)
     }
 }
 
+/**
+ * @brief Free the wrappers of adopted tasks deleted outside dmosi
+ *
+ * Their exit callbacks run here, in the caller's context, as they do for a
+ * killed thread.
+ */
+static void thread_orphans_reap(void)
+{
+    taskENTER_CRITICAL();
+    struct dmosi_thread* orphan = g_thread_orphans;
+    g_thread_orphans = NULL;
+    taskEXIT_CRITICAL();
+
+    while (orphan != NULL) {
+        struct dmosi_thread* next = orphan->next_zombie;
+        thread_invoke_exit_callbacks(orphan);
+        vPortFree(orphan);
+        orphan = next;
+    }
+}
+
+/**
+ * @brief Tag the kernel-allocated TCB and stack of the calling thread
+ *
+ * xTaskCreate() allocated both via pvPortMalloc() while the thread had no
+ * TLS entry yet, so they were attributed to dmosi_thread_get_module_name(NULL)
+ * of the *creating* thread - either the parent's name (wrong owner) or NULL
+ * (untagged). Retag them under the thread's own module name. Done by the
+ * thread itself: by the time the creator could do it, the task may already
+ * have finished and its TCB been freed.
+ *
+ * @param thread Calling thread
+ */
+static void thread_retag_own_task(const struct dmosi_thread* thread)
+{
+    if (thread->module_name == NULL) {
+        return;
+    }
+
+    TaskStatus_t task_status;
+    vTaskGetInfo(NULL, &task_status, pdFALSE, eInvalid);
+    if (task_status.pxStackBase != NULL) {
+        dmosi_heap_retag(task_status.pxStackBase, thread->module_name);
+    }
+
+    // TaskHandle_t *is* the TCB pointer in this (dynamic allocation) configuration
+    dmosi_heap_retag(xTaskGetCurrentTaskHandle(), thread->module_name);
+}
+
 /**
  * @brief Wrapper function for FreeRTOS task entry
  * 
@@ -163,10 +755,31 @@ static void thread_wrapper(void* pvParameters)
     // retrieved by dmosi_thread_current()
     if (thread != NULL) {
         vTaskSetThreadLocalStoragePointer(NULL, DMOD_THREAD_TLS_INDEX, thread);
+        if (!thread_has_static_task(thread)) {
+            thread_retag_own_task(thread);
+        }
     }
     
     if (thread != NULL && thread->entry != NULL) {
+#if DMOSI_MPU
+        // Restricted tasks start privileged for the bookkeeping around the
+        // entry function, which itself runs confined to the task's regions
+        if (thread->mpu_block != NULL) {
+            dmosi_thread_entry_t entry = thread->entry;
+            void* arg = thread->arg;
+
+            portMEMORY_BARRIER();
+            portRESET_PRIVILEGE();
+            portMEMORY_BARRIER();
+            entry(arg);
+            portRAISE_PRIVILEGE();
+            portMEMORY_BARRIER();
+        } else {
+            thread->entry(thread->arg);
+        }
+#else
         thread->entry(thread->arg);
+#endif
     }
 
     // Invoke registered exit callbacks before marking the thread as completed,
@@ -179,12 +792,28 @@ static void thread_wrapper(void* pvParameters)
     // Mark thread as completed and get joiner handle atomically
     if (thread != NULL) {
         taskENTER_CRITICAL();
+        bool claimed = thread->completed;
         thread->completed = true;
         joiner_to_notify = thread->joiner;
         taskEXIT_CRITICAL();
+
+        // Killed or being destroyed from another core: that side owns the
+        // completion and deletes this task, so only wait for it. A cached
+        // thread that destroyed itself is reaped by a later create or trim.
+        if (claimed) {
+            if (thread->destroyed) {
+                taskENTER_CRITICAL();
+                thread_zombie_add_locked(thread);
+                taskEXIT_CRITICAL();
+            }
+            for (;;) {
+                vTaskSuspend(NULL);
+            }
+        }
         
-        // Clear TLS before self-deletion so thread_enumerate won't return
-        // a stale handle for this completed thread.
+        // Unregister and clear TLS before self-deletion so thread_enumerate
+        // won't return a stale handle for this completed thread.
+        thread_registry_remove(thread);
         vTaskSetThreadLocalStoragePointer(NULL, DMOD_THREAD_TLS_INDEX, NULL);
         
         // Notify any task waiting to join (outside critical section)
@@ -193,12 +822,79 @@ static void thread_wrapper(void* pvParameters)
         }
     }
     
-    // Task will self-delete here
+    // Task will self-delete (or park, if statically allocated) here
     // Note: After this point, the task handle becomes invalid but the
     // thread structure remains valid until destroyed
+    if (thread != NULL) {
+        thread_stop_task(thread);
+    }
     vTaskDelete(NULL);
 }
 
+#if DMOSI_MPU
+/**
+ * @brief Start a thread of an isolated process as a restricted task
+ *
+ * The TCB and the stack share one allocation; the stack is aligned and
+ * sized for the MPU region the port programs for it. The task is created
+ * privileged so thread_wrapper() can do its bookkeeping, and drops the
+ * privilege around the entry function.
+ *
+ * @param thread Thread wrapper (freed on failure)
+ * @param name Name of the thread
+ * @param priority Thread priority
+ * @param stack_size Requested stack size in bytes
+ * @param regions MPU regions of the thread's process
+ * @return dmosi_thread_t Created thread handle, NULL on failure
+ */
+static dmosi_thread_t thread_create_restricted(struct dmosi_thread* thread,
+                                               const char* name,
+                                               int priority,
+                                               size_t stack_size,
+                                               const MemoryRegion_t* regions)
+{
+    const size_t align = DMOSI_MPU_REGION_ALIGNMENT;
+    size_t stack_bytes = (stack_size + align - 1) & ~(align - 1);
+    size_t header = (sizeof(StaticTask_t) + align - 1) & ~(align - 1);
+
+    uint8_t* block = pvPortMalloc(header + stack_bytes + align - 1);
+    if (block == NULL) {
+        vPortFree(thread);
+        return NULL;
+    }
+
+    TaskParameters_t parameters = {
+        .pvTaskCode = thread_wrapper,
+        .pcName = name,
+        .usStackDepth = (configSTACK_DEPTH_TYPE)(stack_bytes / sizeof(StackType_t)),
+        .pvParameters = thread,
+        .uxPriority = (UBaseType_t)priority | portPRIVILEGE_BIT,
+        .puxStackBuffer = (StackType_t*)(((uintptr_t)block + header + align - 1) & ~(uintptr_t)(align - 1)),
+        .pxTaskBuffer = (StaticTask_t*)block,
+    };
+    memcpy(parameters.xRegions, regions, sizeof(parameters.xRegions));
+
+    thread->mpu_block = block;
+    thread->stack_size = stack_bytes;
+
+    // See _thread_create
+    thread_registry_add(thread);
+    if (xTaskCreateRestrictedStatic(&parameters, &thread->handle) != pdPASS || thread->handle == NULL) {
+        thread_registry_remove(thread);
+        vPortFree(block);
+        vPortFree(thread);
+        return NULL;
+    }
+
+    vTaskSetThreadLocalStoragePointer(thread->handle, DMOD_THREAD_TLS_INDEX, thread);
+    if (thread->module_name != NULL) {
+        dmosi_heap_retag(block, thread->module_name);
+    }
+
+    return (dmosi_thread_t)thread;
+}
+#endif
+
 //==============================================================================
 //                              THREAD API Implementation
 //==============================================================================
@@ -219,6 +915,8 @@ static void thread_wrapper(void* pvParameters)
  */
 DMOD_INPUT_API_DECLARATION( dmosi, 1.0, dmosi_thread_t, _thread_create, (dmosi_thread_entry_t entry, void* arg, int priority, size_t stack_size, const char* name, dmosi_process_t process) )
 {
+    DMOSI_MPU_PRIVILEGED_SCOPE();
+
     if (entry == NULL || stack_size == 0 || name == NULL) {
         return NULL;
     }
@@ -233,10 +931,63 @@ DMOD_INPUT_API_DECLARATION( dmosi, 1.0, dmosi_thread_t, _thread_create, (dmosi_t
         return NULL;
     }
 
+#if DMOSI_MPU
+    // Threads of isolated processes are confined to the process regions
+    MemoryRegion_t regions[portNUM_CONFIGURABLE_REGIONS];
+    if (dmosi_mpu_get_regions(process, regions)) {
+        return thread_create_restricted(thread, name, priority, stack_size, regions);
+    }
+#endif
+
+    // Recreated threads run on a cached TCB and stack, without the heap
+    size_t cache_stack = (stack_size + sizeof(StackType_t) - 1) & ~(sizeof(StackType_t) - 1);
+    struct thread_cache_block* block = thread_cache_acquire(cache_stack);
+    if (block != NULL) {
+        thread->cache_block = block;
+        thread->stack_size = cache_stack;
+        thread_registry_add(thread);
+        thread->handle = xTaskCreateStatic(
+            thread_wrapper,
+            name,
+            cache_stack / sizeof(StackType_t),
+            thread,
+            priority,
+            (StackType_t*)((uint8_t*)block + THREAD_CACHE_HEADER_SIZE),
+            &block->tcb
+        );
+
+        if (thread->handle == NULL) {
+            thread_registry_remove(thread);
+            thread_cache_release(block);
+            vPortFree(thread);
+            return NULL;
+        }
+
+        // See below. The block holds both the TCB and the stack and stays
+        // valid until the thread is destroyed, even if it finished already.
+        vTaskSetThreadLocalStoragePointer(thread->handle, DMOD_THREAD_TLS_INDEX, thread);
+        if (thread->module_name != NULL) {
+            dmosi_heap_retag(block, thread->module_name);
+        }
+
+        return (dmosi_thread_t)thread;
+    }
+
     // FreeRTOS stack size is in words, not bytes
     // Convert bytes to words (rounding up to ensure sufficient stack)
     UBaseType_t stack_words = (stack_size + sizeof(StackType_t) - 1) / sizeof(StackType_t);
-    
+
+    // Register the thread before its task exists, instead of relying on the
+    // new task to self-register the first time it runs. thread_enumerate()
+    // (and so dmosi_process_find_by_id(), dmosi_thread_get_by_process(), etc.)
+    // discovers threads/processes purely through the registry - a caller that
+    // looks up the newly created thread/process before the scheduler has given
+    // the new task any timeslice must find it. Linking it only after
+    // xTaskCreate() returned is not safe either: a task of higher priority than
+    // its creator may have run to completion and deleted itself by then, and
+    // would be registered with a freed TCB.
+    thread_registry_add(thread);
+
     BaseType_t result = xTaskCreate(
         thread_wrapper,
         name,
@@ -247,40 +998,81 @@ DMOD_INPUT_API_DECLARATION( dmosi, 1.0, dmosi_thread_t, _thread_create, (dmosi_t
     );
 
     if (result != pdPASS || thread->handle == NULL) {
+        thread_registry_remove(thread);
         vPortFree(thread);
         return NULL;
     }
 
-    // Register the TLS association immediately, from the creating task, instead of
-    // relying solely on the new task to self-register the first time it runs (see
-    // thread_wrapper). thread_enumerate() (and so dmosi_process_find_by_id(),
-    // dmosi_thread_get_by_process(), etc.) discovers threads/processes purely by
-    // scanning FreeRTOS's task list for a non-NULL TLS slot - without this, a
-    // caller that looks up the newly created thread/process before the scheduler
-    // has given the new task any timeslice would not find it, even though
-    // xTaskCreate() already succeeded and the task is fully valid.
-    vTaskSetThreadLocalStoragePointer(thread->handle, DMOD_THREAD_TLS_INDEX, thread);
+    // For the same reason the TLS entry and the tags of the TCB and stack are
+    // left to the task itself (see thread_wrapper)
+    return (dmosi_thread_t)thread;
+}
 
-    // The stack buffer was allocated by xTaskCreate() via pvPortMalloc() a few lines up,
-    // at a point where this thread had no TLS entry yet - pvPortMalloc() attributes
-    // memory to dmosi_thread_get_module_name(NULL) (the *calling* thread's module, found
-    // via dmosi_thread_current()), which for brand-new threads either resolves to the
-    // parent's own name (wrong owner) or NULL (untagged) depending on timing. Now that
-    // thread->process is set, retag the stack directly under its own module name instead
-    // of leaving it stuck under someone else's name or none at all.
-    const char* stackModuleName = dmosi_thread_get_module_name((dmosi_thread_t)thread);
-    if (stackModuleName != NULL) {
-        TaskStatus_t taskStatus;
-        vTaskGetInfo(thread->handle, &taskStatus, pdFALSE, eInvalid);
-        if (taskStatus.pxStackBase != NULL) {
-            Dmod_RetagEx(taskStatus.pxStackBase, stackModuleName);
-        }
+/**
+ * @brief Create a thread with caller-provided control block and stack
+ *
+ * Works like dmosi_thread_create() but places the thread wrapper and the
+ * FreeRTOS TCB in @p storage and uses @p stack as the task stack, so no
+ * memory is allocated. Both must stay valid until dmosi_thread_destroy()
+ * is called; they may be reused once it returns.
+ *
+ * When the thread finishes (or is killed) its task is parked rather than
+ * deleted, and only deleted by dmosi_thread_destroy(), so the storage is
+ * never touched by the idle task after it has been handed back.
+ *
+ * @param storage Storage for the thread and its task control block
+ * @param entry Entry function for the thread
+ * @param arg Argument to pass to the entry function
+ * @param priority Thread priority
+ * @param stack Stack buffer (aligned to StackType_t)
+ * @param stack_size Size of @p stack in bytes
+ * @param name Name of the thread (cannot be NULL)
+ * @param process Process to associate the thread with (NULL = current process)
+ * @return dmosi_thread_t Created thread handle, NULL on failure
+ */
+dmosi_thread_t dmosi_thread_create_static(dmosi_thread_storage_t* storage, dmosi_thread_entry_t entry, void* arg, int priority, void* stack, size_t stack_size, const char* name, dmosi_process_t process)
+{
+    if (storage == NULL || entry == NULL || stack == NULL || name == NULL) {
+        return NULL;
+    }
+
+    if (((uintptr_t)stack % sizeof(StackType_t)) != 0 || stack_size < sizeof(StackType_t)) {
+        return NULL;
+    }
 
-        // TaskHandle_t *is* the TCB pointer in this (dynamic allocation) configuration -
-        // it was also allocated via pvPortMalloc() before TLS was set, same as the stack.
-        Dmod_RetagEx(thread->handle, stackModuleName);
+    if (process == NULL) {
+        process = dmosi_process_current();
     }
 
+    // The caller's buffer is used as-is, so round the depth down to whole words
+    UBaseType_t stack_words = stack_size / sizeof(StackType_t);
+
+    struct dmosi_thread_static* st = (struct dmosi_thread_static*)storage;
+    struct dmosi_thread* thread = &st->thread;
+    thread_init(thread, NULL, entry, arg, process, stack_words * sizeof(StackType_t), true);
+
+    // Registered before the task exists for the same reason as in _thread_create
+    thread_registry_add(thread);
+    thread->handle = xTaskCreateStatic(
+        thread_wrapper,
+        name,
+        stack_words,
+        thread,
+        priority,
+        (StackType_t*)stack,
+        &st->tcb
+    );
+
+    if (thread->handle == NULL) {
+        thread_registry_remove(thread);
+        return NULL;
+    }
+
+    // The TCB is caller-provided and stays valid until the thread is
+    // destroyed, so its TLS entry can be set even if it finished already.
+    // There is nothing to retag.
+    vTaskSetThreadLocalStoragePointer(thread->handle, DMOD_THREAD_TLS_INDEX, thread);
+
     return (dmosi_thread_t)thread;
 }
 
@@ -299,16 +1091,32 @@ DMOD_INPUT_API_DECLARATION( dmosi, 1.0, dmosi_thread_t, _thread_create, (dmosi_t
  */
 DMOD_INPUT_API_DECLARATION( dmosi, 1.0, void, _thread_destroy, (dmosi_thread_t thread) )
 {
+    DMOSI_MPU_PRIVILEGED_SCOPE();
+
     if (thread == NULL) {
         return;
     }
 
     TaskHandle_t current = xTaskGetCurrentTaskHandle();
+
+    // The registry lives in the wrapper, so this is safe even for completed tasks
+    thread_registry_remove(thread);
     
     // Only access TLS if the task has not completed (self-deleted).
     // After vTaskDelete(NULL) in thread_wrapper, the TCB may have been
-    // freed by the idle task, making TLS access unsafe.
-    if (thread->handle != NULL && !thread->completed) {
+    // freed by the idle task, making TLS access unsafe. Statically created
+    // and cached tasks are only parked on completion, so their TCB is still valid.
+    // Claiming completion in the same critical section keeps a thread that
+    // finishes concurrently (on another core) from deleting itself meanwhile.
+    // A parked cached task is taken off the zombie list and deleted here.
+    taskENTER_CRITICAL();
+    if (thread->zombie) {
+        thread_zombie_remove_locked(thread);
+    }
+    bool task_alive = !thread->completed || thread_has_static_task(thread);
+    thread->completed = true;
+    taskEXIT_CRITICAL();
+    if (thread->handle != NULL && task_alive) {
         // Check if the task-local storage still points to this structure
         void* stored = pvTaskGetThreadLocalStoragePointer(thread->handle, DMOD_THREAD_TLS_INDEX);
         if (stored == thread) {
@@ -317,9 +1125,13 @@ DMOD_INPUT_API_DECLARATION( dmosi, 1.0, void, _thread_destroy, (dmosi_thread_t t
     }
     
     // Only delete the task if:
-    // 1. It hasn't completed yet (completed is false)
+    // 1. It hasn't completed yet, or is a parked statically created task
     // 2. It's not the current thread (to avoid self-deletion)
-    if (!thread->completed && thread->handle != NULL && thread->handle != current) {
+    // Deleting another (not running) task is synchronous, so caller-provided
+    // storage of a static thread is no longer referenced once this returns.
+    bool self = (thread->handle == current);
+    if (task_alive && thread->handle != NULL && !self) {
+        thread_halt_task(thread->handle);
         vTaskDelete(thread->handle);
     }
 
@@ -329,7 +1141,24 @@ DMOD_INPUT_API_DECLARATION( dmosi, 1.0, void, _thread_destroy, (dmosi_thread_t t
     // thread's termination point. A no-op if thread_wrapper already ran them.
     thread_invoke_exit_callbacks(thread);
 
-    vPortFree(thread);
+    // A thread destroying itself is still running on its cached stack, so
+    // it parks on the zombie list once it returns and keeps its wrapper
+    if (thread->cache_block != NULL) {
+        if (self) {
+            thread->destroyed = true;
+            return;
+        }
+        thread_cache_release(thread->cache_block);
+    }
+#if DMOSI_MPU
+    if (thread->mpu_block != NULL && !self) {
+        vPortFree(thread->mpu_block);
+    }
+#endif
+
+    if (!thread->is_static) {
+        vPortFree(thread);
+    }
 }
 
 /**
@@ -343,6 +1172,8 @@ DMOD_INPUT_API_DECLARATION( dmosi, 1.0, void, _thread_destroy, (dmosi_thread_t t
  */
 DMOD_INPUT_API_DECLARATION( dmosi, 1.0, int, _thread_join, (dmosi_thread_t thread) )
 {
+    DMOSI_MPU_PRIVILEGED_SCOPE();
+
     if (thread == NULL) {
         return -EINVAL;
     }
@@ -419,6 +1250,8 @@ DMOD_INPUT_API_DECLARATION( dmosi, 1.0, int, _thread_join, (dmosi_thread_t threa
  */
 DMOD_INPUT_API_DECLARATION( dmosi, 1.0, dmosi_thread_t, _thread_current, (void) )
 {
+    DMOSI_MPU_PRIVILEGED_SCOPE();
+
     TaskHandle_t current_handle = xTaskGetCurrentTaskHandle();
     
     if (current_handle == NULL) {
@@ -440,6 +1273,7 @@ DMOD_INPUT_API_DECLARATION( dmosi, 1.0, dmosi_thread_t, _thread_current, (void)
 
     // If no structure exists, allocate and store one
     if (thread == NULL) {
+        thread_orphans_reap();
         vTaskSetThreadLocalStoragePointer(current_handle, DMOD_THREAD_TLS_INDEX, DMOSI_THREAD_TLS_BOOTSTRAPPING);
 
         // Use g_init_process as a fallback during system initialization to break
@@ -455,6 +1289,7 @@ DMOD_INPUT_API_DECLARATION( dmosi, 1.0, dmosi_thread_t, _thread_current, (void)
 
         // Store in task-local storage for future calls
         vTaskSetThreadLocalStoragePointer(current_handle, DMOD_THREAD_TLS_INDEX, thread);
+        thread_registry_add(thread);
     }
 
     return (dmosi_thread_t)thread;
@@ -469,15 +1304,19 @@ DMOD_INPUT_API_DECLARATION( dmosi, 1.0, dmosi_thread_t, _thread_current, (void)
  */
 DMOD_INPUT_API_DECLARATION( dmosi, 1.0, void, _thread_sleep, (uint32_t ms) )
 {
-    TickType_t ticks = pdMS_TO_TICKS(ms);
-    
-    // Ensure we delay at least 1 tick if ms > 0
+    // Never shorter than ms, so any ms > 0 delays at least 2 ticks
     // vTaskDelay(0) just yields to equal priority tasks without blocking
-    if (ms > 0 && ticks == 0) {
-        ticks = 1;
-    }
-    
-    vTaskDelay(ticks);
+    vTaskDelay(dmosi_ticks_from_wait_ms(ms));
+}
+
+/**
+ * @brief Sleep for a specified number of ticks
+ *
+ * @param ticks Ticks to sleep (0 = yield to threads of equal priority)
+ */
+void dmosi_thread_sleep_ticks(uint32_t ticks)
+{
+    vTaskDelay(dmosi_ticks_from_api(ticks));
 }
 
 /**
@@ -490,6 +1329,8 @@ DMOD_INPUT_API_DECLARATION( dmosi, 1.0, void, _thread_sleep, (uint32_t ms) )
  */
 DMOD_INPUT_API_DECLARATION( dmosi, 1.0, const char*, _thread_get_name, (dmosi_thread_t thread) )
 {
+    DMOSI_MPU_PRIVILEGED_SCOPE();
+
     // If thread is NULL, get current thread
     if (thread == NULL) {
         thread = dmosi_thread_current();
@@ -505,14 +1346,16 @@ DMOD_INPUT_API_DECLARATION( dmosi, 1.0, const char*, _thread_get_name, (dmosi_th
 /**
  * @brief Get thread module name
  * 
- * Returns the module name associated with the thread by retrieving it from
- * the thread's associated process.
+ * Returns the module name associated with the thread. The name is cached on
+ * the thread when its process is assigned, so no process lookup is needed.
  * 
  * @param thread Thread handle (if NULL, returns module name of current thread)
  * @return const char* Module name of the process that owns the thread, NULL on failure
  */
 DMOD_INPUT_API_DECLARATION( dmosi, 1.0, const char*, _thread_get_module_name, (dmosi_thread_t thread) )
 {
+    DMOSI_MPU_PRIVILEGED_SCOPE();
+
     // If thread is NULL, get current thread
     if (thread == NULL) {
         thread = dmosi_thread_current();
@@ -521,11 +1364,7 @@ DMOD_INPUT_API_DECLARATION( dmosi, 1.0, const char*, _thread_get_module_name, (d
         }
     }
     
-    if (thread->process == NULL) {
-        return NULL;
-    }
-    
-    return dmosi_process_get_module_name(thread->process);
+    return thread->module_name;
 }
 
 /**
@@ -538,6 +1377,8 @@ DMOD_INPUT_API_DECLARATION( dmosi, 1.0, const char*, _thread_get_module_name, (d
  */
 DMOD_INPUT_API_DECLARATION( dmosi, 1.0, int, _thread_get_priority, (dmosi_thread_t thread) )
 {
+    DMOSI_MPU_PRIVILEGED_SCOPE();
+
     // If thread is NULL, get current thread
     if (thread == NULL) {
         thread = dmosi_thread_current();
@@ -560,6 +1401,8 @@ DMOD_INPUT_API_DECLARATION( dmosi, 1.0, int, _thread_get_priority, (dmosi_thread
  */
 DMOD_INPUT_API_DECLARATION( dmosi, 1.0, dmosi_process_t, _thread_get_process, (dmosi_thread_t thread) )
 {
+    DMOSI_MPU_PRIVILEGED_SCOPE();
+
     // If thread is NULL, get current thread
     if (thread == NULL) {
         thread = dmosi_thread_current();
@@ -582,53 +1425,54 @@ DMOD_INPUT_API_DECLARATION( dmosi, 1.0, dmosi_process_t, _thread_get_process, (d
  */
 DMOD_INPUT_API_DECLARATION( dmosi, 1.0, int, _thread_kill, (dmosi_thread_t thread, int status) )
 {
+    DMOSI_MPU_PRIVILEGED_SCOPE();
+
     if (thread == NULL) {
         return -EINVAL;
     }
 
     (void)status;
 
-    TaskHandle_t current = xTaskGetCurrentTaskHandle();
-
     // A killed thread never reaches thread_wrapper's own completion path, so
     // invoke its exit callbacks here. Note these run in the killer's context
     // when killing another thread (the killed task is deleted, not resumed).
     thread_invoke_exit_callbacks(thread);
 
-    // Mark thread as completed and notify any joiner
+    // Mark thread as completed and notify any joiner. A thread created with
+    // an entry that already completed has stopped its own task (or is being
+    // destroyed), so there is nothing left to kill.
     taskENTER_CRITICAL();
+    bool finished = thread->completed && thread->entry != NULL;
     thread->completed = true;
-    TaskHandle_t joiner_to_notify = thread->joiner;
+    TaskHandle_t joiner_to_notify = finished ? NULL : thread->joiner;
     taskEXIT_CRITICAL();
 
+    if (finished) {
+        return 0;
+    }
+
+    thread_registry_remove(thread);
+
     if (joiner_to_notify != NULL) {
         xTaskNotifyGive(joiner_to_notify);
     }
 
-    // Delete the FreeRTOS task if it is not the current task
-    if (thread->handle != NULL && thread->handle != current) {
-        vTaskDelete(thread->handle);
-    } else if (thread->handle != NULL && thread->handle == current) {
-        // Self-termination: delete this task; does not return
-        vTaskDelete(NULL);
+    // Delete (or park, if statically allocated) the FreeRTOS task; when it
+    // is the current task this is a self-termination and does not return
+    if (thread->handle != NULL) {
+        thread_stop_task(thread);
     }
 
     return 0;
 }
 
 /**
- * @brief Safety margin added to the task-array allocation to guard against
- *        tasks being created between uxTaskGetNumberOfTasks() and
- *        uxTaskGetSystemState().
- */
-#define THREAD_ENUM_MARGIN    4
-
-/**
- * @brief Enumerate all FreeRTOS tasks that have a dmosi_thread in TLS.
+ * @brief Enumerate registered threads
  *
- * Allocates a temporary TaskStatus_t array, calls uxTaskGetSystemState(), and
- * for each task whose TLS slot 0 is non-NULL, optionally writes the handle to
- * @p threads up to @p max_count entries.
+ * Walks the thread registry with the scheduler suspended and writes
+ * matching handles to @p threads up to @p max_count entries. With a process
+ * filter only the bucket of that process is visited. Nothing is allocated.
+ * Wrappers of adopted tasks that were deleted outside dmosi are freed first.
  *
  * @param process  Filter: only include threads whose process matches this value.
  *                 Pass NULL to include threads regardless of process.
@@ -639,46 +1483,45 @@ DMOD_INPUT_API_DECLARATION( dmosi, 1.0, int, _thread_kill, (dmosi_thread_t threa
  */
 static size_t thread_enumerate(dmosi_process_t process, dmosi_thread_t* threads, size_t max_count)
 {
-    // Add a small margin to guard against new tasks being created between the
-    // count query and the actual enumeration call.
-    UBaseType_t alloc_count = uxTaskGetNumberOfTasks() + THREAD_ENUM_MARGIN;
-    TaskStatus_t* task_array = (TaskStatus_t*)pvPortMalloc(alloc_count * sizeof(TaskStatus_t));
-    if (task_array == NULL) {
-        return 0;
-    }
-
-    UBaseType_t filled = uxTaskGetSystemState(task_array, alloc_count, NULL);
     size_t count = 0;
 
-    for (UBaseType_t i = 0; i < filled; i++) {
-        struct dmosi_thread* t = (struct dmosi_thread*)pvTaskGetThreadLocalStoragePointer(
-            task_array[i].xHandle, DMOD_THREAD_TLS_INDEX);
-        if (t == NULL) {
-            continue;
-        }
-        if (process != NULL && t->process != process) {
-            continue;
+    thread_orphans_reap();
+
+    vTaskSuspendAll();
+    if (process == NULL) {
+        for (struct dmosi_thread* t = g_thread_list; t != NULL; t = t->all_next) {
+            if (threads != NULL) {
+                if (count == max_count) {
+                    break;
+                }
+                threads[count] = (dmosi_thread_t)t;
+            }
+            count++;
         }
-        if (threads != NULL && count < max_count) {
-            threads[count] = (dmosi_thread_t)t;
+    } else {
+        for (struct dmosi_thread* t = *thread_registry_bucket(process); t != NULL; t = t->bucket_next) {
+            if (t->process != process) {
+                continue;
+            }
+            if (threads != NULL) {
+                if (count == max_count) {
+                    break;
+                }
+                threads[count] = (dmosi_thread_t)t;
+            }
+            count++;
         }
-        count++;
     }
+    (void)xTaskResumeAll();
 
-    vPortFree(task_array);
-
-    // When writing to the array, cap the return value at the number of handles written.
-    if (threads != NULL && count > max_count) {
-        return max_count;
-    }
     return count;
 }
 
 /**
  * @brief Get an array of all threads
  *
- * Fills the provided array with handles of all existing threads by enumerating
- * FreeRTOS tasks and retrieving the dmosi_thread structure stored in TLS.
+ * Fills the provided array with handles of all existing threads from the
+ * thread registry.
  * If @p threads is NULL, returns the total number of threads.
  *
  * @param threads Pointer to array to fill, or NULL to query count only
@@ -687,6 +1530,8 @@ static size_t thread_enumerate(dmosi_process_t process, dmosi_thread_t* threads,
  */
 DMOD_INPUT_API_DECLARATION( dmosi, 1.0, size_t, _thread_get_all, (dmosi_thread_t* threads, size_t max_count) )
 {
+    DMOSI_MPU_PRIVILEGED_SCOPE();
+
     return thread_enumerate(NULL, threads, max_count);
 }
 
@@ -694,7 +1539,7 @@ DMOD_INPUT_API_DECLARATION( dmosi, 1.0, size_t, _thread_get_all, (dmosi_thread_t
  * @brief Get an array of threads belonging to a specific process
  *
  * Fills the provided array with handles of all threads associated with @p process
- * by enumerating FreeRTOS tasks and checking the dmosi_thread structure in TLS.
+ * from its bucket of the thread registry.
  * If @p threads is NULL, returns the number of threads in that process.
  *
  * @param process Process handle whose threads to retrieve
@@ -704,9 +1549,103 @@ DMOD_INPUT_API_DECLARATION( dmosi, 1.0, size_t, _thread_get_all, (dmosi_thread_t
  */
 DMOD_INPUT_API_DECLARATION( dmosi, 1.0, size_t, _thread_get_by_process, (dmosi_process_t process, dmosi_thread_t* threads, size_t max_count) )
 {
+    DMOSI_MPU_PRIVILEGED_SCOPE();
+
     return thread_enumerate(process, threads, max_count);
 }
 
+/**
+ * @brief Get the run time of a thread within a CPU usage window
+ *
+ * Threads that took no sample at the start of the window were created
+ * during it, so all of their run time counts.
+ *
+ * Must be called inside the critical section covering
+ * dmosi_runtime_window_locked().
+ *
+ * @param thread Registered thread with a live task
+ * @param window Window from dmosi_runtime_window_locked()
+ * @return configRUN_TIME_COUNTER_TYPE Run-time counter ticks spent running
+ */
+static configRUN_TIME_COUNTER_TYPE thread_cpu_busy_locked(struct dmosi_thread* thread, const dmosi_cpu_window_t* window)
+{
+    configRUN_TIME_COUNTER_TYPE busy = ulTaskGetRunTimeCounter(thread->handle);
+
+    if (window->seq != DMOSI_CPU_NO_SAMPLE && thread->cpu_first_sample != DMOSI_CPU_NO_SAMPLE &&
+        thread->cpu_first_sample <= window->seq) {
+        busy -= thread->cpu_samples[window->seq % DMOSI_CPU_SAMPLES];
+    }
+
+    return busy;
+}
+
+/**
+ * @brief Record the run-time counters of all registered threads
+ *
+ * Called by the CPU usage sampler inside a critical section.
+ *
+ * @param seq Sequence number of the sample
+ */
+void dmosi_thread_runtime_sample(uint32_t seq)
+{
+    for (struct dmosi_thread* t = g_thread_list; t != NULL; t = t->all_next) {
+        if (t->handle == NULL) {
+            continue;
+        }
+
+        t->cpu_samples[seq % DMOSI_CPU_SAMPLES] = ulTaskGetRunTimeCounter(t->handle);
+        if (t->cpu_first_sample == DMOSI_CPU_NO_SAMPLE || t->cpu_first_sample > seq) {
+            t->cpu_first_sample = seq;
+        }
+    }
+}
+
+/**
+ * @brief Measure the stack of a live thread
+ *
+ * The peak usage comes from the high-water mark in @p status. The current
+ * usage of the calling thread is taken from its own stack pointer; for other
+ * threads it is the depth saved at their last context switch (a thread running
+ * on another core may be deeper by now).
+ *
+ * @param thread Thread the status belongs to
+ * @param status Status of the task, with the high-water mark
+ * @param total Filled with the stack size in bytes
+ * @param current Filled with the bytes in use now
+ * @param peak Filled with the most bytes in use so far
+ */
+static void thread_stack_usage(const struct dmosi_thread* thread, const TaskStatus_t* status,
+                               size_t* total, size_t* current, size_t* peak)
+{
+    uintptr_t base = (uintptr_t)status->pxStackBase;
+    uintptr_t end = (uintptr_t)(status->pxEndOfStack + 1);
+
+    // Threads adopted from foreign tasks have no recorded size
+    *total = (thread->stack_size != 0) ? thread->stack_size : (size_t)(end - base);
+
+    volatile char stack_var;
+    uintptr_t sp = (thread->handle == xTaskGetCurrentTaskHandle()) ? (uintptr_t)&stack_var
+                                                                   : (uintptr_t)status->pxTopOfStack;
+
+    // Outside the task stack (e.g. the pthread stacks of the POSIX port) the
+    // depth is unknown
+    uintptr_t used = 0;
+    if (sp >= base && sp <= end) {
+#if ( portSTACK_GROWTH < 0 )
+        used = end - sp;
+#else
+        used = sp - base;
+#endif
+    }
+    *current = ((size_t)used < *total) ? (size_t)used : *total;
+
+    size_t free_bytes = (size_t)status->usStackHighWaterMark * sizeof(StackType_t);
+    *peak = (*total > free_bytes) ? (*total - free_bytes) : 0;
+    if (*peak < *current) {
+        *peak = *current;
+    }
+}
+
 /**
  * @brief Get information about a thread
  *
@@ -714,10 +1653,17 @@ DMOD_INPUT_API_DECLARATION( dmosi, 1.0, size_t, _thread_get_by_process, (dmosi_p
  * and runtime for the given thread.  If @p thread is NULL, the current thread
  * is used.
  *
- * Stack peak/current values are derived from FreeRTOS's high-water mark
- * (minimum free stack ever observed).  CPU usage and runtime are reported as
- * zero because run-time statistics are not enabled in the default build
- * configuration.
+ * The stack peak is derived from FreeRTOS's high-water mark (minimum free
+ * stack ever observed); the current usage is the depth of the stack pointer,
+ * as of the last context switch for threads other than the caller.  CPU
+ * usage covers the last
+ * DMOSI_CPU_WINDOW_SHORT_MS (see dmosi_thread_get_cpu_usage()), so load
+ * spikes are not averaged away over the thread's lifetime; runtime is the
+ * total run time of the thread.
+ *
+ * CPU usage is relative to a single core: a task can only run on one core at
+ * a time, so 100% means it kept one core busy, whatever configNUMBER_OF_CORES
+ * is. The load of each core is available from dmosi_core_get_usage().
  *
  * @param thread Thread handle (NULL = current thread)
  * @param info   Pointer to a dmosi_thread_info_t structure to fill
@@ -725,6 +1671,8 @@ DMOD_INPUT_API_DECLARATION( dmosi, 1.0, size_t, _thread_get_by_process, (dmosi_p
  */
 DMOD_INPUT_API_DECLARATION( dmosi, 1.0, int, _thread_get_info, (dmosi_thread_t thread, dmosi_thread_info_t* info) )
 {
+    DMOSI_MPU_PRIVILEGED_SCOPE();
+
     if (info == NULL) {
         return -EINVAL;
     }
@@ -765,51 +1713,27 @@ DMOD_INPUT_API_DECLARATION( dmosi, 1.0, int, _thread_get_info, (dmosi_thread_t t
         default:         state = DMOSI_THREAD_STATE_TERMINATED; break;
     }
 
-    // usStackHighWaterMark is the minimum free stack space in words (StackType_t units).
-    // Peak usage = total stack - minimum free space ever observed.
-    // FreeRTOS does not expose instantaneous stack usage, so stack_current is not available.
-    size_t free_bytes = (size_t)task_status.usStackHighWaterMark * sizeof(StackType_t);
-    size_t peak_usage = (thread->stack_size > free_bytes) ? (thread->stack_size - free_bytes) : 0;
-
-    info->stack_total   = thread->stack_size;
-    info->stack_current = 0;       // Not measurable by FreeRTOS at arbitrary call sites
-    info->stack_peak    = peak_usage;
+    thread_stack_usage(thread, &task_status, &info->stack_total, &info->stack_current, &info->stack_peak);
     info->state         = state;
 
-    // Compute cpu_usage from the FreeRTOS run-time stats counter.
-    // task_status.ulRunTimeCounter holds the accumulated counter ticks for this task.
-    // portGET_RUN_TIME_COUNTER_VALUE() returns the current total elapsed counter value.
-    // Clamp to [0, 100] because sampling the task counter and total counter at different
-    // instants can make the ratio slightly exceed 100% due to scheduling jitter.
-    configRUN_TIME_COUNTER_TYPE total_runtime = portGET_RUN_TIME_COUNTER_VALUE();
-    if (total_runtime > 0U) {
-        float usage = (float)task_status.ulRunTimeCounter / (float)total_runtime * 100.0f;
-        info->cpu_usage = (usage < 100.0f) ? usage : 100.0f;
+    dmosi_cpu_window_t window;
+
+    taskENTER_CRITICAL();
+    dmosi_runtime_window_locked(DMOSI_CPU_WINDOW_SHORT_MS, &window);
+    configRUN_TIME_COUNTER_TYPE busy = thread_cpu_busy_locked(thread, &window);
+    taskEXIT_CRITICAL();
+
+    float usage = dmosi_runtime_share(busy, &window);
+    info->cpu_usage = (usage < 100.0f) ? usage : 100.0f;
+
+    // Divide before multiplying to avoid overflow when the counter value is large
+    uint64_t hz = dmosi_runtime_get_counter_hz();
+    if (hz > 0) {
+        uint64_t counter = (uint64_t)task_status.ulRunTimeCounter;
+        info->runtime_ms = (counter / hz) * 1000ULL + (counter % hz) * 1000ULL / hz;
     } else {
-        info->cpu_usage = 0.0f;
-    }
-
-    // Compute runtime_ms.  The counter unit depends on portGET_RUN_TIME_COUNTER_VALUE():
-    // on POSIX it returns tms_utime ticks (CLK_TCK per second); convert via sysconf.
-    // Divide before multiplying (seconds * 1000 + sub-second remainder * 1000 / clk_tck)
-    // to avoid overflow when the counter value is large.
-    // On other architectures, runtime_ms is left as 0 (counter frequency is unknown
-    // without a port-specific conversion factor).
-#if defined(__unix__) || defined(__APPLE__)
-    {
-        long clk_tck = sysconf(_SC_CLK_TCK);
-        if (clk_tck > 0) {
-            uint64_t counter = (uint64_t)task_status.ulRunTimeCounter;
-            uint64_t freq    = (uint64_t)clk_tck;
-            info->runtime_ms = (counter / freq) * 1000ULL
-                               + (counter % freq) * 1000ULL / freq;
-        } else {
-            info->runtime_ms = 0;
-        }
+        info->runtime_ms = 0;
     }
-#else
-    info->runtime_ms = 0;
-#endif
 
     return 0;
 }
@@ -833,6 +1757,8 @@ DMOD_INPUT_API_DECLARATION( dmosi, 1.0, int, _thread_get_info, (dmosi_thread_t t
  */
 DMOD_INPUT_API_DECLARATION( dmosi, 1.0, dmosi_thread_exit_callback_handle_t, _thread_register_exit_callback, (dmosi_thread_t thread, dmosi_thread_exit_callback_t callback, void* arg) )
 {
+    DMOSI_MPU_PRIVILEGED_SCOPE();
+
     if (thread == NULL || callback == NULL) {
         return NULL;
     }
@@ -871,6 +1797,8 @@ DMOD_INPUT_API_DECLARATION( dmosi, 1.0, dmosi_thread_exit_callback_handle_t, _th
  */
 DMOD_INPUT_API_DECLARATION( dmosi, 1.0, int, _thread_unregister_exit_callback, (dmosi_thread_t thread, dmosi_thread_exit_callback_handle_t handle) )
 {
+    DMOSI_MPU_PRIVILEGED_SCOPE();
+
     if (thread == NULL || handle == NULL) {
         return -EINVAL;
     }
@@ -896,6 +1824,368 @@ DMOD_INPUT_API_DECLARATION( dmosi, 1.0, int, _thread_unregister_exit_callback, (
     return 0;
 }
 
+//==============================================================================
+//                              Thread priority
+//==============================================================================
+
+/**
+ * @brief Change the priority of a thread
+ *
+ * Sets the base priority. While the thread holds a FreeRTOS mutex with an
+ * inherited priority the higher priority stays in effect until it is
+ * released. A thread raised by a dmosi mutex ceiling or contention boost
+ * returns to the priority it had when that mutex was locked.
+ *
+ * @param thread Thread handle (NULL = current thread)
+ * @param priority New priority (0 .. configMAX_PRIORITIES - 1)
+ * @return int 0 on success, -EINVAL if @p priority is out of range,
+ *         -ESRCH if the thread has terminated
+ */
+int dmosi_thread_set_priority(dmosi_thread_t thread, int priority)
+{
+    if (priority < 0 || priority >= (int)configMAX_PRIORITIES) {
+        return -EINVAL;
+    }
+
+    if (thread == NULL) {
+        thread = dmosi_thread_current();
+        if (thread == NULL) {
+            return -EFAULT;
+        }
+    }
+
+    if (thread->handle == NULL || (thread->entry != NULL && thread->completed)) {
+        return -ESRCH;
+    }
+
+    vTaskPrioritySet(thread->handle, (UBaseType_t)priority);
+
+    return 0;
+}
+
+//==============================================================================
+//                              Multi-core
+//==============================================================================
+
+/**
+ * @brief Mask with one bit set for every core the scheduler runs on
+ */
+#define THREAD_ALL_CORES_MASK    ((uint32_t)((1ULL << configNUMBER_OF_CORES) - 1U))
+
+/**
+ * @brief Get the number of cores the scheduler runs on
+ *
+ * @return uint32_t Number of cores (configNUMBER_OF_CORES)
+ */
+uint32_t dmosi_core_count(void)
+{
+    return (uint32_t)configNUMBER_OF_CORES;
+}
+
+/**
+ * @brief Restrict the cores a thread may run on
+ *
+ * On single-core builds only core 0 exists, so any mask containing it is
+ * accepted and has no effect.
+ *
+ * @param thread Thread handle (NULL = current thread)
+ * @param core_mask Bit mask of allowed cores (bit n = core n)
+ * @return int 0 on success, -EINVAL if @p core_mask selects no existing core,
+ *         -ESRCH if the thread has terminated
+ */
+int dmosi_thread_set_affinity(dmosi_thread_t thread, uint32_t core_mask)
+{
+    if ((core_mask & THREAD_ALL_CORES_MASK) == 0) {
+        return -EINVAL;
+    }
+
+    if (thread == NULL) {
+        thread = dmosi_thread_current();
+        if (thread == NULL) {
+            return -EFAULT;
+        }
+    }
+
+    if (thread->handle == NULL || (thread->entry != NULL && thread->completed)) {
+        return -ESRCH;
+    }
+
+#if configNUMBER_OF_CORES > 1
+    vTaskCoreAffinitySet(thread->handle, (UBaseType_t)(core_mask & THREAD_ALL_CORES_MASK));
+#endif
+
+    return 0;
+}
+
+/**
+ * @brief Get the cores a thread may run on
+ *
+ * @param thread Thread handle (NULL = current thread)
+ * @param core_mask Set to the bit mask of allowed cores (bit n = core n)
+ * @return int 0 on success, -EINVAL if @p core_mask is NULL, -ESRCH if the
+ *         thread has terminated
+ */
+int dmosi_thread_get_affinity(dmosi_thread_t thread, uint32_t* core_mask)
+{
+    if (core_mask == NULL) {
+        return -EINVAL;
+    }
+
+    if (thread == NULL) {
+        thread = dmosi_thread_current();
+        if (thread == NULL) {
+            return -EFAULT;
+        }
+    }
+
+    if (thread->handle == NULL || (thread->entry != NULL && thread->completed)) {
+        return -ESRCH;
+    }
+
+#if configNUMBER_OF_CORES > 1
+    *core_mask = (uint32_t)vTaskCoreAffinityGet(thread->handle) & THREAD_ALL_CORES_MASK;
+#else
+    *core_mask = THREAD_ALL_CORES_MASK;
+#endif
+
+    return 0;
+}
+
+/**
+ * @brief Get the recent load of a core
+ *
+ * Covers the last DMOSI_CPU_WINDOW_SHORT_MS, the same window as the CPU usage
+ * reported by _thread_get_info, so the load of a core can be compared with
+ * the usage of the threads running on it. Other windows are available from
+ * dmosi_core_get_cpu_usage().
+ *
+ * @param core Core index (0 .. dmosi_core_count() - 1)
+ * @param usage Set to the share of time the core was busy, in percent [0, 100]
+ * @return int 0 on success, -EINVAL on invalid arguments
+ */
+int dmosi_core_get_usage(uint32_t core, float* usage)
+{
+    return dmosi_core_get_cpu_usage(core, DMOSI_CPU_WINDOW_SHORT_MS, usage);
+}
+
+//==============================================================================
+//                              Run-time statistics
+//==============================================================================
+
+/**
+ * @brief Get the CPU usage of a thread over a recent time window
+ *
+ * The window ends now and starts at the newest CPU usage sample at least
+ * @p window_ms old, so it is up to DMOSI_CPU_SAMPLE_MS longer than asked
+ * for; with less history it covers the time since the thread or the
+ * sampler started. Relative to a single core, like _thread_get_info.
+ *
+ * @param thread Thread handle (NULL = current thread)
+ * @param window_ms Window length in milliseconds (0 = since the thread started)
+ * @param usage Set to the share of the window the thread ran, in percent [0, 100]
+ * @return int 0 on success, -ESRCH if the thread terminated, -EINVAL on invalid arguments
+ */
+int dmosi_thread_get_cpu_usage(dmosi_thread_t thread, uint32_t window_ms, float* usage)
+{
+    if (usage == NULL) {
+        return -EINVAL;
+    }
+
+    struct dmosi_thread* t = (struct dmosi_thread*)((thread != NULL) ? thread : dmosi_thread_current());
+    if (t == NULL) {
+        return -EINVAL;
+    }
+
+    dmosi_cpu_window_t window;
+    int result = 0;
+
+    taskENTER_CRITICAL();
+    if (!t->registered || t->handle == NULL) {
+        result = -ESRCH;
+    } else {
+        dmosi_runtime_window_locked(window_ms, &window);
+        float share = dmosi_runtime_share(thread_cpu_busy_locked(t, &window), &window);
+        *usage = (share < 100.0f) ? share : 100.0f;
+    }
+    taskEXIT_CRITICAL();
+
+    return result;
+}
+
+/**
+ * @brief Get the CPU usage of a process over a recent time window
+ *
+ * Sums the windowed run time of the process's live threads (see
+ * dmosi_thread_get_cpu_usage()); threads that already terminated no longer
+ * count. 100% corresponds to one fully busy core.
+ *
+ * @param process Process handle (NULL = current process)
+ * @param window_ms Window length in milliseconds (0 = since start)
+ * @param usage Set to the share of the window the threads ran, in percent
+ *        [0, 100 * configNUMBER_OF_CORES]
+ * @return int 0 on success, -EINVAL on invalid arguments
+ */
+int dmosi_process_get_cpu_usage(dmosi_process_t process, uint32_t window_ms, float* usage)
+{
+    if (usage == NULL) {
+        return -EINVAL;
+    }
+
+    if (process == NULL) {
+        process = dmosi_process_current();
+        if (process == NULL) {
+            return -EINVAL;
+        }
+    }
+
+    dmosi_cpu_window_t window;
+    configRUN_TIME_COUNTER_TYPE busy = 0;
+
+    taskENTER_CRITICAL();
+    dmosi_runtime_window_locked(window_ms, &window);
+    for (struct dmosi_thread* t = *thread_registry_bucket(process); t != NULL; t = t->bucket_next) {
+        if (t->process == process && t->handle != NULL) {
+            busy += thread_cpu_busy_locked(t, &window);
+        }
+    }
+    taskEXIT_CRITICAL();
+
+    float share = dmosi_runtime_share(busy, &window);
+    float limit = 100.0f * (float)configNUMBER_OF_CORES;
+    *usage = (share < limit) ? share : limit;
+
+    return 0;
+}
+
+//==============================================================================
+//                              Stack cache
+//==============================================================================
+
+/**
+ * @brief Get statistics of the thread stack cache
+ *
+ * @param stats Structure to fill
+ * @return int 0 on success, -EINVAL if @p stats is NULL, -ENOTSUP if the
+ *         cache is disabled
+ */
+int dmosi_thread_cache_get_stats(dmosi_thread_cache_stats_t* stats)
+{
+    if (stats == NULL) {
+        return -EINVAL;
+    }
+
+    if (DMOSI_THREAD_CACHE_SIZE == 0) {
+        return -ENOTSUP;
+    }
+
+    taskENTER_CRITICAL();
+    stats->cached_blocks = g_thread_cache_count;
+    stats->cached_bytes = 0;
+    for (struct thread_cache_block* block = g_thread_cache; block != NULL; block = block->next) {
+        stats->cached_bytes += THREAD_CACHE_HEADER_SIZE + block->stack_size;
+    }
+    stats->hits = g_thread_cache_hits;
+    stats->misses = g_thread_cache_misses;
+    taskEXIT_CRITICAL();
+
+    return 0;
+}
+
+/**
+ * @brief Free all blocks held by the thread stack cache
+ *
+ * Parked tasks of finished cached threads are reaped first, so their blocks
+ * are freed as well. Blocks of threads that are still running are not
+ * affected; they are cached again when those threads finish.
+ *
+ * @return size_t Number of bytes returned to the heap
+ */
+size_t dmosi_thread_cache_trim(void)
+{
+    size_t freed = 0;
+
+    thread_cache_reap();
+
+    taskENTER_CRITICAL();
+    struct thread_cache_block* block = g_thread_cache;
+    g_thread_cache = NULL;
+    g_thread_cache_count = 0;
+    taskEXIT_CRITICAL();
+
+    while (block != NULL) {
+        struct thread_cache_block* next = block->next;
+        freed += THREAD_CACHE_HEADER_SIZE + block->stack_size;
+        vPortFree(block);
+        block = next;
+    }
+
+    return freed;
+}
+
+//==============================================================================
+//                              Stack advisor
+//==============================================================================
+
+/**
+ * @brief Recommend a stack size for a measured peak usage
+ *
+ * @param peak Most bytes in use so far
+ * @return size_t Peak plus DMOSI_STACK_ADVISOR_MARGIN percent and the
+ *         overflow guard, aligned, at least configMINIMAL_STACK_SIZE
+ */
+static size_t thread_stack_recommend(size_t peak)
+{
+    size_t size = peak + (peak * DMOSI_STACK_ADVISOR_MARGIN + 99U) / 100U + THREAD_STACK_GUARD_SIZE;
+    size = (size + portBYTE_ALIGNMENT - 1U) & ~((size_t)portBYTE_ALIGNMENT - 1U);
+
+    size_t minimum = (size_t)configMINIMAL_STACK_SIZE * sizeof(StackType_t);
+    return (size > minimum) ? size : minimum;
+}
+
+/**
+ * @brief Measure the stacks of all threads and recommend stack sizes
+ *
+ * Walks the thread registry with the scheduler suspended, so no thread of
+ * this core can be destroyed meanwhile, and scans the stack of each live
+ * thread for its high-water mark. Threads that have finished are skipped.
+ *
+ * The recommendation only covers the deepest path each thread has taken so
+ * far, so sample after the threads have gone through their worst case.
+ *
+ * @param process Only report threads of this process (NULL = all threads)
+ * @param entries Array to fill
+ * @param max_entries Capacity of @p entries
+ * @return size_t Number of entries filled
+ */
+size_t dmosi_thread_stack_advise(dmosi_process_t process, dmosi_stack_advice_t* entries, size_t max_entries)
+{
+    if (entries == NULL) {
+        return 0;
+    }
+
+    size_t count = 0;
+
+    vTaskSuspendAll();
+    for (struct dmosi_thread* t = g_thread_list; t != NULL && count < max_entries; t = t->all_next) {
+        if ((process != NULL && t->process != process) ||
+            t->handle == NULL || (t->entry != NULL && t->completed)) {
+            continue;
+        }
+
+        TaskStatus_t task_status;
+        vTaskGetInfo(t->handle, &task_status, pdTRUE, eInvalid);
+
+        dmosi_stack_advice_t* entry = &entries[count++];
+        entry->thread = (dmosi_thread_t)t;
+        entry->process = t->process;
+        thread_stack_usage(t, &task_status, &entry->stack_size, &entry->stack_current, &entry->stack_peak);
+        entry->recommended_size = thread_stack_recommend(entry->stack_peak);
+    }
+    (void)xTaskResumeAll();
+
+    return count;
+}
+
 //==============================================================================
 //                              Initialization helpers
 //==============================================================================
@@ -939,12 +2229,92 @@ void dmosi_thread_unregister_current(void)
     struct dmosi_thread* thread = (struct dmosi_thread*)pvTaskGetThreadLocalStoragePointer(
         current_handle, DMOD_THREAD_TLS_INDEX);
 
-    if (thread != NULL) {
+    if (thread != NULL && thread != DMOSI_THREAD_TLS_BOOTSTRAPPING) {
+        thread_registry_remove(thread);
         vTaskSetThreadLocalStoragePointer(current_handle, DMOD_THREAD_TLS_INDEX, NULL);
         vPortFree(thread);
     }
 }
 
+/**
+ * @brief Get the module name of the current task for allocation tagging
+ *
+ * Fast path used by pvPortMalloc(): reads the cached module name straight from
+ * the task's TLS slot, without going through dmosi_thread_current() and the
+ * owning process. Only a task that has no dmosi_thread yet takes the slow path
+ * (lazy registration), which happens at most once per task.
+ *
+ * @param heap_slot Filled with the heap statistics slot of the module (may be NULL)
+ * @return const char* Module name to tag the allocation with, NULL if unknown
+ *         (including while the current task's wrapper is being created)
+ */
+const char* dmosi_thread_current_module_name(uint32_t* heap_slot)
+{
+    const char* module_name = NULL;
+    struct dmosi_thread* thread = NULL;
+    TaskHandle_t current_handle = xTaskGetCurrentTaskHandle();
+
+    if (current_handle != NULL) {
+        thread = (struct dmosi_thread*)pvTaskGetThreadLocalStoragePointer(current_handle, DMOD_THREAD_TLS_INDEX);
+        if (thread == NULL) {
+            module_name = dmosi_thread_get_module_name(NULL);
+        } else if (thread != DMOSI_THREAD_TLS_BOOTSTRAPPING) {
+            module_name = thread->module_name;
+        }
+    }
+
+    if (heap_slot != NULL) {
+#if DMOSI_HEAP_STATS
+        bool cached = (thread != NULL && thread != DMOSI_THREAD_TLS_BOOTSTRAPPING);
+        *heap_slot = cached ? thread->heap_slot : dmosi_heap_stats_slot(module_name);
+#else
+        *heap_slot = 0;
+#endif
+    }
+
+    return module_name;
+}
+
+/**
+ * @brief Get the FreeRTOS task handle of a thread
+ *
+ * Lets other dmosi objects (e.g. events bound to a waiter) address the task
+ * directly without exposing the thread structure.
+ *
+ * @param thread Thread handle (NULL = current thread)
+ * @return TaskHandle_t Task handle
+ */
+TaskHandle_t dmosi_thread_get_task_handle(dmosi_thread_t thread)
+{
+    if (thread == NULL) {
+        return xTaskGetCurrentTaskHandle();
+    }
+
+    return thread->handle;
+}
+
+#if DMOSI_MPU
+/**
+ * @brief Apply new MPU regions to the running threads of a process
+ *
+ * The kernel only copies the settings into the TCBs; they take effect when
+ * each task is next switched in.
+ *
+ * @param process Isolated process
+ * @param regions Regions of @p process
+ */
+void dmosi_thread_mpu_update(dmosi_process_t process, const MemoryRegion_t* regions)
+{
+    taskENTER_CRITICAL();
+    for (struct dmosi_thread* t = *thread_registry_bucket(process); t != NULL; t = t->bucket_next) {
+        if (t->process == process && t->mpu_block != NULL && t->handle != NULL) {
+            vTaskAllocateMPURegions(t->handle, regions);
+        }
+    }
+    taskEXIT_CRITICAL();
+}
+#endif
+
 //==============================================================================
 //                              Dmod SAL Implementation
 //==============================================================================
@@ -965,6 +2335,8 @@ void dmosi_thread_unregister_current(void)
  */
 DMOD_INPUT_API_DECLARATION( Dmod, 1.0, size_t, _GetLeftStackSize, (void) )
 {
+    DMOSI_MPU_PRIVILEGED_SCOPE();
+
     volatile char stack_var;
 
 #if DMOD_USE_PTHREAD && defined(__linux__)
@@ -0,0 +1,126 @@
+#ifndef DMOSI_TICKS_H
+#define DMOSI_TICKS_H
+
+#include <stdint.h>
+#include "dmosi_freertos.h"
+#include "FreeRTOS.h"
+
+/**
+ * @brief Largest finite timeout in ticks
+ *
+ * One below portMAX_DELAY, so that a long but finite wait is never turned
+ * into an infinite one by clamping.
+ */
+#define DMOSI_TICKS_MAX_FINITE    ( ( uint32_t ) portMAX_DELAY - 1U )
+
+/**
+ * @brief Convert milliseconds to ticks, rounding up
+ *
+ * The tick rate is a compile-time constant, so the branches below are
+ * resolved by the preprocessor: when it divides 1000 (100 Hz, 1000 Hz, ...)
+ * or is a multiple of 1000 the conversion is a single 32-bit division by a
+ * constant or multiplication, which compilers turn into a multiply and
+ * shift. Other rates split @p ms into whole seconds and a remainder so the
+ * arithmetic still stays within 32 bits, unlike pdMS_TO_TICKS().
+ *
+ * The result saturates at DMOSI_TICKS_MAX_FINITE.
+ *
+ * @param ms Time in milliseconds
+ * @return TickType_t Smallest tick count covering @p ms (0 only for 0)
+ */
+static inline TickType_t dmosi_ticks_from_ms(uint32_t ms)
+{
+#if ( 1000 % configTICK_RATE_HZ ) == 0
+    const uint32_t ms_per_tick = 1000U / configTICK_RATE_HZ;
+    uint32_t ticks = ms / ms_per_tick + ( ( ms % ms_per_tick ) != 0U ? 1U : 0U );
+#elif ( configTICK_RATE_HZ % 1000 ) == 0
+    const uint32_t ticks_per_ms = configTICK_RATE_HZ / 1000U;
+    if (ms > DMOSI_TICKS_MAX_FINITE / ticks_per_ms) {
+        return (TickType_t)DMOSI_TICKS_MAX_FINITE;
+    }
+    uint32_t ticks = ms * ticks_per_ms;
+#else
+    uint32_t seconds = ms / 1000U;
+    if (seconds > DMOSI_TICKS_MAX_FINITE / configTICK_RATE_HZ) {
+        return (TickType_t)DMOSI_TICKS_MAX_FINITE;
+    }
+    uint32_t ticks = seconds * configTICK_RATE_HZ
+                   + ( ( ms % 1000U ) * configTICK_RATE_HZ + 999U ) / 1000U;
+#endif
+
+    return (TickType_t)( ( ticks > DMOSI_TICKS_MAX_FINITE ) ? DMOSI_TICKS_MAX_FINITE : ticks );
+}
+
+/**
+ * @brief Convert a relative wait in milliseconds to ticks
+ *
+ * A wait ends on a tick interrupt, and the first one may follow right after
+ * the wait started, so one tick is added on top of dmosi_ticks_from_ms().
+ * That way the wait never ends before @p ms have elapsed.
+ *
+ * @param ms Wait time in milliseconds
+ * @return TickType_t 0 for 0, otherwise one tick more than
+ *         dmosi_ticks_from_ms() (saturated at DMOSI_TICKS_MAX_FINITE)
+ */
+static inline TickType_t dmosi_ticks_from_wait_ms(uint32_t ms)
+{
+    TickType_t ticks = dmosi_ticks_from_ms(ms);
+
+    return (ticks == 0U || ticks >= DMOSI_TICKS_MAX_FINITE) ? ticks : (TickType_t)( ticks + 1U );
+}
+
+/**
+ * @brief Convert an API timeout to ticks
+ *
+ * @param timeout_ms Timeout in milliseconds (0 = no wait, negative = wait forever)
+ * @return TickType_t 0, portMAX_DELAY, or the tick count of
+ *         dmosi_ticks_from_wait_ms()
+ */
+static inline TickType_t dmosi_ticks_from_timeout(int32_t timeout_ms)
+{
+    if (timeout_ms < 0) {
+        // Wait forever
+        return portMAX_DELAY;
+    }
+
+    return dmosi_ticks_from_wait_ms((uint32_t)timeout_ms);
+}
+
+/**
+ * @brief Convert a tick-domain API timeout to kernel ticks
+ *
+ * @param ticks Timeout in ticks (0 = no wait, DMOSI_TICKS_FOREVER = wait forever)
+ * @return TickType_t @p ticks, saturated at DMOSI_TICKS_MAX_FINITE when
+ *         TickType_t is narrower than 32 bits
+ */
+static inline TickType_t dmosi_ticks_from_api(uint32_t ticks)
+{
+    if (ticks == DMOSI_TICKS_FOREVER) {
+        return portMAX_DELAY;
+    }
+
+    return (TickType_t)( ( ticks > DMOSI_TICKS_MAX_FINITE ) ? DMOSI_TICKS_MAX_FINITE : ticks );
+}
+
+/**
+ * @brief Convert ticks to milliseconds, rounding down
+ *
+ * Computed in 64 bits (a multiplication only when the tick rate divides
+ * 1000), so long periods are not truncated in tick width.
+ *
+ * @param ticks Tick count
+ * @return uint32_t Milliseconds, saturated at UINT32_MAX
+ */
+static inline uint32_t dmosi_ticks_to_ms_floor(uint32_t ticks)
+{
+#if ( 1000 % configTICK_RATE_HZ ) == 0
+    uint64_t ms = (uint64_t)ticks * ( 1000U / configTICK_RATE_HZ );
+#else
+    uint64_t ms = (uint64_t)( ticks / configTICK_RATE_HZ ) * 1000U
+                + (uint64_t)( ticks % configTICK_RATE_HZ ) * 1000U / configTICK_RATE_HZ;
+#endif
+
+    return ( ms > UINT32_MAX ) ? UINT32_MAX : (uint32_t)ms;
+}
+
+#endif /* DMOSI_TICKS_H */
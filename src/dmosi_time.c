@@ -1,8 +1,110 @@
 #include <stdint.h>
 #include "dmosi.h"
+#include "dmosi_freertos.h"
+#include "dmosi_ticks.h"
 #include "FreeRTOS.h"
 #include "task.h"
 
+#if defined(DMOSI_ARCH_TIME_CLOCK_GETTIME)
+    #include <time.h>
+#endif
+
+/**
+ * @brief Number of nanoseconds per second
+ */
+#define TIME_NS_PER_SECOND    1000000000ULL
+
+#if defined(DMOSI_ARCH_TIME_SYSTICK)
+
+/*
+ * Cortex-M SysTick and interrupt control registers (identical on ARMv6-M,
+ * ARMv7-M and ARMv8-M)
+ */
+#define TIME_SYSTICK_LOAD     ( *( volatile uint32_t* ) 0xE000E014UL )
+#define TIME_SYSTICK_VAL      ( *( volatile uint32_t* ) 0xE000E018UL )
+#define TIME_SCB_ICSR         ( *( volatile uint32_t* ) 0xE000ED04UL )
+#define TIME_ICSR_PENDSTSET   ( 1UL << 26 )
+
+#ifdef configSYSTICK_CLOCK_HZ
+    #define TIME_SYSTICK_HZ    ( ( uint64_t ) configSYSTICK_CLOCK_HZ )
+#else
+    #define TIME_SYSTICK_HZ    ( ( uint64_t ) configCPU_CLOCK_HZ )
+#endif
+
+/**
+ * @brief Get the time elapsed within the current tick
+ *
+ * SysTick counts down from LOAD to 0 once per tick. A reload whose tick
+ * interrupt is still pending (e.g. inside a critical section) is reported
+ * as a full tick on top of the counter value.
+ *
+ * @return uint64_t Nanoseconds since the last tick was counted
+ */
+static uint64_t time_subtick_ns(void)
+{
+    uint32_t load = TIME_SYSTICK_LOAD;
+    if (load == 0) {
+        return 0;   // SysTick not running yet
+    }
+
+    uint32_t value = TIME_SYSTICK_VAL;
+    uint64_t elapsed = (uint64_t)(load - value);
+
+    // The pending flag may belong to a reload just after VAL was read, in
+    // which case VAL is still near zero
+    if ((TIME_SCB_ICSR & TIME_ICSR_PENDSTSET) != 0 && value > load / 2) {
+        elapsed += (uint64_t)load + 1;
+    }
+
+    return elapsed * TIME_NS_PER_SECOND / TIME_SYSTICK_HZ;
+}
+
+#else
+
+/**
+ * @brief Get the time elapsed within the current tick
+ *
+ * No sub-tick counter on this architecture: time advances in whole ticks.
+ *
+ * @return uint64_t Always 0
+ */
+static inline uint64_t time_subtick_ns(void)
+{
+    return 0;
+}
+
+#endif
+
+/**
+ * @brief Get the 64-bit tick count without a critical section
+ *
+ * Reads the kernel tick count together with its overflow counter, so a
+ * 16- or 32-bit tick type is extended without any periodic maintenance.
+ * The pair is read twice and the read is retried if a tick happened in
+ * between; @p subtick_ns is sampled between the two reads so it belongs to
+ * the same tick.
+ *
+ * @param subtick_ns Set to the time elapsed within the returned tick
+ * @return uint64_t Ticks since the scheduler started
+ */
+static uint64_t time_ticks64(uint64_t* subtick_ns)
+{
+    TimeOut_t first;
+    TimeOut_t second;
+
+    do {
+        vTaskInternalSetTimeOutState(&first);
+        *subtick_ns = time_subtick_ns();
+        vTaskInternalSetTimeOutState(&second);
+    } while (first.xOverflowCount != second.xOverflowCount || first.xTimeOnEntering != second.xTimeOnEntering);
+
+#if ( configTICK_TYPE_WIDTH_IN_BITS == TICK_TYPE_WIDTH_64_BITS )
+    return (uint64_t)second.xTimeOnEntering;
+#else
+    return ((uint64_t)(UBaseType_t)second.xOverflowCount << (sizeof(TickType_t) * 8)) | (uint64_t)second.xTimeOnEntering;
+#endif
+}
+
 //==============================================================================
 //                              System Time API Implementation
 //==============================================================================
@@ -23,3 +125,71 @@ DMOD_INPUT_API_DECLARATION( dmosi, 1.0, uint32_t, _get_tick_count, (void) )
 
     return (uint32_t)( (uint64_t)ticks * 1000ULL / configTICK_RATE_HZ );
 }
+
+/**
+ * @brief Get the monotonic time in nanoseconds
+ *
+ * 64 bits wide, so it does not wrap in practice. Combines the tick count
+ * with the architecture's sub-tick counter (SysTick on Cortex-M), or reads
+ * CLOCK_MONOTONIC on POSIX; elsewhere the resolution is one tick. Lock-free
+ * and safe to call from both task and interrupt context.
+ *
+ * @return uint64_t Nanoseconds since the scheduler started (since an
+ *         arbitrary point in the past on POSIX)
+ */
+uint64_t dmosi_get_time_ns(void)
+{
+#if defined(DMOSI_ARCH_TIME_CLOCK_GETTIME)
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * TIME_NS_PER_SECOND + (uint64_t)ts.tv_nsec;
+#else
+    uint64_t subtick_ns;
+    uint64_t ticks = time_ticks64(&subtick_ns);
+
+    // Split the conversion so that it cannot overflow for any tick count
+    return (ticks / configTICK_RATE_HZ) * TIME_NS_PER_SECOND
+           + (ticks % configTICK_RATE_HZ) * TIME_NS_PER_SECOND / configTICK_RATE_HZ
+           + subtick_ns;
+#endif
+}
+
+/**
+ * @brief Get the monotonic time in microseconds
+ *
+ * @see dmosi_get_time_ns()
+ *
+ * @return uint64_t Microseconds since the scheduler started
+ */
+uint64_t dmosi_get_time_us(void)
+{
+    return dmosi_get_time_ns() / 1000ULL;
+}
+
+//==============================================================================
+//                              Tick conversion API Implementation
+//==============================================================================
+
+/**
+ * @brief Convert milliseconds to ticks, rounding up
+ *
+ * @see dmosi_ticks_from_ms()
+ *
+ * @param ms Time in milliseconds
+ * @return uint32_t Tick count, saturated below DMOSI_TICKS_FOREVER
+ */
+uint32_t dmosi_ms_to_ticks(uint32_t ms)
+{
+    return (uint32_t)dmosi_ticks_from_ms(ms);
+}
+
+/**
+ * @brief Convert ticks to milliseconds, rounding down
+ *
+ * @param ticks Tick count
+ * @return uint32_t Milliseconds, saturated at UINT32_MAX
+ */
+uint32_t dmosi_ticks_to_ms(uint32_t ticks)
+{
+    return dmosi_ticks_to_ms_floor(ticks);
+}
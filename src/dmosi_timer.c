@@ -2,7 +2,12 @@
 #include <stdbool.h>
 #include <errno.h>
 #include "dmosi.h"
+#include "dmosi_pool.h"
+#include "dmosi_freertos.h"
+#include "dmosi_ticks.h"
+#include "dmosi_mpu.h"
 #include "FreeRTOS.h"
+#include "task.h"
 #include "timers.h"
 
 /**
@@ -11,27 +16,34 @@
  * This structure wraps the FreeRTOS TimerHandle_t and stores
  * the user callback and argument so the FreeRTOS timer callback
  * can invoke the user-provided callback with the correct argument.
+ * The kernel control block is embedded, so a timer needs a single
+ * allocation.
  */
 struct dmosi_timer {
     TimerHandle_t handle;             /**< FreeRTOS timer handle */
+    StaticTimer_t buffer;             /**< Embedded FreeRTOS control block */
     dmosi_timer_callback_t callback;  /**< User-provided callback */
     void* arg;                        /**< User-provided callback argument */
+    bool is_static;                   /**< Whether the wrapper lives in caller-provided storage */
 };
 
+_Static_assert(sizeof(struct dmosi_timer) <= sizeof(dmosi_timer_storage_t),
+               "dmosi_timer_storage_t is too small for struct dmosi_timer");
+_Static_assert(_Alignof(struct dmosi_timer) <= _Alignof(dmosi_timer_storage_t),
+               "dmosi_timer_storage_t is under-aligned for struct dmosi_timer");
+
 /**
- * @brief Convert milliseconds to FreeRTOS ticks, ensuring at least 1 tick
- *
- * @param ms Time in milliseconds
- * @return TickType_t Equivalent tick count (minimum 1 if ms > 0)
+ * @brief Completion flag used to wait for the timer service task
  */
-static TickType_t ms_to_ticks(uint32_t ms)
-{
-    TickType_t ticks = pdMS_TO_TICKS(ms);
-    if (ms > 0 && ticks == 0) {
-        ticks = 1;
-    }
-    return ticks;
-}
+struct timer_fence {
+    TaskHandle_t waiter;              /**< Task waiting for the fence */
+    volatile bool done;               /**< Set once the timer service task reached the fence */
+};
+
+/**
+ * @brief Pool serving struct dmosi_timer wrappers (see DMOSI_TIMER_POOL_SIZE)
+ */
+DMOSI_POOL_DEFINE(g_dmosi_timer_pool, struct dmosi_timer, DMOSI_TIMER_POOL_SIZE);
 
 /**
  * @brief Internal FreeRTOS timer callback wrapper
@@ -51,6 +63,93 @@ static void timer_callback_wrapper(TimerHandle_t xTimer)
     }
 }
 
+/**
+ * @brief Initialize a timer wrapper and create its kernel object in place
+ *
+ * @param timer Wrapper to initialize
+ * @param callback Callback function to execute when timer expires
+ * @param arg Argument to pass to the callback function
+ * @param period_ms Timer period in milliseconds
+ * @param auto_reload Whether the timer should auto-reload
+ * @param is_static Whether the wrapper lives in caller-provided storage
+ * @return true on success, false if the kernel object could not be created
+ */
+static bool timer_init(struct dmosi_timer* timer, dmosi_timer_callback_t callback, void* arg, uint32_t period_ms, bool auto_reload, bool is_static)
+{
+    timer->callback = callback;
+    timer->arg = arg;
+    timer->is_static = is_static;
+
+    timer->handle = xTimerCreateStatic(
+        "dmosi_timer",
+        dmosi_ticks_from_ms(period_ms),
+        auto_reload ? pdTRUE : pdFALSE,
+        (void*)timer,
+        timer_callback_wrapper,
+        &timer->buffer
+    );
+
+    return timer->handle != NULL;
+}
+
+/**
+ * @brief Return a pooled timer wrapper once the timer service task deleted it
+ *
+ * Runs on the timer service task, queued right behind the delete command, so
+ * the embedded control block is no longer referenced by the kernel.
+ *
+ * @param pvParameter1 Timer wrapper to release
+ * @param ulParameter2 Unused
+ */
+static void timer_release_deferred(void* pvParameter1, uint32_t ulParameter2)
+{
+    (void)ulParameter2;
+    dmosi_pool_free(&g_dmosi_timer_pool, pvParameter1);
+}
+
+/**
+ * @brief Signal a task waiting in timer_wait_for_service_task()
+ *
+ * @param pvParameter1 struct timer_fence to signal
+ * @param ulParameter2 Unused
+ */
+static void timer_fence_signal(void* pvParameter1, uint32_t ulParameter2)
+{
+    (void)ulParameter2;
+    struct timer_fence* fence = (struct timer_fence*)pvParameter1;
+    TaskHandle_t waiter = fence->waiter;
+
+    fence->done = true;
+    xTaskNotifyGive(waiter);
+}
+
+/**
+ * @brief Wait until the timer service task processed all pending commands
+ *
+ * Timer commands (including deletes) are executed asynchronously by the timer
+ * service task. Queueing a fence behind them and waiting for it guarantees
+ * that the kernel no longer references an embedded control block.
+ *
+ * @return true if the wait completed, false if it is not possible from the
+ *         calling context (timer service task itself, or scheduler not running)
+ */
+static bool timer_wait_for_service_task(void)
+{
+    if (!dmosi_is_started() || xTaskGetCurrentTaskHandle() == xTimerGetTimerDaemonTaskHandle()) {
+        return false;
+    }
+
+    struct timer_fence fence = { .waiter = xTaskGetCurrentTaskHandle(), .done = false };
+    if (xTimerPendFunctionCall(timer_fence_signal, &fence, 0, portMAX_DELAY) != pdPASS) {
+        return false;
+    }
+
+    while (!fence.done) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    }
+    return true;
+}
+
 //==============================================================================
 //                              TIMER API Implementation
 //==============================================================================
@@ -70,30 +169,47 @@ static void timer_callback_wrapper(TimerHandle_t xTimer)
  */
 DMOD_INPUT_API_DECLARATION( dmosi, 1.0, dmosi_timer_t, _timer_create, (dmosi_timer_callback_t callback, void* arg, uint32_t period_ms, bool auto_reload) )
 {
+    DMOSI_MPU_PRIVILEGED_SCOPE();
+
     if (callback == NULL || period_ms == 0) {
         return NULL;
     }
 
-    struct dmosi_timer* timer = (struct dmosi_timer*)pvPortMalloc(sizeof(*timer));
+    struct dmosi_timer* timer = (struct dmosi_timer*)dmosi_pool_alloc(&g_dmosi_timer_pool);
     if (timer == NULL) {
         return NULL;
     }
 
-    timer->callback = callback;
-    timer->arg = arg;
+    if (!timer_init(timer, callback, arg, period_ms, auto_reload, false)) {
+        dmosi_pool_free(&g_dmosi_timer_pool, timer);
+        return NULL;
+    }
 
-    TickType_t period_ticks = ms_to_ticks(period_ms);
+    return (dmosi_timer_t)timer;
+}
 
-    timer->handle = xTimerCreate(
-        "dmosi_timer",
-        period_ticks,
-        auto_reload ? pdTRUE : pdFALSE,
-        (void*)timer,
-        timer_callback_wrapper
-    );
+/**
+ * @brief Create a timer in caller-provided storage
+ *
+ * Works like dmosi_timer_create() but uses @p storage for both the wrapper
+ * and the FreeRTOS control block, so no memory is allocated. The storage
+ * must stay valid until dmosi_timer_destroy() is called.
+ *
+ * @param storage Storage for the timer
+ * @param callback Callback function to execute when timer expires
+ * @param arg Argument to pass to the callback function
+ * @param period_ms Timer period in milliseconds
+ * @param auto_reload Whether the timer should auto-reload
+ * @return dmosi_timer_t Created timer handle, NULL on failure
+ */
+dmosi_timer_t dmosi_timer_create_static(dmosi_timer_storage_t* storage, dmosi_timer_callback_t callback, void* arg, uint32_t period_ms, bool auto_reload)
+{
+    if (storage == NULL || callback == NULL || period_ms == 0) {
+        return NULL;
+    }
 
-    if (timer->handle == NULL) {
-        vPortFree(timer);
+    struct dmosi_timer* timer = (struct dmosi_timer*)storage;
+    if (!timer_init(timer, callback, arg, period_ms, auto_reload, true)) {
         return NULL;
     }
 
@@ -103,21 +219,42 @@ DMOD_INPUT_API_DECLARATION( dmosi, 1.0, dmosi_timer_t, _timer_create, (dmosi_tim
 /**
  * @brief Destroy a timer
  *
- * Stops and destroys a timer, freeing associated resources.
+ * Stops and destroys a timer, freeing associated resources. The callback is
+ * never invoked once this has been called.
+ *
+ * The FreeRTOS timer service task deletes the timer asynchronously, so a
+ * pooled wrapper is only released once that has happened. For a timer created
+ * with dmosi_timer_create_static() this waits for the timer service task, so
+ * the storage may be reused once this returns - except when called from a
+ * timer callback or before the scheduler starts, where the storage must not
+ * be reused until the timer service task has run.
  *
  * @param timer Timer handle to destroy
  */
 DMOD_INPUT_API_DECLARATION( dmosi, 1.0, void, _timer_destroy, (dmosi_timer_t timer) )
 {
+    DMOSI_MPU_PRIVILEGED_SCOPE();
+
     if (timer == NULL) {
         return;
     }
 
-    if (timer->handle != NULL) {
-        xTimerDelete(timer->handle, portMAX_DELAY);
+    timer->callback = NULL;
+
+    if (timer->handle != NULL && xTimerDelete(timer->handle, portMAX_DELAY) == pdPASS) {
+        if (timer->is_static) {
+            timer_wait_for_service_task();
+            return;
+        }
+
+        if (xTimerPendFunctionCall(timer_release_deferred, timer, 0, portMAX_DELAY) == pdPASS) {
+            return;
+        }
     }
 
-    vPortFree(timer);
+    if (!timer->is_static) {
+        dmosi_pool_free(&g_dmosi_timer_pool, timer);
+    }
 }
 
 /**
@@ -132,6 +269,8 @@ DMOD_INPUT_API_DECLARATION( dmosi, 1.0, void, _timer_destroy, (dmosi_timer_t tim
  */
 DMOD_INPUT_API_DECLARATION( dmosi, 1.0, int, _timer_start, (dmosi_timer_t timer) )
 {
+    DMOSI_MPU_PRIVILEGED_SCOPE();
+
     if (timer == NULL) {
         return -EINVAL;
     }
@@ -165,6 +304,8 @@ DMOD_INPUT_API_DECLARATION( dmosi, 1.0, int, _timer_start, (dmosi_timer_t timer)
  */
 DMOD_INPUT_API_DECLARATION( dmosi, 1.0, int, _timer_stop, (dmosi_timer_t timer) )
 {
+    DMOSI_MPU_PRIVILEGED_SCOPE();
+
     if (timer == NULL) {
         return -EINVAL;
     }
@@ -200,6 +341,8 @@ DMOD_INPUT_API_DECLARATION( dmosi, 1.0, int, _timer_stop, (dmosi_timer_t timer)
  */
 DMOD_INPUT_API_DECLARATION( dmosi, 1.0, int, _timer_reset, (dmosi_timer_t timer) )
 {
+    DMOSI_MPU_PRIVILEGED_SCOPE();
+
     if (timer == NULL) {
         return -EINVAL;
     }
@@ -235,6 +378,8 @@ DMOD_INPUT_API_DECLARATION( dmosi, 1.0, int, _timer_reset, (dmosi_timer_t timer)
  */
 DMOD_INPUT_API_DECLARATION( dmosi, 1.0, int, _timer_set_period, (dmosi_timer_t timer, uint32_t period_ms) )
 {
+    DMOSI_MPU_PRIVILEGED_SCOPE();
+
     if (timer == NULL || period_ms == 0) {
         return -EINVAL;
     }
@@ -243,7 +388,7 @@ DMOD_INPUT_API_DECLARATION( dmosi, 1.0, int, _timer_set_period, (dmosi_timer_t t
         return -ENOTSUP;
     }
 
-    TickType_t period_ticks = ms_to_ticks(period_ms);
+    TickType_t period_ticks = dmosi_ticks_from_ms(period_ms);
     BaseType_t result;
 
     if (xPortIsInsideInterrupt()) {
@@ -260,18 +405,22 @@ DMOD_INPUT_API_DECLARATION( dmosi, 1.0, int, _timer_set_period, (dmosi_timer_t t
 /**
  * @brief Get timer period
  *
- * Returns the period of the specified timer in milliseconds.
+ * Returns the period of the specified timer in milliseconds. Periods are
+ * kept in whole ticks, so the value read back is the requested period
+ * rounded up to the tick period.
  *
  * @param timer Timer handle
  * @return uint32_t Timer period in milliseconds, 0 on failure
  */
 DMOD_INPUT_API_DECLARATION( dmosi, 1.0, uint32_t, _timer_get_period, (dmosi_timer_t timer) )
 {
+    DMOSI_MPU_PRIVILEGED_SCOPE();
+
     if (timer == NULL) {
         return 0;
     }
 
     TickType_t period_ticks = xTimerGetPeriod(timer->handle);
 
-    return (uint32_t)(period_ticks * 1000 / configTICK_RATE_HZ);
+    return dmosi_ticks_to_ms_floor((uint32_t)period_ticks);
 }
@@ -0,0 +1,885 @@
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <errno.h>
+#include "dmosi.h"
+#include "dmosi_freertos.h"
+#include "dmosi_notify.h"
+#include "dmosi_ticks.h"
+#include "FreeRTOS.h"
+#include "task.h"
+
+/**
+ * @brief Number of bits of the slot index of one wheel level
+ */
+#define WHEEL_BITS      6
+
+/**
+ * @brief Number of slots per wheel level
+ */
+#define WHEEL_SLOTS     (1u << WHEEL_BITS)
+
+/**
+ * @brief Mask reducing a tick to a slot index
+ */
+#define WHEEL_MASK      (WHEEL_SLOTS - 1u)
+
+/**
+ * @brief Number of wheel levels
+ *
+ * Level n holds timers expiring within 64^(n + 1) ticks, so four levels
+ * cover 2^24 ticks directly (46 hours at 100 Hz). Timers further out are
+ * parked in the last level and re-sorted whenever it cascades.
+ */
+#define WHEEL_LEVELS    4
+
+/**
+ * @brief Life cycle of a wheel timer
+ */
+enum wheel_timer_state {
+    WHEEL_TIMER_IDLE = 0,       /**< Not started, stopped or fired (one-shot) */
+    WHEEL_TIMER_ARMED,          /**< Linked into a wheel slot */
+    WHEEL_TIMER_EXPIRED,        /**< Linked into the expired list, awaiting dispatch */
+};
+
+/**
+ * @brief Internal layout of dmosi_wheel_timer_t
+ *
+ * A timer sits in at most one wheel list at a time (a slot or the expired
+ * list) and, independently, in the dispatch queue, so a periodic timer can
+ * be re-armed while its previous expiry still waits for a dispatch thread.
+ * The pprev links point at the link that references the timer, so
+ * unlinking is O(1) without knowing the list.
+ */
+struct wheel_timer {
+    struct wheel_timer* next;           /**< Next timer in the same wheel list */
+    struct wheel_timer** pprev;         /**< Wheel list link pointing at this timer */
+    struct wheel_timer* dispatch_next;  /**< Next timer in the dispatch queue */
+    struct wheel_timer** dispatch_pprev;/**< Dispatch queue link pointing at this timer */
+    struct dmosi_timer_wheel* wheel;    /**< Owning wheel */
+    dmosi_timer_callback_t callback;    /**< User-provided callback */
+    void* arg;                          /**< User-provided callback argument */
+    uint32_t expires;                   /**< Wheel tick of the next expiry */
+    uint32_t interval;                  /**< Ticks between start and expiry / between expiries */
+    uint32_t flags;                     /**< DMOSI_WHEEL_TIMER_* flags */
+    uint8_t state;                      /**< One of enum wheel_timer_state */
+    uint8_t level;                      /**< Wheel level while armed */
+    uint8_t slot;                       /**< Slot index while armed */
+    bool queued;                        /**< Waiting in the dispatch queue */
+};
+
+_Static_assert(sizeof(struct wheel_timer) <= sizeof(dmosi_wheel_timer_t),
+               "dmosi_wheel_timer_t is too small for struct wheel_timer");
+_Static_assert(_Alignof(struct wheel_timer) <= _Alignof(dmosi_wheel_timer_t),
+               "dmosi_wheel_timer_t is under-aligned for struct wheel_timer");
+_Static_assert(sizeof(TickType_t) >= sizeof(uint32_t),
+               "timer wheels need a tick type of at least 32 bits");
+
+/**
+ * @brief A callback dispatch thread
+ */
+struct wheel_dispatcher {
+    struct dmosi_timer_wheel* wheel;    /**< Owning wheel */
+    dmosi_thread_t thread;              /**< Dispatch thread */
+    TaskHandle_t task;                  /**< Dispatch task, set by the thread itself */
+    bool idle;                          /**< Parked waiting for expired timers */
+};
+
+/**
+ * @brief Internal structure of a timer wheel
+ *
+ * All lists are protected by a kernel critical section. Starting and
+ * stopping a timer links or unlinks one list node and flips an occupancy
+ * bit, so both are O(1) and run directly in the caller's context.
+ */
+struct dmosi_timer_wheel {
+    struct wheel_timer* slots[WHEEL_LEVELS][WHEEL_SLOTS];  /**< Armed timers by level and slot */
+    uint64_t occupied[WHEEL_LEVELS];    /**< Bit n set if slot n of the level is non-empty */
+    struct wheel_timer* expired;        /**< Expired timers in expiry order */
+    struct wheel_timer** expired_tail;  /**< Link to append the next expired timer to */
+    uint32_t current;                   /**< Next wheel tick to process */
+    uint32_t wake_tick;                 /**< Tick the service thread sleeps until */
+    bool sleeping;                      /**< Service thread is parked until @ref wake_tick */
+    bool stopping;                      /**< Set by dmosi_timer_wheel_destroy() */
+    dmosi_thread_t service;             /**< Thread advancing the wheel */
+    TaskHandle_t service_task;          /**< Task of @ref service, set by the thread itself */
+    struct wheel_timer* queue;          /**< Expired timers waiting for a dispatch thread */
+    struct wheel_timer** queue_tail;    /**< Link to append the next queued timer to */
+    size_t dispatcher_count;            /**< Number of dispatch threads (0 = run on the service thread) */
+    struct wheel_dispatcher dispatchers[];  /**< Dispatch threads */
+};
+
+/**
+ * @brief Enter the wheel critical section from task or interrupt context
+ *
+ * @return UBaseType_t Saved interrupt state for wheel_unlock()
+ */
+static UBaseType_t wheel_lock(void)
+{
+    if (xPortIsInsideInterrupt()) {
+        return taskENTER_CRITICAL_FROM_ISR();
+    }
+
+    taskENTER_CRITICAL();
+    return 0;
+}
+
+/**
+ * @brief Leave the wheel critical section
+ *
+ * @param saved Value returned by wheel_lock()
+ */
+static void wheel_unlock(UBaseType_t saved)
+{
+    if (xPortIsInsideInterrupt()) {
+        taskEXIT_CRITICAL_FROM_ISR(saved);
+    } else {
+        (void)saved;
+        taskEXIT_CRITICAL();
+    }
+}
+
+/**
+ * @brief Get the current kernel tick as a wheel tick
+ *
+ * @return uint32_t Current tick (wraps like a 32-bit tick count)
+ */
+static uint32_t wheel_now(void)
+{
+    return (uint32_t)(xPortIsInsideInterrupt() ? xTaskGetTickCountFromISR() : xTaskGetTickCount());
+}
+
+/**
+ * @brief Get the index of the lowest set bit
+ *
+ * @param bits Non-zero bit set
+ * @return uint32_t Index of the lowest set bit
+ */
+static inline uint32_t wheel_first_set(uint64_t bits)
+{
+#if defined(__GNUC__)
+    return (uint32_t)__builtin_ctzll(bits);
+#else
+    uint32_t index = 0;
+    while ((bits & 1u) == 0) {
+        bits >>= 1;
+        index++;
+    }
+    return index;
+#endif
+}
+
+/**
+ * @brief Link a timer into the slot matching its expiry
+ *
+ * Must be called inside the wheel critical section.
+ *
+ * @param wheel Timer wheel
+ * @param timer Timer with @ref wheel_timer::expires set
+ */
+static void wheel_insert_locked(struct dmosi_timer_wheel* wheel, struct wheel_timer* timer)
+{
+    uint32_t delta = timer->expires - wheel->current;
+    uint32_t level = 0;
+    uint32_t position = timer->expires;
+
+    if ((int32_t)delta < 0) {
+        position = wheel->current;      // Already due: run on the next pass
+    } else {
+        while (level < WHEEL_LEVELS - 1 && delta >= (1u << (WHEEL_BITS * (level + 1)))) {
+            level++;
+        }
+        if (level == WHEEL_LEVELS - 1 && delta >= (1u << (WHEEL_BITS * WHEEL_LEVELS))) {
+            // Beyond the wheel: park in the furthest slot and re-sort on cascade
+            position = wheel->current + (1u << (WHEEL_BITS * WHEEL_LEVELS)) - 1u;
+        }
+    }
+
+    uint32_t slot = (position >> (WHEEL_BITS * level)) & WHEEL_MASK;
+    struct wheel_timer** head = &wheel->slots[level][slot];
+
+    timer->next = *head;
+    if (*head != NULL) {
+        (*head)->pprev = &timer->next;
+    }
+    timer->pprev = head;
+    *head = timer;
+
+    timer->state = WHEEL_TIMER_ARMED;
+    timer->level = (uint8_t)level;
+    timer->slot = (uint8_t)slot;
+    wheel->occupied[level] |= (uint64_t)1 << slot;
+}
+
+/**
+ * @brief Unlink a timer from its slot or from the expired list
+ *
+ * Must be called inside the wheel critical section.
+ *
+ * @param wheel Timer wheel
+ * @param timer Armed or expired timer
+ */
+static void wheel_unlink_locked(struct dmosi_timer_wheel* wheel, struct wheel_timer* timer)
+{
+    *timer->pprev = timer->next;
+    if (timer->next != NULL) {
+        timer->next->pprev = timer->pprev;
+    }
+
+    if (timer->state == WHEEL_TIMER_ARMED) {
+        if (wheel->slots[timer->level][timer->slot] == NULL) {
+            wheel->occupied[timer->level] &= ~((uint64_t)1 << timer->slot);
+        }
+    } else if (wheel->expired_tail == &timer->next) {
+        wheel->expired_tail = timer->pprev;
+    }
+
+    timer->next = NULL;
+    timer->pprev = NULL;
+    timer->state = WHEEL_TIMER_IDLE;
+}
+
+/**
+ * @brief Append a timer to the dispatch queue
+ *
+ * Must be called inside the wheel critical section.
+ *
+ * @param wheel Timer wheel
+ * @param timer Timer that is not queued yet
+ */
+static void wheel_queue_locked(struct dmosi_timer_wheel* wheel, struct wheel_timer* timer)
+{
+    timer->dispatch_next = NULL;
+    timer->dispatch_pprev = wheel->queue_tail;
+    *wheel->queue_tail = timer;
+    wheel->queue_tail = &timer->dispatch_next;
+    timer->queued = true;
+}
+
+/**
+ * @brief Remove a timer from the dispatch queue
+ *
+ * Must be called inside the wheel critical section.
+ *
+ * @param wheel Timer wheel
+ * @param timer Queued timer
+ */
+static void wheel_dequeue_locked(struct dmosi_timer_wheel* wheel, struct wheel_timer* timer)
+{
+    *timer->dispatch_pprev = timer->dispatch_next;
+    if (timer->dispatch_next != NULL) {
+        timer->dispatch_next->dispatch_pprev = timer->dispatch_pprev;
+    } else {
+        wheel->queue_tail = timer->dispatch_pprev;
+    }
+
+    timer->dispatch_next = NULL;
+    timer->dispatch_pprev = NULL;
+    timer->queued = false;
+}
+
+/**
+ * @brief Re-sort the timers of one slot into the lower levels
+ *
+ * Must be called inside the wheel critical section.
+ *
+ * @param wheel Timer wheel
+ * @param level Level of the slot (> 0)
+ * @param slot Slot index
+ */
+static void wheel_cascade_locked(struct dmosi_timer_wheel* wheel, uint32_t level, uint32_t slot)
+{
+    struct wheel_timer* timer = wheel->slots[level][slot];
+
+    wheel->slots[level][slot] = NULL;
+    wheel->occupied[level] &= ~((uint64_t)1 << slot);
+
+    while (timer != NULL) {
+        struct wheel_timer* next = timer->next;
+        wheel_insert_locked(wheel, timer);
+        timer = next;
+    }
+}
+
+/**
+ * @brief Move all timers due up to @p now to the expired list
+ *
+ * Stretches without level-0 timers are skipped in steps of one level-0
+ * revolution, so catching up after a long sleep stays cheap.
+ *
+ * Must be called inside the wheel critical section.
+ *
+ * @param wheel Timer wheel
+ * @param now Current wheel tick
+ */
+static void wheel_expire_locked(struct dmosi_timer_wheel* wheel, uint32_t now)
+{
+    while ((int32_t)(now - wheel->current) >= 0) {
+        uint32_t index = wheel->current & WHEEL_MASK;
+
+        if (index == 0) {
+            for (uint32_t level = 1; level < WHEEL_LEVELS; level++) {
+                uint32_t slot = (wheel->current >> (WHEEL_BITS * level)) & WHEEL_MASK;
+                wheel_cascade_locked(wheel, level, slot);
+                if (slot != 0) {
+                    break;
+                }
+            }
+        }
+
+        struct wheel_timer* timer = wheel->slots[0][index];
+        wheel->slots[0][index] = NULL;
+        wheel->occupied[0] &= ~((uint64_t)1 << index);
+
+        while (timer != NULL) {
+            struct wheel_timer* next = timer->next;
+            timer->next = NULL;
+            timer->pprev = wheel->expired_tail;
+            timer->state = WHEEL_TIMER_EXPIRED;
+            *wheel->expired_tail = timer;
+            wheel->expired_tail = &timer->next;
+            timer = next;
+        }
+
+        wheel->current++;
+
+        if (wheel->occupied[0] == 0) {
+            uint32_t boundary = (wheel->current + WHEEL_MASK) & ~WHEEL_MASK;
+            bool higher = false;
+            for (uint32_t level = 1; level < WHEEL_LEVELS; level++) {
+                higher = higher || (wheel->occupied[level] != 0);
+            }
+            if (!higher || (int32_t)(now - boundary) < 0) {
+                wheel->current = now + 1u;
+                break;
+            }
+            wheel->current = boundary;
+        }
+    }
+}
+
+/**
+ * @brief Get the number of ticks until the wheel needs processing again
+ *
+ * Must be called inside the wheel critical section.
+ *
+ * @param wheel Timer wheel
+ * @param now Current wheel tick
+ * @return TickType_t Ticks to sleep, portMAX_DELAY if no timer is armed
+ */
+static TickType_t wheel_next_event_locked(struct dmosi_timer_wheel* wheel, uint32_t now)
+{
+    uint32_t due;
+
+    if (wheel->occupied[0] != 0) {
+        // Level-0 slots hold the timers of the next revolution in slot order
+        uint32_t index = wheel->current & WHEEL_MASK;
+        uint64_t bits = wheel->occupied[0];
+        uint64_t rotated = (index == 0) ? bits : ((bits >> index) | (bits << (WHEEL_SLOTS - index)));
+        due = wheel->current + wheel_first_set(rotated);
+    } else {
+        bool higher = false;
+        for (uint32_t level = 1; level < WHEEL_LEVELS; level++) {
+            higher = higher || (wheel->occupied[level] != 0);
+        }
+        if (!higher) {
+            return portMAX_DELAY;
+        }
+        due = (wheel->current + WHEEL_MASK) & ~WHEEL_MASK;   // Next cascade
+    }
+
+    return ((int32_t)(due - now) > 0) ? (TickType_t)(due - now) : 0;
+}
+
+/**
+ * @brief Wake the service thread if it sleeps past @p expires
+ *
+ * Must be called inside the wheel critical section.
+ *
+ * @param wheel Timer wheel
+ * @param expires Expiry of a newly armed timer
+ * @return TaskHandle_t Service task to notify (NULL if none)
+ */
+static TaskHandle_t wheel_wake_locked(struct dmosi_timer_wheel* wheel, uint32_t expires)
+{
+    if (!wheel->sleeping || (int32_t)(expires - wheel->wake_tick) >= 0) {
+        return NULL;
+    }
+
+    wheel->sleeping = false;
+    return wheel->service_task;
+}
+
+/**
+ * @brief Notify the service task from task or interrupt context
+ *
+ * @param task Task to notify (NULL = none)
+ */
+static void wheel_notify(TaskHandle_t task)
+{
+    if (task == NULL) {
+        return;
+    }
+
+    if (xPortIsInsideInterrupt()) {
+        BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+        vTaskNotifyGiveIndexedFromISR(task, DMOSI_NOTIFY_INDEX_WAIT, &xHigherPriorityTaskWoken);
+        portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
+    } else {
+        xTaskNotifyGiveIndexed(task, DMOSI_NOTIFY_INDEX_WAIT);
+    }
+}
+
+/**
+ * @brief Claim an idle dispatch thread if timers are queued
+ *
+ * Must be called inside the wheel critical section.
+ *
+ * @param wheel Timer wheel
+ * @return TaskHandle_t Dispatch task to notify (NULL if none)
+ */
+static TaskHandle_t wheel_claim_dispatcher_locked(struct dmosi_timer_wheel* wheel)
+{
+    if (wheel->queue == NULL) {
+        return NULL;
+    }
+
+    for (size_t i = 0; i < wheel->dispatcher_count; i++) {
+        struct wheel_dispatcher* dispatcher = &wheel->dispatchers[i];
+        if (dispatcher->idle) {
+            dispatcher->idle = false;
+            return dispatcher->task;
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * @brief Process expired timers as one batch
+ *
+ * Due timers are collected in a single pass, periodic ones re-armed, and
+ * then either handed to the dispatch threads or, for direct timers, run
+ * right here with the critical section released around each callback.
+ *
+ * @param wheel Timer wheel
+ * @param sleep Whether the caller is the service thread about to sleep
+ * @return TickType_t Ticks until the next event (if @p sleep)
+ */
+static TickType_t wheel_run(struct dmosi_timer_wheel* wheel, bool sleep)
+{
+    UBaseType_t saved = wheel_lock();
+    uint32_t now = wheel_now();
+
+    wheel_expire_locked(wheel, now);
+
+    while (wheel->expired != NULL) {
+        struct wheel_timer* timer = wheel->expired;
+        wheel_unlink_locked(wheel, timer);
+#if DMOSI_TRACE
+        dmosi_trace_timer_expired(timer);
+#endif
+
+        if ((timer->flags & DMOSI_WHEEL_TIMER_PERIODIC) != 0) {
+            // Stay on the original grid, skipping expiries that were missed
+            do {
+                timer->expires += timer->interval;
+            } while ((int32_t)(now - timer->expires) >= 0);
+            wheel_insert_locked(wheel, timer);
+        }
+
+        if (wheel->dispatcher_count > 0 && (timer->flags & DMOSI_WHEEL_TIMER_DIRECT) == 0) {
+            // An expiry whose predecessor still waits for dispatch is merged into it
+            if (!timer->queued) {
+                wheel_queue_locked(wheel, timer);
+            }
+            continue;
+        }
+
+        dmosi_timer_callback_t callback = timer->callback;
+        void* arg = timer->arg;
+        wheel_unlock(saved);
+        callback(arg);
+        saved = wheel_lock();
+    }
+
+    TickType_t delay = portMAX_DELAY;
+    if (sleep) {
+        now = wheel_now();
+        delay = wheel_next_event_locked(wheel, now);
+        wheel->sleeping = (delay > 0);
+        wheel->wake_tick = (delay == portMAX_DELAY) ? now + (UINT32_MAX >> 1) : now + (uint32_t)delay;
+    }
+
+    TaskHandle_t task = wheel_claim_dispatcher_locked(wheel);
+    wheel_unlock(saved);
+
+    // Hand the batch to as many idle dispatch threads as it needs
+    while (task != NULL) {
+        wheel_notify(task);
+
+        saved = wheel_lock();
+        task = wheel_claim_dispatcher_locked(wheel);
+        wheel_unlock(saved);
+    }
+
+    return delay;
+}
+
+/**
+ * @brief Entry function of the dispatch threads
+ *
+ * @param arg Dispatcher
+ */
+static void wheel_dispatcher_entry(void* arg)
+{
+    struct wheel_dispatcher* dispatcher = (struct wheel_dispatcher*)arg;
+    struct dmosi_timer_wheel* wheel = dispatcher->wheel;
+
+    // Published before the first park, so the wheel only ever notifies a known task
+    dispatcher->task = xTaskGetCurrentTaskHandle();
+
+    for (;;) {
+        taskENTER_CRITICAL();
+        struct wheel_timer* timer = wheel->queue;
+        if (timer == NULL) {
+            bool stopping = wheel->stopping;
+            dispatcher->idle = !stopping;
+            taskEXIT_CRITICAL();
+
+            if (stopping) {
+                return;
+            }
+
+            ulTaskNotifyTakeIndexed(DMOSI_NOTIFY_INDEX_WAIT, pdTRUE, portMAX_DELAY);
+            continue;
+        }
+        wheel_dequeue_locked(wheel, timer);
+        dmosi_timer_callback_t callback = timer->callback;
+        void* callback_arg = timer->arg;
+        taskEXIT_CRITICAL();
+
+        callback(callback_arg);
+    }
+}
+
+/**
+ * @brief Entry function of the service thread
+ *
+ * @param arg Timer wheel
+ */
+static void wheel_service_entry(void* arg)
+{
+    struct dmosi_timer_wheel* wheel = (struct dmosi_timer_wheel*)arg;
+
+    wheel->service_task = xTaskGetCurrentTaskHandle();
+
+    for (;;) {
+        taskENTER_CRITICAL();
+        bool stopping = wheel->stopping;
+        taskEXIT_CRITICAL();
+
+        if (stopping) {
+            return;
+        }
+
+        TickType_t delay = wheel_run(wheel, true);
+        if (delay > 0) {
+            ulTaskNotifyTakeIndexed(DMOSI_NOTIFY_INDEX_WAIT, pdTRUE, delay);
+        }
+
+        taskENTER_CRITICAL();
+        wheel->sleeping = false;
+        taskEXIT_CRITICAL();
+    }
+}
+
+//==============================================================================
+//                              TIMER WHEEL API Implementation
+//==============================================================================
+
+/**
+ * @brief Create a timer wheel
+ *
+ * A service thread advances the wheel and sleeps until the next expiry.
+ * With @p dispatch_threads > 0 the callbacks run on that many dispatch
+ * threads, so slow callbacks do not delay each other or the expiry
+ * processing; with 0 they run on the service thread.
+ *
+ * @param dispatch_threads Number of callback dispatch threads (0 = none)
+ * @param priority Priority of the service and dispatch threads
+ * @param stack_size Stack size of each thread in bytes
+ * @param name Name of the threads (cannot be NULL)
+ * @param process Process the threads belong to (NULL = current process)
+ * @return dmosi_timer_wheel_t Created timer wheel handle, NULL on failure
+ */
+dmosi_timer_wheel_t dmosi_timer_wheel_create(size_t dispatch_threads, int priority, size_t stack_size, const char* name, dmosi_process_t process)
+{
+    if (stack_size == 0 || name == NULL) {
+        DMOD_LOG_ERROR("Invalid timer wheel parameters: stack_size=%zu\n", stack_size);
+        return NULL;
+    }
+
+    if (dispatch_threads > (SIZE_MAX - sizeof(struct dmosi_timer_wheel)) / sizeof(struct wheel_dispatcher)) {
+        DMOD_LOG_ERROR("Invalid timer wheel parameters: dispatch_threads=%zu\n", dispatch_threads);
+        return NULL;
+    }
+
+    struct dmosi_timer_wheel* wheel = pvPortMalloc(sizeof(*wheel) + dispatch_threads * sizeof(struct wheel_dispatcher));
+    if (wheel == NULL) {
+        DMOD_LOG_ERROR("Failed to allocate memory for timer wheel\n");
+        return NULL;
+    }
+
+    for (uint32_t level = 0; level < WHEEL_LEVELS; level++) {
+        for (uint32_t slot = 0; slot < WHEEL_SLOTS; slot++) {
+            wheel->slots[level][slot] = NULL;
+        }
+        wheel->occupied[level] = 0;
+    }
+    wheel->expired = NULL;
+    wheel->expired_tail = &wheel->expired;
+    wheel->current = wheel_now();
+    wheel->wake_tick = wheel->current;
+    wheel->sleeping = false;
+    wheel->stopping = false;
+    wheel->service = NULL;
+    wheel->service_task = NULL;
+    wheel->queue = NULL;
+    wheel->queue_tail = &wheel->queue;
+    wheel->dispatcher_count = dispatch_threads;
+
+    for (size_t i = 0; i < dispatch_threads; i++) {
+        struct wheel_dispatcher* dispatcher = &wheel->dispatchers[i];
+        dispatcher->wheel = wheel;
+        dispatcher->thread = NULL;
+        dispatcher->task = NULL;
+        dispatcher->idle = false;
+    }
+
+    for (size_t i = 0; i < dispatch_threads; i++) {
+        wheel->dispatchers[i].thread = dmosi_thread_create(wheel_dispatcher_entry, &wheel->dispatchers[i], priority, stack_size, name, process);
+        if (wheel->dispatchers[i].thread == NULL) {
+            DMOD_LOG_ERROR("Failed to create timer wheel dispatch thread %zu\n", i);
+            dmosi_timer_wheel_destroy(wheel);
+            return NULL;
+        }
+    }
+
+    wheel->service = dmosi_thread_create(wheel_service_entry, wheel, priority, stack_size, name, process);
+    if (wheel->service == NULL) {
+        DMOD_LOG_ERROR("Failed to create timer wheel service thread\n");
+        dmosi_timer_wheel_destroy(wheel);
+        return NULL;
+    }
+
+    return wheel;
+}
+
+/**
+ * @brief Destroy a timer wheel
+ *
+ * Armed timers are dropped without firing and queued dispatches are
+ * canceled; callbacks already running are finished first. Must not be
+ * called from a callback of @p wheel.
+ *
+ * @param wheel Timer wheel handle to destroy
+ */
+void dmosi_timer_wheel_destroy(dmosi_timer_wheel_t wheel)
+{
+    if (wheel == NULL) {
+        return;
+    }
+
+    taskENTER_CRITICAL();
+    wheel->stopping = true;
+    TaskHandle_t task = wheel->service_task;
+    taskEXIT_CRITICAL();
+
+    if (wheel->service != NULL) {
+        if (task != NULL) {
+            xTaskNotifyGiveIndexed(task, DMOSI_NOTIFY_INDEX_WAIT);
+        }
+        dmosi_thread_join(wheel->service);
+        dmosi_thread_destroy(wheel->service);
+    }
+
+    for (size_t i = 0; i < wheel->dispatcher_count; i++) {
+        struct wheel_dispatcher* dispatcher = &wheel->dispatchers[i];
+        if (dispatcher->thread == NULL) {
+            continue;
+        }
+
+        taskENTER_CRITICAL();
+        task = dispatcher->idle ? dispatcher->task : NULL;
+        dispatcher->idle = false;
+        taskEXIT_CRITICAL();
+
+        if (task != NULL) {
+            xTaskNotifyGiveIndexed(task, DMOSI_NOTIFY_INDEX_WAIT);
+        }
+        dmosi_thread_join(dispatcher->thread);
+        dmosi_thread_destroy(dispatcher->thread);
+    }
+
+    taskENTER_CRITICAL();
+    for (uint32_t level = 0; level < WHEEL_LEVELS; level++) {
+        for (uint32_t slot = 0; slot < WHEEL_SLOTS; slot++) {
+            while (wheel->slots[level][slot] != NULL) {
+                wheel_unlink_locked(wheel, wheel->slots[level][slot]);
+            }
+        }
+    }
+    while (wheel->expired != NULL) {
+        wheel_unlink_locked(wheel, wheel->expired);
+    }
+    while (wheel->queue != NULL) {
+        wheel_dequeue_locked(wheel, wheel->queue);
+    }
+    taskEXIT_CRITICAL();
+
+    vPortFree(wheel);
+}
+
+/**
+ * @brief Process expired timers of a wheel now
+ *
+ * The service thread does this on its own; calling it from the tick hook or
+ * a hardware timer interrupt additionally runs DMOSI_WHEEL_TIMER_DIRECT
+ * callbacks in interrupt context with minimal latency.
+ *
+ * @param wheel Timer wheel handle
+ */
+void dmosi_timer_wheel_advance(dmosi_timer_wheel_t wheel)
+{
+    if (wheel != NULL) {
+        (void)wheel_run(wheel, false);
+    }
+}
+
+/**
+ * @brief Prepare a wheel timer
+ *
+ * @param timer Timer storage
+ * @param wheel Timer wheel the timer runs on
+ * @param callback Callback function to execute when the timer expires
+ * @param arg Argument to pass to the callback function
+ * @param flags DMOSI_WHEEL_TIMER_* flags
+ * @return int 0 on success, -EINVAL on invalid arguments
+ */
+int dmosi_wheel_timer_init(dmosi_wheel_timer_t* timer, dmosi_timer_wheel_t wheel, dmosi_timer_callback_t callback, void* arg, uint32_t flags)
+{
+    if (timer == NULL || wheel == NULL || callback == NULL) {
+        return -EINVAL;
+    }
+
+    struct wheel_timer* t = (struct wheel_timer*)timer;
+    t->next = NULL;
+    t->pprev = NULL;
+    t->dispatch_next = NULL;
+    t->dispatch_pprev = NULL;
+    t->wheel = wheel;
+    t->callback = callback;
+    t->arg = arg;
+    t->expires = 0;
+    t->interval = 0;
+    t->flags = flags;
+    t->state = WHEEL_TIMER_IDLE;
+    t->level = 0;
+    t->slot = 0;
+    t->queued = false;
+
+    return 0;
+}
+
+/**
+ * @brief Start or restart a wheel timer
+ *
+ * O(1) and never blocks or queues a command. Safe to call from both task and
+ * interrupt context, including from the timer's own callback. A periodic
+ * timer expires every @p timeout_ms from now on.
+ *
+ * @param timer Initialized timer
+ * @param timeout_ms Time until the (first) expiry in milliseconds (> 0)
+ * @return int 0 on success, -EINVAL on invalid arguments
+ */
+int dmosi_wheel_timer_start(dmosi_wheel_timer_t* timer, uint32_t timeout_ms)
+{
+    if (timer == NULL || timeout_ms == 0) {
+        return -EINVAL;
+    }
+
+    struct wheel_timer* t = (struct wheel_timer*)timer;
+    struct dmosi_timer_wheel* wheel = t->wheel;
+
+    TickType_t ticks = dmosi_ticks_from_ms(timeout_ms);
+
+    UBaseType_t saved = wheel_lock();
+    if (t->state != WHEEL_TIMER_IDLE) {
+        wheel_unlink_locked(wheel, t);
+    }
+    t->interval = (uint32_t)ticks;
+    t->expires = wheel_now() + t->interval;
+    wheel_insert_locked(wheel, t);
+    TaskHandle_t wake = wheel_wake_locked(wheel, t->expires);
+    wheel_unlock(saved);
+
+    wheel_notify(wake);
+
+    return 0;
+}
+
+/**
+ * @brief Stop a wheel timer
+ *
+ * O(1) and safe to call from both task and interrupt context. A dispatch
+ * that has not started yet is canceled; a callback that is already running
+ * is not waited for.
+ *
+ * @param timer Initialized timer
+ * @return int 0 if the timer was active, -ENOENT if it was not, -EINVAL if @p timer is NULL
+ */
+int dmosi_wheel_timer_stop(dmosi_wheel_timer_t* timer)
+{
+    if (timer == NULL) {
+        return -EINVAL;
+    }
+
+    struct wheel_timer* t = (struct wheel_timer*)timer;
+    struct dmosi_timer_wheel* wheel = t->wheel;
+    int result = -ENOENT;
+
+    UBaseType_t saved = wheel_lock();
+    if (t->state != WHEEL_TIMER_IDLE) {
+        wheel_unlink_locked(wheel, t);
+        result = 0;
+    }
+    if (t->queued) {
+        wheel_dequeue_locked(wheel, t);
+        result = 0;
+    }
+    wheel_unlock(saved);
+
+    return result;
+}
+
+/**
+ * @brief Check whether a wheel timer is armed
+ *
+ * @param timer Initialized timer
+ * @return bool true if the timer will expire, false otherwise
+ */
+bool dmosi_wheel_timer_is_active(dmosi_wheel_timer_t* timer)
+{
+    if (timer == NULL) {
+        return false;
+    }
+
+    struct wheel_timer* t = (struct wheel_timer*)timer;
+
+    UBaseType_t saved = wheel_lock();
+    bool active = (t->state != WHEEL_TIMER_IDLE);
+    wheel_unlock(saved);
+
+    return active;
+}
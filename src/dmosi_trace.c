@@ -0,0 +1,505 @@
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+#include <errno.h>
+#include "dmosi.h"
+#include "dmosi_freertos.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include "queue.h"
+
+/**
+ * @brief Number of trace events buffered per core
+ *
+ * Configurable via the CMake parameter of the same name (must be a power
+ * of two). Each buffered event takes 32 bytes.
+ */
+#ifndef DMOSI_TRACE_BUFFER_SIZE
+    #define DMOSI_TRACE_BUFFER_SIZE    256
+#endif
+
+#if ( DMOSI_TRACE_BUFFER_SIZE & ( DMOSI_TRACE_BUFFER_SIZE - 1 ) ) != 0 || DMOSI_TRACE_BUFFER_SIZE < 2
+    #error "DMOSI_TRACE_BUFFER_SIZE must be a power of two"
+#endif
+
+#define TRACE_MASK    ( ( uint32_t ) DMOSI_TRACE_BUFFER_SIZE - 1U )
+
+#if DMOSI_TRACE
+
+/**
+ * @brief Slot of a trace ring
+ *
+ * @ref seq tells which side owns the slot: equal to the position a
+ * producer is about to write, it is free; one past it, the event is
+ * complete and may be read.
+ */
+struct trace_slot {
+    _Atomic uint32_t seq;           /**< Position sequence of the slot */
+    dmosi_trace_event_t event;      /**< Recorded event */
+};
+
+/**
+ * @brief Trace ring of one core
+ *
+ * A bounded multi-producer queue in the style of D. Vyukov's: a producer
+ * claims a position with a single compare-and-swap and publishes the event
+ * through the slot sequence, so an interrupt that records an event while
+ * the interrupted code is half-way through its own needs no lock and no
+ * masked interrupts. Readers claim positions the same way.
+ */
+struct trace_ring {
+    _Atomic uint32_t head;          /**< Next position to write */
+    _Atomic uint32_t tail;          /**< Next position to read */
+    _Atomic uint32_t lost;          /**< Events dropped since the last recorded one */
+    struct trace_slot slots[DMOSI_TRACE_BUFFER_SIZE];
+};
+
+static struct trace_ring g_trace_rings[configNUMBER_OF_CORES];
+static atomic_bool g_trace_running = false;             /**< Events are recorded */
+static bool g_trace_initialized = false;                /**< Slot sequences are set up */
+static _Atomic uint32_t g_trace_dropped = 0;            /**< Events dropped since boot */
+
+/**
+ * @brief Get the core the caller runs on
+ *
+ * @return uint32_t Core index
+ */
+static inline uint32_t trace_core(void)
+{
+#if ( configNUMBER_OF_CORES > 1 )
+    return (uint32_t)portGET_CORE_ID();
+#else
+    return 0;
+#endif
+}
+
+/**
+ * @brief Append an event to the ring of the current core
+ *
+ * Lock-free and safe from any context, including the scheduler and
+ * interrupts above configMAX_SYSCALL_INTERRUPT_PRIORITY.
+ *
+ * @param type Event type
+ * @param object Object the event refers to
+ * @param arg Event-specific argument
+ */
+static void trace_record(dmosi_trace_event_type_t type, const void* object, uint32_t arg)
+{
+    if (!atomic_load_explicit(&g_trace_running, memory_order_relaxed)) {
+        return;
+    }
+
+    uint32_t core = trace_core();
+    struct trace_ring* ring = &g_trace_rings[core];
+    uint32_t pos = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    struct trace_slot* slot;
+
+    for (;;) {
+        slot = &ring->slots[pos & TRACE_MASK];
+        int32_t diff = (int32_t)(atomic_load_explicit(&slot->seq, memory_order_acquire) - pos);
+
+        if (diff == 0) {
+            if (atomic_compare_exchange_weak_explicit(&ring->head, &pos, pos + 1U,
+                                                      memory_order_relaxed, memory_order_relaxed)) {
+                break;
+            }
+        } else if (diff < 0) {
+            // Full: the oldest event has not been read yet
+            atomic_fetch_add_explicit(&ring->lost, 1U, memory_order_relaxed);
+            atomic_fetch_add_explicit(&g_trace_dropped, 1U, memory_order_relaxed);
+            return;
+        } else {
+            pos = atomic_load_explicit(&ring->head, memory_order_relaxed);
+        }
+    }
+
+    uint32_t lost = atomic_exchange_explicit(&ring->lost, 0U, memory_order_relaxed);
+
+    slot->event.timestamp_ns = dmosi_get_time_ns();
+    slot->event.object = (uint64_t)(uintptr_t)object;
+    slot->event.arg = arg;
+    slot->event.type = (uint8_t)type;
+    slot->event.core = (uint8_t)core;
+    slot->event.lost = (lost < UINT16_MAX) ? (uint16_t)lost : UINT16_MAX;
+
+    atomic_store_explicit(&slot->seq, pos + 1U, memory_order_release);
+}
+
+/**
+ * @brief Take the oldest complete event of a ring
+ *
+ * @param ring Trace ring
+ * @param event Filled with the event
+ * @return bool true if an event was taken, false if none is pending
+ */
+static bool trace_take(struct trace_ring* ring, dmosi_trace_event_t* event)
+{
+    uint32_t pos = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+    struct trace_slot* slot;
+
+    for (;;) {
+        slot = &ring->slots[pos & TRACE_MASK];
+        int32_t diff = (int32_t)(atomic_load_explicit(&slot->seq, memory_order_acquire) - (pos + 1U));
+
+        if (diff == 0) {
+            if (atomic_compare_exchange_weak_explicit(&ring->tail, &pos, pos + 1U,
+                                                      memory_order_relaxed, memory_order_relaxed)) {
+                break;
+            }
+        } else if (diff < 0) {
+            return false;   // Empty, or the oldest event is still being written
+        } else {
+            pos = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+        }
+    }
+
+    *event = slot->event;
+    atomic_store_explicit(&slot->seq, pos + DMOSI_TRACE_BUFFER_SIZE, memory_order_release);
+
+    return true;
+}
+
+/**
+ * @brief Record the name of an object as DMOSI_TRACE_EVENT_NAME chunks
+ *
+ * @param object Object the name belongs to
+ * @param name NUL-terminated name (NULL = none)
+ */
+static void trace_record_name(const void* object, const char* name)
+{
+    if (name == NULL) {
+        return;
+    }
+
+    // The kernel keeps task names NUL-terminated within configMAX_TASK_NAME_LEN
+    size_t i = 0;
+    bool end = false;
+
+    while (!end) {
+        uint32_t chunk = 0;
+
+        for (uint32_t shift = 0; shift < 32U && !end; shift += 8U, i++) {
+            uint8_t c = (i < configMAX_TASK_NAME_LEN - 1U) ? (uint8_t)name[i] : 0U;
+            chunk |= (uint32_t)c << shift;
+            end = (c == 0U);
+        }
+
+        trace_record(DMOSI_TRACE_EVENT_NAME, object, chunk);
+    }
+}
+
+/**
+ * @brief Record creation and name of a task
+ *
+ * @param task Task handle
+ */
+static void trace_record_task(TaskHandle_t task)
+{
+    trace_record(DMOSI_TRACE_EVENT_TASK_CREATE, task, (uint32_t)uxTaskPriorityGet(task));
+    trace_record_name(task, pcTaskGetName(task));
+}
+
+/**
+ * @brief Get the argument of a queue event
+ *
+ * @param queue Kernel queue
+ * @param from_isr Nonzero if called from an interrupt
+ * @return uint32_t Queue type, with DMOSI_TRACE_ARG_FROM_ISR if applicable
+ */
+static inline uint32_t trace_queue_arg(void* queue, int from_isr)
+{
+    return (uint32_t)ucQueueGetQueueType((QueueHandle_t)queue) | ((from_isr != 0) ? DMOSI_TRACE_ARG_FROM_ISR : 0U);
+}
+
+#endif /* DMOSI_TRACE */
+
+//==============================================================================
+//                              Trace recorder API
+//==============================================================================
+
+/**
+ * @brief Start recording trace events
+ *
+ * Records a DMOSI_TRACE_EVENT_TASK_CREATE and the name of every existing
+ * task first, so the host can label tasks created before the start.
+ * Events left from an earlier run stay in the rings.
+ *
+ * @return int 0 on success, -ENOTSUP if DMOSI_TRACE is disabled,
+ *         -ENOMEM if the task list could not be taken
+ */
+int dmosi_trace_start(void)
+{
+#if !DMOSI_TRACE
+    return -ENOTSUP;
+#else
+    if (atomic_load(&g_trace_running)) {
+        return 0;
+    }
+
+    taskENTER_CRITICAL();
+    if (!g_trace_initialized) {
+        for (uint32_t core = 0; core < (uint32_t)configNUMBER_OF_CORES; core++) {
+            for (uint32_t i = 0; i < DMOSI_TRACE_BUFFER_SIZE; i++) {
+                atomic_init(&g_trace_rings[core].slots[i].seq, i);
+            }
+        }
+        g_trace_initialized = true;
+    }
+    taskEXIT_CRITICAL();
+
+    UBaseType_t count = uxTaskGetNumberOfTasks() + 4U;     // Room for tasks created meanwhile
+    TaskStatus_t* tasks = pvPortMalloc(count * sizeof(TaskStatus_t));
+    if (tasks == NULL) {
+        DMOD_LOG_ERROR("Failed to allocate task list for trace start\n");
+        return -ENOMEM;
+    }
+
+    atomic_store(&g_trace_running, true);
+
+    count = uxTaskGetSystemState(tasks, count, NULL);
+    for (UBaseType_t i = 0; i < count; i++) {
+        trace_record_task(tasks[i].xHandle);
+    }
+    vPortFree(tasks);
+
+    return 0;
+#endif
+}
+
+/**
+ * @brief Stop recording trace events
+ *
+ * Events already recorded stay available to dmosi_trace_read().
+ */
+void dmosi_trace_stop(void)
+{
+#if DMOSI_TRACE
+    atomic_store(&g_trace_running, false);
+#endif
+}
+
+/**
+ * @brief Check whether trace events are being recorded
+ *
+ * @return bool true between dmosi_trace_start() and dmosi_trace_stop()
+ */
+bool dmosi_trace_is_running(void)
+{
+#if DMOSI_TRACE
+    return atomic_load(&g_trace_running);
+#else
+    return false;
+#endif
+}
+
+/**
+ * @brief Take recorded events out of the per-core rings
+ *
+ * Takes one event from each core in turn, so a busy core does not starve
+ * the others; events of one core are returned in order, merging cores by
+ * timestamp is left to the host. Lock-free and never blocks, so several
+ * readers may drain concurrently, even from interrupts.
+ *
+ * @param events Array to fill
+ * @param max_events Capacity of @p events
+ * @return size_t Number of events filled (0 if none are pending)
+ */
+size_t dmosi_trace_read(dmosi_trace_event_t* events, size_t max_events)
+{
+    if (events == NULL) {
+        return 0;
+    }
+
+    size_t count = 0;
+
+#if DMOSI_TRACE
+    if (!g_trace_initialized) {
+        return 0;
+    }
+
+    bool pending = true;
+    while (pending && count < max_events) {
+        pending = false;
+        for (uint32_t core = 0; core < (uint32_t)configNUMBER_OF_CORES && count < max_events; core++) {
+            if (trace_take(&g_trace_rings[core], &events[count])) {
+                count++;
+                pending = true;
+            }
+        }
+    }
+#else
+    (void)max_events;
+#endif
+
+    return count;
+}
+
+/**
+ * @brief Get the number of events dropped because a ring was full
+ *
+ * @return uint32_t Events dropped since boot, over all cores
+ */
+uint32_t dmosi_trace_get_dropped(void)
+{
+#if DMOSI_TRACE
+    return atomic_load(&g_trace_dropped);
+#else
+    return 0;
+#endif
+}
+
+/**
+ * @brief Record entry into an interrupt handler
+ *
+ * @param irq Interrupt number
+ */
+void dmosi_trace_isr_enter(uint32_t irq)
+{
+#if DMOSI_TRACE
+    trace_record(DMOSI_TRACE_EVENT_ISR_ENTER, NULL, irq);
+#else
+    (void)irq;
+#endif
+}
+
+/**
+ * @brief Record exit from an interrupt handler
+ */
+void dmosi_trace_isr_exit(void)
+{
+#if DMOSI_TRACE
+    trace_record(DMOSI_TRACE_EVENT_ISR_EXIT, NULL, 0);
+#endif
+}
+
+#if DMOSI_TRACE
+
+//==============================================================================
+//                              Kernel trace hooks
+//==============================================================================
+
+/**
+ * @brief traceTASK_SWITCHED_IN hook
+ *
+ * @param task Task about to run
+ */
+void dmosi_trace_task_switched_in(const void* task)
+{
+    trace_record(DMOSI_TRACE_EVENT_TASK_SWITCH_IN, task, 0);
+}
+
+/**
+ * @brief traceTASK_SWITCHED_OUT hook
+ *
+ * @param task Task about to be switched out
+ */
+void dmosi_trace_task_switched_out(const void* task)
+{
+    trace_record(DMOSI_TRACE_EVENT_TASK_SWITCH_OUT, task, 0);
+}
+
+/**
+ * @brief traceTASK_CREATE hook
+ *
+ * Called by the kernel inside its critical section, after the task has
+ * been initialized.
+ *
+ * @param task New task
+ */
+void dmosi_trace_task_create(void* task)
+{
+    if (atomic_load_explicit(&g_trace_running, memory_order_relaxed)) {
+        trace_record_task((TaskHandle_t)task);
+    }
+}
+
+/**
+ * @brief traceTASK_DELETE hook
+ *
+ * @param task Task being deleted
+ */
+void dmosi_trace_task_delete(const void* task)
+{
+    trace_record(DMOSI_TRACE_EVENT_TASK_DELETE, task, 0);
+}
+
+/**
+ * @brief traceTASK_NOTIFY, traceTASK_NOTIFY_FROM_ISR and traceTASK_NOTIFY_GIVE_FROM_ISR hook
+ *
+ * @param task Notified task
+ * @param index Notification index
+ */
+void dmosi_trace_task_notify(const void* task, uint32_t index)
+{
+    trace_record(DMOSI_TRACE_EVENT_TASK_NOTIFY, task, index);
+}
+
+/**
+ * @brief traceQUEUE_CREATE hook (queues, semaphores and mutexes)
+ *
+ * @param queue New queue
+ */
+void dmosi_trace_queue_create(void* queue)
+{
+    trace_record(DMOSI_TRACE_EVENT_QUEUE_CREATE, queue, trace_queue_arg(queue, 0));
+}
+
+/**
+ * @brief traceQUEUE_DELETE hook
+ *
+ * @param queue Queue being deleted
+ */
+void dmosi_trace_queue_delete(void* queue)
+{
+    trace_record(DMOSI_TRACE_EVENT_QUEUE_DELETE, queue, trace_queue_arg(queue, 0));
+}
+
+/**
+ * @brief traceQUEUE_SEND* hook (also semaphore and mutex give)
+ *
+ * @param queue Queue
+ * @param passed Nonzero if the item was sent
+ * @param from_isr Nonzero if called from an interrupt
+ */
+void dmosi_trace_queue_send(void* queue, int passed, int from_isr)
+{
+    trace_record((passed != 0) ? DMOSI_TRACE_EVENT_QUEUE_SEND : DMOSI_TRACE_EVENT_QUEUE_SEND_FAILED,
+                 queue, trace_queue_arg(queue, from_isr));
+}
+
+/**
+ * @brief traceQUEUE_RECEIVE* hook (also semaphore and mutex take)
+ *
+ * @param queue Queue
+ * @param passed Nonzero if an item was received
+ * @param from_isr Nonzero if called from an interrupt
+ */
+void dmosi_trace_queue_receive(void* queue, int passed, int from_isr)
+{
+    trace_record((passed != 0) ? DMOSI_TRACE_EVENT_QUEUE_RECEIVE : DMOSI_TRACE_EVENT_QUEUE_RECEIVE_FAILED,
+                 queue, trace_queue_arg(queue, from_isr));
+}
+
+/**
+ * @brief traceBLOCKING_ON_QUEUE_SEND / traceBLOCKING_ON_QUEUE_RECEIVE hook
+ *
+ * @param queue Queue the current task blocks on
+ * @param sending Nonzero if blocking to send
+ */
+void dmosi_trace_queue_block(void* queue, int sending)
+{
+    trace_record((sending != 0) ? DMOSI_TRACE_EVENT_QUEUE_BLOCK_SEND : DMOSI_TRACE_EVENT_QUEUE_BLOCK_RECEIVE,
+                 queue, trace_queue_arg(queue, 0));
+}
+
+/**
+ * @brief traceTIMER_EXPIRED hook, also called by the timer wheel
+ *
+ * @param timer Expired timer
+ */
+void dmosi_trace_timer_expired(const void* timer)
+{
+    trace_record(DMOSI_TRACE_EVENT_TIMER_EXPIRED, timer, 0);
+}
+
+#endif /* DMOSI_TRACE */
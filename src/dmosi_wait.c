@@ -0,0 +1,197 @@
+#include <stddef.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+#include <errno.h>
+#include "dmosi.h"
+#include "dmosi_freertos.h"
+#include "dmosi_notify.h"
+#include "dmosi_wait.h"
+#include "dmosi_ticks.h"
+#include "FreeRTOS.h"
+#include "task.h"
+
+/**
+ * @brief Notify all watchers of an object
+ *
+ * Usable from any context.
+ *
+ * @param list Watchers of the object
+ */
+void dmosi_watch_notify_slow(dmosi_watch_list_t* list)
+{
+    if (xPortIsInsideInterrupt()) {
+        BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+
+        UBaseType_t saved = taskENTER_CRITICAL_FROM_ISR();
+        for (dmosi_watcher_t* w = atomic_load_explicit(&list->head, memory_order_relaxed); w != NULL; w = w->next) {
+            vTaskNotifyGiveIndexedFromISR(w->task, DMOSI_NOTIFY_INDEX_WAIT, &xHigherPriorityTaskWoken);
+        }
+        taskEXIT_CRITICAL_FROM_ISR(saved);
+
+        portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
+    } else {
+        taskENTER_CRITICAL();
+        for (dmosi_watcher_t* w = atomic_load_explicit(&list->head, memory_order_relaxed); w != NULL; w = w->next) {
+            xTaskNotifyGiveIndexed(w->task, DMOSI_NOTIFY_INDEX_WAIT);
+        }
+        taskEXIT_CRITICAL();
+    }
+}
+
+/**
+ * @brief Get the watcher list of an object
+ *
+ * @param object Object to wait on
+ * @return dmosi_watch_list_t* Watcher list
+ */
+static dmosi_watch_list_t* wait_list(const dmosi_wait_object_t* object)
+{
+    switch (object->type) {
+        case DMOSI_WAIT_QUEUE:  return dmosi_queue_watch_list((dmosi_queue_t)object->object);
+        case DMOSI_WAIT_FUTURE: return dmosi_future_watch_list((dmosi_future_t)object->object);
+        default:                return dmosi_semaphore_watch_list((dmosi_semaphore_t)object->object);
+    }
+}
+
+/**
+ * @brief Check whether an object is ready
+ *
+ * Must be called inside a critical section.
+ *
+ * @param object Object to wait on
+ * @return true if taking from the object would not block
+ */
+static bool wait_ready_locked(const dmosi_wait_object_t* object)
+{
+    switch (object->type) {
+        case DMOSI_WAIT_QUEUE:  return dmosi_queue_ready((dmosi_queue_t)object->object);
+        case DMOSI_WAIT_FUTURE: return dmosi_future_ready((dmosi_future_t)object->object);
+        default:                return dmosi_semaphore_ready_locked((dmosi_semaphore_t)object->object);
+    }
+}
+
+/**
+ * @brief Remove a watcher from a list
+ *
+ * Must be called inside a critical section.
+ *
+ * @param list Watcher list
+ * @param watcher Watcher to remove (ignored if not listed)
+ */
+static void wait_unlink_locked(dmosi_watch_list_t* list, dmosi_watcher_t* watcher)
+{
+    dmosi_watcher_t* prev = NULL;
+    dmosi_watcher_t* cur = atomic_load_explicit(&list->head, memory_order_relaxed);
+
+    while (cur != NULL && cur != watcher) {
+        prev = cur;
+        cur = cur->next;
+    }
+
+    if (cur == NULL) {
+        return;
+    }
+
+    if (prev == NULL) {
+        atomic_store_explicit(&list->head, watcher->next, memory_order_relaxed);
+    } else {
+        prev->next = watcher->next;
+    }
+}
+
+//==============================================================================
+//                              MULTIPLE OBJECT WAIT Implementation
+//==============================================================================
+
+/**
+ * @brief Wait until one of several queues, semaphores or futures is ready
+ *
+ * Nothing is taken from the ready object: receive from the queue, wait on
+ * the semaphore or poll the future afterwards. When several objects are
+ * ready the lowest index wins, so order @p objects by priority.
+ *
+ * The calling thread registers a watcher on every object for the duration
+ * of the wait; producers notify it on DMOSI_NOTIFY_INDEX_WAIT, so no object
+ * has to be dedicated to a set and no polling is involved.
+ *
+ * @param objects Objects to wait on
+ * @param count Number of objects (1 .. DMOSI_WAIT_MULTIPLE_MAX)
+ * @param timeout_ms Timeout in milliseconds (0 = no wait, -1 = wait forever)
+ * @return int Index of the first ready object in @p objects, -EAGAIN or
+ *         -ETIMEDOUT if none became ready, -EINVAL on invalid arguments
+ */
+int dmosi_wait_multiple(const dmosi_wait_object_t* objects, size_t count, int32_t timeout_ms)
+{
+    if (objects == NULL || count == 0 || count > DMOSI_WAIT_MULTIPLE_MAX) {
+        DMOD_LOG_ERROR("Invalid object list for multiple wait (count=%zu)\n", count);
+        return -EINVAL;
+    }
+
+    for (size_t i = 0; i < count; i++) {
+        if (objects[i].object == NULL ||
+            (objects[i].type != DMOSI_WAIT_QUEUE && objects[i].type != DMOSI_WAIT_SEMAPHORE &&
+             objects[i].type != DMOSI_WAIT_FUTURE)) {
+            DMOD_LOG_ERROR("Invalid object %zu in multiple wait\n", i);
+            return -EINVAL;
+        }
+    }
+
+    if (timeout_ms != 0 && !dmosi_is_started()) {
+        return -ENOTSUP;
+    }
+
+    TickType_t ticks = dmosi_ticks_from_timeout(timeout_ms);
+
+    dmosi_watcher_t watchers[DMOSI_WAIT_MULTIPLE_MAX];
+    TaskHandle_t self = xTaskGetCurrentTaskHandle();
+    TimeOut_t timeout;
+    vTaskSetTimeOutState(&timeout);
+
+    for (;;) {
+        int ready = -1;
+
+        // Producers change the object state inside a critical section as
+        // well, so a change either precedes the check or finds the watchers
+        taskENTER_CRITICAL();
+        if (ticks > 0) {
+            for (size_t i = 0; i < count; i++) {
+                dmosi_watch_list_t* list = wait_list(&objects[i]);
+                watchers[i].task = self;
+                watchers[i].next = atomic_load_explicit(&list->head, memory_order_relaxed);
+                atomic_store_explicit(&list->head, &watchers[i], memory_order_relaxed);
+            }
+        }
+        for (size_t i = 0; i < count && ready < 0; i++) {
+            if (wait_ready_locked(&objects[i])) {
+                ready = (int)i;
+            }
+        }
+        if (ready >= 0 && ticks > 0) {
+            for (size_t i = 0; i < count; i++) {
+                wait_unlink_locked(wait_list(&objects[i]), &watchers[i]);
+            }
+        }
+        taskEXIT_CRITICAL();
+
+        if (ready >= 0) {
+            return ready;
+        }
+
+        if (ticks == 0) {
+            return (timeout_ms == 0) ? -EAGAIN : -ETIMEDOUT;
+        }
+
+        ulTaskNotifyTakeIndexed(DMOSI_NOTIFY_INDEX_WAIT, pdTRUE, ticks);
+
+        taskENTER_CRITICAL();
+        for (size_t i = 0; i < count; i++) {
+            wait_unlink_locked(wait_list(&objects[i]), &watchers[i]);
+        }
+        taskEXIT_CRITICAL();
+
+        if (xTaskCheckForTimeOut(&timeout, &ticks) == pdTRUE) {
+            // Deadline passed: one last look without waiting
+            ticks = 0;
+        }
+    }
+}
@@ -0,0 +1,121 @@
+#ifndef DMOSI_WAIT_H
+#define DMOSI_WAIT_H
+
+#include <stdbool.h>
+#include <stdatomic.h>
+#include "dmosi.h"
+#include "dmosi_freertos.h"
+#include "FreeRTOS.h"
+#include "task.h"
+
+/**
+ * @brief Thread blocked in dmosi_wait_multiple() on one object
+ *
+ * Lives on the waiter's stack for the duration of the wait.
+ */
+typedef struct dmosi_watcher {
+    struct dmosi_watcher* next;     /**< Next watcher of the same object */
+    TaskHandle_t task;              /**< Task to notify on DMOSI_NOTIFY_INDEX_WAIT */
+} dmosi_watcher_t;
+
+/**
+ * @brief Watchers of a queue or semaphore
+ *
+ * Only modified inside a kernel critical section; the head is atomic so the
+ * producer fast path can skip the critical section when nobody watches.
+ */
+typedef struct {
+    _Atomic(dmosi_watcher_t*) head; /**< First watcher (NULL = none) */
+} dmosi_watch_list_t;
+
+/**
+ * @brief Initialize an empty watcher list
+ *
+ * @param list List to initialize
+ */
+static inline void dmosi_watch_init(dmosi_watch_list_t* list)
+{
+    atomic_init(&list->head, NULL);
+}
+
+/**
+ * @brief Notify all watchers of an object (any context)
+ *
+ * @param list Watchers of the object
+ */
+void dmosi_watch_notify_slow(dmosi_watch_list_t* list);
+
+/**
+ * @brief Notify the watchers of an object that became ready
+ *
+ * Called by producers after the object state changed, outside their own
+ * critical sections. The fence orders the state change before the check of
+ * the list, pairing with the watcher registering before it checks the state.
+ *
+ * @param list Watchers of the object
+ */
+static inline void dmosi_watch_notify(dmosi_watch_list_t* list)
+{
+    atomic_thread_fence(memory_order_seq_cst);
+    if (atomic_load_explicit(&list->head, memory_order_relaxed) != NULL) {
+        dmosi_watch_notify_slow(list);
+    }
+}
+
+/**
+ * @brief Get the watcher list of a queue
+ *
+ * Implemented by the queue module.
+ *
+ * @param queue Queue handle
+ * @return dmosi_watch_list_t* Watcher list of @p queue
+ */
+dmosi_watch_list_t* dmosi_queue_watch_list(dmosi_queue_t queue);
+
+/**
+ * @brief Check whether a queue holds an item
+ *
+ * @param queue Queue handle
+ * @return true if a receive would not block
+ */
+bool dmosi_queue_ready(dmosi_queue_t queue);
+
+/**
+ * @brief Get the watcher list of a semaphore
+ *
+ * Implemented by the semaphore module.
+ *
+ * @param semaphore Semaphore handle
+ * @return dmosi_watch_list_t* Watcher list of @p semaphore
+ */
+dmosi_watch_list_t* dmosi_semaphore_watch_list(dmosi_semaphore_t semaphore);
+
+/**
+ * @brief Check whether a unit can be taken from a semaphore
+ *
+ * Must be called inside a critical section.
+ *
+ * @param semaphore Semaphore handle
+ * @return true if a wait for one unit would not block
+ */
+bool dmosi_semaphore_ready_locked(dmosi_semaphore_t semaphore);
+
+/**
+ * @brief Get the watcher list of a future
+ *
+ * Implemented by the future module.
+ *
+ * @param future Future handle
+ * @return dmosi_watch_list_t* Watcher list of @p future
+ */
+dmosi_watch_list_t* dmosi_future_watch_list(dmosi_future_t future);
+
+/**
+ * @brief Check whether a future is completed
+ *
+ * @param future Future handle
+ * @return true if a wait on @p future would not block
+ */
+bool dmosi_future_ready(dmosi_future_t future);
+
+#endif /* DMOSI_WAIT_H */
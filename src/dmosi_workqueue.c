@@ -0,0 +1,551 @@
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <errno.h>
+#include "dmosi.h"
+#include "dmosi_freertos.h"
+#include "dmosi_notify.h"
+#include "dmosi_ticks.h"
+#include "FreeRTOS.h"
+#include "task.h"
+
+/**
+ * @brief Whether idle workers take pending work from their siblings
+ *
+ * Configurable via the CMake parameter of the same name. Enabled by default
+ * on SMP builds, where workers run in parallel and an idle core should not
+ * wait behind a busy one.
+ */
+#ifndef DMOSI_WORKQUEUE_WORK_STEALING
+    #define DMOSI_WORKQUEUE_WORK_STEALING    (configNUMBER_OF_CORES > 1)
+#endif
+
+/**
+ * @brief Life cycle of a work item
+ */
+enum work_state {
+    WORK_IDLE = 0,          /**< Initialized, never submitted */
+    WORK_PENDING,           /**< Queued on a worker */
+    WORK_RUNNING,           /**< Being executed by a worker */
+    WORK_DONE,              /**< Executed */
+    WORK_CANCELED,          /**< Removed before it ran */
+};
+
+/**
+ * @brief Internal layout of dmosi_work_t
+ */
+struct dmosi_work {
+    dmosi_work_fn_t fn;             /**< Function to run */
+    void* arg;                      /**< Argument passed to @ref fn */
+    struct dmosi_work* next;        /**< Next item in the worker's pending list */
+    TaskHandle_t waiter;            /**< Task blocked in dmosi_work_wait() (NULL if none) */
+    uint32_t state;                 /**< One of enum work_state */
+};
+
+_Static_assert(sizeof(struct dmosi_work) <= sizeof(dmosi_work_t),
+               "dmosi_work_t is too small for struct dmosi_work");
+_Static_assert(_Alignof(struct dmosi_work) <= _Alignof(dmosi_work_t),
+               "dmosi_work_t is under-aligned for struct dmosi_work");
+
+/**
+ * @brief A worker thread and its pending work
+ */
+struct workqueue_worker {
+    struct dmosi_workqueue* wq;     /**< Owning work queue */
+    dmosi_thread_t thread;          /**< Worker thread */
+    TaskHandle_t task;              /**< Worker task, set by the worker itself */
+    struct dmosi_work* head;        /**< Oldest pending item */
+    struct dmosi_work* tail;        /**< Newest pending item */
+    bool idle;                      /**< Parked waiting for work */
+};
+
+/**
+ * @brief Internal structure of a work queue
+ *
+ * Each worker owns a FIFO of pending items. Submitting prefers an idle
+ * worker and otherwise distributes round-robin; with work stealing enabled
+ * a worker whose own list is empty takes the oldest item of a sibling.
+ * All lists are protected by a kernel critical section, so submitting is
+ * O(1) and safe from interrupts.
+ */
+struct dmosi_workqueue {
+    size_t worker_count;                    /**< Number of workers */
+    size_t next_worker;                     /**< Round-robin cursor for busy workers */
+    bool stopping;                          /**< Set by dmosi_workqueue_destroy() */
+    struct workqueue_worker workers[];      /**< Workers */
+};
+
+/**
+ * @brief Map a finished state to the result of dmosi_work_wait()
+ *
+ * @param state Work state
+ * @return int 0 if done, -ECANCELED if canceled, -EINVAL if never submitted,
+ *         1 if still pending or running
+ */
+static int work_result(uint32_t state)
+{
+    switch (state) {
+        case WORK_DONE:     return 0;
+        case WORK_CANCELED: return -ECANCELED;
+        case WORK_IDLE:     return -EINVAL;
+        default:            return 1;
+    }
+}
+
+/**
+ * @brief Take the next item for a worker
+ *
+ * Must be called inside a critical section.
+ *
+ * @param wq Work queue
+ * @param worker Worker looking for work
+ * @return struct dmosi_work* Item to run, NULL if there is none
+ */
+static struct dmosi_work* workqueue_take_locked(struct dmosi_workqueue* wq, struct workqueue_worker* worker)
+{
+    struct workqueue_worker* source = worker;
+
+#if DMOSI_WORKQUEUE_WORK_STEALING
+    for (size_t i = 0; source->head == NULL && i < wq->worker_count; i++) {
+        source = &wq->workers[i];
+    }
+#else
+    (void)wq;
+#endif
+
+    struct dmosi_work* work = source->head;
+    if (work != NULL) {
+        source->head = work->next;
+        if (source->head == NULL) {
+            source->tail = NULL;
+        }
+        work->next = NULL;
+    }
+    return work;
+}
+
+/**
+ * @brief Queue an item on a worker
+ *
+ * Must be called inside a critical section.
+ *
+ * @param wq Work queue
+ * @param work Item to queue
+ * @param wake Set to the worker task to notify (NULL if none)
+ * @return int 0 on success, -EBUSY if @p work is pending or running,
+ *         -ESHUTDOWN if the work queue is being destroyed
+ */
+static int workqueue_submit_locked(struct dmosi_workqueue* wq, struct dmosi_work* work, TaskHandle_t* wake)
+{
+    *wake = NULL;
+
+    if (wq->stopping) {
+        return -ESHUTDOWN;
+    }
+
+    if (work->state == WORK_PENDING || work->state == WORK_RUNNING) {
+        return -EBUSY;
+    }
+
+    struct workqueue_worker* worker = NULL;
+    for (size_t i = 0; i < wq->worker_count; i++) {
+        if (wq->workers[i].idle) {
+            worker = &wq->workers[i];
+            break;
+        }
+    }
+
+    if (worker == NULL) {
+        worker = &wq->workers[wq->next_worker];
+        wq->next_worker = (wq->next_worker + 1) % wq->worker_count;
+    }
+
+    work->state = WORK_PENDING;
+    work->next = NULL;
+    if (worker->tail != NULL) {
+        worker->tail->next = work;
+    } else {
+        worker->head = work;
+    }
+    worker->tail = work;
+
+    if (worker->idle) {
+        worker->idle = false;
+        *wake = worker->task;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Entry function of the worker threads
+ *
+ * @param arg Worker
+ */
+static void workqueue_worker_entry(void* arg)
+{
+    struct workqueue_worker* worker = (struct workqueue_worker*)arg;
+    struct dmosi_workqueue* wq = worker->wq;
+
+    // Published before the first park, so submitters only ever notify a known task
+    worker->task = xTaskGetCurrentTaskHandle();
+
+    for (;;) {
+        taskENTER_CRITICAL();
+        struct dmosi_work* work = workqueue_take_locked(wq, worker);
+        if (work == NULL) {
+            bool stopping = wq->stopping;
+            worker->idle = !stopping;
+            taskEXIT_CRITICAL();
+
+            if (stopping) {
+                return;
+            }
+
+            ulTaskNotifyTakeIndexed(DMOSI_NOTIFY_INDEX_WAIT, pdTRUE, portMAX_DELAY);
+            continue;
+        }
+        work->state = WORK_RUNNING;
+        taskEXIT_CRITICAL();
+
+        work->fn(work->arg);
+
+        // The owner may reuse the item as soon as it is marked done
+        taskENTER_CRITICAL();
+        work->state = WORK_DONE;
+        TaskHandle_t waiter = work->waiter;
+        work->waiter = NULL;
+        taskEXIT_CRITICAL();
+
+        if (waiter != NULL) {
+            xTaskNotifyGiveIndexed(waiter, DMOSI_NOTIFY_INDEX_WAIT);
+        }
+    }
+}
+
+//==============================================================================
+//                              WORKQUEUE API Implementation
+//==============================================================================
+
+/**
+ * @brief Create a work queue
+ *
+ * The worker threads are created up front and belong to @p process, so
+ * submitting work never creates a task.
+ *
+ * @param worker_count Number of worker threads (> 0)
+ * @param priority Priority of the worker threads
+ * @param stack_size Stack size of each worker thread in bytes
+ * @param name Name of the worker threads (cannot be NULL)
+ * @param process Process the workers belong to (NULL = current process)
+ * @return dmosi_workqueue_t Created work queue handle, NULL on failure
+ */
+dmosi_workqueue_t dmosi_workqueue_create(size_t worker_count, int priority, size_t stack_size, const char* name, dmosi_process_t process)
+{
+    if (worker_count == 0 || stack_size == 0 || name == NULL ||
+        worker_count > (SIZE_MAX - sizeof(struct dmosi_workqueue)) / sizeof(struct workqueue_worker)) {
+        DMOD_LOG_ERROR("Invalid work queue parameters: worker_count=%zu, stack_size=%zu\n", worker_count, stack_size);
+        return NULL;
+    }
+
+    struct dmosi_workqueue* wq = pvPortMalloc(sizeof(*wq) + worker_count * sizeof(struct workqueue_worker));
+    if (wq == NULL) {
+        DMOD_LOG_ERROR("Failed to allocate memory for work queue\n");
+        return NULL;
+    }
+
+    wq->worker_count = worker_count;
+    wq->next_worker = 0;
+    wq->stopping = false;
+
+    for (size_t i = 0; i < worker_count; i++) {
+        struct workqueue_worker* worker = &wq->workers[i];
+        worker->wq = wq;
+        worker->thread = NULL;
+        worker->task = NULL;
+        worker->head = NULL;
+        worker->tail = NULL;
+        worker->idle = false;
+    }
+
+    for (size_t i = 0; i < worker_count; i++) {
+        wq->workers[i].thread = dmosi_thread_create(workqueue_worker_entry, &wq->workers[i], priority, stack_size, name, process);
+        if (wq->workers[i].thread == NULL) {
+            DMOD_LOG_ERROR("Failed to create work queue worker %zu\n", i);
+            dmosi_workqueue_destroy(wq);
+            return NULL;
+        }
+    }
+
+    return wq;
+}
+
+/**
+ * @brief Destroy a work queue
+ *
+ * Items still pending are canceled; items already running are finished
+ * first. Blocks until all workers have exited, so it must not be called
+ * from a worker of @p wq.
+ *
+ * @param wq Work queue handle to destroy
+ */
+void dmosi_workqueue_destroy(dmosi_workqueue_t wq)
+{
+    if (wq == NULL) {
+        return;
+    }
+
+    struct dmosi_work* canceled = NULL;
+
+    taskENTER_CRITICAL();
+    wq->stopping = true;
+    for (size_t i = 0; i < wq->worker_count; i++) {
+        struct workqueue_worker* worker = &wq->workers[i];
+        if (worker->tail != NULL) {
+            worker->tail->next = canceled;
+            canceled = worker->head;
+        }
+        worker->head = NULL;
+        worker->tail = NULL;
+    }
+    taskEXIT_CRITICAL();
+
+    // Items stay pending until they are unlinked here one at a time, so
+    // their waiters can be woken outside the critical section; once marked
+    // canceled an item may be reused by its owner and is not touched again.
+    while (canceled != NULL) {
+        struct dmosi_work* work = canceled;
+
+        taskENTER_CRITICAL();
+        canceled = work->next;
+        work->next = NULL;
+        work->state = WORK_CANCELED;
+        TaskHandle_t waiter = work->waiter;
+        work->waiter = NULL;
+        taskEXIT_CRITICAL();
+
+        if (waiter != NULL) {
+            xTaskNotifyGiveIndexed(waiter, DMOSI_NOTIFY_INDEX_WAIT);
+        }
+    }
+
+    for (size_t i = 0; i < wq->worker_count; i++) {
+        struct workqueue_worker* worker = &wq->workers[i];
+        if (worker->thread == NULL) {
+            continue;
+        }
+
+        taskENTER_CRITICAL();
+        TaskHandle_t task = worker->idle ? worker->task : NULL;
+        worker->idle = false;
+        taskEXIT_CRITICAL();
+
+        if (task != NULL) {
+            xTaskNotifyGiveIndexed(task, DMOSI_NOTIFY_INDEX_WAIT);
+        }
+
+        dmosi_thread_join(worker->thread);
+        dmosi_thread_destroy(worker->thread);
+    }
+
+    vPortFree(wq);
+}
+
+/**
+ * @brief Prepare a work item
+ *
+ * The item may be submitted again once it finished or was canceled.
+ *
+ * @param work Work item storage
+ * @param fn Function to run on a worker
+ * @param arg Argument passed to @p fn
+ * @return int 0 on success, -EINVAL on invalid arguments
+ */
+int dmosi_work_init(dmosi_work_t* work, dmosi_work_fn_t fn, void* arg)
+{
+    if (work == NULL || fn == NULL) {
+        return -EINVAL;
+    }
+
+    struct dmosi_work* w = (struct dmosi_work*)work;
+    w->fn = fn;
+    w->arg = arg;
+    w->next = NULL;
+    w->waiter = NULL;
+    w->state = WORK_IDLE;
+
+    return 0;
+}
+
+/**
+ * @brief Submit a work item to a work queue
+ *
+ * Never blocks. Safe to call from both task and interrupt context; from an
+ * interrupt at most one context switch is requested, on exit from the
+ * handler. The item must stay valid until it finished or was canceled.
+ *
+ * @param wq Work queue handle
+ * @param work Initialized work item
+ * @return int 0 on success, -EBUSY if @p work is already pending or running,
+ *         -ESHUTDOWN if the work queue is being destroyed, -EINVAL on invalid arguments
+ */
+int dmosi_workqueue_submit(dmosi_workqueue_t wq, dmosi_work_t* work)
+{
+    if (wq == NULL || work == NULL) {
+        return -EINVAL;
+    }
+
+    struct dmosi_work* w = (struct dmosi_work*)work;
+    TaskHandle_t wake;
+    int result;
+
+    if (xPortIsInsideInterrupt()) {
+        UBaseType_t saved = taskENTER_CRITICAL_FROM_ISR();
+        result = workqueue_submit_locked(wq, w, &wake);
+        taskEXIT_CRITICAL_FROM_ISR(saved);
+
+        if (wake != NULL) {
+            BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+            vTaskNotifyGiveIndexedFromISR(wake, DMOSI_NOTIFY_INDEX_WAIT, &xHigherPriorityTaskWoken);
+            portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
+        }
+    } else {
+        taskENTER_CRITICAL();
+        result = workqueue_submit_locked(wq, w, &wake);
+        taskEXIT_CRITICAL();
+
+        if (wake != NULL) {
+            xTaskNotifyGiveIndexed(wake, DMOSI_NOTIFY_INDEX_WAIT);
+        }
+    }
+
+    return result;
+}
+
+/**
+ * @brief Cancel a pending work item
+ *
+ * @param wq Work queue handle the item was submitted to
+ * @param work Work item
+ * @return int 0 on success, -EBUSY if the item is already running,
+ *         -ENOENT if it is not pending, -EINVAL on invalid arguments
+ */
+int dmosi_workqueue_cancel(dmosi_workqueue_t wq, dmosi_work_t* work)
+{
+    if (wq == NULL || work == NULL) {
+        return -EINVAL;
+    }
+
+    struct dmosi_work* w = (struct dmosi_work*)work;
+    int result = -ENOENT;
+    TaskHandle_t waiter = NULL;
+
+    taskENTER_CRITICAL();
+    if (w->state == WORK_RUNNING) {
+        result = -EBUSY;
+    } else if (w->state == WORK_PENDING) {
+        for (size_t i = 0; i < wq->worker_count && result != 0; i++) {
+            struct workqueue_worker* worker = &wq->workers[i];
+            struct dmosi_work* prev = NULL;
+            for (struct dmosi_work* it = worker->head; it != NULL; prev = it, it = it->next) {
+                if (it != w) {
+                    continue;
+                }
+                if (prev != NULL) {
+                    prev->next = w->next;
+                } else {
+                    worker->head = w->next;
+                }
+                if (worker->tail == w) {
+                    worker->tail = prev;
+                }
+                w->next = NULL;
+                w->state = WORK_CANCELED;
+                waiter = w->waiter;
+                w->waiter = NULL;
+                result = 0;
+                break;
+            }
+        }
+    }
+    taskEXIT_CRITICAL();
+
+    if (waiter != NULL) {
+        xTaskNotifyGiveIndexed(waiter, DMOSI_NOTIFY_INDEX_WAIT);
+    }
+
+    return result;
+}
+
+/**
+ * @brief Wait for a submitted work item to finish
+ *
+ * Only one task may wait for an item at a time. Waiting from a worker for
+ * an item queued on the same work queue can deadlock when all workers wait.
+ *
+ * @param work Work item
+ * @param timeout_ms Timeout in milliseconds (0 = no wait, -1 = wait forever)
+ * @return int 0 if the item ran, -ECANCELED if it was canceled, -EINVAL if it
+ *         was never submitted, -EBUSY if another task is waiting for it,
+ *         negative error code on failure
+ */
+int dmosi_work_wait(dmosi_work_t* work, int32_t timeout_ms)
+{
+    if (work == NULL) {
+        return -EINVAL;
+    }
+
+    struct dmosi_work* w = (struct dmosi_work*)work;
+
+    taskENTER_CRITICAL();
+    int result = work_result(w->state);
+    taskEXIT_CRITICAL();
+
+    if (result <= 0) {
+        return result;
+    }
+
+    if (timeout_ms == 0) {
+        return -EAGAIN;  // Would block
+    }
+
+    if (!dmosi_is_started()) {
+        return -ENOTSUP;
+    }
+
+    TickType_t ticks = dmosi_ticks_from_timeout(timeout_ms);
+
+    TaskHandle_t self = xTaskGetCurrentTaskHandle();
+    TimeOut_t timeout;
+    vTaskSetTimeOutState(&timeout);
+
+    for (;;) {
+        taskENTER_CRITICAL();
+        result = work_result(w->state);
+        if (result > 0) {
+            if (w->waiter != NULL && w->waiter != self) {
+                result = -EBUSY;
+            } else {
+                w->waiter = self;
+            }
+        }
+        taskEXIT_CRITICAL();
+
+        if (result <= 0) {
+            return result;
+        }
+
+        if (xTaskCheckForTimeOut(&timeout, &ticks) == pdTRUE) {
+            taskENTER_CRITICAL();
+            if (w->waiter == self) {
+                w->waiter = NULL;
+            }
+            result = work_result(w->state);
+            taskEXIT_CRITICAL();
+
+            return (result <= 0) ? result : -ETIMEDOUT;  // Timeout occurred
+        }
+
+        ulTaskNotifyTakeIndexed(DMOSI_NOTIFY_INDEX_WAIT, pdTRUE, ticks);
+    }
+}
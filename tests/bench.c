@@ -0,0 +1,512 @@
+#define DMOD_ENABLE_REGISTRATION
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include "dmod.h"
+#include "dmod_sal.h"
+#include "dmosi.h"
+#include "dmosi_freertos.h"
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* =========================================================================
+ * Microbenchmarks
+ *
+ * Every benchmark prints one JSON object per line on stdout, e.g.
+ *   {"bench":"mutex_uncontended","param":0,"iterations":10000,
+ *    "ops_per_sec":12345678,"p50_ns":80,"p90_ns":85,"p99_ns":120,"max_ns":900}
+ * so runs can be collected and compared across releases.  Lines that do
+ * not start with '{' are human-readable progress only.
+ *
+ * Throughput is measured over BENCH_ITERATIONS back-to-back operations,
+ * latency percentiles over BENCH_SAMPLES individually timed ones (which
+ * includes the cost of reading the clock).  Both can be overridden with
+ * -D on the command line for slower boards.
+ * ========================================================================= */
+
+#ifndef BENCH_ITERATIONS
+    #define BENCH_ITERATIONS    10000
+#endif
+
+#ifndef BENCH_SAMPLES
+    #define BENCH_SAMPLES       1000
+#endif
+
+/* Expirations recorded by the timer jitter benchmark */
+#ifndef BENCH_TIMER_SAMPLES
+    #define BENCH_TIMER_SAMPLES 100
+#endif
+
+/* The benchmark task runs below the helper threads, so each hand-off to a
+ * helper switches context immediately; the timer task stays above both. */
+#define BENCH_TASK_PRIORITY      ( configMAX_PRIORITIES - 3 )
+#define BENCH_HELPER_PRIORITY    ( configMAX_PRIORITIES - 2 )
+#define BENCH_HELPER_STACK       4096
+
+/* =========================================================================
+ * pvPortMalloc / vPortFree overrides
+ *
+ * Same as in main.c: the DMOD-routing heap in dmosi_heap.c cannot serve the
+ * allocations made while dmosi_init() sets up the system process, so plain
+ * malloc/free are used.  The heap benchmark therefore measures the
+ * pvPortMalloc() that is linked into this executable.
+ * ========================================================================= */
+void* pvPortMalloc( size_t size )
+{
+    return malloc( size );
+}
+
+void vPortFree( void* ptr )
+{
+    free( ptr );
+}
+
+size_t xPortGetFreeHeapSize( void )
+{
+    return 0;
+}
+
+size_t xPortGetMinimumEverFreeHeapSize( void )
+{
+    return 0;
+}
+
+void vPortInitialiseBlocks( void )
+{
+}
+
+void dmosi_heap_retag( void* ptr, const char* module_name )
+{
+    if( ptr != NULL && module_name != NULL )
+    {
+        Dmod_RetagEx( ptr, module_name );
+    }
+}
+
+#if ( configCHECK_FOR_STACK_OVERFLOW > 0 )
+void vApplicationStackOverflowHook( TaskHandle_t xTask,
+                                    char * pcTaskName )
+{
+    ( void ) xTask;
+    printf( "STACK OVERFLOW in task: %s\n", pcTaskName );
+    abort();
+}
+#endif /* configCHECK_FOR_STACK_OVERFLOW */
+
+/* Stack depth multiplier for the benchmark task */
+#define BENCH_TASK_STACK_MULTIPLIER    32
+
+/* =========================================================================
+ * Harness
+ * ========================================================================= */
+typedef void ( * bench_op_t )( void * ctx );
+
+static uint32_t g_samples[ BENCH_SAMPLES ];
+
+static int compare_u32( const void * a, const void * b )
+{
+    uint32_t x = *( const uint32_t * ) a;
+    uint32_t y = *( const uint32_t * ) b;
+
+    return ( x > y ) - ( x < y );
+}
+
+static uint32_t percentile( const uint32_t * sorted, size_t count, uint32_t pct )
+{
+    if( count == 0 )
+    {
+        return 0;
+    }
+
+    return sorted[ ( ( count - 1 ) * pct ) / 100 ];
+}
+
+static uint32_t clamp_ns( uint64_t ns )
+{
+    return ( ns < UINT32_MAX ) ? ( uint32_t ) ns : UINT32_MAX;
+}
+
+/* Print one result line; @p samples is sorted in place */
+static void bench_report( const char * name, uint32_t param, uint32_t iterations,
+                          uint64_t elapsed_ns, uint32_t * samples, size_t count )
+{
+    uint64_t ops_per_sec = ( elapsed_ns > 0 ) ? ( ( uint64_t ) iterations * 1000000000ULL ) / elapsed_ns : 0;
+
+    qsort( samples, count, sizeof( samples[ 0 ] ), compare_u32 );
+
+    printf( "{\"bench\":\"%s\",\"param\":%lu,\"iterations\":%lu,\"ops_per_sec\":%llu,"
+            "\"p50_ns\":%lu,\"p90_ns\":%lu,\"p99_ns\":%lu,\"max_ns\":%lu}\n",
+            name,
+            ( unsigned long ) param,
+            ( unsigned long ) iterations,
+            ( unsigned long long ) ops_per_sec,
+            ( unsigned long ) percentile( samples, count, 50 ),
+            ( unsigned long ) percentile( samples, count, 90 ),
+            ( unsigned long ) percentile( samples, count, 99 ),
+            ( unsigned long ) ( ( count > 0 ) ? samples[ count - 1 ] : 0 ) );
+}
+
+/* Run @p op for throughput, then time BENCH_SAMPLES single calls */
+static void bench_run( const char * name, uint32_t param, uint32_t iterations,
+                       bench_op_t op, void * ctx )
+{
+    /* Warm up caches, pools and lazily created kernel objects */
+    for( uint32_t i = 0; i < 16; i++ )
+    {
+        op( ctx );
+    }
+
+    uint64_t start = dmosi_get_time_ns();
+    for( uint32_t i = 0; i < iterations; i++ )
+    {
+        op( ctx );
+    }
+    uint64_t elapsed = dmosi_get_time_ns() - start;
+
+    for( size_t i = 0; i < BENCH_SAMPLES; i++ )
+    {
+        uint64_t t0 = dmosi_get_time_ns();
+        op( ctx );
+        g_samples[ i ] = clamp_ns( dmosi_get_time_ns() - t0 );
+    }
+
+    bench_report( name, param, iterations, elapsed, g_samples, BENCH_SAMPLES );
+}
+
+/* =========================================================================
+ * Helper thread exchanging semaphore signals with the benchmark task
+ *
+ * The helper waits for "ping"; when @ref mutex is set it then takes and
+ * releases the mutex, which blocks until the benchmark task unlocks it,
+ * otherwise it answers with "pong".
+ * ========================================================================= */
+typedef struct
+{
+    dmosi_semaphore_t ping;
+    dmosi_semaphore_t pong;
+    dmosi_mutex_t mutex;
+    volatile bool stop;
+    dmosi_thread_t thread;
+} bench_partner_t;
+
+static void partner_entry( void * arg )
+{
+    bench_partner_t * partner = ( bench_partner_t * ) arg;
+
+    for( ;; )
+    {
+        dmosi_semaphore_wait( partner->ping, 1, -1 );
+        if( partner->stop )
+        {
+            break;
+        }
+
+        if( partner->mutex != NULL )
+        {
+            dmosi_mutex_lock( partner->mutex );
+            dmosi_mutex_unlock( partner->mutex );
+        }
+        else
+        {
+            dmosi_semaphore_post( partner->pong, 1 );
+        }
+    }
+}
+
+static bool partner_start( bench_partner_t * partner, dmosi_mutex_t mutex )
+{
+    partner->ping = dmosi_semaphore_create( 0, 1 );
+    partner->pong = dmosi_semaphore_create( 0, 1 );
+    partner->mutex = mutex;
+    partner->stop = false;
+    partner->thread = NULL;
+
+    if( partner->ping != NULL && partner->pong != NULL )
+    {
+        partner->thread = dmosi_thread_create( partner_entry, partner, BENCH_HELPER_PRIORITY,
+                                               BENCH_HELPER_STACK, "bench_peer", NULL );
+    }
+
+    return partner->thread != NULL;
+}
+
+static void partner_stop( bench_partner_t * partner )
+{
+    if( partner->thread != NULL )
+    {
+        partner->stop = true;
+        dmosi_semaphore_post( partner->ping, 1 );
+        dmosi_thread_join( partner->thread );
+        dmosi_thread_destroy( partner->thread );
+    }
+
+    dmosi_semaphore_destroy( partner->ping );
+    dmosi_semaphore_destroy( partner->pong );
+}
+
+/* =========================================================================
+ * Mutex
+ * ========================================================================= */
+static void op_mutex_lock_unlock( void * ctx )
+{
+    dmosi_mutex_lock( ( dmosi_mutex_t ) ctx );
+    dmosi_mutex_unlock( ( dmosi_mutex_t ) ctx );
+}
+
+/* The helper blocks on the held mutex and receives it on unlock */
+static void op_mutex_handoff( void * ctx )
+{
+    bench_partner_t * partner = ( bench_partner_t * ) ctx;
+
+    dmosi_mutex_lock( partner->mutex );
+    dmosi_semaphore_post( partner->ping, 1 );
+    dmosi_mutex_unlock( partner->mutex );
+}
+
+static void bench_mutex( void )
+{
+    dmosi_mutex_t m = dmosi_mutex_create( false );
+    if( m == NULL )
+    {
+        printf( "mutex: creation failed, skipped\n" );
+        return;
+    }
+
+    bench_run( "mutex_uncontended", 0, BENCH_ITERATIONS, op_mutex_lock_unlock, m );
+
+    bench_partner_t partner;
+    if( partner_start( &partner, m ) )
+    {
+        bench_run( "mutex_contended_handoff", 0, BENCH_ITERATIONS, op_mutex_handoff, &partner );
+    }
+    partner_stop( &partner );
+
+    dmosi_mutex_destroy( m );
+}
+
+/* =========================================================================
+ * Semaphore
+ * ========================================================================= */
+static void op_semaphore_post_wait( void * ctx )
+{
+    dmosi_semaphore_post( ( dmosi_semaphore_t ) ctx, 1 );
+    dmosi_semaphore_wait( ( dmosi_semaphore_t ) ctx, 1, 0 );
+}
+
+/* One round trip: two context switches */
+static void op_semaphore_ping_pong( void * ctx )
+{
+    bench_partner_t * partner = ( bench_partner_t * ) ctx;
+
+    dmosi_semaphore_post( partner->ping, 1 );
+    dmosi_semaphore_wait( partner->pong, 1, -1 );
+}
+
+static void bench_semaphore( void )
+{
+    dmosi_semaphore_t sem = dmosi_semaphore_create( 0, 1 );
+    if( sem != NULL )
+    {
+        bench_run( "semaphore_post_wait", 0, BENCH_ITERATIONS, op_semaphore_post_wait, sem );
+        dmosi_semaphore_destroy( sem );
+    }
+
+    bench_partner_t partner;
+    if( partner_start( &partner, NULL ) )
+    {
+        bench_run( "semaphore_ping_pong", 0, BENCH_ITERATIONS, op_semaphore_ping_pong, &partner );
+    }
+    partner_stop( &partner );
+}
+
+/* =========================================================================
+ * Queue
+ * ========================================================================= */
+typedef struct
+{
+    dmosi_queue_t queue;
+    uint8_t item[ 256 ];
+} bench_queue_t;
+
+static void op_queue_send_receive( void * ctx )
+{
+    bench_queue_t * q = ( bench_queue_t * ) ctx;
+
+    dmosi_queue_send( q->queue, q->item, 0 );
+    dmosi_queue_receive( q->queue, q->item, 0 );
+}
+
+static void bench_queue( void )
+{
+    static const uint32_t item_sizes[] = { 4, 16, 64, 256 };
+    static bench_queue_t q;
+
+    memset( q.item, 0xA5, sizeof( q.item ) );
+
+    for( size_t i = 0; i < sizeof( item_sizes ) / sizeof( item_sizes[ 0 ] ); i++ )
+    {
+        q.queue = dmosi_queue_create( item_sizes[ i ], 1 );
+        if( q.queue == NULL )
+        {
+            printf( "queue: creation with %lu-byte items failed, skipped\n", ( unsigned long ) item_sizes[ i ] );
+            continue;
+        }
+
+        /* param = item size in bytes */
+        bench_run( "queue_send_receive", item_sizes[ i ], BENCH_ITERATIONS, op_queue_send_receive, &q );
+        dmosi_queue_destroy( q.queue );
+    }
+}
+
+/* =========================================================================
+ * Timer jitter
+ * ========================================================================= */
+static volatile uint32_t g_timer_expirations;
+static uint64_t g_timer_stamps[ BENCH_TIMER_SAMPLES + 1 ];
+
+static void timer_jitter_callback( void * arg )
+{
+    ( void ) arg;
+
+    if( g_timer_expirations <= BENCH_TIMER_SAMPLES )
+    {
+        g_timer_stamps[ g_timer_expirations ] = dmosi_get_time_ns();
+        g_timer_expirations++;
+    }
+}
+
+static void bench_timer( void )
+{
+    /* About two ticks, rounded up to whole milliseconds */
+    uint32_t period_ms = ( 2000U + configTICK_RATE_HZ - 1U ) / configTICK_RATE_HZ;
+
+    g_timer_expirations = 0;
+    dmosi_timer_t timer = dmosi_timer_create( timer_jitter_callback, NULL, period_ms, true );
+    if( timer == NULL || dmosi_timer_start( timer ) != 0 )
+    {
+        printf( "timer: start failed, skipped\n" );
+        dmosi_timer_destroy( timer );
+        return;
+    }
+
+    uint64_t start = dmosi_get_time_ns();
+    while( g_timer_expirations <= BENCH_TIMER_SAMPLES )
+    {
+        dmosi_thread_sleep( period_ms );
+    }
+    dmosi_timer_stop( timer );
+    uint64_t elapsed = dmosi_get_time_ns() - start;
+    dmosi_timer_destroy( timer );
+
+    /* Latency = deviation of each interval from the nominal period */
+    uint64_t period_ns = ( ( uint64_t ) pdMS_TO_TICKS( period_ms ) * 1000000000ULL ) / configTICK_RATE_HZ;
+    static uint32_t jitter[ BENCH_TIMER_SAMPLES ];
+    for( size_t i = 0; i < BENCH_TIMER_SAMPLES; i++ )
+    {
+        uint64_t interval = g_timer_stamps[ i + 1 ] - g_timer_stamps[ i ];
+        jitter[ i ] = clamp_ns( ( interval > period_ns ) ? interval - period_ns : period_ns - interval );
+    }
+
+    /* param = timer period in milliseconds */
+    bench_report( "timer_jitter", period_ms, BENCH_TIMER_SAMPLES, elapsed, jitter, BENCH_TIMER_SAMPLES );
+}
+
+/* =========================================================================
+ * Thread create / join
+ * ========================================================================= */
+static void empty_entry( void * arg )
+{
+    ( void ) arg;
+}
+
+static void op_thread_create_join( void * ctx )
+{
+    ( void ) ctx;
+
+    dmosi_thread_t t = dmosi_thread_create( empty_entry, NULL, BENCH_HELPER_PRIORITY,
+                                            BENCH_HELPER_STACK, "bench_thr", NULL );
+    if( t != NULL )
+    {
+        dmosi_thread_join( t );
+        dmosi_thread_destroy( t );
+    }
+}
+
+static void bench_thread( void )
+{
+    /* Far fewer iterations: every one allocates a stack and a kernel task */
+    bench_run( "thread_create_join", 0, BENCH_ITERATIONS / 10, op_thread_create_join, NULL );
+}
+
+/* =========================================================================
+ * Heap
+ * ========================================================================= */
+static void op_heap_malloc_free( void * ctx )
+{
+    void * block = pvPortMalloc( ( size_t ) ( uintptr_t ) ctx );
+    vPortFree( block );
+}
+
+static void bench_heap( void )
+{
+    static const uint32_t sizes[] = { 16, 256, 4096 };
+
+    for( size_t i = 0; i < sizeof( sizes ) / sizeof( sizes[ 0 ] ); i++ )
+    {
+        /* param = block size in bytes */
+        bench_run( "heap_malloc_free", sizes[ i ], BENCH_ITERATIONS, op_heap_malloc_free,
+                   ( void * ) ( uintptr_t ) sizes[ i ] );
+    }
+}
+
+/* =========================================================================
+ * Benchmark task
+ * ========================================================================= */
+static void bench_task( void * pvParameters )
+{
+    ( void ) pvParameters;
+
+    printf( "{\"suite\":\"dmosi_freertos_bench\",\"tick_rate_hz\":%lu,\"cores\":%lu,"
+            "\"iterations\":%lu,\"samples\":%lu}\n",
+            ( unsigned long ) configTICK_RATE_HZ,
+            ( unsigned long ) configNUMBER_OF_CORES,
+            ( unsigned long ) BENCH_ITERATIONS,
+            ( unsigned long ) BENCH_SAMPLES );
+
+    bench_mutex();
+    bench_semaphore();
+    bench_queue();
+    bench_timer();
+    bench_thread();
+    bench_heap();
+
+    fflush( stdout );
+
+    /* Stop the scheduler so that dmosi_init() in main() returns */
+    dmosi_deinit();
+    vTaskEndScheduler();
+    vTaskDelete( NULL );
+}
+
+/* =========================================================================
+ * main
+ * ========================================================================= */
+int main( void )
+{
+    xTaskCreate( bench_task,
+                 "bench",
+                 configMINIMAL_STACK_SIZE * BENCH_TASK_STACK_MULTIPLIER,
+                 NULL,
+                 BENCH_TASK_PRIORITY,
+                 NULL );
+
+    if( !dmosi_init() )
+    {
+        printf( "ERROR: dmosi_init() failed\n" );
+        return 1;
+    }
+
+    return 0;
+}
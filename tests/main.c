@@ -9,6 +9,7 @@
 #include "dmod.h"
 #include "dmod_sal.h"
 #include "dmosi.h"
+#include "dmosi_freertos.h"
 #include "FreeRTOS.h"
 #include "task.h"
 #include "semphr.h"
@@ -46,6 +47,16 @@ void vPortInitialiseBlocks( void )
 {
 }
 
+/* dmosi_heap_retag() lives in dmosi_heap.c as well; blocks from malloc()
+ * carry no accounting header, so only the DMOD tag is moved */
+void dmosi_heap_retag( void* ptr, const char* module_name )
+{
+    if( ptr != NULL && module_name != NULL )
+    {
+        Dmod_RetagEx( ptr, module_name );
+    }
+}
+
 /* =========================================================================
  * FreeRTOS application hooks
  * ========================================================================= */
@@ -87,10 +98,80 @@ static int tests_failed = 0;
 /* =========================================================================
  * Mutex tests
  * ========================================================================= */
+static volatile bool g_mutex_holder_locked = false;
+
+static void mutex_holder_entry( void * arg )
+{
+    dmosi_mutex_lock( ( dmosi_mutex_t ) arg );
+    g_mutex_holder_locked = true;
+    vTaskDelay( pdMS_TO_TICKS( 20 ) );
+    dmosi_mutex_unlock( ( dmosi_mutex_t ) arg );
+}
+
+/* Holds a ceiling mutex and a plain one while the test task contends for
+ * the plain one, and changes its own priority meanwhile */
+static dmosi_mutex_t g_boost_ceiling_mutex = NULL;
+static volatile UBaseType_t g_boost_prio_held = 0;
+static volatile UBaseType_t g_boost_prio_base = 0;
+static volatile UBaseType_t g_boost_prio_after = 0;
+
+static void mutex_boost_entry( void * arg )
+{
+    dmosi_mutex_lock( g_boost_ceiling_mutex );
+    dmosi_mutex_lock( ( dmosi_mutex_t ) arg );
+    g_mutex_holder_locked = true;
+    vTaskDelay( pdMS_TO_TICKS( 20 ) );
+    g_boost_prio_held = uxTaskPriorityGet( NULL );
+    dmosi_thread_set_priority( NULL, 0 );
+    g_boost_prio_base = uxTaskBasePriorityGet( NULL );
+    dmosi_mutex_unlock( ( dmosi_mutex_t ) arg );
+    dmosi_mutex_unlock( g_boost_ceiling_mutex );
+    g_boost_prio_after = uxTaskPriorityGet( NULL );
+}
+
+/* Holds a mutex while a contender already waits for it and a higher
+ * priority one queues behind that contender */
+static volatile UBaseType_t g_chain_prio_held = 0;
+
+static void mutex_chain_holder_entry( void * arg )
+{
+    dmosi_mutex_lock( ( dmosi_mutex_t ) arg );
+    g_mutex_holder_locked = true;
+    vTaskDelay( pdMS_TO_TICKS( 20 ) );
+    g_chain_prio_held = uxTaskPriorityGet( NULL );
+    dmosi_mutex_unlock( ( dmosi_mutex_t ) arg );
+}
+
+static void mutex_contender_entry( void * arg )
+{
+    dmosi_mutex_lock( ( dmosi_mutex_t ) arg );
+    dmosi_mutex_unlock( ( dmosi_mutex_t ) arg );
+}
+
+/* Locked and unlocked in main() before the scheduler starts, with a task
+ * created in between so the current task handle changes */
+static dmosi_mutex_t g_prestart_mutex = NULL;
+static int g_prestart_lock_result = -1;
+static int g_prestart_unlock_result = -1;
+
+static void prestart_task_entry( void * pvParameters )
+{
+    ( void ) pvParameters;
+    vTaskDelete( NULL );
+}
+
 static void test_mutex( void )
 {
     printf( "\n=== Testing mutex ===\n" );
 
+    /* Lock and unlock are no-ops before the scheduler starts */
+    TEST_ASSERT( g_prestart_lock_result == 0 && g_prestart_unlock_result == 0,
+                 "Lock and unlock before the scheduler starts return 0" );
+    TEST_ASSERT( dmosi_mutex_lock_timeout( g_prestart_mutex, 20 ) == 0 &&
+                 dmosi_mutex_unlock( g_prestart_mutex ) == 0,
+                 "Mutex used before the scheduler starts is free afterwards" );
+    dmosi_mutex_destroy( g_prestart_mutex );
+
     /* Non-recursive mutex: create, lock, unlock, destroy */
     dmosi_mutex_t m = dmosi_mutex_create( false );
     TEST_ASSERT( m != NULL, "Create non-recursive mutex" );
@@ -112,9 +193,154 @@ static void test_mutex( void )
 
     dmosi_mutex_destroy( rm );
 
+    /* Non-recursive self-deadlock and foreign unlock are rejected */
+    m = dmosi_mutex_create( false );
+    TEST_ASSERT( dmosi_mutex_unlock( m ) == -EPERM, "Unlock mutex not held returns -EPERM" );
+    dmosi_mutex_lock( m );
+    TEST_ASSERT( dmosi_mutex_lock( m ) == -EDEADLK,
+                 "Relock of held non-recursive mutex returns -EDEADLK" );
+    dmosi_mutex_unlock( m );
+
+    /* Contended lock blocks until the holder releases */
+    g_mutex_holder_locked = false;
+    dmosi_thread_t holder = dmosi_thread_create( mutex_holder_entry, m, 1, 4096, "mtx_hold", NULL );
+    while( !g_mutex_holder_locked )
+    {
+        vTaskDelay( 1 );
+    }
+    TEST_ASSERT( dmosi_mutex_trylock( m ) == -EAGAIN, "Trylock held mutex returns -EAGAIN" );
+    TEST_ASSERT( dmosi_mutex_lock_timeout( m, 20 ) == -ETIMEDOUT,
+                 "Lock with short timeout on held mutex returns -ETIMEDOUT" );
+    TEST_ASSERT( dmosi_mutex_lock( m ) == 0, "Lock contended mutex" );
+    TEST_ASSERT( dmosi_mutex_unlock( m ) == 0, "Unlock contended mutex" );
+    dmosi_thread_join( holder );
+    dmosi_thread_destroy( holder );
+
+    /* A bounded wait succeeds when the holder releases within the timeout */
+    g_mutex_holder_locked = false;
+    holder = dmosi_thread_create( mutex_holder_entry, m, 1, 4096, "mtx_hold", NULL );
+    while( !g_mutex_holder_locked )
+    {
+        vTaskDelay( 1 );
+    }
+    TEST_ASSERT( dmosi_mutex_lock_timeout( m, 1000 ) == 0,
+                 "Lock with timeout on held mutex succeeds once released" );
+    dmosi_mutex_unlock( m );
+    dmosi_thread_join( holder );
+    dmosi_thread_destroy( holder );
+
+    /* A contended fast-path owner inherits the waiter's priority without
+     * losing its own priority changes or its ceiling bookkeeping */
+    g_boost_ceiling_mutex = dmosi_mutex_create( false );
+    dmosi_mutex_set_ceiling( g_boost_ceiling_mutex, 2 );
+    g_mutex_holder_locked = false;
+    holder = dmosi_thread_create( mutex_boost_entry, m, 1, 4096, "mtx_boost", NULL );
+    while( !g_mutex_holder_locked )
+    {
+        vTaskDelay( 1 );
+    }
+    TEST_ASSERT( dmosi_mutex_lock( m ) == 0 && dmosi_mutex_unlock( m ) == 0,
+                 "Lock mutex held by a lower-priority thread" );
+    dmosi_thread_join( holder );
+    dmosi_thread_destroy( holder );
+    TEST_ASSERT( g_boost_prio_held == uxTaskPriorityGet( NULL ),
+                 "Contended owner inherits the waiter's priority" );
+    TEST_ASSERT( g_boost_prio_base == 0 && g_boost_prio_after == 0,
+                 "Priority set by a boosted owner survives unlocking" );
+    dmosi_mutex_destroy( g_boost_ceiling_mutex );
+
+    /* A contender queued behind another one still lends the owner its priority */
+    g_mutex_holder_locked = false;
+    holder = dmosi_thread_create( mutex_chain_holder_entry, m, 0, 4096, "mtx_chain", NULL );
+    while( !g_mutex_holder_locked )
+    {
+        vTaskDelay( 1 );
+    }
+    dmosi_thread_t contender = dmosi_thread_create( mutex_contender_entry, m, 1, 4096, "mtx_cont", NULL );
+    vTaskDelay( 2 );
+    TEST_ASSERT( dmosi_mutex_lock( m ) == 0 && dmosi_mutex_unlock( m ) == 0,
+                 "Lock mutex behind another contender" );
+    dmosi_thread_join( contender );
+    dmosi_thread_destroy( contender );
+    dmosi_thread_join( holder );
+    dmosi_thread_destroy( holder );
+    TEST_ASSERT( g_chain_prio_held == uxTaskPriorityGet( NULL ),
+                 "Owner inherits the priority of a contender queued behind another" );
+
+    dmosi_mutex_stats_t mstats;
+    TEST_ASSERT( dmosi_mutex_get_stats( m, &mstats ) == 0, "Get mutex stats returns 0" );
+    TEST_ASSERT( mstats.contended >= 1 && mstats.timeouts >= 2,
+                 "Mutex stats record contention and timeouts" );
+    TEST_ASSERT( mstats.wait_time_total_us >= mstats.wait_time_max_us,
+                 "Mutex total wait time covers the longest wait" );
+    TEST_ASSERT( dmosi_mutex_trylock( m ) == 0 && dmosi_mutex_unlock( m ) == 0,
+                 "Trylock free mutex succeeds" );
+    dmosi_mutex_destroy( m );
+
+    rm = dmosi_mutex_create( true );
+    TEST_ASSERT( dmosi_mutex_lock_timeout( rm, 0 ) == 0 && dmosi_mutex_trylock( rm ) == 0,
+                 "Timed lock and trylock relock a held recursive mutex" );
+    dmosi_mutex_unlock( rm );
+    dmosi_mutex_unlock( rm );
+    dmosi_mutex_destroy( rm );
+
+    /* Priority ceiling: owner runs at the ceiling while holding the mutex */
+    UBaseType_t base_prio = uxTaskPriorityGet( NULL );
+    m = dmosi_mutex_create( false );
+    TEST_ASSERT( dmosi_mutex_set_ceiling( m, ( int ) configMAX_PRIORITIES ) == -EINVAL,
+                 "Set out-of-range ceiling returns -EINVAL" );
+    if( base_prio + 1 < configMAX_PRIORITIES )
+    {
+        TEST_ASSERT( dmosi_mutex_set_ceiling( m, ( int ) base_prio + 1 ) == 0, "Set mutex ceiling returns 0" );
+        TEST_ASSERT( dmosi_mutex_lock( m ) == 0 && uxTaskPriorityGet( NULL ) == base_prio + 1,
+                     "Locking a ceiling mutex raises the owner to the ceiling" );
+        TEST_ASSERT( dmosi_mutex_set_ceiling( m, -1 ) == -EBUSY, "Set ceiling of a held mutex returns -EBUSY" );
+        dmosi_mutex_unlock( m );
+        TEST_ASSERT( uxTaskPriorityGet( NULL ) == base_prio, "Unlocking a ceiling mutex restores the priority" );
+    }
+    if( base_prio > 0 )
+    {
+        dmosi_mutex_set_ceiling( m, ( int ) base_prio - 1 );
+        TEST_ASSERT( dmosi_mutex_lock( m ) == -EINVAL, "Locking below the caller's priority returns -EINVAL" );
+        TEST_ASSERT( dmosi_mutex_trylock( m ) == -EINVAL && dmosi_mutex_lock_timeout( m, 20 ) == -EINVAL,
+                     "Trylock and timed lock below the caller's priority return -EINVAL" );
+        TEST_ASSERT( uxTaskPriorityGet( NULL ) == base_prio && dmosi_mutex_set_ceiling( m, -1 ) == 0,
+                     "Rejected lock leaves the priority and the mutex untouched" );
+    }
+
+    /* Nested ceilings are undone in reverse order of locking */
+    if( base_prio >= 1 && base_prio + 1 < configMAX_PRIORITIES )
+    {
+        dmosi_mutex_t outer = dmosi_mutex_create( false );
+        dmosi_mutex_t inner = dmosi_mutex_create( false );
+        dmosi_mutex_set_ceiling( outer, ( int ) base_prio );
+        dmosi_mutex_set_ceiling( inner, ( int ) base_prio + 1 );
+        dmosi_thread_set_priority( NULL, ( int ) base_prio - 1 );
+        dmosi_mutex_lock( outer );
+        UBaseType_t outer_prio = uxTaskPriorityGet( NULL );
+        dmosi_mutex_lock( inner );
+        UBaseType_t inner_prio = uxTaskPriorityGet( NULL );
+        dmosi_mutex_unlock( inner );
+        UBaseType_t unlocked_inner_prio = uxTaskPriorityGet( NULL );
+        dmosi_mutex_unlock( outer );
+        TEST_ASSERT( outer_prio == base_prio && inner_prio == base_prio + 1,
+                     "Nested ceiling mutexes raise the owner to each ceiling" );
+        TEST_ASSERT( unlocked_inner_prio == base_prio && uxTaskPriorityGet( NULL ) == base_prio - 1,
+                     "Unlocking nested ceiling mutexes restores each previous priority" );
+        dmosi_thread_set_priority( NULL, ( int ) base_prio );
+        dmosi_mutex_destroy( inner );
+        dmosi_mutex_destroy( outer );
+    }
+    TEST_ASSERT( dmosi_mutex_set_ceiling( m, -1 ) == 0 && dmosi_mutex_lock( m ) == 0 && dmosi_mutex_unlock( m ) == 0,
+                 "Cleared ceiling allows locking again" );
+    dmosi_mutex_destroy( m );
+
     /* NULL input handling */
     TEST_ASSERT( dmosi_mutex_lock( NULL ) == -EINVAL, "Lock NULL mutex returns -EINVAL" );
     TEST_ASSERT( dmosi_mutex_unlock( NULL ) == -EINVAL, "Unlock NULL mutex returns -EINVAL" );
+    TEST_ASSERT( dmosi_mutex_trylock( NULL ) == -EINVAL, "Trylock NULL mutex returns -EINVAL" );
+    TEST_ASSERT( dmosi_mutex_get_stats( NULL, NULL ) == -EINVAL, "Get stats of NULL mutex returns -EINVAL" );
+    TEST_ASSERT( dmosi_mutex_set_ceiling( NULL, 0 ) == -EINVAL, "Set ceiling of NULL mutex returns -EINVAL" );
     dmosi_mutex_destroy( NULL );
     TEST_ASSERT( true, "Destroy NULL mutex does not crash" );
 }
@@ -122,6 +348,40 @@ static void test_mutex( void )
 /* =========================================================================
  * Semaphore tests
  * ========================================================================= */
+static void semaphore_trickle_entry( void * arg )
+{
+    /* Post one unit at a time so a multi-unit waiter needs several posts */
+    for( int i = 0; i < 3; i++ )
+    {
+        vTaskDelay( pdMS_TO_TICKS( 10 ) );
+        dmosi_semaphore_post( ( dmosi_semaphore_t ) arg, 1 );
+    }
+}
+
+/* Waits on a semaphore and records the order in which waiters were served */
+struct semaphore_waiter_arg
+{
+    dmosi_semaphore_t semaphore;
+    uint32_t units;
+    int32_t timeout_ms;
+    char tag;
+    volatile int result;    /* 1 while still waiting */
+};
+
+static char g_semaphore_order[ 4 ];
+static volatile int g_semaphore_order_len = 0;
+
+static void semaphore_waiter_entry( void * arg )
+{
+    struct semaphore_waiter_arg * waiter = ( struct semaphore_waiter_arg * ) arg;
+    int result = dmosi_semaphore_wait( waiter->semaphore, waiter->units, waiter->timeout_ms );
+    if( result == 0 )
+    {
+        g_semaphore_order[ g_semaphore_order_len++ ] = waiter->tag;
+    }
+    waiter->result = result;
+}
+
 static void test_semaphore( void )
 {
     printf( "\n=== Testing semaphore ===\n" );
@@ -155,6 +415,88 @@ static void test_semaphore( void )
 
     dmosi_semaphore_destroy( s );
 
+    /* Multi-unit wait/post is all-or-nothing */
+    s = dmosi_semaphore_create( 2, 8 );
+    TEST_ASSERT( s != NULL, "Create counting semaphore (initial=2, max=8)" );
+    TEST_ASSERT( dmosi_semaphore_wait( s, 3, 0 ) == -EAGAIN,
+                 "Wait for 3 units with only 2 available returns -EAGAIN" );
+    TEST_ASSERT( dmosi_semaphore_wait( s, 2, 0 ) == 0,
+                 "Failed multi-unit wait does not take partial units" );
+    TEST_ASSERT( dmosi_semaphore_post( s, 9 ) == -EOVERFLOW,
+                 "Post of 9 units beyond max_count returns -EOVERFLOW" );
+    TEST_ASSERT( dmosi_semaphore_wait( s, 1, 0 ) == -EAGAIN,
+                 "Overflowing post does not release partial units" );
+    TEST_ASSERT( dmosi_semaphore_post( s, 8 ) == 0, "Post 8 units at once" );
+    TEST_ASSERT( dmosi_semaphore_wait( s, 8, 0 ) == 0, "Wait for 8 units at once" );
+    TEST_ASSERT( dmosi_semaphore_wait( s, 9, 0 ) == -EINVAL,
+                 "Wait for more units than max_count returns -EINVAL" );
+
+    /* A blocking multi-unit wait collects units from several posts */
+    dmosi_thread_t trickle = dmosi_thread_create(
+        semaphore_trickle_entry, s, 1, 4096, "sem_trickle", NULL );
+    TEST_ASSERT( trickle != NULL, "Create semaphore trickle thread" );
+    TEST_ASSERT( dmosi_semaphore_wait( s, 3, 1000 ) == 0,
+                 "Wait for 3 units is satisfied by 3 single-unit posts" );
+    dmosi_thread_join( trickle );
+    dmosi_thread_destroy( trickle );
+
+    /* The timeout is a single deadline for the whole request */
+    TEST_ASSERT( dmosi_semaphore_post( s, 1 ) == 0, "Post 1 unit before timed wait" );
+    TEST_ASSERT( dmosi_semaphore_wait( s, 2, 20 ) == -ETIMEDOUT,
+                 "Wait for 2 units with only 1 posted times out" );
+    TEST_ASSERT( dmosi_semaphore_wait( s, 1, 0 ) == 0,
+                 "Timed-out multi-unit wait leaves available units in place" );
+
+    dmosi_semaphore_destroy( s );
+
+    /* Waiters are served by priority, in arrival order among equal priorities */
+    s = dmosi_semaphore_create( 0, 8 );
+    struct semaphore_waiter_arg wa = { s, 1, -1, 'a', 1 };
+    struct semaphore_waiter_arg wb = { s, 1, -1, 'b', 1 };
+    struct semaphore_waiter_arg wc = { s, 1, -1, 'c', 1 };
+    g_semaphore_order_len = 0;
+    dmosi_thread_t ta = dmosi_thread_create( semaphore_waiter_entry, &wa, 1, 4096, "sem_a", NULL );
+    vTaskDelay( 2 );
+    dmosi_thread_t tb = dmosi_thread_create( semaphore_waiter_entry, &wb, 1, 4096, "sem_b", NULL );
+    vTaskDelay( 2 );
+    dmosi_thread_t tc = dmosi_thread_create( semaphore_waiter_entry, &wc, 2, 4096, "sem_c", NULL );
+    vTaskDelay( 2 );
+    for( int i = 0; i < 3; i++ )
+    {
+        dmosi_semaphore_post( s, 1 );
+        vTaskDelay( 2 );
+    }
+    TEST_ASSERT( g_semaphore_order_len == 3 && memcmp( g_semaphore_order, "cab", 3 ) == 0,
+                 "Semaphore waiters are woken by priority, then in arrival order" );
+    dmosi_thread_join( ta );
+    dmosi_thread_join( tb );
+    dmosi_thread_join( tc );
+    dmosi_thread_destroy( ta );
+    dmosi_thread_destroy( tb );
+    dmosi_thread_destroy( tc );
+
+    /* A larger request at the head holds back smaller ones until it times out */
+    struct semaphore_waiter_arg wbig = { s, 3, 50, 'B', 1 };
+    struct semaphore_waiter_arg wsmall = { s, 1, -1, 's', 1 };
+    g_semaphore_order_len = 0;
+    dmosi_thread_t tbig = dmosi_thread_create( semaphore_waiter_entry, &wbig, 2, 4096, "sem_big", NULL );
+    vTaskDelay( 2 );
+    dmosi_thread_t tsmall = dmosi_thread_create( semaphore_waiter_entry, &wsmall, 1, 4096, "sem_small", NULL );
+    vTaskDelay( 2 );
+    dmosi_semaphore_post( s, 1 );
+    vTaskDelay( 2 );
+    TEST_ASSERT( wsmall.result == 1, "Smaller request queued behind a larger one keeps waiting" );
+    dmosi_thread_join( tbig );
+    TEST_ASSERT( wbig.result == -ETIMEDOUT, "Queued multi-unit waiter times out" );
+    dmosi_thread_join( tsmall );
+    TEST_ASSERT( wsmall.result == 0, "Timed-out waiter passes the units it held back on" );
+    TEST_ASSERT( dmosi_semaphore_wait( s, 1, 0 ) == -EAGAIN,
+                 "Units passed on are taken exactly once" );
+    dmosi_thread_destroy( tbig );
+    dmosi_thread_destroy( tsmall );
+
+    dmosi_semaphore_destroy( s );
+
     /* Invalid parameters */
     TEST_ASSERT( dmosi_semaphore_create( 0, 0 ) == NULL,
                  "Create semaphore with max_count=0 returns NULL" );
@@ -213,6 +555,25 @@ static void test_queue( void )
     TEST_ASSERT( dmosi_queue_receive( q, NULL, 0 ) == -EINVAL,
                  "Receive into NULL buffer returns -EINVAL" );
 
+    /* Batch send/receive */
+    int batch_in[ 8 ] = { 1, 2, 3, 4, 5, 6, 7, 8 };
+    int batch_out[ 8 ] = { 0 };
+    size_t moved = 0;
+    TEST_ASSERT( dmosi_queue_send_batch( q, batch_in, 8, 0, &moved, 0 ) == 0 && moved == 5,
+                 "Batch send fills the queue and reports 5 items sent" );
+    TEST_ASSERT( dmosi_queue_send_batch( q, batch_in, 8, 1, &moved, 0 ) == -EAGAIN && moved == 0,
+                 "Batch send to full queue with min_count=1 returns -EAGAIN" );
+    TEST_ASSERT( dmosi_queue_receive_batch( q, batch_out, 8, 3, &moved, 100 ) == 0 && moved == 5,
+                 "Batch receive drains all 5 items" );
+    TEST_ASSERT( batch_out[ 0 ] == 1 && batch_out[ 4 ] == 5,
+                 "Batch receive preserves item order" );
+    TEST_ASSERT( dmosi_queue_receive_batch( q, batch_out, 8, 1, &moved, 20 ) == -ETIMEDOUT && moved == 0,
+                 "Batch receive from empty queue with timeout returns -ETIMEDOUT" );
+    TEST_ASSERT( dmosi_queue_send_batch( q, batch_in, 2, 3, &moved, 0 ) == -EINVAL,
+                 "Batch send with min_count > count returns -EINVAL" );
+    TEST_ASSERT( dmosi_queue_receive_batch( NULL, batch_out, 8, 1, &moved, 0 ) == -EINVAL,
+                 "Batch receive from NULL queue returns -EINVAL" );
+
     dmosi_queue_destroy( q );
 
     /* Invalid parameters */
@@ -318,6 +679,13 @@ static void simple_thread_entry( void * arg )
     /* Thread exits here; thread_wrapper handles cleanup */
 }
 
+static void self_destroy_thread_entry( void * arg )
+{
+    ( void ) arg;
+    dmosi_thread_destroy( dmosi_thread_current() );
+    g_thread_ran = true;
+}
+
 static void slow_thread_entry( void * arg )
 {
     ( void ) arg;
@@ -325,6 +693,17 @@ static void slow_thread_entry( void * arg )
     vTaskDelay( portMAX_DELAY );
 }
 
+/* Plain FreeRTOS task adopted by dmosi_thread_current(), deleted with
+ * vTaskDelete() by the test */
+static volatile bool g_adopted_ready = false;
+
+static void adopted_task_entry( void * pvParameters )
+{
+    ( void ) pvParameters;
+    g_adopted_ready = ( dmosi_thread_current() != NULL );
+    vTaskDelay( portMAX_DELAY );
+}
+
 static volatile int g_exit_callback_count = 0;
 static volatile dmosi_thread_t g_exit_callback_thread = NULL;
 static volatile void * g_exit_callback_arg = NULL;
@@ -357,6 +736,20 @@ static void test_thread( void )
     int prio = dmosi_thread_get_priority( current );
     TEST_ASSERT( prio >= 0, "Get current thread priority >= 0" );
 
+    /* Runtime priority change */
+    if( prio + 1 < ( int ) configMAX_PRIORITIES )
+    {
+        TEST_ASSERT( dmosi_thread_set_priority( NULL, prio + 1 ) == 0 &&
+                     dmosi_thread_get_priority( current ) == prio + 1,
+                     "Set current thread priority takes effect" );
+        TEST_ASSERT( dmosi_thread_set_priority( current, prio ) == 0 &&
+                     dmosi_thread_get_priority( current ) == prio,
+                     "Restore current thread priority" );
+    }
+    TEST_ASSERT( dmosi_thread_set_priority( current, -1 ) == -EINVAL &&
+                 dmosi_thread_set_priority( current, ( int ) configMAX_PRIORITIES ) == -EINVAL,
+                 "Set out-of-range priority returns -EINVAL" );
+
     /* Thread's process */
     dmosi_process_t proc = dmosi_thread_get_process( current );
     TEST_ASSERT( proc != NULL, "Get current thread's process returns non-NULL" );
@@ -459,6 +852,96 @@ static void test_thread( void )
     size_t proc_count = dmosi_thread_get_by_process( proc, NULL, 0 );
     TEST_ASSERT( proc_count >= 1, "thread_get_by_process count >= 1" );
 
+    /* Stack cache: reuse, exact-size keying, reaping and trim */
+    dmosi_thread_cache_stats_t cs_before, cs_after;
+    TEST_ASSERT( dmosi_thread_cache_get_stats( NULL ) == -EINVAL,
+                 "Get stack cache stats with NULL returns -EINVAL" );
+    if( dmosi_thread_cache_get_stats( &cs_before ) == -ENOTSUP )
+    {
+        TEST_ASSERT( dmosi_thread_cache_trim() == 0,
+                     "Stack cache is disabled in this build (DMOSI_THREAD_CACHE_SIZE=0)" );
+    }
+    else
+    {
+        dmosi_thread_cache_trim();
+
+        /* A destroyed thread's block serves the next thread of the same size */
+        t = dmosi_thread_create( simple_thread_entry, NULL, 1, 4096, "cache_t", NULL );
+        dmosi_thread_join( t );
+        dmosi_thread_destroy( t );
+        dmosi_thread_cache_get_stats( &cs_before );
+        t = dmosi_thread_create( simple_thread_entry, NULL, 1, 4096, "cache_t", NULL );
+        dmosi_thread_join( t );
+        dmosi_thread_destroy( t );
+        dmosi_thread_cache_get_stats( &cs_after );
+        TEST_ASSERT( cs_after.hits == cs_before.hits + 1 && cs_after.cached_blocks == 1,
+                     "Thread create is served from the stack cache" );
+
+        /* Blocks are keyed on the exact stack size */
+        t = dmosi_thread_create( simple_thread_entry, NULL, 1, 4096 + 256, "cache_t", NULL );
+        dmosi_thread_join( t );
+        dmosi_thread_cache_get_stats( &cs_before );
+        TEST_ASSERT( cs_before.misses == cs_after.misses + 1 && cs_before.cached_blocks == 1,
+                     "Thread with another stack size does not take a cached block" );
+
+        /* A finished thread that was not destroyed yet is reclaimed by trim,
+         * so destroying it afterwards returns nothing to the cache */
+        TEST_ASSERT( dmosi_thread_cache_trim() > 0, "Trim frees cached stacks" );
+        dmosi_thread_destroy( t );
+        dmosi_thread_cache_get_stats( &cs_after );
+        TEST_ASSERT( cs_after.cached_blocks == 0 && cs_after.cached_bytes == 0,
+                     "Trim reclaims the stack of a finished, undestroyed thread" );
+
+        /* A thread destroying itself parks and is reclaimed later */
+        g_thread_ran = false;
+        dmosi_thread_create( self_destroy_thread_entry, NULL, 1, 4096, "cache_sd", NULL );
+        while( !g_thread_ran )
+        {
+            vTaskDelay( 1 );
+        }
+        vTaskDelay( 2 );
+        dmosi_thread_cache_get_stats( &cs_before );
+        t = dmosi_thread_create( simple_thread_entry, NULL, 1, 4096, "cache_t", NULL );
+        dmosi_thread_join( t );
+        dmosi_thread_destroy( t );
+        dmosi_thread_cache_get_stats( &cs_after );
+        TEST_ASSERT( cs_after.hits == cs_before.hits + 1,
+                     "Stack of a self-destroyed thread is reused" );
+        dmosi_thread_cache_trim();
+    }
+
+    /* The registry tracks thread creation and completion */
+    dmosi_thread_t listed[ 2 ];
+    TEST_ASSERT( dmosi_thread_get_all( listed, 1 ) == 1, "thread_get_all caps at max_count" );
+    dmosi_thread_t reg = dmosi_thread_create( simple_thread_entry, NULL, 1, 4096, "reg", proc );
+    TEST_ASSERT( dmosi_thread_get_all( NULL, 0 ) == count + 1, "Created thread is enumerated" );
+    TEST_ASSERT( dmosi_thread_get_by_process( proc, NULL, 0 ) == proc_count + 1,
+                 "Created thread is enumerated for its process" );
+    dmosi_thread_join( reg );
+    TEST_ASSERT( dmosi_thread_get_all( NULL, 0 ) == count, "Completed thread is no longer enumerated" );
+    dmosi_thread_destroy( reg );
+
+    /* A thread above its creator's priority finishes before the create call
+     * returns and must not be left registered */
+    g_thread_ran = false;
+    dmosi_thread_t quick = dmosi_thread_create( simple_thread_entry, NULL, configMAX_PRIORITIES - 1, 4096, "quick", proc );
+    TEST_ASSERT( quick != NULL && g_thread_ran, "Higher-priority thread runs during creation" );
+    TEST_ASSERT( dmosi_thread_get_all( NULL, 0 ) == count &&
+                 dmosi_thread_get_by_process( proc, NULL, 0 ) == proc_count,
+                 "Thread finished during creation is not enumerated" );
+    dmosi_thread_join( quick );
+    dmosi_thread_destroy( quick );
+
+    /* A foreign task deleted behind dmosi's back is pruned from the registry */
+    TaskHandle_t adopted = NULL;
+    xTaskCreate( adopted_task_entry, "adopted", configMINIMAL_STACK_SIZE * 4, NULL,
+                 configMAX_PRIORITIES - 1, &adopted );
+    TEST_ASSERT( g_adopted_ready && dmosi_thread_get_all( NULL, 0 ) == count + 1,
+                 "Adopted task is enumerated" );
+    vTaskDelete( adopted );
+    TEST_ASSERT( dmosi_thread_get_all( NULL, 0 ) == count,
+                 "Adopted task deleted outside dmosi is no longer enumerated" );
+
     /* Thread info for the current thread */
     dmosi_thread_info_t info;
     int info_ret = dmosi_thread_get_info( current, &info );
@@ -475,6 +958,26 @@ static void test_thread( void )
     TEST_ASSERT( info_null.state == DMOSI_THREAD_STATE_RUNNING,
                  "thread_get_info with NULL: state is RUNNING" );
 
+    /* Core affinity and per-core load */
+    uint32_t cores = dmosi_core_count();
+    uint32_t mask = 0;
+    TEST_ASSERT( cores >= 1, "At least one core" );
+    TEST_ASSERT( dmosi_thread_set_affinity( current, 1u ) == 0, "Pin current thread to core 0" );
+    TEST_ASSERT( dmosi_thread_get_affinity( NULL, &mask ) == 0 && mask == 1u,
+                 "Affinity of current thread is core 0" );
+    TEST_ASSERT( dmosi_thread_set_affinity( current, ( uint32_t ) ( ( 1ull << cores ) - 1u ) ) == 0,
+                 "Allow current thread on all cores" );
+    TEST_ASSERT( dmosi_thread_set_affinity( current, 0 ) == -EINVAL,
+                 "Empty affinity mask returns -EINVAL" );
+    TEST_ASSERT( dmosi_thread_get_affinity( current, NULL ) == -EINVAL,
+                 "Get affinity with NULL mask returns -EINVAL" );
+    float core_usage = -1.0f;
+    TEST_ASSERT( dmosi_core_get_usage( 0, &core_usage ) == 0 &&
+                 core_usage >= 0.0f && core_usage <= 100.0f,
+                 "Core 0 usage in [0, 100]" );
+    TEST_ASSERT( dmosi_core_get_usage( cores, &core_usage ) == -EINVAL,
+                 "Usage of a non-existent core returns -EINVAL" );
+
     /* Thread info with NULL info pointer must return -EINVAL */
     TEST_ASSERT( dmosi_thread_get_info( current, NULL ) == -EINVAL,
                  "thread_get_info with NULL info returns -EINVAL" );
@@ -511,6 +1014,1191 @@ static void test_thread( void )
                  "Dmod_GetLeftStackSize returns a value below 1 GiB" );
 }
 
+/* =========================================================================
+ * Stack advisor tests
+ * ========================================================================= */
+static void test_stack_advisor( void )
+{
+    printf( "\n=== Testing stack advisor ===\n" );
+
+    dmosi_thread_info_t info;
+    TEST_ASSERT( dmosi_thread_get_info( NULL, &info ) == 0, "thread_get_info returns 0 for current thread" );
+    TEST_ASSERT( info.stack_total > 0, "thread_get_info: stack_total known for the current thread" );
+    TEST_ASSERT( info.stack_current <= info.stack_peak && info.stack_peak <= info.stack_total,
+                 "thread_get_info: current <= peak <= total" );
+
+    dmosi_process_t proc = dmosi_process_current();
+    dmosi_thread_t slow = dmosi_thread_create( slow_thread_entry, NULL, 1, 4096, "advised", proc );
+    TEST_ASSERT( slow != NULL, "Create thread to advise on" );
+    dmosi_thread_sleep( 10 );
+
+    dmosi_stack_advice_t entries[ 16 ];
+    size_t count = dmosi_thread_stack_advise( proc, entries, 16 );
+    TEST_ASSERT( count >= 2 && count <= 16, "Stack advisor reports the threads of the process" );
+
+    const dmosi_stack_advice_t * advice = NULL;
+    for( size_t i = 0; i < count; i++ )
+    {
+        if( entries[ i ].thread == slow )
+        {
+            advice = &entries[ i ];
+        }
+    }
+    TEST_ASSERT( advice != NULL, "Stack advisor reports the created thread" );
+    if( advice != NULL )
+    {
+        TEST_ASSERT( advice->process == proc, "Advice names the process of the thread" );
+        TEST_ASSERT( advice->stack_size >= 4096, "Advice reports the stack size of the thread" );
+        TEST_ASSERT( advice->stack_current <= advice->stack_peak && advice->stack_peak <= advice->stack_size,
+                     "Advice: current <= peak <= stack size" );
+        TEST_ASSERT( advice->recommended_size > advice->stack_peak &&
+                     ( advice->recommended_size % portBYTE_ALIGNMENT ) == 0,
+                     "Recommended size covers the peak and is aligned" );
+    }
+
+    TEST_ASSERT( dmosi_thread_stack_advise( proc, entries, 1 ) == 1, "Stack advisor caps at max_entries" );
+    TEST_ASSERT( dmosi_thread_stack_advise( NULL, NULL, 16 ) == 0, "Stack advisor without entries returns 0" );
+    TEST_ASSERT( dmosi_thread_stack_advise( NULL, entries, 16 ) >= count, "Stack advisor reports threads of all processes" );
+
+    dmosi_thread_kill( slow, 0 );
+    dmosi_thread_destroy( slow );
+}
+
+/* =========================================================================
+ * Object pool tests
+ * ========================================================================= */
+static void test_pool( void )
+{
+    printf( "\n=== Testing object pools ===\n" );
+
+    dmosi_pool_stats_t before;
+    dmosi_pool_stats_t after;
+
+    TEST_ASSERT( dmosi_pool_get_stats( DMOSI_POOL_MUTEX, &before ) == 0,
+                 "Get mutex pool stats returns 0" );
+
+    /* A single mutex is served from the pool and returned to it on destroy */
+    dmosi_mutex_t m = dmosi_mutex_create( false );
+    TEST_ASSERT( m != NULL, "Create mutex for pool test" );
+    dmosi_pool_get_stats( DMOSI_POOL_MUTEX, &after );
+    if( before.capacity > before.in_use )
+    {
+        TEST_ASSERT( after.hits == before.hits + 1 && after.in_use == before.in_use + 1,
+                     "Mutex wrapper is served from the pool" );
+    }
+    else
+    {
+        TEST_ASSERT( after.misses == before.misses + 1,
+                     "Mutex wrapper falls back to the heap when the pool is full" );
+    }
+    dmosi_mutex_destroy( m );
+    dmosi_pool_get_stats( DMOSI_POOL_MUTEX, &after );
+    TEST_ASSERT( after.in_use == before.in_use,
+                 "Destroyed mutex wrapper is returned to the pool" );
+
+    /* Exhausting the pool falls back to the heap and records misses */
+    size_t n = before.capacity + 2;
+    dmosi_queue_t queues[ 64 ];
+    if( n > sizeof( queues ) / sizeof( queues[ 0 ] ) )
+    {
+        n = sizeof( queues ) / sizeof( queues[ 0 ] );
+    }
+    dmosi_pool_get_stats( DMOSI_POOL_QUEUE, &before );
+    bool all_created = true;
+    for( size_t i = 0; i < n; i++ )
+    {
+        queues[ i ] = dmosi_queue_create( sizeof( int ), 1 );
+        all_created = all_created && ( queues[ i ] != NULL );
+    }
+    TEST_ASSERT( all_created, "Create more queues than the pool capacity" );
+    dmosi_pool_get_stats( DMOSI_POOL_QUEUE, &after );
+    TEST_ASSERT( after.misses > before.misses,
+                 "Queue pool records misses once exhausted" );
+    TEST_ASSERT( after.in_use <= after.capacity,
+                 "Queue pool in_use never exceeds its capacity" );
+    for( size_t i = 0; i < n; i++ )
+    {
+        dmosi_queue_destroy( queues[ i ] );
+    }
+    dmosi_pool_get_stats( DMOSI_POOL_QUEUE, &after );
+    TEST_ASSERT( after.in_use == before.in_use,
+                 "All pooled queue wrappers are returned on destroy" );
+
+    /* Invalid parameters */
+    TEST_ASSERT( dmosi_pool_get_stats( DMOSI_POOL_TYPE_COUNT, &before ) == -EINVAL,
+                 "Get stats of an invalid pool type returns -EINVAL" );
+    TEST_ASSERT( dmosi_pool_get_stats( DMOSI_POOL_TIMER, NULL ) == -EINVAL,
+                 "Get pool stats into NULL returns -EINVAL" );
+}
+
+/* =========================================================================
+ * Heap statistics tests
+ *
+ * The malloc()-based pvPortMalloc() above does not account anything, so the
+ * accounted allocation path it wraps in dmosi_heap.c is driven directly.
+ * ========================================================================= */
+extern uint32_t dmosi_heap_stats_slot( const char* module_name );
+extern void* dmosi_heap_stats_malloc( size_t size, const char* module_name, uint32_t slot );
+extern void dmosi_heap_stats_release( void* ptr );
+extern void dmosi_heap_stats_retag( void* ptr, const char* module_name );
+extern size_t dmosi_heap_stats_free_size( size_t heap_size, bool minimum );
+
+static void test_heap_stats( void )
+{
+    printf( "\n=== Testing heap statistics ===\n" );
+
+    dmosi_heap_stats_t stats;
+    dmosi_heap_stats_t totals_before;
+    dmosi_heap_stats_t totals_after;
+
+    TEST_ASSERT( dmosi_heap_get_stats( "heap_test", &stats ) == -ENOENT,
+                 "Stats of a module that never allocated return -ENOENT" );
+    TEST_ASSERT( dmosi_heap_get_stats( NULL, &totals_before ) == 0, "Get heap totals" );
+
+    uint32_t slot = dmosi_heap_stats_slot( "heap_test" );
+    TEST_ASSERT( slot == dmosi_heap_stats_slot( "heap_test" ), "Module keeps its slot" );
+
+    const size_t heap_size = 1024 * 1024;
+    size_t free_before = dmosi_heap_stats_free_size( heap_size, false );
+
+    uint8_t* a = dmosi_heap_stats_malloc( 100, "heap_test", slot );
+    uint8_t* b = dmosi_heap_stats_malloc( 50, "heap_test", slot );
+    TEST_ASSERT( a != NULL && b != NULL &&
+                 ( ( uintptr_t ) a % portBYTE_ALIGNMENT ) == 0 && ( ( uintptr_t ) b % portBYTE_ALIGNMENT ) == 0,
+                 "Accounted blocks are aligned to portBYTE_ALIGNMENT" );
+    memset( a, 0xA5, 100 );
+    memset( b, 0x5A, 50 );
+    TEST_ASSERT( dmosi_heap_get_stats( "heap_test", &stats ) == 0 &&
+                 stats.bytes_in_use == 150 && stats.peak_bytes == 150 && stats.allocations == 2,
+                 "Allocations are accounted to their module" );
+    TEST_ASSERT( dmosi_heap_stats_free_size( heap_size, false ) < free_before - 150,
+                 "Free heap size drops by the blocks and their headers" );
+    TEST_ASSERT( dmosi_heap_stats_free_size( 0, false ) == 0, "Free heap size is 0 without a heap size" );
+
+    dmosi_heap_stats_release( a );
+    TEST_ASSERT( dmosi_heap_stats_malloc( SIZE_MAX, "heap_test", slot ) == NULL,
+                 "Oversized allocation fails" );
+    dmosi_heap_get_stats( "heap_test", &stats );
+    TEST_ASSERT( stats.bytes_in_use == 50 && stats.peak_bytes == 150 && stats.failures == 1,
+                 "Free keeps the peak, failures are counted" );
+    TEST_ASSERT( dmosi_heap_stats_free_size( heap_size, true ) < dmosi_heap_stats_free_size( heap_size, false ),
+                 "Minimum ever free heap size keeps the low watermark" );
+
+    dmosi_heap_get_stats( NULL, &totals_after );
+    TEST_ASSERT( totals_after.bytes_in_use == totals_before.bytes_in_use + 50 &&
+                 totals_after.allocations == totals_before.allocations + 2,
+                 "Totals include the module" );
+
+    dmosi_heap_module_stats_t entries[ 20 ];
+    size_t count = dmosi_heap_get_module_stats( entries, 20 );
+    bool listed = false;
+    for( size_t i = 0; i < count; i++ )
+    {
+        listed = listed || ( strcmp( entries[ i ].module_name, "heap_test" ) == 0 &&
+                             entries[ i ].stats.bytes_in_use == 50 );
+    }
+    TEST_ASSERT( listed, "Module is listed in the per-module stats" );
+
+    /* Retagging moves the live block to the new module */
+    dmosi_heap_stats_retag( b, "heap_test2" );
+    dmosi_heap_get_stats( "heap_test", &stats );
+    TEST_ASSERT( stats.bytes_in_use == 0 && dmosi_heap_get_stats( "heap_test2", &stats ) == 0 &&
+                 stats.bytes_in_use == 50 && b[ 49 ] == 0x5A,
+                 "Retag moves the block's accounting" );
+    dmosi_heap_stats_release( b );
+    dmosi_heap_get_stats( "heap_test2", &stats );
+    TEST_ASSERT( stats.bytes_in_use == 0, "Release of a retagged block is accounted to the new module" );
+    dmosi_heap_stats_release( NULL );
+
+    TEST_ASSERT( dmosi_heap_get_stats( NULL, NULL ) == -EINVAL,
+                 "Get heap stats into NULL returns -EINVAL" );
+    TEST_ASSERT( dmosi_heap_get_module_stats( NULL, 4 ) == 0,
+                 "Get module stats into NULL returns 0" );
+}
+
+/* =========================================================================
+ * Static allocation tests
+ * ========================================================================= */
+static void test_static_alloc( void )
+{
+    printf( "\n=== Testing static allocation ===\n" );
+
+    /* Mutex */
+    static dmosi_mutex_storage_t mutex_storage;
+    dmosi_mutex_t m = dmosi_mutex_create_static( &mutex_storage, true );
+    TEST_ASSERT( m != NULL, "Create static recursive mutex" );
+    TEST_ASSERT( dmosi_mutex_lock( m ) == 0 && dmosi_mutex_lock( m ) == 0,
+                 "Lock static recursive mutex twice" );
+    TEST_ASSERT( dmosi_mutex_unlock( m ) == 0 && dmosi_mutex_unlock( m ) == 0,
+                 "Unlock static recursive mutex twice" );
+    dmosi_mutex_destroy( m );
+    TEST_ASSERT( dmosi_mutex_create_static( NULL, false ) == NULL,
+                 "Create static mutex with NULL storage returns NULL" );
+
+    /* Semaphore */
+    static dmosi_semaphore_storage_t sem_storage;
+    dmosi_semaphore_t s = dmosi_semaphore_create_static( &sem_storage, 1, 2 );
+    TEST_ASSERT( s != NULL, "Create static semaphore" );
+    TEST_ASSERT( dmosi_semaphore_wait( s, 1, 0 ) == 0, "Wait on static semaphore" );
+    TEST_ASSERT( dmosi_semaphore_wait( s, 1, 0 ) == -EAGAIN,
+                 "Wait on empty static semaphore returns -EAGAIN" );
+    dmosi_semaphore_destroy( s );
+    TEST_ASSERT( dmosi_semaphore_create_static( &sem_storage, 3, 2 ) == NULL,
+                 "Create static semaphore with initial > max returns NULL" );
+
+    /* Queue */
+    static dmosi_queue_storage_t queue_storage;
+    static int queue_buffer[ 4 ];
+    dmosi_queue_t q = dmosi_queue_create_static( &queue_storage, sizeof( int ), 4, queue_buffer );
+    TEST_ASSERT( q != NULL, "Create static queue" );
+    int item = 7;
+    int received = 0;
+    TEST_ASSERT( dmosi_queue_send( q, &item, 0 ) == 0, "Send to static queue" );
+    TEST_ASSERT( dmosi_queue_receive( q, &received, 0 ) == 0 && received == 7,
+                 "Receive from static queue" );
+    dmosi_queue_destroy( q );
+    TEST_ASSERT( dmosi_queue_create_static( &queue_storage, sizeof( int ), 4, NULL ) == NULL,
+                 "Create static queue with NULL buffer returns NULL" );
+
+    /* Timer: the storage may be reused as soon as destroy returns */
+    static dmosi_timer_storage_t timer_storage;
+    g_timer_callback_count = 0;
+    dmosi_timer_t t = dmosi_timer_create_static( &timer_storage, timer_callback, NULL, 20, true );
+    TEST_ASSERT( t != NULL, "Create static timer" );
+    TEST_ASSERT( dmosi_timer_start( t ) == 0, "Start static timer" );
+    vTaskDelay( pdMS_TO_TICKS( 70 ) );
+    TEST_ASSERT( g_timer_callback_count >= 2, "Static timer callback fired" );
+    dmosi_timer_destroy( t );
+    t = dmosi_timer_create_static( &timer_storage, timer_callback, NULL, 20, false );
+    TEST_ASSERT( t != NULL, "Re-create static timer in the same storage" );
+    dmosi_timer_destroy( t );
+
+    /* Thread */
+    static dmosi_thread_storage_t thread_storage;
+    static StackType_t thread_stack[ 1024 ];
+    g_thread_ran = false;
+    dmosi_thread_t th = dmosi_thread_create_static( &thread_storage, simple_thread_entry, NULL, 1,
+                                                    thread_stack, sizeof( thread_stack ),
+                                                    "static_t", NULL );
+    TEST_ASSERT( th != NULL, "Create static thread" );
+    TEST_ASSERT( dmosi_thread_join( th ) == 0, "Join static thread returns 0" );
+    TEST_ASSERT( g_thread_ran == true, "Static thread entry function was executed" );
+    dmosi_thread_destroy( th );
+
+    /* A killed static thread is parked until destroyed, then storage is reusable */
+    th = dmosi_thread_create_static( &thread_storage, slow_thread_entry, NULL, 1,
+                                     thread_stack, sizeof( thread_stack ), "static_k", NULL );
+    TEST_ASSERT( th != NULL, "Re-create static thread in the same storage" );
+    TEST_ASSERT( dmosi_thread_kill( th, 0 ) == 0, "Kill static thread returns 0" );
+    dmosi_thread_destroy( th );
+
+    TEST_ASSERT( dmosi_thread_create_static( &thread_storage, simple_thread_entry, NULL, 1,
+                                             NULL, sizeof( thread_stack ), "static_n", NULL ) == NULL,
+                 "Create static thread with NULL stack returns NULL" );
+}
+
+/* =========================================================================
+ * Stream and message buffer tests
+ * ========================================================================= */
+static void test_stream( void )
+{
+    printf( "\n=== Testing streams and message buffers ===\n" );
+
+    dmosi_stream_t st = dmosi_stream_create( 16, 1 );
+    TEST_ASSERT( st != NULL, "Create stream (size=16, trigger=1)" );
+
+    /* Copying send/receive */
+    const char text[] = "0123456789";
+    char out[ 16 ] = { 0 };
+    size_t n = 0;
+    TEST_ASSERT( dmosi_stream_send( st, text, 10, &n, 0 ) == 0 && n == 10,
+                 "Send 10 bytes to stream" );
+    TEST_ASSERT( dmosi_stream_bytes_available( st ) == 10, "Stream reports 10 bytes available" );
+    TEST_ASSERT( dmosi_stream_send( st, text, 10, &n, 0 ) == -EAGAIN && n == 6,
+                 "Send beyond capacity writes what fits and returns -EAGAIN" );
+    TEST_ASSERT( dmosi_stream_receive( st, out, sizeof( out ), &n, 0 ) == 0 && n == 16,
+                 "Receive all 16 bytes from stream" );
+    TEST_ASSERT( memcmp( out, "0123456789012345", 16 ) == 0, "Stream preserves byte order" );
+    TEST_ASSERT( dmosi_stream_receive( st, out, sizeof( out ), &n, 20 ) == -ETIMEDOUT,
+                 "Receive from empty stream with timeout returns -ETIMEDOUT" );
+
+    /* Zero-copy: the write position is now at the start of the ring */
+    void * wr = NULL;
+    size_t len = 32;
+    TEST_ASSERT( dmosi_stream_reserve( st, &wr, &len, 0 ) == 0 && len == 16,
+                 "Reserve hands out the contiguous free region" );
+    memcpy( wr, "abcd", 4 );
+    TEST_ASSERT( dmosi_stream_commit( st, 20 ) == -EINVAL,
+                 "Commit more than reserved returns -EINVAL" );
+    TEST_ASSERT( dmosi_stream_commit( st, 4 ) == 0, "Commit 4 bytes written in place" );
+
+    const void * rd = NULL;
+    len = 16;
+    TEST_ASSERT( dmosi_stream_peek( st, &rd, &len, 0 ) == 0 && len == 4 &&
+                 memcmp( rd, "abcd", 4 ) == 0,
+                 "Peek returns committed bytes in place" );
+    TEST_ASSERT( dmosi_stream_consume( st, 2 ) == 0, "Consume part of the peeked bytes" );
+    TEST_ASSERT( dmosi_stream_bytes_available( st ) == 2, "Consumed bytes are released" );
+
+    TEST_ASSERT( dmosi_stream_set_trigger_level( st, 17 ) == -EINVAL,
+                 "Trigger level above stream size returns -EINVAL" );
+    TEST_ASSERT( dmosi_stream_set_trigger_level( st, 4 ) == 0, "Set stream trigger level" );
+    dmosi_stream_destroy( st );
+
+    TEST_ASSERT( dmosi_stream_create( 0, 1 ) == NULL, "Create stream with size=0 returns NULL" );
+    TEST_ASSERT( dmosi_stream_send( NULL, text, 1, &n, 0 ) == -EINVAL,
+                 "Send to NULL stream returns -EINVAL" );
+
+    /* Message buffer */
+    dmosi_message_buffer_t mb = dmosi_message_buffer_create( 64 );
+    TEST_ASSERT( mb != NULL, "Create message buffer (size=64)" );
+    TEST_ASSERT( dmosi_message_buffer_send( mb, "hello", 5, 0 ) == 0, "Send message" );
+    TEST_ASSERT( dmosi_message_buffer_receive( mb, out, 4, &n, 0 ) == -EMSGSIZE,
+                 "Receive into too small buffer returns -EMSGSIZE" );
+    TEST_ASSERT( dmosi_message_buffer_receive( mb, out, sizeof( out ), &n, 0 ) == 0 && n == 5 &&
+                 memcmp( out, "hello", 5 ) == 0,
+                 "Receive message" );
+    TEST_ASSERT( dmosi_message_buffer_receive( mb, out, sizeof( out ), &n, 0 ) == -EAGAIN,
+                 "Receive from empty message buffer returns -EAGAIN" );
+    TEST_ASSERT( dmosi_message_buffer_send( mb, out, 64, 0 ) == -EMSGSIZE,
+                 "Send message larger than the buffer returns -EMSGSIZE" );
+    dmosi_message_buffer_destroy( mb );
+}
+
+/* =========================================================================
+ * Lock-free ring tests
+ * ========================================================================= */
+static void ring_producer_entry( void * arg )
+{
+    dmosi_ring_t ring = ( dmosi_ring_t ) arg;
+    for( uint32_t i = 0; i < 100; i++ )
+    {
+        while( dmosi_ring_push( ring, &i ) != 0 )
+        {
+            vTaskDelay( 1 );
+        }
+    }
+}
+
+static void test_ring( void )
+{
+    printf( "\n=== Testing lock-free rings ===\n" );
+
+    dmosi_ring_t r = dmosi_ring_create( sizeof( uint32_t ), 5 );
+    TEST_ASSERT( r != NULL, "Create ring (capacity=5)" );
+    TEST_ASSERT( dmosi_ring_capacity( r ) == 8, "Ring capacity is rounded up to a power of two" );
+
+    uint32_t v = 0;
+    bool pushed = true;
+    for( uint32_t i = 0; i < 8; i++ )
+    {
+        pushed = pushed && ( dmosi_ring_push( r, &i ) == 0 );
+    }
+    TEST_ASSERT( pushed && dmosi_ring_count( r ) == 8, "Fill ring with 8 items" );
+    TEST_ASSERT( dmosi_ring_push( r, &v ) == -EAGAIN, "Push to full ring returns -EAGAIN" );
+
+    bool in_order = true;
+    for( uint32_t i = 0; i < 8; i++ )
+    {
+        in_order = in_order && ( dmosi_ring_pop( r, &v, 0 ) == 0 ) && ( v == i );
+    }
+    TEST_ASSERT( in_order, "Ring pops items in FIFO order" );
+    TEST_ASSERT( dmosi_ring_pop( r, &v, 0 ) == -EAGAIN, "Pop from empty ring returns -EAGAIN" );
+    TEST_ASSERT( dmosi_ring_pop( r, &v, 20 ) == -ETIMEDOUT,
+                 "Pop from empty ring with timeout returns -ETIMEDOUT" );
+
+    /* Blocking consumer parks while a producer thread fills the ring */
+    dmosi_thread_t producer = dmosi_thread_create(
+        ring_producer_entry, r, 1, 4096, "ring_prod", NULL );
+    TEST_ASSERT( producer != NULL, "Create ring producer thread" );
+    in_order = true;
+    for( uint32_t i = 0; i < 100; i++ )
+    {
+        in_order = in_order && ( dmosi_ring_pop( r, &v, 1000 ) == 0 ) && ( v == i );
+    }
+    TEST_ASSERT( in_order, "Blocking pop receives all produced items in order" );
+    dmosi_thread_join( producer );
+    dmosi_thread_destroy( producer );
+    dmosi_ring_destroy( r );
+
+    TEST_ASSERT( dmosi_ring_create( 0, 4 ) == NULL, "Create ring with item_size=0 returns NULL" );
+    TEST_ASSERT( dmosi_ring_create( 4, 0 ) == NULL, "Create ring with capacity=0 returns NULL" );
+    TEST_ASSERT( dmosi_ring_push( NULL, &v ) == -EINVAL, "Push to NULL ring returns -EINVAL" );
+}
+
+/* =========================================================================
+ * Event tests
+ * ========================================================================= */
+static void event_signal_entry( void * arg )
+{
+    vTaskDelay( pdMS_TO_TICKS( 10 ) );
+    dmosi_event_signal( ( dmosi_event_t ) arg );
+}
+
+static void event_foreign_wait_entry( void * arg )
+{
+    g_thread_ran = ( dmosi_event_wait( ( dmosi_event_t ) arg, 0 ) == -EPERM );
+}
+
+static void test_event( void )
+{
+    printf( "\n=== Testing events ===\n" );
+
+    dmosi_event_t ev = dmosi_event_create( dmosi_thread_current() );
+    TEST_ASSERT( ev != NULL, "Create event bound to the current thread" );
+    TEST_ASSERT( dmosi_event_wait( ev, 0 ) == -EAGAIN,
+                 "Wait on unsignalled event (no timeout) returns -EAGAIN" );
+    TEST_ASSERT( dmosi_event_signal( ev ) == 0 && dmosi_event_signal( ev ) == 0,
+                 "Signal event twice" );
+    TEST_ASSERT( dmosi_event_wait( ev, 0 ) == 0, "Wait consumes the signal" );
+    TEST_ASSERT( dmosi_event_wait( ev, 20 ) == -ETIMEDOUT,
+                 "Signals do not accumulate" );
+
+    /* A second event bound to the same thread keeps its own signal */
+    dmosi_event_t ev2 = dmosi_event_create( dmosi_thread_current() );
+    dmosi_event_signal( ev2 );
+    TEST_ASSERT( dmosi_event_wait( ev, 20 ) == -ETIMEDOUT,
+                 "Signal of another event does not satisfy the wait" );
+    TEST_ASSERT( dmosi_event_wait( ev2, 0 ) == 0,
+                 "Other event's signal is preserved" );
+    dmosi_event_destroy( ev2 );
+
+    dmosi_thread_t t = dmosi_thread_create( event_signal_entry, ev, 1, 4096, "ev_sig", NULL );
+    TEST_ASSERT( dmosi_event_wait( ev, 1000 ) == 0, "Blocking wait is woken by a signal" );
+    dmosi_thread_join( t );
+    dmosi_thread_destroy( t );
+
+    g_thread_ran = false;
+    t = dmosi_thread_create( event_foreign_wait_entry, ev, 1, 4096, "ev_foreign", NULL );
+    dmosi_thread_join( t );
+    dmosi_thread_destroy( t );
+    TEST_ASSERT( g_thread_ran, "Wait from a thread the event is not bound to returns -EPERM" );
+    dmosi_event_destroy( ev );
+
+    /* Unbound events are semaphore-backed */
+    ev = dmosi_event_create( NULL );
+    TEST_ASSERT( ev != NULL, "Create unbound event" );
+    TEST_ASSERT( dmosi_event_signal( ev ) == 0 && dmosi_event_signal( ev ) == 0,
+                 "Signal unbound event twice" );
+    TEST_ASSERT( dmosi_event_wait( ev, 0 ) == 0 && dmosi_event_wait( ev, 0 ) == -EAGAIN,
+                 "Unbound event is binary" );
+    dmosi_event_destroy( ev );
+
+    TEST_ASSERT( dmosi_event_signal( NULL ) == -EINVAL, "Signal NULL event returns -EINVAL" );
+}
+
+/* =========================================================================
+ * Event group tests
+ * ========================================================================= */
+static void event_group_set_entry( void * arg )
+{
+    vTaskDelay( pdMS_TO_TICKS( 10 ) );
+    dmosi_event_group_set( ( dmosi_event_group_t ) arg, 0x1 );
+    vTaskDelay( pdMS_TO_TICKS( 10 ) );
+    dmosi_event_group_set( ( dmosi_event_group_t ) arg, 0x4 );
+}
+
+static void test_event_group( void )
+{
+    printf( "\n=== Testing event groups ===\n" );
+
+    dmosi_event_group_t g = dmosi_event_group_create();
+    uint32_t bits = 0;
+    TEST_ASSERT( g != NULL && dmosi_event_group_get( g ) == 0, "Create event group with no bits set" );
+    TEST_ASSERT( dmosi_event_group_wait( g, 0x1, 0, &bits, 0 ) == -EAGAIN,
+                 "Wait for unset bit (no timeout) returns -EAGAIN" );
+
+    TEST_ASSERT( dmosi_event_group_set( g, 0x3 ) == 0 && dmosi_event_group_get( g ) == 0x3, "Set bits" );
+    TEST_ASSERT( dmosi_event_group_wait( g, 0x6, 0, &bits, 0 ) == 0 && bits == 0x3,
+                 "Wait-any is satisfied by one of the bits" );
+    TEST_ASSERT( dmosi_event_group_wait( g, 0x6, DMOSI_EVENT_GROUP_WAIT_ALL, &bits, 20 ) == -ETIMEDOUT,
+                 "Wait-all times out while a bit is missing" );
+    TEST_ASSERT( dmosi_event_group_wait( g, 0x1, DMOSI_EVENT_GROUP_CLEAR_ON_EXIT, &bits, 0 ) == 0 &&
+                 dmosi_event_group_get( g ) == 0x2,
+                 "Clear-on-exit consumes the awaited bits" );
+    TEST_ASSERT( dmosi_event_group_clear( g, 0x2 ) == 0 && dmosi_event_group_get( g ) == 0, "Clear bits" );
+
+    dmosi_thread_t t = dmosi_thread_create( event_group_set_entry, g, 1, 4096, "eg_set", NULL );
+    TEST_ASSERT( dmosi_event_group_wait( g, 0x5, DMOSI_EVENT_GROUP_WAIT_ALL | DMOSI_EVENT_GROUP_CLEAR_ON_EXIT,
+                                         &bits, 1000 ) == 0 && ( bits & 0x5 ) == 0x5,
+                 "Blocking wait-all is woken once all bits are set" );
+    dmosi_thread_join( t );
+    dmosi_thread_destroy( t );
+
+    TEST_ASSERT( dmosi_event_group_set( g, 0x80000000UL ) == -EINVAL, "Setting a reserved bit returns -EINVAL" );
+    TEST_ASSERT( dmosi_event_group_wait( g, 0, 0, NULL, 0 ) == -EINVAL, "Waiting for no bits returns -EINVAL" );
+    TEST_ASSERT( dmosi_event_group_set( NULL, 0x1 ) == -EINVAL, "Set on NULL group returns -EINVAL" );
+    dmosi_event_group_destroy( g );
+}
+
+/* =========================================================================
+ * Multiple object wait tests
+ * ========================================================================= */
+static void wait_multiple_post_entry( void * arg )
+{
+    vTaskDelay( pdMS_TO_TICKS( 10 ) );
+    dmosi_semaphore_post( ( dmosi_semaphore_t ) arg, 1 );
+}
+
+static void test_wait_multiple( void )
+{
+    printf( "\n=== Testing multiple object wait ===\n" );
+
+    dmosi_queue_t q1 = dmosi_queue_create( sizeof( int ), 2 );
+    dmosi_queue_t q2 = dmosi_queue_create( sizeof( int ), 2 );
+    dmosi_semaphore_t sem = dmosi_semaphore_create( 0, 1 );
+    dmosi_wait_object_t objects[] = {
+        { DMOSI_WAIT_QUEUE, q1 },
+        { DMOSI_WAIT_QUEUE, q2 },
+        { DMOSI_WAIT_SEMAPHORE, sem },
+    };
+    int item = 5;
+    int received = 0;
+
+    TEST_ASSERT( dmosi_wait_multiple( objects, 3, 0 ) == -EAGAIN, "Nothing ready (no timeout) returns -EAGAIN" );
+    TEST_ASSERT( dmosi_wait_multiple( objects, 3, 20 ) == -ETIMEDOUT, "Nothing ready times out" );
+
+    dmosi_queue_send( q2, &item, 0 );
+    TEST_ASSERT( dmosi_wait_multiple( objects, 3, 0 ) == 1, "Reports the queue holding an item" );
+    TEST_ASSERT( dmosi_queue_receive( q2, &received, 0 ) == 0 && received == 5, "Item can then be received" );
+
+    dmosi_queue_send( q1, &item, 0 );
+    dmosi_semaphore_post( sem, 1 );
+    TEST_ASSERT( dmosi_wait_multiple( objects, 3, 0 ) == 0, "Lowest index wins when several are ready" );
+    dmosi_queue_receive( q1, &received, 0 );
+    TEST_ASSERT( dmosi_wait_multiple( objects, 3, 0 ) == 2 && dmosi_semaphore_wait( sem, 1, 0 ) == 0,
+                 "Reports a semaphore with a unit available" );
+
+    dmosi_thread_t t = dmosi_thread_create( wait_multiple_post_entry, sem, 1, 4096, "wm_post", NULL );
+    TEST_ASSERT( dmosi_wait_multiple( objects, 3, 1000 ) == 2, "Blocking wait is woken by a post" );
+    dmosi_thread_join( t );
+    dmosi_thread_destroy( t );
+    dmosi_semaphore_wait( sem, 1, 0 );
+
+    TEST_ASSERT( dmosi_wait_multiple( objects, 0, 0 ) == -EINVAL, "Empty object list returns -EINVAL" );
+    TEST_ASSERT( dmosi_wait_multiple( NULL, 1, 0 ) == -EINVAL, "NULL object list returns -EINVAL" );
+
+    dmosi_semaphore_destroy( sem );
+    dmosi_queue_destroy( q2 );
+    dmosi_queue_destroy( q1 );
+}
+
+/* =========================================================================
+ * Work queue tests
+ * ========================================================================= */
+static volatile int g_work_runs = 0;
+
+static void work_count_fn( void * arg )
+{
+    ( void ) arg;
+    taskENTER_CRITICAL();
+    g_work_runs++;
+    taskEXIT_CRITICAL();
+}
+
+static void test_workqueue( void )
+{
+    printf( "\n=== Testing work queues ===\n" );
+
+    /* Workers run below the test task, so submitted items stay pending
+     * until the test blocks */
+    dmosi_workqueue_t wq = dmosi_workqueue_create( 2, 1, 4096, "wq", NULL );
+    TEST_ASSERT( wq != NULL, "Create work queue with 2 workers" );
+
+    dmosi_work_t works[ 4 ];
+    g_work_runs = 0;
+    for( int i = 0; i < 4; i++ )
+    {
+        dmosi_work_init( &works[ i ], work_count_fn, NULL );
+    }
+    TEST_ASSERT( dmosi_work_wait( &works[ 0 ], 0 ) == -EINVAL,
+                 "Wait on never-submitted work returns -EINVAL" );
+
+    for( int i = 0; i < 4; i++ )
+    {
+        TEST_ASSERT( dmosi_workqueue_submit( wq, &works[ i ] ) == 0, "Submit work item" );
+    }
+    TEST_ASSERT( dmosi_workqueue_submit( wq, &works[ 0 ] ) == -EBUSY,
+                 "Resubmit pending work returns -EBUSY" );
+    TEST_ASSERT( dmosi_work_wait( &works[ 0 ], 0 ) == -EAGAIN,
+                 "Wait on pending work (no timeout) returns -EAGAIN" );
+    TEST_ASSERT( dmosi_workqueue_cancel( wq, &works[ 3 ] ) == 0, "Cancel pending work" );
+    TEST_ASSERT( dmosi_work_wait( &works[ 3 ], 0 ) == -ECANCELED,
+                 "Wait on canceled work returns -ECANCELED" );
+
+    bool all_done = true;
+    for( int i = 0; i < 3; i++ )
+    {
+        all_done = all_done && ( dmosi_work_wait( &works[ i ], 1000 ) == 0 );
+    }
+    TEST_ASSERT( all_done && g_work_runs == 3, "Submitted work runs on the workers" );
+    TEST_ASSERT( dmosi_workqueue_cancel( wq, &works[ 0 ] ) == -ENOENT,
+                 "Cancel finished work returns -ENOENT" );
+
+    /* Finished work can be submitted again */
+    TEST_ASSERT( dmosi_workqueue_submit( wq, &works[ 0 ] ) == 0 &&
+                 dmosi_work_wait( &works[ 0 ], 1000 ) == 0 && g_work_runs == 4,
+                 "Resubmit finished work" );
+
+    /* Destroy cancels what has not started */
+    dmosi_workqueue_submit( wq, &works[ 1 ] );
+    dmosi_workqueue_destroy( wq );
+    TEST_ASSERT( dmosi_work_wait( &works[ 1 ], 0 ) == -ECANCELED,
+                 "Destroy cancels pending work" );
+
+    /* NULL input handling */
+    TEST_ASSERT( dmosi_workqueue_create( 0, 1, 4096, "wq", NULL ) == NULL,
+                 "Create work queue with no workers returns NULL" );
+    TEST_ASSERT( dmosi_workqueue_submit( NULL, &works[ 0 ] ) == -EINVAL,
+                 "Submit to NULL work queue returns -EINVAL" );
+    TEST_ASSERT( dmosi_work_init( NULL, work_count_fn, NULL ) == -EINVAL,
+                 "Init NULL work returns -EINVAL" );
+    dmosi_workqueue_destroy( NULL );
+}
+
+/* =========================================================================
+ * Future tests
+ * ========================================================================= */
+static volatile intptr_t g_future_callback_result = 0;
+
+static void future_complete_entry( void * arg )
+{
+    dmosi_thread_sleep( 10 );
+    dmosi_future_complete( ( dmosi_future_t ) arg, 42 );
+}
+
+static void future_callback( dmosi_future_t future, intptr_t result, void * arg )
+{
+    ( void ) arg;
+    g_future_callback_result = result;
+    /* The callback owns the future and releases it */
+    dmosi_future_destroy( future );
+}
+
+static void test_future( void )
+{
+    printf( "\n=== Testing futures ===\n" );
+
+    dmosi_future_t f = dmosi_future_create();
+    intptr_t result = 0;
+    TEST_ASSERT( f != NULL, "Create future" );
+    TEST_ASSERT( dmosi_future_poll( f, &result ) == -EAGAIN, "Poll pending future returns -EAGAIN" );
+    TEST_ASSERT( dmosi_future_wait( f, &result, 0 ) == -EAGAIN, "Wait on pending future (no timeout) returns -EAGAIN" );
+    TEST_ASSERT( dmosi_future_wait( f, &result, 20 ) == -ETIMEDOUT, "Wait on pending future times out" );
+
+    /* Completion from another thread wakes the waiter */
+    dmosi_thread_t t = dmosi_thread_create( future_complete_entry, f, 1, 4096, "fut", NULL );
+    TEST_ASSERT( dmosi_future_wait( f, &result, 1000 ) == 0 && result == 42, "Wait returns the result" );
+    TEST_ASSERT( dmosi_future_complete( f, 7 ) == -EALREADY, "Completing twice returns -EALREADY" );
+    TEST_ASSERT( dmosi_future_poll( f, &result ) == 0 && result == 42, "Poll completed future returns the result" );
+    dmosi_thread_join( t );
+    dmosi_thread_destroy( t );
+
+    /* Reset makes the future reusable, also in a multiple wait */
+    TEST_ASSERT( dmosi_future_reset( f ) == 0 && dmosi_future_poll( f, NULL ) == -EAGAIN,
+                 "Reset returns the future to pending" );
+    dmosi_semaphore_t sem = dmosi_semaphore_create( 0, 1 );
+    dmosi_wait_object_t objects[ 2 ] = {
+        { .type = DMOSI_WAIT_SEMAPHORE, .object = sem },
+        { .type = DMOSI_WAIT_FUTURE, .object = f },
+    };
+    t = dmosi_thread_create( future_complete_entry, f, 1, 4096, "fut", NULL );
+    TEST_ASSERT( dmosi_wait_multiple( objects, 2, 1000 ) == 1, "Multiple wait reports the completed future" );
+    dmosi_thread_join( t );
+    dmosi_thread_destroy( t );
+    dmosi_semaphore_destroy( sem );
+
+    /* Pooled futures come back to the pool */
+    dmosi_pool_stats_t before, after;
+    dmosi_pool_get_stats( DMOSI_POOL_FUTURE, &before );
+    dmosi_future_destroy( f );
+    dmosi_pool_get_stats( DMOSI_POOL_FUTURE, &after );
+    TEST_ASSERT( after.in_use + 1 == before.in_use, "Destroyed future returns to the pool" );
+
+    /* Callback on a work queue, attached before and after completion */
+    dmosi_workqueue_t wq = dmosi_workqueue_create( 1, 1, 4096, "fut_wq", NULL );
+    f = dmosi_future_create();
+    g_future_callback_result = 0;
+    TEST_ASSERT( dmosi_future_on_complete( f, wq, future_callback, NULL ) == 0, "Attach callback" );
+    TEST_ASSERT( dmosi_future_on_complete( f, wq, future_callback, NULL ) == -EBUSY,
+                 "Attaching a second callback returns -EBUSY" );
+    TEST_ASSERT( dmosi_future_complete( f, 5 ) == 0, "Complete future with a callback" );
+    for( int i = 0; i < 100 && g_future_callback_result == 0; i++ )
+    {
+        dmosi_thread_sleep( 1 );
+    }
+    TEST_ASSERT( g_future_callback_result == 5, "Callback runs with the result" );
+
+    f = dmosi_future_create();
+    g_future_callback_result = 0;
+    dmosi_future_complete( f, 9 );
+    TEST_ASSERT( dmosi_future_on_complete( f, wq, future_callback, NULL ) == 0,
+                 "Attach callback to a completed future" );
+    for( int i = 0; i < 100 && g_future_callback_result == 0; i++ )
+    {
+        dmosi_thread_sleep( 1 );
+    }
+    TEST_ASSERT( g_future_callback_result == 9, "Callback of a completed future runs right away" );
+    dmosi_workqueue_destroy( wq );
+
+    /* NULL input handling */
+    TEST_ASSERT( dmosi_future_complete( NULL, 0 ) == -EINVAL, "Complete NULL future returns -EINVAL" );
+    TEST_ASSERT( dmosi_future_wait( NULL, NULL, 0 ) == -EINVAL, "Wait on NULL future returns -EINVAL" );
+    TEST_ASSERT( dmosi_future_on_complete( NULL, NULL, future_callback, NULL ) == -EINVAL,
+                 "Attach callback to NULL future returns -EINVAL" );
+    dmosi_future_destroy( NULL );
+}
+
+/* =========================================================================
+ * Deferred interrupt work tests
+ * ========================================================================= */
+static volatile uint32_t g_defer_order = 0;
+
+static void defer_call( void * arg )
+{
+    g_defer_order = g_defer_order * 10U + ( uint32_t ) ( uintptr_t ) arg;
+    if( g_defer_order >= 123U )
+    {
+        g_thread_ran = ( xTaskGetCurrentTaskHandle() != NULL &&
+                         strcmp( pcTaskGetName( NULL ), "dmosi_defer" ) == 0 );
+    }
+}
+
+static void test_defer( void )
+{
+    printf( "\n=== Testing deferred interrupt work ===\n" );
+
+    g_defer_order = 0;
+    g_thread_ran = false;
+    TEST_ASSERT( dmosi_defer_from_isr( defer_call, ( void * ) 1 ) == 0 &&
+                 dmosi_defer_from_isr( defer_call, ( void * ) 2 ) == 0 &&
+                 dmosi_defer_from_isr( defer_call, ( void * ) 3 ) == 0,
+                 "Queue three deferred calls" );
+
+    for( int i = 0; i < 50 && g_defer_order < 123U; i++ )
+    {
+        dmosi_thread_sleep( 2 );
+    }
+    TEST_ASSERT( g_defer_order == 123U, "Deferred calls run in order" );
+    TEST_ASSERT( g_thread_ran, "Deferred calls run on the daemon task" );
+
+    TEST_ASSERT( dmosi_defer_from_isr( NULL, NULL ) == -EINVAL, "Deferring NULL returns -EINVAL" );
+    TEST_ASSERT( dmosi_defer_get_dropped() == 0, "No deferred call was dropped" );
+}
+
+/* =========================================================================
+ * Timer wheel tests
+ * ========================================================================= */
+static volatile int g_wheel_fires = 0;
+
+static void wheel_count_fn( void * arg )
+{
+    ( void ) arg;
+    taskENTER_CRITICAL();
+    g_wheel_fires++;
+    taskEXIT_CRITICAL();
+}
+
+static void test_timer_wheel( void )
+{
+    printf( "\n=== Testing timer wheel ===\n" );
+
+    dmosi_timer_wheel_t wheel = dmosi_timer_wheel_create( 2, 1, 4096, "wheel", NULL );
+    TEST_ASSERT( wheel != NULL, "Create timer wheel with 2 dispatch threads" );
+
+    dmosi_wheel_timer_t one_shot;
+    TEST_ASSERT( dmosi_wheel_timer_init( &one_shot, wheel, wheel_count_fn, NULL, 0 ) == 0,
+                 "Init one-shot wheel timer" );
+    TEST_ASSERT( !dmosi_wheel_timer_is_active( &one_shot ), "Initialized wheel timer is idle" );
+
+    g_wheel_fires = 0;
+    TEST_ASSERT( dmosi_wheel_timer_start( &one_shot, 20 ) == 0, "Start one-shot wheel timer" );
+    TEST_ASSERT( dmosi_wheel_timer_is_active( &one_shot ), "Started wheel timer is active" );
+    vTaskDelay( pdMS_TO_TICKS( 100 ) );
+    TEST_ASSERT( g_wheel_fires == 1, "One-shot wheel timer fires once" );
+    TEST_ASSERT( !dmosi_wheel_timer_is_active( &one_shot ), "Fired one-shot wheel timer is idle" );
+
+    /* Stop before expiry */
+    g_wheel_fires = 0;
+    dmosi_wheel_timer_start( &one_shot, 50 );
+    TEST_ASSERT( dmosi_wheel_timer_stop( &one_shot ) == 0, "Stop armed wheel timer" );
+    TEST_ASSERT( dmosi_wheel_timer_stop( &one_shot ) == -ENOENT,
+                 "Stop idle wheel timer returns -ENOENT" );
+    vTaskDelay( pdMS_TO_TICKS( 100 ) );
+    TEST_ASSERT( g_wheel_fires == 0, "Stopped wheel timer does not fire" );
+
+    /* Periodic timer */
+    dmosi_wheel_timer_t periodic;
+    dmosi_wheel_timer_init( &periodic, wheel, wheel_count_fn, NULL, DMOSI_WHEEL_TIMER_PERIODIC );
+    g_wheel_fires = 0;
+    dmosi_wheel_timer_start( &periodic, 10 );
+    vTaskDelay( pdMS_TO_TICKS( 105 ) );
+    dmosi_wheel_timer_stop( &periodic );
+    TEST_ASSERT( g_wheel_fires >= 5, "Periodic wheel timer fires repeatedly" );
+
+    /* Far-out timers sit in the upper wheel levels */
+    dmosi_wheel_timer_t far;
+    dmosi_wheel_timer_init( &far, wheel, wheel_count_fn, NULL, 0 );
+    dmosi_wheel_timer_start( &far, 600000 );
+    TEST_ASSERT( dmosi_wheel_timer_is_active( &far ), "Far-out wheel timer is armed" );
+    dmosi_timer_wheel_advance( wheel );
+    TEST_ASSERT( dmosi_wheel_timer_stop( &far ) == 0, "Stop far-out wheel timer" );
+
+    /* Destroy drops armed timers */
+    dmosi_wheel_timer_start( &one_shot, 1000 );
+    dmosi_timer_wheel_destroy( wheel );
+
+    /* Direct callbacks on a wheel without dispatch threads */
+    wheel = dmosi_timer_wheel_create( 0, 1, 4096, "wheel", NULL );
+    TEST_ASSERT( wheel != NULL, "Create timer wheel without dispatch threads" );
+    dmosi_wheel_timer_init( &one_shot, wheel, wheel_count_fn, NULL, DMOSI_WHEEL_TIMER_DIRECT );
+    g_wheel_fires = 0;
+    dmosi_wheel_timer_start( &one_shot, 10 );
+    vTaskDelay( pdMS_TO_TICKS( 60 ) );
+    TEST_ASSERT( g_wheel_fires == 1, "Direct wheel timer fires on the service thread" );
+    dmosi_timer_wheel_destroy( wheel );
+
+    /* NULL input handling */
+    TEST_ASSERT( dmosi_timer_wheel_create( 0, 1, 0, "wheel", NULL ) == NULL,
+                 "Create timer wheel with zero stack returns NULL" );
+    TEST_ASSERT( dmosi_wheel_timer_init( NULL, wheel, wheel_count_fn, NULL, 0 ) == -EINVAL,
+                 "Init NULL wheel timer returns -EINVAL" );
+    TEST_ASSERT( dmosi_wheel_timer_init( &one_shot, NULL, wheel_count_fn, NULL, 0 ) == -EINVAL,
+                 "Init wheel timer without wheel returns -EINVAL" );
+    TEST_ASSERT( dmosi_wheel_timer_start( NULL, 10 ) == -EINVAL,
+                 "Start NULL wheel timer returns -EINVAL" );
+    TEST_ASSERT( dmosi_wheel_timer_stop( NULL ) == -EINVAL,
+                 "Stop NULL wheel timer returns -EINVAL" );
+    dmosi_timer_wheel_destroy( NULL );
+}
+
+/* =========================================================================
+ * Run-time statistics tests
+ * ========================================================================= */
+static void test_runtime_stats( void )
+{
+    printf( "\n=== Testing run-time statistics ===\n" );
+
+    TEST_ASSERT( dmosi_runtime_get_counter_hz() > 0, "Run-time counter frequency is known" );
+
+    /* Let the sampler record a few samples */
+    vTaskDelay( pdMS_TO_TICKS( 3 * 500 ) );
+
+    float usage = -1.0f;
+    TEST_ASSERT( dmosi_thread_get_cpu_usage( NULL, DMOSI_CPU_WINDOW_SHORT_MS, &usage ) == 0 &&
+                 usage >= 0.0f && usage <= 100.0f,
+                 "Current thread CPU usage over the short window is in range" );
+    usage = -1.0f;
+    TEST_ASSERT( dmosi_thread_get_cpu_usage( NULL, 0, &usage ) == 0 && usage >= 0.0f && usage <= 100.0f,
+                 "Current thread lifetime CPU usage is in range" );
+
+    usage = -1.0f;
+    TEST_ASSERT( dmosi_process_get_cpu_usage( NULL, DMOSI_CPU_WINDOW_LONG_MS, &usage ) == 0 &&
+                 usage >= 0.0f && usage <= 100.0f * ( float ) dmosi_core_count(),
+                 "Current process CPU usage over the long window is in range" );
+
+    bool cores_ok = true;
+    for( uint32_t core = 0; core < dmosi_core_count(); core++ )
+    {
+        usage = -1.0f;
+        cores_ok = cores_ok && ( dmosi_core_get_cpu_usage( core, DMOSI_CPU_WINDOW_SHORT_MS, &usage ) == 0 ) &&
+                   usage >= 0.0f && usage <= 100.0f;
+    }
+    TEST_ASSERT( cores_ok, "Windowed core usage is in range" );
+
+    dmosi_thread_info_t info;
+    TEST_ASSERT( dmosi_thread_get_info( NULL, &info ) == 0 && info.cpu_usage >= 0.0f && info.cpu_usage <= 100.0f,
+                 "Thread info reports windowed CPU usage" );
+
+    /* Invalid parameters */
+    TEST_ASSERT( dmosi_thread_get_cpu_usage( NULL, 1000, NULL ) == -EINVAL,
+                 "Thread CPU usage into NULL returns -EINVAL" );
+    TEST_ASSERT( dmosi_process_get_cpu_usage( NULL, 1000, NULL ) == -EINVAL,
+                 "Process CPU usage into NULL returns -EINVAL" );
+    TEST_ASSERT( dmosi_core_get_cpu_usage( dmosi_core_count(), 1000, &usage ) == -EINVAL,
+                 "Usage of a non-existent core returns -EINVAL" );
+}
+
+/* =========================================================================
+ * Trace recorder tests
+ * ========================================================================= */
+static void test_trace( void )
+{
+    printf( "\n=== Testing trace recorder ===\n" );
+
+    dmosi_trace_event_t events[ 32 ];
+
+    TEST_ASSERT( dmosi_trace_read( NULL, 32 ) == 0, "Reading into NULL returns no events" );
+
+    if( dmosi_trace_start() == -ENOTSUP )
+    {
+        TEST_ASSERT( !dmosi_trace_is_running() && dmosi_trace_read( events, 32 ) == 0,
+                     "Trace recorder is disabled in this build (DMOSI_TRACE=OFF)" );
+        return;
+    }
+    TEST_ASSERT( dmosi_trace_is_running(), "Trace recorder is running after start" );
+
+    /* Existing tasks are announced with their names on start */
+    bool found_name = false;
+    size_t count;
+    while( ( count = dmosi_trace_read( events, 32 ) ) > 0 )
+    {
+        for( size_t i = 0; i < count; i++ )
+        {
+            found_name = found_name || ( events[ i ].type == DMOSI_TRACE_EVENT_NAME );
+        }
+    }
+    TEST_ASSERT( found_name, "Start records the names of existing tasks" );
+
+    dmosi_queue_t q = dmosi_queue_create( sizeof( int ), 1 );
+    int item = 7;
+    int received = 0;
+    dmosi_queue_send( q, &item, 0 );
+    dmosi_queue_send( q, &item, 0 );    /* Full: fails */
+    dmosi_queue_receive( q, &received, 0 );
+    dmosi_thread_sleep( 20 );
+    dmosi_trace_stop();
+    dmosi_queue_destroy( q );
+
+    TEST_ASSERT( !dmosi_trace_is_running(), "Trace recorder is stopped after stop" );
+
+    bool found_send = false;
+    bool found_send_failed = false;
+    bool found_receive = false;
+    bool found_switch = false;
+    bool ordered = true;
+    uint64_t last_ns[ 8 ] = { 0 };
+    while( ( count = dmosi_trace_read( events, 32 ) ) > 0 )
+    {
+        for( size_t i = 0; i < count; i++ )
+        {
+            const dmosi_trace_event_t* e = &events[ i ];
+            uint32_t core = ( e->core < 8 ) ? e->core : 7;
+            ordered = ordered && ( e->timestamp_ns >= last_ns[ core ] );
+            last_ns[ core ] = e->timestamp_ns;
+
+            bool base_queue = ( e->arg & 0xFFu ) == queueQUEUE_TYPE_BASE;
+            found_send = found_send || ( e->type == DMOSI_TRACE_EVENT_QUEUE_SEND && base_queue );
+            found_send_failed = found_send_failed || ( e->type == DMOSI_TRACE_EVENT_QUEUE_SEND_FAILED && base_queue );
+            found_receive = found_receive || ( e->type == DMOSI_TRACE_EVENT_QUEUE_RECEIVE && base_queue );
+            found_switch = found_switch || ( e->type == DMOSI_TRACE_EVENT_TASK_SWITCH_IN );
+        }
+    }
+    TEST_ASSERT( found_send && found_send_failed && found_receive, "Queue operations are recorded" );
+    TEST_ASSERT( found_switch, "Context switches are recorded" );
+    TEST_ASSERT( ordered, "Events of each core are time-ordered" );
+    TEST_ASSERT( dmosi_trace_read( events, 32 ) == 0, "Rings are empty after draining" );
+}
+
+/* =========================================================================
+ * Object statistics tests
+ * ========================================================================= */
+static void test_object_stats( void )
+{
+    printf( "\n=== Testing object statistics ===\n" );
+
+    dmosi_queue_t q = dmosi_queue_create( sizeof( int ), 2 );
+    dmosi_semaphore_t sem = dmosi_semaphore_create( 0, 1 );
+    dmosi_object_stats_t stats;
+    dmosi_object_info_t objects[ 16 ];
+
+    TEST_ASSERT( dmosi_object_get_stats( NULL, &stats ) == -EINVAL, "Stats of NULL returns -EINVAL" );
+
+    if( dmosi_object_get_stats( q, &stats ) == -ENOTSUP )
+    {
+        TEST_ASSERT( dmosi_object_set_name( q, "q" ) == -ENOTSUP && dmosi_object_get_all( objects, 16 ) == 0,
+                     "Object statistics are disabled in this build (DMOSI_OBJECT_STATS=OFF)" );
+        dmosi_semaphore_destroy( sem );
+        dmosi_queue_destroy( q );
+        return;
+    }
+
+    int item = 1;
+    int received = 0;
+    dmosi_queue_send( q, &item, 0 );
+    dmosi_queue_send( q, &item, 0 );
+    dmosi_queue_send( q, &item, 0 );    /* Full: fails */
+    dmosi_queue_receive( q, &received, 0 );
+    TEST_ASSERT( dmosi_object_get_stats( q, &stats ) == 0 && stats.operations == 3 && stats.timeouts == 1 &&
+                 stats.high_water == 2 && stats.blocked == 0,
+                 "Queue counts items moved, failures and the high watermark" );
+
+    TEST_ASSERT( dmosi_semaphore_wait( sem, 1, 50 ) == -ETIMEDOUT, "Empty semaphore wait times out" );
+    TEST_ASSERT( dmosi_object_get_stats( sem, &stats ) == 0 && stats.blocked == 1 && stats.timeouts == 1 &&
+                 stats.high_water == 1 && stats.wait_time_total_us >= 30000,
+                 "Semaphore accounts the blocked wait and its duration" );
+
+    TEST_ASSERT( dmosi_object_set_name( q, "stats_q" ) == 0, "Naming a queue succeeds" );
+    size_t count = dmosi_object_get_all( objects, 16 );
+    bool found = false;
+    for( size_t i = 0; i < count; i++ )
+    {
+        found = found || ( objects[ i ].object == q && objects[ i ].type == DMOSI_OBJECT_TYPE_QUEUE &&
+                           objects[ i ].name != NULL && strcmp( objects[ i ].name, "stats_q" ) == 0 );
+    }
+    TEST_ASSERT( found, "Enumeration reports the named queue" );
+
+    dmosi_semaphore_destroy( sem );
+    dmosi_queue_destroy( q );
+    TEST_ASSERT( dmosi_object_get_stats( q, &stats ) == -ENOENT, "Destroyed objects leave the registry" );
+}
+
+/* =========================================================================
+ * Periodic schedule tests
+ * ========================================================================= */
+static void test_periodic( void )
+{
+    printf( "\n=== Testing periodic schedule ===\n" );
+
+    const uint32_t tick_us = 1000000u / configTICK_RATE_HZ;
+    dmosi_periodic_t p;
+    dmosi_periodic_stats_t ps;
+
+    /* Drift-free: execution time inside the loop does not add up */
+    TEST_ASSERT( dmosi_periodic_init( &p, 2u * tick_us ) == 0, "Init periodic schedule" );
+    TickType_t start = xTaskGetTickCount();
+    int missed = 0;
+    for( int i = 0; i < 4; i++ )
+    {
+        vTaskDelay( 1 );    /* Loop body shorter than the period */
+        missed += dmosi_periodic_wait( &p );
+    }
+    TEST_ASSERT( missed == 0 && xTaskGetTickCount() - start == 8,
+                 "Periodic waits wake on the absolute time grid" );
+
+    /* Sub-tick period: 1.5 ticks alternates between 1 and 2 ticks */
+    dmosi_periodic_init( &p, tick_us + tick_us / 2u );
+    start = xTaskGetTickCount();
+    for( int i = 0; i < 4; i++ )
+    {
+        dmosi_periodic_wait( &p );
+    }
+    TEST_ASSERT( xTaskGetTickCount() - start == 6, "Sub-tick period is exact on average" );
+
+    /* Overrun: missed activations are skipped and reported */
+    dmosi_periodic_init( &p, 2u * tick_us );
+    vTaskDelay( 5 );
+    missed = dmosi_periodic_wait( &p );
+    TEST_ASSERT( missed == 2, "Overrun skips the missed activations" );
+    TEST_ASSERT( dmosi_periodic_get_stats( &p, &ps ) == 0 && ps.overruns == 1 &&
+                 ps.missed_periods == 2 && ps.activations == 1 && ps.max_lateness_us == 3u * tick_us,
+                 "Periodic stats report the overrun and its lateness" );
+
+    /* Invalid input handling */
+    TEST_ASSERT( dmosi_periodic_init( &p, tick_us / 2u ) == -EINVAL,
+                 "Init with a period below one tick returns -EINVAL" );
+    TEST_ASSERT( dmosi_periodic_wait( NULL ) == -EINVAL, "Wait on NULL schedule returns -EINVAL" );
+    TEST_ASSERT( dmosi_periodic_get_stats( &p, NULL ) == -EINVAL, "Get stats into NULL returns -EINVAL" );
+}
+
+/* =========================================================================
+ * Power management tests
+ * ========================================================================= */
+static int g_pm_pre_calls = 0;
+static int g_pm_post_calls = 0;
+static dmosi_pm_state_t g_pm_last_state = DMOSI_PM_STATE_ACTIVE;
+
+static int pm_pre_sleep_fn( dmosi_pm_state_t state, uint32_t idle_us, void * arg )
+{
+    ( void ) idle_us;
+    g_pm_pre_calls++;
+    g_pm_last_state = state;
+    return ( arg != NULL ) ? 1 : 0;
+}
+
+static void pm_post_sleep_fn( dmosi_pm_state_t state, void * arg )
+{
+    ( void ) arg;
+    ( void ) state;
+    g_pm_post_calls++;
+}
+
+static void test_power( void )
+{
+    printf( "\n=== Testing power management ===\n" );
+
+    /* State selection follows the declared exit latencies */
+    TEST_ASSERT( dmosi_pm_select_state( 1000 ) == DMOSI_PM_STATE_SLEEP,
+                 "Only WFI sleep is available by default" );
+    TEST_ASSERT( dmosi_pm_set_state_latency( DMOSI_PM_STATE_STOP, 100 ) == 0 &&
+                 dmosi_pm_set_state_latency( DMOSI_PM_STATE_STANDBY, 5000 ) == 0,
+                 "Declare deeper sleep states" );
+    TEST_ASSERT( dmosi_pm_select_state( 10000 ) == DMOSI_PM_STATE_STANDBY,
+                 "Long idle period selects the deepest state" );
+    TEST_ASSERT( dmosi_pm_select_state( 1000 ) == DMOSI_PM_STATE_STOP,
+                 "Idle period shorter than the wake-up latency rules a state out" );
+
+    /* Latency constraints */
+    dmosi_pm_constraint_t c1, c2;
+    TEST_ASSERT( dmosi_pm_constraint_add( &c1, 200 ) == 0 && dmosi_pm_select_state( 10000 ) == DMOSI_PM_STATE_STOP,
+                 "Latency constraint limits the sleep depth" );
+    TEST_ASSERT( dmosi_pm_constraint_add( &c1, 200 ) == -EEXIST, "Add active constraint returns -EEXIST" );
+    TEST_ASSERT( dmosi_pm_constraint_add( &c2, 0 ) == 0 && dmosi_pm_select_state( 10000 ) == DMOSI_PM_STATE_ACTIVE,
+                 "Zero-latency constraint prevents sleep" );
+    TEST_ASSERT( dmosi_pm_pre_sleep( 100 ) == 0, "Pre-sleep with sleep disallowed skips the wait" );
+    dmosi_pm_post_sleep( 100 );
+    TEST_ASSERT( dmosi_pm_constraint_remove( &c2 ) == 0 && dmosi_pm_select_state( 10000 ) == DMOSI_PM_STATE_STOP,
+                 "Removing a constraint relaxes the limit" );
+    TEST_ASSERT( dmosi_pm_constraint_remove( &c1 ) == 0 && dmosi_pm_constraint_remove( &c1 ) == -ENOENT,
+                 "Remove inactive constraint returns -ENOENT" );
+
+    /* Hooks run around a sleep */
+    dmosi_pm_hook_t hook = { .pre_sleep = pm_pre_sleep_fn, .post_sleep = pm_post_sleep_fn, .arg = NULL };
+    TEST_ASSERT( dmosi_pm_register_hook( &hook ) == 0, "Register sleep hooks" );
+    TEST_ASSERT( dmosi_pm_register_hook( &hook ) == -EEXIST, "Register hooks twice returns -EEXIST" );
+    TEST_ASSERT( dmosi_pm_pre_sleep( 100 ) == 100 && g_pm_pre_calls == 1 &&
+                 g_pm_last_state == DMOSI_PM_STATE_STANDBY,
+                 "Pre-sleep hook sees the selected state" );
+    dmosi_pm_post_sleep( 100 );
+    TEST_ASSERT( g_pm_post_calls == 1, "Post-sleep hook runs after waking" );
+    hook.arg = &hook;
+    TEST_ASSERT( dmosi_pm_pre_sleep( 100 ) == 0, "Hook performing the sleep itself skips the port's wait" );
+    dmosi_pm_post_sleep( 100 );
+    TEST_ASSERT( dmosi_pm_unregister_hook( &hook ) == 0 && dmosi_pm_unregister_hook( &hook ) == -ENOENT,
+                 "Unregister sleep hooks" );
+
+    dmosi_pm_set_state_latency( DMOSI_PM_STATE_STOP, UINT32_MAX );
+    dmosi_pm_set_state_latency( DMOSI_PM_STATE_STANDBY, UINT32_MAX );
+
+    /* Invalid input handling */
+    TEST_ASSERT( dmosi_pm_set_state_latency( DMOSI_PM_STATE_ACTIVE, 0 ) == -EINVAL,
+                 "Set latency of the active state returns -EINVAL" );
+    TEST_ASSERT( dmosi_pm_register_hook( NULL ) == -EINVAL && dmosi_pm_constraint_add( NULL, 0 ) == -EINVAL,
+                 "NULL hook or constraint returns -EINVAL" );
+}
+
+/* =========================================================================
+ * Memory protection tests
+ * ========================================================================= */
+static void test_mpu( void )
+{
+    printf( "\n=== Testing memory protection ===\n" );
+
+    static uint8_t region[ 2 * DMOSI_MPU_REGION_ALIGNMENT ] __attribute__( ( aligned( DMOSI_MPU_REGION_ALIGNMENT ) ) );
+    dmosi_process_t process = dmosi_process_current();
+
+    TEST_ASSERT( dmosi_mpu_isolate( NULL ) == -EINVAL, "Isolate NULL process returns -EINVAL" );
+    TEST_ASSERT( dmosi_mpu_add_region( process, NULL, sizeof( region ), DMOSI_MPU_READ_WRITE ) == -EINVAL,
+                 "Add region without base returns -EINVAL" );
+    TEST_ASSERT( !dmosi_mpu_is_isolated( process ), "Processes are not isolated by default" );
+
+#if DMOSI_MPU
+    /* The test process itself stays privileged, so only the checks */
+    TEST_ASSERT( dmosi_mpu_add_region( process, region, sizeof( region ), DMOSI_MPU_READ_ONLY | DMOSI_MPU_READ_WRITE ) == -EINVAL,
+                 "Add region with both access levels returns -EINVAL" );
+    TEST_ASSERT( dmosi_mpu_add_region( process, region + 1, DMOSI_MPU_REGION_ALIGNMENT, DMOSI_MPU_READ_WRITE ) == -EINVAL,
+                 "Add misaligned region returns -EINVAL" );
+    TEST_ASSERT( dmosi_mpu_add_region( process, region, sizeof( region ), DMOSI_MPU_READ_WRITE ) == -ESRCH,
+                 "Add region to a process that is not isolated returns -ESRCH" );
+    TEST_ASSERT( dmosi_mpu_release( process ) == -ESRCH, "Release a process that is not isolated returns -ESRCH" );
+#else
+    TEST_ASSERT( dmosi_mpu_isolate( process ) == -ENOTSUP, "Isolate returns -ENOTSUP without DMOSI_MPU" );
+    TEST_ASSERT( dmosi_mpu_add_region( process, region, sizeof( region ), DMOSI_MPU_READ_WRITE ) == -ENOTSUP,
+                 "Add region returns -ENOTSUP without DMOSI_MPU" );
+    TEST_ASSERT( dmosi_mpu_release( process ) == -ENOTSUP, "Release returns -ENOTSUP without DMOSI_MPU" );
+#endif
+}
+
 /* =========================================================================
  * Tick count tests
  * ========================================================================= */
@@ -535,6 +2223,108 @@ static void test_tick_count( void )
     uint32_t elapsed = t2 - t1;
     TEST_ASSERT( elapsed >= 40 && elapsed <= 200,
                  "dmosi_get_tick_count() returns time in milliseconds (not raw ticks)" );
+
+    /* High-resolution time is monotonic and advances below tick granularity */
+    uint64_t ns1 = dmosi_get_time_ns();
+    uint64_t ns2 = dmosi_get_time_ns();
+    TEST_ASSERT( ns2 >= ns1, "dmosi_get_time_ns() is monotonic" );
+
+    uint64_t us1 = dmosi_get_time_us();
+    vTaskDelay( pdMS_TO_TICKS( 50 ) );
+    uint64_t us2 = dmosi_get_time_us();
+    TEST_ASSERT( us2 - us1 >= 40000 && us2 - us1 <= 200000,
+                 "dmosi_get_time_us() returns time in microseconds" );
+}
+
+/* =========================================================================
+ * Tick conversion tests
+ * ========================================================================= */
+static void test_ticks( void )
+{
+    printf( "\n=== Testing tick conversion ===\n" );
+
+    /* Millisecond timeouts round up to whole ticks */
+    TEST_ASSERT( dmosi_ms_to_ticks( 0 ) == 0, "0 ms converts to 0 ticks" );
+    TEST_ASSERT( dmosi_ms_to_ticks( 1 ) >= 1, "1 ms rounds up to at least 1 tick" );
+    TEST_ASSERT( dmosi_ms_to_ticks( 1000 ) == configTICK_RATE_HZ,
+                 "1000 ms converts to configTICK_RATE_HZ ticks" );
+    TEST_ASSERT( dmosi_ms_to_ticks( 1001 ) > configTICK_RATE_HZ,
+                 "A partial tick rounds up" );
+    TEST_ASSERT( dmosi_ms_to_ticks( UINT32_MAX ) < DMOSI_TICKS_FOREVER,
+                 "Long finite timeouts never become infinite" );
+    TEST_ASSERT( dmosi_ticks_to_ms( configTICK_RATE_HZ ) == 1000,
+                 "configTICK_RATE_HZ ticks convert to 1000 ms" );
+    TEST_ASSERT( dmosi_ticks_to_ms( UINT32_MAX ) >= UINT32_MAX / configTICK_RATE_HZ,
+                 "Tick to ms conversion is not truncated in tick width" );
+
+    /* The timer period reads back rounded to whole ticks, never shorter */
+    dmosi_timer_t timer = dmosi_timer_create( timer_callback, NULL, 100, false );
+    TEST_ASSERT( timer != NULL, "Create timer for tick conversion" );
+    if ( timer != NULL )
+    {
+        TEST_ASSERT( dmosi_timer_set_period( timer, 1001 ) == 0 &&
+                     dmosi_timer_get_period( timer ) == dmosi_ticks_to_ms( dmosi_ms_to_ticks( 1001 ) ) &&
+                     dmosi_timer_get_period( timer ) >= 1001,
+                     "Timer period is rounded up to whole ticks" );
+        dmosi_timer_destroy( timer );
+    }
+
+    /* Tick-domain variants */
+    dmosi_queue_t queue = dmosi_queue_create( sizeof( uint32_t ), 1 );
+    TEST_ASSERT( queue != NULL, "Create queue for tick-domain timeouts" );
+    if ( queue != NULL )
+    {
+        uint32_t item = 42;
+        uint32_t out = 0;
+        TEST_ASSERT( dmosi_queue_send_ticks( queue, &item, 0 ) == 0, "dmosi_queue_send_ticks() without wait succeeds" );
+        TEST_ASSERT( dmosi_queue_send_ticks( queue, &item, 0 ) == -EAGAIN, "dmosi_queue_send_ticks() on a full queue returns -EAGAIN" );
+        TEST_ASSERT( dmosi_queue_send_ticks( queue, &item, 2 ) == -ETIMEDOUT, "dmosi_queue_send_ticks() times out" );
+        TEST_ASSERT( dmosi_queue_receive_ticks( queue, &out, DMOSI_TICKS_FOREVER ) == 0 && out == 42,
+                     "dmosi_queue_receive_ticks() receives the item" );
+        TEST_ASSERT( dmosi_queue_receive_ticks( queue, &out, 0 ) == -EAGAIN, "dmosi_queue_receive_ticks() on an empty queue returns -EAGAIN" );
+        dmosi_queue_destroy( queue );
+    }
+
+    dmosi_semaphore_t sem = dmosi_semaphore_create( 1, 1 );
+    TEST_ASSERT( sem != NULL, "Create semaphore for tick-domain timeouts" );
+    if ( sem != NULL )
+    {
+        TEST_ASSERT( dmosi_semaphore_wait_ticks( sem, 1, 0 ) == 0, "dmosi_semaphore_wait_ticks() takes an available unit" );
+        TEST_ASSERT( dmosi_semaphore_wait_ticks( sem, 1, 2 ) == -ETIMEDOUT, "dmosi_semaphore_wait_ticks() times out" );
+        dmosi_semaphore_destroy( sem );
+    }
+
+    TickType_t before = xTaskGetTickCount();
+    dmosi_thread_sleep_ticks( 2 );
+    TEST_ASSERT( xTaskGetTickCount() - before >= 2, "dmosi_thread_sleep_ticks() sleeps for the given ticks" );
+
+    /* A millisecond timeout started late in a tick still lasts the full time */
+    sem = dmosi_semaphore_create( 0, 1 );
+    TEST_ASSERT( sem != NULL, "Create semaphore for a late-started timeout" );
+    if ( sem != NULL )
+    {
+        uint32_t tick_us = 1000000U / configTICK_RATE_HZ;
+        int32_t timeout_ms = ( int32_t ) ( ( tick_us + 999U ) / 1000U );
+        TickType_t tick = xTaskGetTickCount();
+        while( xTaskGetTickCount() == tick )
+        {
+        }
+        uint64_t start = dmosi_get_time_us();
+        while( dmosi_get_time_us() - start < tick_us * 3U / 4U )
+        {
+        }
+        start = dmosi_get_time_us();
+        int result = dmosi_semaphore_wait( sem, 1, timeout_ms );
+        uint64_t elapsed = dmosi_get_time_us() - start;
+        TEST_ASSERT( result == -ETIMEDOUT && elapsed >= ( uint64_t ) timeout_ms * 1000U,
+                     "Timeout never expires before the requested time" );
+
+        start = dmosi_get_time_us();
+        dmosi_thread_sleep( ( uint32_t ) timeout_ms );
+        TEST_ASSERT( dmosi_get_time_us() - start >= ( uint64_t ) timeout_ms * 1000U,
+                     "Sleep never ends before the requested time" );
+        dmosi_semaphore_destroy( sem );
+    }
 }
 
 /* =========================================================================
@@ -582,7 +2372,27 @@ static void test_task( void * pvParameters )
     test_queue();
     test_timer();
     test_thread();
+    test_stack_advisor();
+    test_pool();
+    test_heap_stats();
+    test_static_alloc();
+    test_mpu();
+    test_stream();
+    test_ring();
+    test_event();
+    test_event_group();
+    test_wait_multiple();
+    test_workqueue();
+    test_future();
+    test_defer();
+    test_timer_wheel();
+    test_periodic();
+    test_power();
+    test_runtime_stats();
+    test_trace();
+    test_object_stats();
     test_tick_count();
+    test_ticks();
     test_is_started();
     test_init_deinit();
 
@@ -624,6 +2434,11 @@ int main( void )
                  configMAX_PRIORITIES - 2,
                  NULL );
 
+    g_prestart_mutex = dmosi_mutex_create( false );
+    g_prestart_lock_result = dmosi_mutex_lock( g_prestart_mutex );
+    xTaskCreate( prestart_task_entry, "prestart", configMINIMAL_STACK_SIZE, NULL, configMAX_PRIORITIES - 2, NULL );
+    g_prestart_unlock_result = dmosi_mutex_unlock( g_prestart_mutex );
+
     /* dmosi_init() creates the system process and starts the FreeRTOS
      * scheduler.  It blocks here until vTaskEndScheduler() is called.
      * test_task calls dmosi_deinit() followed by vTaskEndScheduler() to